@@ -0,0 +1,322 @@
+// Host-native entry point. Runs the proxy core (stratum server, pool client,
+// resolver, config and boot cache) as a Linux process so it can be exercised
+// with sanitizers, profilers and the scripts in scripts/bench.
+
+#include <Arduino.h>
+#include <HostFS.h>
+
+#include <csignal>
+#include <cstring>
+
+#include "app_context.h"
+#include "boot_cache.h"
+#include "cluster.h"
+#include "config_manager.h"
+#include "config_reload.h"
+#include "header_jobs.h"
+#include "health_monitor.h"
+#include "job_cache.h"
+#include "mdns_service.h"
+#include "metrics_endpoint.h"
+#include "miner_stats.h"
+#include "pool_client.h"
+#include "pool_handover.h"
+#include "pool_probe.h"
+#include "pool_resolver.h"
+#include "pool_split.h"
+#include "pool_tx.h"
+#include "power_policy.h"
+#include "scheduler.h"
+#include "storage.h"
+#include "stratum_capture.h"
+#include "stratum_server.h"
+
+namespace {
+volatile std::sig_atomic_t stop_requested = 0;
+volatile std::sig_atomic_t reload_requested = 0;
+
+void HandleSignal(int) {
+    stop_requested = 1;
+}
+
+// Stands in for saving the dashboard form
+void HandleReload(int) {
+    reload_requested = 1;
+}
+
+void PrintUsage(const char* program) {
+    std::printf("Usage: %s [--data-dir DIR] [--port PORT] [--pool HOST:PORT] [--user USER] [--pass PASS]\n"
+                "          [--capture off|ram|flash] [--sv2] [--coalesce-us US] [--free-heap KB] [--balance]\n"
+                "          [--metrics-port PORT] [--alt-pool HOST:PORT] [--alt-weight PCT] [--slice-s S]\n"
+                "          [--probe pool|HOST:PORT] [--probe-samples N] [--probe-watch-s S]\n"
+                "          [--pool-fingerprint HEX]\n",
+                program);
+}
+
+void ReloadConfigOnSignal() {
+    if (!reload_requested) {
+        return;
+    }
+    reload_requested = 0;
+    if (LoadConfig(config)) {
+        Serial.printf("Reloaded config: pool %s:%d as %s\n", config.pool_host, config.pool_port, config.pool_user);
+        NoteConfigChange();
+    }
+}
+
+// The device's task table, less the Wi-Fi, OTA and display tasks
+void RegisterTasks() {
+    AddTask("pool", ServicePoolLink, 5, 20000, TaskPriority::kHigh);
+    AddTask("stratum", ServiceMinerSessions, 100, 20000, TaskPriority::kHigh);
+    AddTask("handover", UpdatePoolHandover, 10, 20000, TaskPriority::kHigh);
+    AddTask("headers", BuildHeaderJobs, 100, 10000, TaskPriority::kNormal);
+    AddTask("reload", ReloadConfigOnSignal, 100, 5000, TaskPriority::kNormal);
+    AddTask("config", UpdateConfigReload, 100, 20000, TaskPriority::kNormal);
+    AddTask("resolver", UpdatePoolResolver, 100, 5000, TaskPriority::kNormal);
+    AddTask("split", UpdatePoolSplit, 1000, 20000, TaskPriority::kNormal);
+    AddTask("probe", UpdatePoolProbe, 5, 20000, TaskPriority::kNormal);
+    AddTask("health", UpdateHealth, 100, 2000, TaskPriority::kLow);
+    AddTask("power", UpdatePowerPolicy, 1000, 1000, TaskPriority::kLow);
+    AddTask("miners", HandleMinerConnections, 1000, 2000, TaskPriority::kLow);
+    AddTask("cluster", UpdateCluster, 100, 5000, TaskPriority::kLow);
+    AddTask("capture", [] { FlushStratumCapture(); }, 100, 20000, TaskPriority::kLow);
+    AddTask("mdns", UpdateMDNS, 100, 2000, TaskPriority::kLow);
+}
+
+bool ApplyPoolArgument(const char* value, char* host, size_t host_size, int& port_out) {
+    String pool(value);
+    int colon = pool.lastIndexOf(':');
+    if (colon <= 0) {
+        return false;
+    }
+
+    int port = pool.substring(colon + 1).toInt();
+    if (port <= 0 || port > 65535) {
+        return false;
+    }
+
+    CopyStringField(host, host_size, pool.substring(0, colon));
+    port_out = port;
+    return true;
+}
+}
+
+int main(int argc, char** argv) {
+    std::setvbuf(stdout, nullptr, _IOLBF, 0);
+    std::signal(SIGINT, HandleSignal);
+    std::signal(SIGTERM, HandleSignal);
+    std::signal(SIGHUP, HandleReload);
+
+    const char* data_dir = "yuma-data";
+    const char* pool = nullptr;
+    const char* alt_pool = nullptr;
+    long alt_weight = -1;
+    long slice_s = -1;
+    // Stands in for the dashboard's /test_pool
+    const char* probe = nullptr;
+    PoolProbeRequest probe_request;
+    const char* user = nullptr;
+    const char* pass = nullptr;
+    const char* fingerprint = nullptr;
+    CaptureMode capture = CaptureMode::kOff;
+    bool sv2 = false;
+    bool balance = false;
+    long coalesce_us = -1;
+    long free_heap_kb = -1;
+    long port = ConfigDefaults::kStratumPort;
+    long metrics_port = 0;
+
+    for (int i = 1; i < argc; ++i) {
+        const char* arg = argv[i];
+        const char* value = i + 1 < argc ? argv[i + 1] : nullptr;
+
+        if (std::strcmp(arg, "--help") == 0 || std::strcmp(arg, "-h") == 0) {
+            PrintUsage(argv[0]);
+            return 0;
+        }
+        if (std::strcmp(arg, "--sv2") == 0) {
+            sv2 = true;
+            continue;
+        }
+        if (std::strcmp(arg, "--balance") == 0) {
+            balance = true;
+            continue;
+        }
+        if (!value) {
+            PrintUsage(argv[0]);
+            return 2;
+        }
+
+        if (std::strcmp(arg, "--data-dir") == 0) {
+            data_dir = value;
+        } else if (std::strcmp(arg, "--port") == 0) {
+            port = std::strtol(value, nullptr, 10);
+        } else if (std::strcmp(arg, "--pool") == 0) {
+            pool = value;
+        } else if (std::strcmp(arg, "--alt-pool") == 0) {
+            alt_pool = value;
+        } else if (std::strcmp(arg, "--alt-weight") == 0) {
+            alt_weight = std::strtol(value, nullptr, 10);
+        } else if (std::strcmp(arg, "--slice-s") == 0) {
+            slice_s = std::strtol(value, nullptr, 10);
+        } else if (std::strcmp(arg, "--probe") == 0) {
+            probe = value;
+        } else if (std::strcmp(arg, "--probe-samples") == 0) {
+            probe_request.samples = static_cast<int>(std::strtol(value, nullptr, 10));
+        } else if (std::strcmp(arg, "--probe-watch-s") == 0) {
+            probe_request.watch_s = static_cast<int>(std::strtol(value, nullptr, 10));
+        } else if (std::strcmp(arg, "--user") == 0) {
+            user = value;
+        } else if (std::strcmp(arg, "--pass") == 0) {
+            pass = value;
+        } else if (std::strcmp(arg, "--pool-fingerprint") == 0) {
+            fingerprint = value;
+        } else if (std::strcmp(arg, "--coalesce-us") == 0) {
+            coalesce_us = std::strtol(value, nullptr, 10);
+        } else if (std::strcmp(arg, "--metrics-port") == 0) {
+            metrics_port = std::strtol(value, nullptr, 10);
+        } else if (std::strcmp(arg, "--free-heap") == 0) {
+            free_heap_kb = std::strtol(value, nullptr, 10);
+        } else if (std::strcmp(arg, "--capture") == 0) {
+            if (!ParseCaptureMode(value, capture)) {
+                PrintUsage(argv[0]);
+                return 2;
+            }
+        } else {
+            PrintUsage(argv[0]);
+            return 2;
+        }
+        ++i;
+    }
+
+    if (port <= 0 || port > 65535) {
+        std::fprintf(stderr, "Invalid stratum port %ld\n", port);
+        return 2;
+    }
+    if (metrics_port < 0 || metrics_port > 65535) {
+        std::fprintf(stderr, "Invalid metrics port %ld\n", metrics_port);
+        return 2;
+    }
+
+    Serial.println("=== YUMA Stratum Proxy ===");
+    Serial.printf("Target board: %s\n", GetBoardName());
+
+    HostFS.setRoot(data_dir);
+    if (free_heap_kb >= 0) {
+        HostSetFreeHeap(static_cast<uint32_t>(free_heap_kb) * 1024);
+    }
+    metrics.uptime_start = millis();
+
+    if (!SetupStorage()) {
+        Serial.println("Storage initialization failed; continuing with defaults");
+    }
+
+    LoadConfig(config);
+    if (pool && !ApplyPoolArgument(pool, config.pool_host, sizeof(config.pool_host), config.pool_port)) {
+        std::fprintf(stderr, "Invalid --pool value '%s', expected HOST:PORT\n", pool);
+        return 2;
+    }
+    if (alt_pool &&
+        !ApplyPoolArgument(alt_pool, config.alt_pool_host, sizeof(config.alt_pool_host), config.alt_pool_port)) {
+        std::fprintf(stderr, "Invalid --alt-pool value '%s', expected HOST:PORT\n", alt_pool);
+        return 2;
+    }
+    if (alt_weight >= 0) {
+        config.alt_pool_weight = constrain(static_cast<int>(alt_weight), 0, 100);
+    }
+    if (slice_s >= 0) {
+        config.pool_slice_s = static_cast<int>(slice_s);
+    }
+    if (user) {
+        CopyStringField(config.pool_user, sizeof(config.pool_user), user);
+    }
+    if (pass) {
+        CopyStringField(config.pool_pass, sizeof(config.pool_pass), pass);
+    }
+    if (fingerprint) {
+        CopyStringField(config.pool_tls_fingerprint, sizeof(config.pool_tls_fingerprint), fingerprint);
+    }
+    if (sv2) {
+        config.pool_sv2 = true;
+    }
+    if (balance) {
+        config.cluster_balance = true;
+    }
+    if (coalesce_us >= 0) {
+        config.submit_coalesce_us = static_cast<int>(coalesce_us);
+    }
+    InitConfigReload();
+
+    LoadBootCache();
+    LoadJobCache();
+    SetCaptureMode(capture);
+    SetupStratumServer(static_cast<uint16_t>(port));
+    SetupMDNS(static_cast<uint16_t>(port));
+    if (metrics_port > 0) {
+        SetupMetricsEndpoint(static_cast<uint16_t>(metrics_port));
+    }
+    Serial.printf("Pool: %s:%d (%s) as %s\n", config.pool_host, config.pool_port,
+                  config.pool_sv2 ? "sv2" : "sv1", config.pool_user);
+    if (PoolSplitEnabled()) {
+        Serial.printf("Alternate pool: %s:%d as %s, %d%% of the work\n", config.alt_pool_host, config.alt_pool_port,
+                      config.alt_pool_user, config.alt_pool_weight);
+    }
+
+    RegisterTasks();
+    if (probe) {
+        char probe_host[sizeof(config.pool_host)] = "";
+        if (std::strcmp(probe, "pool") != 0 &&
+            !ApplyPoolArgument(probe, probe_host, sizeof(probe_host), probe_request.port)) {
+            std::fprintf(stderr, "Invalid --probe value '%s', expected pool or HOST:PORT\n", probe);
+            return 2;
+        }
+        probe_request.host = probe_host;
+        if (const char* error = StartPoolProbe(probe_request)) {
+            std::fprintf(stderr, "Pool probe not started: %s\n", error);
+            return 2;
+        }
+    }
+    while (!stop_requested) {
+        RunScheduler();
+    }
+
+    Serial.println("Shutting down");
+    const PoolTxStats& tx_stats = CurrentPoolTxStats();
+    Serial.printf("Upstream: %lu writes, %lu shares in %lu packets\n", tx_stats.writes, tx_stats.shares,
+                  tx_stats.share_writes);
+    for (size_t i = 0; i < TaskCount(); ++i) {
+        const TaskStats& task = GetTaskStats(i);
+        Serial.printf("Task %s: %lu runs (%lu signalled), %lu over budget, max %lu us, max late %lu ms\n", task.name,
+                      task.runs, task.signalled_runs, task.overruns, task.max_us, task.max_late_ms);
+    }
+    const PowerStats& power = CurrentPowerStats();
+    for (size_t i = 0; i < kPowerModeCount; ++i) {
+        const LatencyHistogram& histogram = power.reply_latency[i];
+        Serial.printf("Power %s: %lu s, %lu replies, avg %lu ms, max %lu ms\n",
+                      PowerModeName(static_cast<PowerMode>(i)), power.ms_in_mode[i] / 1000, histogram.count,
+                      histogram.count > 0 ? histogram.total_ms / histogram.count : 0, histogram.max_ms);
+    }
+    const PoolSplitStats& split = CurrentPoolSplitStats();
+    for (size_t i = 0; i < kPoolCount; ++i) {
+        Serial.printf("Split %s: %d%% wanted, %.1f%% of work (%.0f difficulty, %lu shares), %lu s\n",
+                      PoolTargetAt(i).host, PoolWeightPercent(i), PoolWorkPercent(i), split.work[i], split.shares[i],
+                      split.ms_on_pool[i] / 1000);
+    }
+    Serial.printf("Split switches: %lu\n", split.switches);
+    const HeaderJobStats& headers = CurrentHeaderJobStats();
+    Serial.printf("Header jobs: %lu templates, %lu headers, avg %lu us, max %lu us\n", headers.templates,
+                  headers.headers, headers.headers > 0 ? headers.build_us_total / headers.headers : 0,
+                  headers.build_us_max);
+    if (probe) {
+        Serial.printf("Probe %s\n", PoolProbeJson().c_str());
+    }
+    // The host has no /api/miners; leave the same rows in the log instead
+    for (const MinerSession* session : connected_miners) {
+        Serial.printf("Miner %s\n", MinerStatsJson(session, millis()).c_str());
+    }
+    SetCaptureMode(CaptureMode::kOff);
+    // A clean stop stands in for the device's planned reboot
+    SaveJobCache();
+    DisconnectFromPool();
+    return 0;
+}
@@ -0,0 +1,332 @@
+// Replays a stratum capture (see src/stratum_capture.h) through the proxy's
+// pool parsing and miner forwarding path and reports per-message cost. Pool
+// output goes to a local sink and miner output to loopback sockets, so the
+// same code runs that would run on the device.
+
+#include <Arduino.h>
+#include <AsyncTCP.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <functional>
+#include <map>
+#include <netinet/in.h>
+#include <string>
+#include <sys/epoll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#include <vector>
+
+#include "app_context.h"
+#include "host_event_loop.h"
+#include "pool_client.h"
+#include "stratum_capture.h"
+#include "stratum_server.h"
+
+namespace {
+constexpr unsigned long kSetupTimeoutMs = 5000;
+
+struct Record {
+    uint32_t time_ms;
+    CaptureDirection direction;
+    uint8_t peer;
+    std::string payload;
+};
+
+struct KindStats {
+    std::vector<double> samples_us;
+    size_t bytes = 0;
+};
+
+struct Options {
+    const char* capture_path = nullptr;
+    double speed = 0;  // 0 = as fast as possible
+    int miners = 0;
+    int repeat = 1;
+    const char* json_path = nullptr;
+    bool verbose = false;
+};
+
+uint16_t Le16(const uint8_t* data) {
+    return static_cast<uint16_t>(data[0] | (data[1] << 8));
+}
+
+uint32_t Le32(const uint8_t* data) {
+    return static_cast<uint32_t>(data[0]) | (static_cast<uint32_t>(data[1]) << 8) |
+           (static_cast<uint32_t>(data[2]) << 16) | (static_cast<uint32_t>(data[3]) << 24);
+}
+
+bool LoadCapture(const char* path, std::vector<Record>& records) {
+    std::FILE* file = std::fopen(path, "rb");
+    if (!file) {
+        std::fprintf(stderr, "Cannot open %s: %s\n", path, std::strerror(errno));
+        return false;
+    }
+
+    uint8_t header[kCaptureFileHeaderSize];
+    if (std::fread(header, 1, sizeof(header), file) != sizeof(header) || Le32(header) != kCaptureMagic ||
+        Le16(header + 4) != kCaptureVersion) {
+        std::fprintf(stderr, "%s is not a v%u stratum capture\n", path, kCaptureVersion);
+        std::fclose(file);
+        return false;
+    }
+
+    uint8_t record_header[kCaptureRecordHeaderSize];
+    while (std::fread(record_header, 1, sizeof(record_header), file) == sizeof(record_header)) {
+        Record record;
+        record.time_ms = Le32(record_header);
+        record.direction = static_cast<CaptureDirection>(record_header[4]);
+        record.peer = record_header[5];
+        record.payload.resize(Le16(record_header + 6));
+        if (std::fread(&record.payload[0], 1, record.payload.size(), file) != record.payload.size()) {
+            std::fprintf(stderr, "Truncated record at end of capture, ignoring it\n");
+            break;
+        }
+        records.push_back(std::move(record));
+    }
+
+    std::fclose(file);
+    return true;
+}
+
+// "pool:mining.notify", "miner:mining.submit", "pool:result", ...
+std::string ClassifyRecord(const Record& record) {
+    const char* side = record.direction == CaptureDirection::kPoolRx ? "pool:" : "miner:";
+    size_t key = record.payload.find("\"method\"");
+    if (key == std::string::npos) {
+        return std::string(side) + "result";
+    }
+    size_t open = record.payload.find('"', record.payload.find(':', key) + 1);
+    size_t close = open == std::string::npos ? open : record.payload.find('"', open + 1);
+    if (close == std::string::npos) {
+        return std::string(side) + "unknown";
+    }
+    return side + record.payload.substr(open + 1, close - open - 1);
+}
+
+double Percentile(std::vector<double>& samples, double pct) {
+    if (samples.empty()) {
+        return 0;
+    }
+    std::sort(samples.begin(), samples.end());
+    size_t index = static_cast<size_t>(pct / 100.0 * (samples.size() - 1) + 0.5);
+    return samples[std::min(index, samples.size() - 1)];
+}
+
+int ConnectLoopback(uint16_t port) {
+    int fd = socket(AF_INET, SOCK_STREAM | SOCK_CLOEXEC | SOCK_NONBLOCK, 0);
+    sockaddr_in address{};
+    address.sin_family = AF_INET;
+    address.sin_port = htons(port);
+    address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    connect(fd, reinterpret_cast<sockaddr*>(&address), sizeof(address));
+    return fd;
+}
+
+// Reads and discards everything the proxy sends to a simulated miner
+void DrainSocket(int fd, size_t& received) {
+    char buffer[4096];
+    ssize_t count;
+    while ((count = recv(fd, buffer, sizeof(buffer), 0)) > 0) {
+        received += static_cast<size_t>(count);
+    }
+}
+
+bool WaitFor(const std::function<bool()>& condition) {
+    unsigned long start = millis();
+    while (!condition()) {
+        if (millis() - start > kSetupTimeoutMs) {
+            return false;
+        }
+        delay(1);
+    }
+    return true;
+}
+
+void PrintUsage(const char* program) {
+    std::printf("Usage: %s CAPTURE [--speed X] [--miners N] [--repeat N] [--json PATH] [--verbose]\n"
+                "  --speed 1 replays at original timing, 0 (default) as fast as possible\n",
+                program);
+}
+
+bool ParseOptions(int argc, char** argv, Options& options) {
+    for (int i = 1; i < argc; ++i) {
+        const char* arg = argv[i];
+        const char* value = i + 1 < argc ? argv[i + 1] : nullptr;
+        if (std::strcmp(arg, "--verbose") == 0) {
+            options.verbose = true;
+            continue;
+        }
+        if (arg[0] != '-' && !options.capture_path) {
+            options.capture_path = arg;
+            continue;
+        }
+        if (!value) {
+            return false;
+        }
+        if (std::strcmp(arg, "--speed") == 0) {
+            options.speed = std::strtod(value, nullptr);
+        } else if (std::strcmp(arg, "--miners") == 0) {
+            options.miners = std::atoi(value);
+        } else if (std::strcmp(arg, "--repeat") == 0) {
+            options.repeat = std::max(1, std::atoi(value));
+        } else if (std::strcmp(arg, "--json") == 0) {
+            options.json_path = value;
+        } else {
+            return false;
+        }
+        ++i;
+    }
+    return options.capture_path != nullptr;
+}
+}
+
+int main(int argc, char** argv) {
+    Options options;
+    if (!ParseOptions(argc, argv, options)) {
+        PrintUsage(argv[0]);
+        return 2;
+    }
+
+    std::vector<Record> records;
+    if (!LoadCapture(options.capture_path, records)) {
+        return 1;
+    }
+
+    int max_peer = 0;
+    for (const Record& record : records) {
+        if (record.direction == CaptureDirection::kMinerRx && record.peer != kCaptureAllMiners) {
+            max_peer = std::max<int>(max_peer, record.peer);
+        }
+    }
+    int miner_count = options.miners > 0 ? options.miners : std::max(1, max_peer);
+
+    // Upstream sink standing in for the pool
+    size_t pool_bytes = 0;
+    AsyncServer pool_sink(IPAddress(127, 0, 0, 1), 0);
+    pool_sink.onClient([&pool_bytes](void*, AsyncClient* client) {
+        client->onData([&pool_bytes](void*, AsyncClient*, void*, size_t len) { pool_bytes += len; });
+        client->onDisconnect([](void*, AsyncClient* closed) { delete closed; });
+    });
+    pool_sink.begin();
+
+    if (!options.verbose) {
+        Serial.setOutput(nullptr);
+    }
+
+    SetupStratumServer(0);
+    if (!PoolClient().connect(IPAddress(127, 0, 0, 1), pool_sink.port())) {
+        std::fprintf(stderr, "Cannot connect to the local pool sink\n");
+        return 1;
+    }
+    metrics.pool_connected = true;
+
+    size_t miner_bytes = 0;
+    std::vector<int> miner_fds;
+    for (int i = 0; i < miner_count; ++i) {
+        int fd = ConnectLoopback(stratum_server->port());
+        miner_fds.push_back(fd);
+        HostWatchFd(fd, EPOLLIN, [fd, &miner_bytes](uint32_t) { DrainSocket(fd, miner_bytes); });
+    }
+    if (!WaitFor([miner_count] { return static_cast<int>(connected_miners.size()) == miner_count; })) {
+        std::fprintf(stderr, "Simulated miners failed to connect\n");
+        return 1;
+    }
+
+    std::map<std::string, KindStats> stats;
+    std::vector<double> all_samples;
+    size_t replayed = 0;
+    unsigned long replay_start = millis();
+
+    for (int pass = 0; pass < options.repeat; ++pass) {
+        unsigned long pass_start = millis();
+        uint32_t first_ms = records.empty() ? 0 : records.front().time_ms;
+
+        for (const Record& record : records) {
+            if (record.direction != CaptureDirection::kPoolRx && record.direction != CaptureDirection::kMinerRx) {
+                continue;
+            }
+
+            if (options.speed > 0) {
+                unsigned long due = pass_start + static_cast<unsigned long>((record.time_ms - first_ms) / options.speed);
+                while (static_cast<long>(due - millis()) > 0) {
+                    delay(1);
+                }
+            }
+
+            String line(record.payload.c_str(), record.payload.size());
+            unsigned long started = micros();
+            if (record.direction == CaptureDirection::kPoolRx) {
+                ProcessPoolLine(line);
+            } else {
+                MinerSession* session = connected_miners[(std::max<int>(record.peer, 1) - 1) % connected_miners.size()];
+                ForwardMinerRequest(session, line);
+            }
+            double elapsed_us = static_cast<double>(micros() - started);
+
+            KindStats& kind = stats[ClassifyRecord(record)];
+            kind.samples_us.push_back(elapsed_us);
+            kind.bytes += record.payload.size();
+            all_samples.push_back(elapsed_us);
+            replayed++;
+
+            // Let the loopback sockets drain like the network stack would between loop() passes
+            yield();
+        }
+    }
+    unsigned long wall_ms = millis() - replay_start;
+    delay(50);
+    Serial.setOutput(stdout);
+
+    std::printf("Replayed %zu messages from %s in %lu ms (%d simulated miners)\n", replayed,
+                options.capture_path, wall_ms, miner_count);
+    std::printf("%-28s %8s %10s %10s %10s %10s\n", "kind", "count", "mean_us", "p50_us", "p99_us", "max_us");
+
+    std::string json = "{\"capture\":\"" + std::string(options.capture_path) + "\",\"messages\":" +
+                       std::to_string(replayed) + ",\"wall_ms\":" + std::to_string(wall_ms) +
+                       ",\"pool_bytes_out\":" + std::to_string(pool_bytes) +
+                       ",\"miner_bytes_out\":" + std::to_string(miner_bytes) + ",\"kinds\":{";
+    bool first = true;
+    auto report = [&](const std::string& name, std::vector<double>& samples, size_t bytes) {
+        double total = 0;
+        for (double sample : samples) {
+            total += sample;
+        }
+        double mean = samples.empty() ? 0 : total / samples.size();
+        double p50 = Percentile(samples, 50);
+        double p99 = Percentile(samples, 99);
+        double max_us = samples.empty() ? 0 : samples.back();
+        std::printf("%-28s %8zu %10.1f %10.1f %10.1f %10.1f\n", name.c_str(), samples.size(), mean, p50, p99, max_us);
+
+        char entry[256];
+        std::snprintf(entry, sizeof(entry),
+                      "%s\"%s\":{\"count\":%zu,\"bytes\":%zu,\"mean_us\":%.1f,\"p50_us\":%.1f,\"p99_us\":%.1f,\"max_us\":%.1f}",
+                      first ? "" : ",", name.c_str(), samples.size(), bytes, mean, p50, p99, max_us);
+        json += entry;
+        first = false;
+    };
+    for (auto& kind : stats) {
+        report(kind.first, kind.second.samples_us, kind.second.bytes);
+    }
+    report("all", all_samples, 0);
+    json += "}}\n";
+
+    std::printf("Output: %zu bytes to pool, %zu bytes to miners\n", pool_bytes, miner_bytes);
+
+    if (options.json_path) {
+        std::FILE* out = std::fopen(options.json_path, "w");
+        if (!out) {
+            std::fprintf(stderr, "Cannot write %s\n", options.json_path);
+            return 1;
+        }
+        std::fputs(json.c_str(), out);
+        std::fclose(out);
+    }
+
+    for (int fd : miner_fds) {
+        ::close(fd);
+    }
+    return 0;
+}
@@ -0,0 +1,160 @@
+#include "Arduino.h"
+
+#include <chrono>
+#include <cstdarg>
+#include <random>
+#include <thread>
+#include <vector>
+
+#include "host_event_loop.h"
+
+namespace {
+using Clock = std::chrono::steady_clock;
+
+const Clock::time_point start_time = Clock::now();
+std::mt19937 rng(std::random_device{}());
+
+// Stands in for the free heap figure the firmware reports on the device.
+// Roomy by default so bench swarms are not capped; --free-heap emulates a board.
+uint32_t host_free_heap = 2 * 1024 * 1024;
+}
+
+unsigned long millis() {
+    return static_cast<unsigned long>(
+        std::chrono::duration_cast<std::chrono::milliseconds>(Clock::now() - start_time).count());
+}
+
+unsigned long micros() {
+    return static_cast<unsigned long>(
+        std::chrono::duration_cast<std::chrono::microseconds>(Clock::now() - start_time).count());
+}
+
+void delay(unsigned long ms) {
+    const unsigned long deadline = millis() + ms;
+    do {
+        unsigned long now = millis();
+        int remaining = now >= deadline ? 0 : static_cast<int>(deadline - now);
+        HostPollEvents(remaining);
+    } while (millis() < deadline);
+}
+
+void delayMicroseconds(unsigned int us) {
+    std::this_thread::sleep_for(std::chrono::microseconds(us));
+}
+
+void yield() {
+    HostPollEvents(0);
+}
+
+long random(long max_value) {
+    return random(0, max_value);
+}
+
+long random(long min_value, long max_value) {
+    if (max_value <= min_value) {
+        return min_value;
+    }
+    std::uniform_int_distribution<long> dist(min_value, max_value - 1);
+    return dist(rng);
+}
+
+void randomSeed(unsigned long seed) {
+    rng.seed(seed);
+}
+
+size_t Print::printf(const char* format, ...) {
+    va_list args;
+    va_start(args, format);
+    va_list copy;
+    va_copy(copy, args);
+    int length = std::vsnprintf(nullptr, 0, format, copy);
+    va_end(copy);
+
+    if (length <= 0) {
+        va_end(args);
+        return 0;
+    }
+
+    std::vector<char> buffer(static_cast<size_t>(length) + 1);
+    std::vsnprintf(buffer.data(), buffer.size(), format, args);
+    va_end(args);
+    return write(reinterpret_cast<const uint8_t*>(buffer.data()), static_cast<size_t>(length));
+}
+
+int Stream::timedRead() {
+    const unsigned long start = millis();
+    do {
+        int value = read();
+        if (value >= 0) {
+            return value;
+        }
+        yield();
+    } while (millis() - start < timeout_ms_);
+    return -1;
+}
+
+size_t Stream::readBytes(char* buffer, size_t length) {
+    size_t count = 0;
+    while (count < length) {
+        int value = timedRead();
+        if (value < 0) {
+            break;
+        }
+        buffer[count++] = static_cast<char>(value);
+    }
+    return count;
+}
+
+String Stream::readStringUntil(char terminator) {
+    String result;
+    int value = timedRead();
+    while (value >= 0 && value != terminator) {
+        result.concat(static_cast<char>(value));
+        value = timedRead();
+    }
+    return result;
+}
+
+String Stream::readString() {
+    String result;
+    int value = timedRead();
+    while (value >= 0) {
+        result.concat(static_cast<char>(value));
+        value = timedRead();
+    }
+    return result;
+}
+
+HostSerial Serial;
+
+size_t HostSerial::write(uint8_t value) {
+    return write(&value, 1);
+}
+
+size_t HostSerial::write(const uint8_t* buffer, size_t size) {
+    if (!output_) {
+        return size;
+    }
+    return std::fwrite(buffer, 1, size, output_);
+}
+
+void HostSerial::flush() {
+    if (output_) {
+        std::fflush(output_);
+    }
+}
+
+HostEsp ESP;
+
+uint32_t HostEsp::getFreeHeap() {
+    return host_free_heap;
+}
+
+void HostSetFreeHeap(uint32_t bytes) {
+    host_free_heap = bytes;
+}
+
+void HostEsp::restart() {
+    std::fflush(stdout);
+    std::exit(0);
+}
@@ -0,0 +1,74 @@
+#pragma once
+
+// Minimal Arduino core surface for the host-native build. Timing is backed by
+// std::chrono and delay()/yield() pump the epoll event loop so async callbacks
+// fire at the same points they would on the device.
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+#include "Print.h"
+#include "Stream.h"
+#include "WString.h"
+
+#define PROGMEM
+#define IRAM_ATTR
+#define F(string_literal) (string_literal)
+
+using std::max;
+using std::min;
+
+unsigned long millis();
+unsigned long micros();
+void delay(unsigned long ms);
+void delayMicroseconds(unsigned int us);
+void yield();
+
+long random(long max_value);
+long random(long min_value, long max_value);
+void randomSeed(unsigned long seed);
+
+template <typename T, typename L, typename H>
+T constrain(T value, L low, H high) {
+    if (value < static_cast<T>(low)) {
+        return static_cast<T>(low);
+    }
+    if (value > static_cast<T>(high)) {
+        return static_cast<T>(high);
+    }
+    return value;
+}
+
+class HostSerial : public Stream {
+public:
+    void begin(unsigned long baud) { (void)baud; }
+    // nullptr discards output, e.g. while timing the relay path
+    void setOutput(std::FILE* output) { output_ = output; }
+    size_t write(uint8_t value) override;
+    size_t write(const uint8_t* buffer, size_t size) override;
+    using Print::write;
+    int available() override { return 0; }
+    int read() override { return -1; }
+    int peek() override { return -1; }
+    void flush() override;
+
+private:
+    std::FILE* output_ = stdout;
+};
+
+extern HostSerial Serial;
+
+class HostEsp {
+public:
+    uint32_t getFreeHeap();
+    void restart();
+};
+
+extern HostEsp ESP;
+
+// Host only: the figure ESP.getFreeHeap() reports
+void HostSetFreeHeap(uint32_t bytes);
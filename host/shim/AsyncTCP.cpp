@@ -0,0 +1,552 @@
+#include "AsyncTCP.h"
+
+#include <arpa/inet.h>
+#include <cerrno>
+#include <fcntl.h>
+#include <netdb.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/epoll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include "host_event_loop.h"
+
+namespace {
+// Mirrors lwIP's per-pcb send buffer and segment size on the ESP targets
+constexpr size_t kSendBufferSize = 5744;
+constexpr size_t kSegmentSize = 1436;
+constexpr unsigned long kPollIntervalMs = 500;
+
+constexpr int8_t kErrConnectionAborted = -13;
+constexpr int8_t kErrConnectionReset = -14;
+constexpr int8_t kErrConnection = -11;
+constexpr int8_t kErrTimeout = -3;
+
+void SetNonBlocking(int fd) {
+    fcntl(fd, F_SETFL, fcntl(fd, F_GETFL) | O_NONBLOCK);
+}
+
+// Lets callers detect that a callback deleted the client it was invoked on.
+// The guard clears the slot again before it goes out of scope.
+#if defined(__GNUC__) && !defined(__clang__) && __GNUC__ >= 12
+#pragma GCC diagnostic ignored "-Wdangling-pointer"
+#endif
+class DestroyGuard {
+public:
+    explicit DestroyGuard(bool*& slot) : slot_(slot), previous_(slot) { slot_ = &destroyed_; }
+    ~DestroyGuard() {
+        if (!destroyed_) {
+            slot_ = previous_;
+        } else if (previous_) {
+            *previous_ = true;
+        }
+    }
+    bool destroyed() const { return destroyed_; }
+
+private:
+    bool*& slot_;
+    bool* previous_;
+    bool destroyed_ = false;
+};
+}
+
+AsyncClient::AsyncClient(int fd) {
+    if (fd >= 0) {
+        Attach(fd);
+        state_ = State::kConnected;
+        last_rx_ms_ = millis();
+        UpdateInterest();
+    }
+}
+
+AsyncClient::~AsyncClient() {
+    if (destroyed_flag_) {
+        *destroyed_flag_ = true;
+    }
+    Shutdown(false);
+}
+
+void AsyncClient::Attach(int fd) {
+    fd_ = fd;
+    SetNonBlocking(fd_);
+
+    sockaddr_in address{};
+    socklen_t length = sizeof(address);
+    if (getpeername(fd_, reinterpret_cast<sockaddr*>(&address), &length) == 0) {
+        remote_ip_ = IPAddress(static_cast<uint32_t>(address.sin_addr.s_addr));
+        remote_port_ = ntohs(address.sin_port);
+    }
+
+    watch_ = HostWatchFd(fd_, EPOLLIN, [this](uint32_t events) { HandleEvents(events); });
+    ticker_id_ = HostAddTicker([this]() { Tick(); });
+    last_poll_ms_ = millis();
+}
+
+bool AsyncClient::connect(IPAddress ip, uint16_t port) {
+    if (state_ != State::kClosed) {
+        return false;
+    }
+
+    int fd = socket(AF_INET, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (fd < 0) {
+        return false;
+    }
+    SetNonBlocking(fd);
+
+    sockaddr_in address{};
+    address.sin_family = AF_INET;
+    address.sin_port = htons(port);
+    address.sin_addr.s_addr = static_cast<uint32_t>(ip);
+
+    int rc = ::connect(fd, reinterpret_cast<sockaddr*>(&address), sizeof(address));
+    if (rc != 0 && errno != EINPROGRESS) {
+        ::close(fd);
+        return false;
+    }
+
+    Attach(fd);
+    remote_ip_ = ip;
+    remote_port_ = port;
+    state_ = State::kConnecting;
+    tx_pending_since_ms_ = millis();
+    UpdateInterest();
+    return true;
+}
+
+bool AsyncClient::connect(const char* host, uint16_t port) {
+    IPAddress ip;
+    if (!host) {
+        return false;
+    }
+    if (!ip.fromString(host)) {
+        addrinfo hints{};
+        hints.ai_family = AF_INET;
+        hints.ai_socktype = SOCK_STREAM;
+        addrinfo* result = nullptr;
+        if (getaddrinfo(host, nullptr, &hints, &result) != 0 || !result) {
+            return false;
+        }
+        ip = IPAddress(static_cast<uint32_t>(reinterpret_cast<sockaddr_in*>(result->ai_addr)->sin_addr.s_addr));
+        freeaddrinfo(result);
+    }
+    return connect(ip, port);
+}
+
+void AsyncClient::close(bool now) {
+    if (!now && fd_ >= 0 && !tx_.empty()) {
+        FlushWrites();
+    }
+    Shutdown(true);
+}
+
+int8_t AsyncClient::abort() {
+    if (fd_ >= 0) {
+        linger option{1, 0};
+        setsockopt(fd_, SOL_SOCKET, SO_LINGER, &option, sizeof(option));
+    }
+    Shutdown(true);
+    return kErrConnectionAborted;
+}
+
+void AsyncClient::Shutdown(bool notify) {
+    if (fd_ < 0) {
+        return;
+    }
+
+    HostUnwatch(watch_);
+    watch_ = nullptr;
+    HostRemoveTicker(ticker_id_);
+    ticker_id_ = 0;
+    ::close(fd_);
+    fd_ = -1;
+    state_ = State::kClosed;
+    tx_.clear();
+
+    // Last action: the disconnect handler commonly deletes this client
+    if (notify && disconnect_cb_) {
+        AcConnectHandler callback = disconnect_cb_;
+        callback(disconnect_arg_, this);
+    }
+}
+
+void AsyncClient::Fail(int8_t error) {
+    DestroyGuard guard(destroyed_flag_);
+    if (error_cb_) {
+        AcErrorHandler callback = error_cb_;
+        callback(error_arg_, this, error);
+    }
+    if (!guard.destroyed()) {
+        Shutdown(true);
+    }
+}
+
+size_t AsyncClient::space() const {
+    if (state_ != State::kConnected || tx_.size() >= kSendBufferSize) {
+        return 0;
+    }
+    return kSendBufferSize - tx_.size();
+}
+
+size_t AsyncClient::add(const char* data, size_t size, uint8_t apiflags) {
+    (void)apiflags;
+    if (!data || size == 0) {
+        return 0;
+    }
+    size_t accepted = std::min(size, space());
+    if (tx_.empty() && accepted > 0) {
+        tx_pending_since_ms_ = millis();
+    }
+    tx_.append(data, accepted);
+    return accepted;
+}
+
+bool AsyncClient::send() {
+    if (state_ != State::kConnected) {
+        return false;
+    }
+    FlushWrites();
+    return true;
+}
+
+size_t AsyncClient::write(const char* data) {
+    return data ? write(data, std::strlen(data)) : 0;
+}
+
+size_t AsyncClient::write(const char* data, size_t size, uint8_t apiflags) {
+    size_t accepted = add(data, size, apiflags);
+    if (accepted > 0) {
+        send();
+    }
+    return accepted;
+}
+
+void AsyncClient::FlushWrites() {
+    if (fd_ < 0 || tx_.empty()) {
+        return;
+    }
+
+    size_t flushed = 0;
+    while (flushed < tx_.size()) {
+        ssize_t sent = ::send(fd_, tx_.data() + flushed, tx_.size() - flushed, MSG_NOSIGNAL | MSG_DONTWAIT);
+        if (sent <= 0) {
+            break;
+        }
+        flushed += static_cast<size_t>(sent);
+    }
+
+    if (flushed == 0) {
+        UpdateInterest();
+        return;
+    }
+
+    const uint32_t elapsed = millis() - tx_pending_since_ms_;
+    tx_.erase(0, flushed);
+    tx_pending_since_ms_ = millis();
+    UpdateInterest();
+
+    if (ack_cb_) {
+        AcAckHandler callback = ack_cb_;
+        callback(ack_arg_, this, flushed, elapsed);
+    }
+}
+
+void AsyncClient::UpdateInterest() {
+    uint32_t events = EPOLLIN | EPOLLRDHUP;
+    if (state_ == State::kConnecting || !tx_.empty()) {
+        events |= EPOLLOUT;
+    }
+    HostModifyWatch(watch_, events);
+}
+
+void AsyncClient::HandleEvents(uint32_t events) {
+    DestroyGuard guard(destroyed_flag_);
+
+    if (state_ == State::kConnecting) {
+        if (!(events & (EPOLLOUT | EPOLLERR | EPOLLHUP))) {
+            return;
+        }
+        int error = 0;
+        socklen_t length = sizeof(error);
+        getsockopt(fd_, SOL_SOCKET, SO_ERROR, &error, &length);
+        if (error != 0) {
+            Fail(kErrConnection);
+            return;
+        }
+        state_ = State::kConnected;
+        last_rx_ms_ = millis();
+        UpdateInterest();
+        if (connect_cb_) {
+            AcConnectHandler callback = connect_cb_;
+            callback(connect_arg_, this);
+            if (guard.destroyed() || fd_ < 0) {
+                return;
+            }
+        }
+    }
+
+    if (events & EPOLLIN) {
+        HandleReadable();
+        if (guard.destroyed() || fd_ < 0) {
+            return;
+        }
+    }
+
+    if (events & EPOLLOUT) {
+        FlushWrites();
+        if (guard.destroyed() || fd_ < 0) {
+            return;
+        }
+    }
+
+    if (events & EPOLLERR) {
+        Fail(kErrConnectionReset);
+    }
+}
+
+void AsyncClient::HandleReadable() {
+    DestroyGuard guard(destroyed_flag_);
+    char buffer[kSegmentSize];
+
+    while (fd_ >= 0) {
+        ssize_t received = recv(fd_, buffer, sizeof(buffer), MSG_DONTWAIT);
+        if (received > 0) {
+            last_rx_ms_ = millis();
+            ack_later_ = false;
+            if (data_cb_) {
+                AcDataHandler callback = data_cb_;
+                callback(data_arg_, this, buffer, static_cast<size_t>(received));
+                if (guard.destroyed()) {
+                    return;
+                }
+            }
+            continue;
+        }
+        if (received == 0) {
+            Shutdown(true);
+            return;
+        }
+        if (errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR) {
+            return;
+        }
+        Fail(kErrConnectionReset);
+        return;
+    }
+}
+
+void AsyncClient::Tick() {
+    DestroyGuard guard(destroyed_flag_);
+    const unsigned long now = millis();
+
+    if (state_ == State::kConnecting && ack_timeout_ms_ > 0 && now - tx_pending_since_ms_ >= ack_timeout_ms_) {
+        Fail(kErrTimeout);
+        return;
+    }
+
+    if (state_ != State::kConnected) {
+        return;
+    }
+
+    if (!tx_.empty() && ack_timeout_ms_ > 0 && now - tx_pending_since_ms_ >= ack_timeout_ms_) {
+        // Like the device libraries, report how long the data sat unacknowledged
+        const uint32_t waited = now - tx_pending_since_ms_;
+        tx_pending_since_ms_ = now;
+        if (timeout_cb_) {
+            AcTimeoutHandler callback = timeout_cb_;
+            callback(timeout_arg_, this, waited);
+        } else {
+            close(true);
+        }
+        return;
+    }
+
+    if (rx_timeout_s_ > 0 && now - last_rx_ms_ >= rx_timeout_s_ * 1000UL) {
+        last_rx_ms_ = now;
+        if (timeout_cb_) {
+            AcTimeoutHandler callback = timeout_cb_;
+            callback(timeout_arg_, this, rx_timeout_s_ * 1000UL);
+        } else {
+            close(true);
+        }
+        return;
+    }
+
+    if (poll_cb_ && now - last_poll_ms_ >= kPollIntervalMs) {
+        last_poll_ms_ = now;
+        AcConnectHandler callback = poll_cb_;
+        callback(poll_arg_, this);
+    }
+}
+
+void AsyncClient::setNoDelay(bool enabled) {
+    if (fd_ < 0) {
+        return;
+    }
+    int flag = enabled ? 1 : 0;
+    setsockopt(fd_, IPPROTO_TCP, TCP_NODELAY, &flag, sizeof(flag));
+}
+
+bool AsyncClient::getNoDelay() {
+    if (fd_ < 0) {
+        return false;
+    }
+    int flag = 0;
+    socklen_t length = sizeof(flag);
+    getsockopt(fd_, IPPROTO_TCP, TCP_NODELAY, &flag, &length);
+    return flag != 0;
+}
+
+size_t AsyncClient::ack(size_t len) {
+    // The kernel owns the receive window on the host; nothing to release
+    ack_later_ = false;
+    return len;
+}
+
+IPAddress AsyncClient::localIP() const {
+    sockaddr_in address{};
+    socklen_t length = sizeof(address);
+    if (fd_ < 0 || getsockname(fd_, reinterpret_cast<sockaddr*>(&address), &length) != 0) {
+        return IPAddress();
+    }
+    return IPAddress(static_cast<uint32_t>(address.sin_addr.s_addr));
+}
+
+uint16_t AsyncClient::localPort() const {
+    sockaddr_in address{};
+    socklen_t length = sizeof(address);
+    if (fd_ < 0 || getsockname(fd_, reinterpret_cast<sockaddr*>(&address), &length) != 0) {
+        return 0;
+    }
+    return ntohs(address.sin_port);
+}
+
+void AsyncClient::onConnect(AcConnectHandler cb, void* arg) {
+    connect_cb_ = cb;
+    connect_arg_ = arg;
+}
+
+void AsyncClient::onDisconnect(AcConnectHandler cb, void* arg) {
+    disconnect_cb_ = cb;
+    disconnect_arg_ = arg;
+}
+
+void AsyncClient::onAck(AcAckHandler cb, void* arg) {
+    ack_cb_ = cb;
+    ack_arg_ = arg;
+}
+
+void AsyncClient::onError(AcErrorHandler cb, void* arg) {
+    error_cb_ = cb;
+    error_arg_ = arg;
+}
+
+void AsyncClient::onData(AcDataHandler cb, void* arg) {
+    data_cb_ = cb;
+    data_arg_ = arg;
+}
+
+void AsyncClient::onTimeout(AcTimeoutHandler cb, void* arg) {
+    timeout_cb_ = cb;
+    timeout_arg_ = arg;
+}
+
+void AsyncClient::onPoll(AcConnectHandler cb, void* arg) {
+    poll_cb_ = cb;
+    poll_arg_ = arg;
+}
+
+const char* AsyncClient::errorToString(int8_t error) {
+    switch (error) {
+        case 0:
+            return "OK";
+        case kErrTimeout:
+            return "Timeout";
+        case kErrConnection:
+            return "Connection error";
+        case kErrConnectionAborted:
+            return "Connection aborted";
+        case kErrConnectionReset:
+            return "Connection reset";
+        default:
+            return "Unknown error";
+    }
+}
+
+AsyncServer::AsyncServer(uint16_t port) : addr_(0, 0, 0, 0), port_(port) {}
+
+AsyncServer::AsyncServer(IPAddress addr, uint16_t port) : addr_(addr), port_(port) {}
+
+AsyncServer::~AsyncServer() {
+    end();
+}
+
+void AsyncServer::onClient(AcConnectHandler cb, void* arg) {
+    client_cb_ = cb;
+    client_arg_ = arg;
+}
+
+void AsyncServer::begin() {
+    if (fd_ >= 0) {
+        return;
+    }
+
+    fd_ = socket(AF_INET, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (fd_ < 0) {
+        return;
+    }
+
+    int reuse = 1;
+    setsockopt(fd_, SOL_SOCKET, SO_REUSEADDR, &reuse, sizeof(reuse));
+
+    sockaddr_in address{};
+    address.sin_family = AF_INET;
+    address.sin_port = htons(port_);
+    address.sin_addr.s_addr = static_cast<uint32_t>(addr_);
+
+    if (bind(fd_, reinterpret_cast<sockaddr*>(&address), sizeof(address)) != 0 || listen(fd_, 128) != 0) {
+        Serial.printf("AsyncServer: cannot listen on port %u (%s)\n", port_, std::strerror(errno));
+        ::close(fd_);
+        fd_ = -1;
+        return;
+    }
+
+    if (port_ == 0) {
+        socklen_t length = sizeof(address);
+        getsockname(fd_, reinterpret_cast<sockaddr*>(&address), &length);
+        port_ = ntohs(address.sin_port);
+    }
+
+    SetNonBlocking(fd_);
+    watch_ = HostWatchFd(fd_, EPOLLIN, [this](uint32_t events) { HandleAccept(); });
+}
+
+void AsyncServer::end() {
+    if (fd_ < 0) {
+        return;
+    }
+    HostUnwatch(watch_);
+    watch_ = nullptr;
+    ::close(fd_);
+    fd_ = -1;
+}
+
+void AsyncServer::HandleAccept() {
+    while (fd_ >= 0) {
+        int client_fd = accept4(fd_, nullptr, nullptr, SOCK_CLOEXEC | SOCK_NONBLOCK);
+        if (client_fd < 0) {
+            return;
+        }
+
+        if (no_delay_) {
+            int flag = 1;
+            setsockopt(client_fd, IPPROTO_TCP, TCP_NODELAY, &flag, sizeof(flag));
+        }
+
+        AsyncClient* client = new AsyncClient(client_fd);
+        if (client_cb_) {
+            client_cb_(client_arg_, client);
+        } else {
+            delete client;
+        }
+    }
+}
@@ -0,0 +1,146 @@
+#pragma once
+
+// Host implementation of the AsyncTCP client/server API on top of the epoll
+// reactor. Callbacks fire from delay()/yield() on the main thread.
+
+#include <functional>
+#include <string>
+
+#include "Arduino.h"
+#include "IPAddress.h"
+
+#define ASYNC_WRITE_FLAG_COPY 0x01
+#define ASYNC_WRITE_FLAG_MORE 0x02
+
+struct HostWatch;
+
+class AsyncClient;
+
+typedef std::function<void(void*, AsyncClient*)> AcConnectHandler;
+typedef std::function<void(void*, AsyncClient*, size_t len, uint32_t time)> AcAckHandler;
+typedef std::function<void(void*, AsyncClient*, int8_t error)> AcErrorHandler;
+typedef std::function<void(void*, AsyncClient*, void* data, size_t len)> AcDataHandler;
+typedef std::function<void(void*, AsyncClient*, uint32_t time)> AcTimeoutHandler;
+
+class AsyncClient {
+public:
+    explicit AsyncClient(int fd = -1);
+    ~AsyncClient();
+    AsyncClient(const AsyncClient&) = delete;
+    AsyncClient& operator=(const AsyncClient&) = delete;
+
+    bool connect(IPAddress ip, uint16_t port);
+    bool connect(const char* host, uint16_t port);
+    void close(bool now = false);
+    void stop() { close(false); }
+    int8_t abort();
+
+    bool connecting() const { return state_ == State::kConnecting; }
+    bool connected() const { return state_ == State::kConnected; }
+    bool disconnecting() const { return false; }
+    bool disconnected() const { return state_ == State::kClosed; }
+    bool freeable() const { return state_ == State::kClosed; }
+
+    bool canSend() const { return connected() && space() > 0; }
+    size_t space() const;
+    size_t add(const char* data, size_t size, uint8_t apiflags = ASYNC_WRITE_FLAG_COPY);
+    bool send();
+    size_t write(const char* data);
+    size_t write(const char* data, size_t size, uint8_t apiflags = ASYNC_WRITE_FLAG_COPY);
+
+    uint8_t state() const { return static_cast<uint8_t>(state_); }
+
+    void setRxTimeout(uint32_t timeout_s) { rx_timeout_s_ = timeout_s; }
+    uint32_t getRxTimeout() const { return rx_timeout_s_; }
+    void setAckTimeout(uint32_t timeout_ms) { ack_timeout_ms_ = timeout_ms; }
+    uint32_t getAckTimeout() const { return ack_timeout_ms_; }
+    void setNoDelay(bool enabled);
+    bool getNoDelay();
+
+    void ackLater() { ack_later_ = true; }
+    size_t ack(size_t len);
+
+    IPAddress remoteIP() const { return remote_ip_; }
+    uint16_t remotePort() const { return remote_port_; }
+    IPAddress localIP() const;
+    uint16_t localPort() const;
+
+    void onConnect(AcConnectHandler cb, void* arg = nullptr);
+    void onDisconnect(AcConnectHandler cb, void* arg = nullptr);
+    void onAck(AcAckHandler cb, void* arg = nullptr);
+    void onError(AcErrorHandler cb, void* arg = nullptr);
+    void onData(AcDataHandler cb, void* arg = nullptr);
+    void onTimeout(AcTimeoutHandler cb, void* arg = nullptr);
+    void onPoll(AcConnectHandler cb, void* arg = nullptr);
+
+    const char* errorToString(int8_t error);
+
+private:
+    enum class State : uint8_t { kClosed = 0, kConnecting = 2, kConnected = 4 };
+
+    void Attach(int fd);
+    void HandleEvents(uint32_t events);
+    void HandleReadable();
+    void FlushWrites();
+    void UpdateInterest();
+    void Tick();
+    void Shutdown(bool notify);
+    void Fail(int8_t error);
+
+    int fd_ = -1;
+    State state_ = State::kClosed;
+    HostWatch* watch_ = nullptr;
+    uint32_t ticker_id_ = 0;
+    std::string tx_;
+    size_t tx_unacked_ = 0;
+    IPAddress remote_ip_;
+    uint16_t remote_port_ = 0;
+    uint32_t rx_timeout_s_ = 0;
+    uint32_t ack_timeout_ms_ = 5000;
+    unsigned long last_rx_ms_ = 0;
+    unsigned long tx_pending_since_ms_ = 0;
+    unsigned long last_poll_ms_ = 0;
+    bool ack_later_ = false;
+    bool* destroyed_flag_ = nullptr;
+
+    AcConnectHandler connect_cb_;
+    void* connect_arg_ = nullptr;
+    AcConnectHandler disconnect_cb_;
+    void* disconnect_arg_ = nullptr;
+    AcAckHandler ack_cb_;
+    void* ack_arg_ = nullptr;
+    AcErrorHandler error_cb_;
+    void* error_arg_ = nullptr;
+    AcDataHandler data_cb_;
+    void* data_arg_ = nullptr;
+    AcTimeoutHandler timeout_cb_;
+    void* timeout_arg_ = nullptr;
+    AcConnectHandler poll_cb_;
+    void* poll_arg_ = nullptr;
+};
+
+class AsyncServer {
+public:
+    explicit AsyncServer(uint16_t port);
+    AsyncServer(IPAddress addr, uint16_t port);
+    ~AsyncServer();
+
+    void onClient(AcConnectHandler cb, void* arg = nullptr);
+    void begin();
+    void end();
+    void setNoDelay(bool enabled) { no_delay_ = enabled; }
+    bool getNoDelay() const { return no_delay_; }
+    uint8_t status() const { return fd_ >= 0 ? 1 : 0; }
+    uint16_t port() const { return port_; }
+
+private:
+    void HandleAccept();
+
+    IPAddress addr_;
+    uint16_t port_;
+    int fd_ = -1;
+    bool no_delay_ = false;
+    HostWatch* watch_ = nullptr;
+    AcConnectHandler client_cb_;
+    void* client_arg_ = nullptr;
+};
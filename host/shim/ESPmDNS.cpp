@@ -0,0 +1,270 @@
+#include "ESPmDNS.h"
+#include "WiFi.h"
+
+#include <algorithm>
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <strings.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+MDNSResponder MDNS;
+
+namespace {
+constexpr uint16_t kMdnsPort = 5353;
+constexpr char kMdnsGroup[] = "224.0.0.251";
+constexpr size_t kMaxDatagram = 1500;
+constexpr uint16_t kTypeA = 1;
+constexpr uint16_t kTypePtr = 12;
+constexpr uint16_t kTypeTxt = 16;
+constexpr uint16_t kTypeSrv = 33;
+constexpr uint16_t kTypeAny = 255;
+constexpr uint32_t kHostTtl = 120;
+constexpr uint32_t kServiceTtl = 4500;
+
+void PutU16(std::string& out, uint16_t value) {
+    out.push_back(static_cast<char>(value >> 8));
+    out.push_back(static_cast<char>(value & 0xFF));
+}
+
+void PutU32(std::string& out, uint32_t value) {
+    PutU16(out, static_cast<uint16_t>(value >> 16));
+    PutU16(out, static_cast<uint16_t>(value & 0xFFFF));
+}
+
+void PutName(std::string& out, const std::string& name) {
+    size_t start = 0;
+    while (start < name.size()) {
+        size_t dot = name.find('.', start);
+        if (dot == std::string::npos) {
+            dot = name.size();
+        }
+        out.push_back(static_cast<char>(dot - start));
+        out.append(name, start, dot - start);
+        start = dot + 1;
+    }
+    out.push_back('\0');
+}
+
+void PutRecord(std::string& out, const std::string& name, uint16_t type, uint32_t ttl, const std::string& rdata) {
+    PutName(out, name);
+    PutU16(out, type);
+    PutU16(out, 1);  // IN
+    PutU32(out, ttl);
+    PutU16(out, static_cast<uint16_t>(rdata.size()));
+    out += rdata;
+}
+
+// Dotted name at pos, following compression pointers; advances pos past it
+bool ReadName(const uint8_t* data, size_t len, size_t& pos, std::string& name) {
+    size_t cursor = pos;
+    bool jumped = false;
+    for (int hops = 0; hops < 16 && cursor < len;) {
+        uint8_t label = data[cursor];
+        if ((label & 0xC0) == 0xC0) {
+            if (cursor + 1 >= len) {
+                return false;
+            }
+            if (!jumped) {
+                pos = cursor + 2;
+            }
+            cursor = ((label & 0x3F) << 8) | data[cursor + 1];
+            jumped = true;
+            hops++;
+            continue;
+        }
+        cursor++;
+        if (label == 0) {
+            if (!jumped) {
+                pos = cursor;
+            }
+            return true;
+        }
+        if (cursor + label > len) {
+            return false;
+        }
+        if (!name.empty()) {
+            name.push_back('.');
+        }
+        name.append(reinterpret_cast<const char*>(data + cursor), label);
+        cursor += label;
+    }
+    return false;
+}
+}
+
+MDNSResponder::~MDNSResponder() {
+    end();
+}
+
+bool MDNSResponder::begin(const char* hostname) {
+    end();
+
+    fd_ = socket(AF_INET, SOCK_DGRAM | SOCK_CLOEXEC | SOCK_NONBLOCK, 0);
+    if (fd_ < 0) {
+        return false;
+    }
+
+    int one = 1;
+    setsockopt(fd_, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+    setsockopt(fd_, SOL_SOCKET, SO_REUSEPORT, &one, sizeof(one));
+
+    sockaddr_in address{};
+    address.sin_family = AF_INET;
+    address.sin_port = htons(kMdnsPort);
+    address.sin_addr.s_addr = htonl(INADDR_ANY);
+    ip_mreq membership{};
+    inet_pton(AF_INET, kMdnsGroup, &membership.imr_multiaddr);
+    membership.imr_interface.s_addr = htonl(INADDR_ANY);
+    if (bind(fd_, reinterpret_cast<sockaddr*>(&address), sizeof(address)) != 0 ||
+        setsockopt(fd_, IPPROTO_IP, IP_ADD_MEMBERSHIP, &membership, sizeof(membership)) != 0) {
+        end();
+        return false;
+    }
+
+    hostname_ = hostname;
+    return true;
+}
+
+void MDNSResponder::end() {
+    if (fd_ >= 0) {
+        ::close(fd_);
+    }
+    fd_ = -1;
+    services_.clear();
+}
+
+MDNSResponder::Service* MDNSResponder::findService(const char* service, const char* proto) {
+    std::string name = std::string("_") + service + "._" + proto;
+    for (Service& entry : services_) {
+        if (entry.name == name) {
+            return &entry;
+        }
+    }
+    return nullptr;
+}
+
+bool MDNSResponder::addService(const char* service, const char* proto, uint16_t port) {
+    if (fd_ < 0) {
+        return false;
+    }
+    Service* entry = findService(service, proto);
+    if (!entry) {
+        services_.emplace_back();
+        entry = &services_.back();
+        entry->name = std::string("_") + service + "._" + proto;
+    }
+    entry->port = port;
+    return true;
+}
+
+bool MDNSResponder::addServiceTxt(const char* service, const char* proto, const char* key, const char* value) {
+    Service* entry = findService(service, proto);
+    if (!entry) {
+        return false;
+    }
+    for (auto& item : entry->txt) {
+        if (item.first == key) {
+            item.second = value;
+            return true;
+        }
+    }
+    entry->txt.emplace_back(key, value);
+    return true;
+}
+
+void MDNSResponder::update() {
+    if (fd_ < 0) {
+        return;
+    }
+
+    uint8_t packet[kMaxDatagram];
+    sockaddr_in source{};
+    socklen_t source_length = sizeof(source);
+    ssize_t received;
+    while ((received = recvfrom(fd_, packet, sizeof(packet), MSG_DONTWAIT, reinterpret_cast<sockaddr*>(&source),
+                                &source_length)) > 0) {
+        size_t len = static_cast<size_t>(received);
+        // Queries only: QR clear and at least one question
+        if (len < 12 || (packet[2] & 0x80) != 0) {
+            continue;
+        }
+
+        uint16_t id = (packet[0] << 8) | packet[1];
+        uint16_t questions = (packet[4] << 8) | packet[5];
+        uint16_t source_port = ntohs(source.sin_port);
+        size_t pos = 12;
+        for (uint16_t i = 0; i < questions; ++i) {
+            std::string name;
+            if (!ReadName(packet, len, pos, name) || pos + 4 > len) {
+                break;
+            }
+            uint16_t type = (packet[pos] << 8) | packet[pos + 1];
+            pos += 4;
+            if (type != kTypePtr && type != kTypeAny) {
+                continue;
+            }
+            for (const Service& service : services_) {
+                if (strcasecmp(name.c_str(), (service.name + ".local").c_str()) == 0) {
+                    answer(service, id, source_port != kMdnsPort, name, source.sin_addr.s_addr, source_port);
+                }
+            }
+        }
+        source_length = sizeof(source);
+    }
+}
+
+void MDNSResponder::answer(const Service& service, uint16_t id, bool legacy, const std::string& question,
+                           uint32_t address, uint16_t port) {
+    const std::string service_name = service.name + ".local";
+    const std::string instance = hostname_ + "." + service_name;
+    const std::string host = hostname_ + ".local";
+
+    std::string out;
+    // A legacy (one-shot) query gets its id and question echoed back
+    PutU16(out, legacy ? id : 0);
+    PutU16(out, 0x8400);  // response, authoritative
+    PutU16(out, legacy ? 1 : 0);
+    PutU16(out, 4);
+    PutU16(out, 0);
+    PutU16(out, 0);
+    if (legacy) {
+        PutName(out, question);
+        PutU16(out, kTypePtr);
+        PutU16(out, 1);
+    }
+
+    std::string rdata;
+    PutName(rdata, instance);
+    PutRecord(out, service_name, kTypePtr, kServiceTtl, rdata);
+
+    rdata.clear();
+    PutU16(rdata, 0);  // priority
+    PutU16(rdata, 0);  // weight
+    PutU16(rdata, service.port);
+    PutName(rdata, host);
+    PutRecord(out, instance, kTypeSrv, kHostTtl, rdata);
+
+    rdata.clear();
+    for (const auto& item : service.txt) {
+        std::string entry = item.first + "=" + item.second;
+        rdata.push_back(static_cast<char>(std::min<size_t>(entry.size(), 255)));
+        rdata.append(entry, 0, 255);
+    }
+    PutRecord(out, instance, kTypeTxt, kServiceTtl, rdata);
+
+    rdata.clear();
+    PutU32(rdata, ntohl(static_cast<uint32_t>(WiFi.localIP())));
+    PutRecord(out, host, kTypeA, kHostTtl, rdata);
+
+    sockaddr_in destination{};
+    destination.sin_family = AF_INET;
+    if (legacy) {
+        destination.sin_addr.s_addr = address;
+        destination.sin_port = htons(port);
+    } else {
+        inet_pton(AF_INET, kMdnsGroup, &destination.sin_addr);
+        destination.sin_port = htons(kMdnsPort);
+    }
+    sendto(fd_, out.data(), out.size(), 0, reinterpret_cast<sockaddr*>(&destination), sizeof(destination));
+}
@@ -0,0 +1,42 @@
+#pragma once
+
+// Minimal mDNS responder with the ESPmDNS service API. It answers PTR
+// queries for the registered services with PTR, SRV, TXT and A records,
+// which is all the proxies need to find each other. Every instance on the
+// machine binds 5353 with SO_REUSEPORT, so several host builds can run side
+// by side. Polled from update(), like the ESP8266 responder.
+
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "Arduino.h"
+
+class MDNSResponder {
+public:
+    MDNSResponder() = default;
+    ~MDNSResponder();
+
+    bool begin(const char* hostname);
+    void end();
+    bool addService(const char* service, const char* proto, uint16_t port);
+    bool addServiceTxt(const char* service, const char* proto, const char* key, const char* value);
+    void update();
+
+private:
+    struct Service {
+        std::string name;  // "_stratum._tcp"
+        uint16_t port = 0;
+        std::vector<std::pair<std::string, std::string>> txt;
+    };
+
+    Service* findService(const char* service, const char* proto);
+    void answer(const Service& service, uint16_t id, bool legacy, const std::string& question, uint32_t address,
+                uint16_t port);
+
+    int fd_ = -1;
+    std::string hostname_;
+    std::vector<Service> services_;
+};
+
+extern MDNSResponder MDNS;
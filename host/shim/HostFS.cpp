@@ -0,0 +1,155 @@
+#include "HostFS.h"
+
+#include <sys/stat.h>
+
+#include <cerrno>
+#include <filesystem>
+
+namespace fs = std::filesystem;
+
+HostFileSystem HostFS;
+
+File::File(std::FILE* handle, const String& name)
+    : handle_(handle, [](std::FILE* file) { std::fclose(file); }), name_(name) {}
+
+size_t File::write(uint8_t value) {
+    return write(&value, 1);
+}
+
+size_t File::write(const uint8_t* buffer, size_t size) {
+    return handle_ ? std::fwrite(buffer, 1, size, handle_.get()) : 0;
+}
+
+int File::available() {
+    if (!handle_) {
+        return 0;
+    }
+    return static_cast<int>(size() - position());
+}
+
+int File::read() {
+    if (!handle_) {
+        return -1;
+    }
+    int value = std::fgetc(handle_.get());
+    return value == EOF ? -1 : value;
+}
+
+size_t File::read(uint8_t* buffer, size_t size) {
+    return handle_ ? std::fread(buffer, 1, size, handle_.get()) : 0;
+}
+
+int File::peek() {
+    if (!handle_) {
+        return -1;
+    }
+    int value = std::fgetc(handle_.get());
+    if (value == EOF) {
+        return -1;
+    }
+    std::ungetc(value, handle_.get());
+    return value;
+}
+
+void File::flush() {
+    if (handle_) {
+        std::fflush(handle_.get());
+    }
+}
+
+bool File::seek(uint32_t position, SeekMode mode) {
+    if (!handle_) {
+        return false;
+    }
+    int whence = mode == SeekCur ? SEEK_CUR : (mode == SeekEnd ? SEEK_END : SEEK_SET);
+    return std::fseek(handle_.get(), static_cast<long>(position), whence) == 0;
+}
+
+size_t File::position() const {
+    if (!handle_) {
+        return 0;
+    }
+    long offset = std::ftell(handle_.get());
+    return offset < 0 ? 0 : static_cast<size_t>(offset);
+}
+
+size_t File::size() const {
+    if (!handle_) {
+        return 0;
+    }
+    struct stat info {};
+    if (fstat(fileno(handle_.get()), &info) != 0) {
+        return 0;
+    }
+    return static_cast<size_t>(info.st_size);
+}
+
+void File::close() {
+    handle_.reset();
+}
+
+void HostFileSystem::setRoot(const String& root) {
+    root_ = root;
+}
+
+bool HostFileSystem::begin(bool format_on_fail) {
+    (void)format_on_fail;
+    std::error_code error;
+    fs::create_directories(root_.c_str(), error);
+    return fs::is_directory(root_.c_str(), error);
+}
+
+bool HostFileSystem::format() {
+    std::error_code error;
+    fs::remove_all(root_.c_str(), error);
+    return begin(false);
+}
+
+std::string HostFileSystem::Resolve(const char* path) const {
+    std::string resolved = root_.c_str();
+    if (!path || path[0] != '/') {
+        resolved += '/';
+    }
+    resolved += path ? path : "";
+    return resolved;
+}
+
+File HostFileSystem::open(const char* path, const char* mode) {
+    std::string resolved = Resolve(path);
+    std::string file_mode = mode ? mode : "r";
+    if (file_mode.find('b') == std::string::npos) {
+        file_mode += 'b';
+    }
+    std::FILE* handle = std::fopen(resolved.c_str(), file_mode.c_str());
+    if (!handle) {
+        return File();
+    }
+    return File(handle, String(path));
+}
+
+bool HostFileSystem::exists(const char* path) {
+    std::error_code error;
+    return fs::exists(Resolve(path), error);
+}
+
+bool HostFileSystem::remove(const char* path) {
+    std::error_code error;
+    return fs::remove(Resolve(path), error);
+}
+
+bool HostFileSystem::rename(const char* from, const char* to) {
+    std::error_code error;
+    fs::rename(Resolve(from), Resolve(to), error);
+    return !error;
+}
+
+size_t HostFileSystem::usedBytes() {
+    size_t used = 0;
+    std::error_code error;
+    for (const auto& entry : fs::recursive_directory_iterator(root_.c_str(), error)) {
+        if (entry.is_regular_file(error)) {
+            used += static_cast<size_t>(entry.file_size(error));
+        }
+    }
+    return used;
+}
@@ -0,0 +1,71 @@
+#pragma once
+
+// Directory-backed stand-in for SPIFFS/LittleFS. Paths such as "/config.json"
+// resolve below the root passed to HostFS.setRoot().
+
+#include <cstdio>
+#include <memory>
+#include <string>
+
+#include "Arduino.h"
+
+#define FILE_READ "r"
+#define FILE_WRITE "w"
+#define FILE_APPEND "a"
+
+enum SeekMode { SeekSet = 0, SeekCur = 1, SeekEnd = 2 };
+
+class File : public Stream {
+public:
+    File() = default;
+    File(std::FILE* handle, const String& name);
+
+    explicit operator bool() const { return handle_ != nullptr; }
+
+    size_t write(uint8_t value) override;
+    size_t write(const uint8_t* buffer, size_t size) override;
+    using Print::write;
+    int available() override;
+    int read() override;
+    size_t read(uint8_t* buffer, size_t size);
+    int peek() override;
+    void flush() override;
+
+    bool seek(uint32_t position, SeekMode mode = SeekSet);
+    size_t position() const;
+    size_t size() const;
+    void close();
+    const char* name() const { return name_.c_str(); }
+
+private:
+    std::shared_ptr<std::FILE> handle_;
+    String name_;
+};
+
+class HostFileSystem {
+public:
+    void setRoot(const String& root);
+    const String& root() const { return root_; }
+
+    bool begin(bool format_on_fail = false);
+    void end() {}
+    bool format();
+
+    File open(const char* path, const char* mode = FILE_READ);
+    File open(const String& path, const char* mode = FILE_READ) { return open(path.c_str(), mode); }
+    bool exists(const char* path);
+    bool exists(const String& path) { return exists(path.c_str()); }
+    bool remove(const char* path);
+    bool remove(const String& path) { return remove(path.c_str()); }
+    bool rename(const char* from, const char* to);
+
+    size_t totalBytes() const { return 1024 * 1024; }
+    size_t usedBytes();
+
+private:
+    std::string Resolve(const char* path) const;
+
+    String root_ = "yuma-data";
+};
+
+extern HostFileSystem HostFS;
@@ -0,0 +1,46 @@
+#include "IPAddress.h"
+
+#include <cstdio>
+
+const IPAddress INADDR_NONE(0, 0, 0, 0);
+
+bool IPAddress::fromString(const char* address) {
+    if (!address) {
+        return false;
+    }
+
+    uint8_t parsed[4];
+    int octet = 0;
+    int value = -1;
+    for (const char* p = address;; ++p) {
+        if (*p >= '0' && *p <= '9') {
+            value = (value < 0 ? 0 : value * 10) + (*p - '0');
+            if (value > 255) {
+                return false;
+            }
+        } else if (*p == '.' || *p == '\0') {
+            if (value < 0 || octet > 3) {
+                return false;
+            }
+            parsed[octet++] = static_cast<uint8_t>(value);
+            value = -1;
+            if (*p == '\0') {
+                break;
+            }
+        } else {
+            return false;
+        }
+    }
+
+    if (octet != 4) {
+        return false;
+    }
+    std::memcpy(bytes_, parsed, sizeof(bytes_));
+    return true;
+}
+
+String IPAddress::toString() const {
+    char buffer[16];
+    std::snprintf(buffer, sizeof(buffer), "%u.%u.%u.%u", bytes_[0], bytes_[1], bytes_[2], bytes_[3]);
+    return String(buffer);
+}
@@ -0,0 +1,39 @@
+#pragma once
+
+#include <cstdint>
+#include <cstring>
+
+#include "WString.h"
+
+// IPv4 address stored in network byte order, like the ESP cores' IPAddress.
+class IPAddress {
+public:
+    IPAddress() = default;
+    IPAddress(uint8_t a, uint8_t b, uint8_t c, uint8_t d) {
+        bytes_[0] = a;
+        bytes_[1] = b;
+        bytes_[2] = c;
+        bytes_[3] = d;
+    }
+    IPAddress(uint32_t address) { std::memcpy(bytes_, &address, sizeof(bytes_)); }
+
+    operator uint32_t() const {
+        uint32_t address;
+        std::memcpy(&address, bytes_, sizeof(address));
+        return address;
+    }
+
+    bool operator==(const IPAddress& other) const { return std::memcmp(bytes_, other.bytes_, sizeof(bytes_)) == 0; }
+    bool operator!=(const IPAddress& other) const { return !(*this == other); }
+    uint8_t operator[](int index) const { return bytes_[index]; }
+    uint8_t& operator[](int index) { return bytes_[index]; }
+
+    bool fromString(const char* address);
+    bool fromString(const String& address) { return fromString(address.c_str()); }
+    String toString() const;
+
+private:
+    uint8_t bytes_[4] = {0, 0, 0, 0};
+};
+
+extern const IPAddress INADDR_NONE;
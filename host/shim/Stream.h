@@ -0,0 +1,23 @@
+#pragma once
+
+#include "Print.h"
+
+class Stream : public Print {
+public:
+    virtual int available() = 0;
+    virtual int read() = 0;
+    virtual int peek() = 0;
+
+    void setTimeout(unsigned long timeout_ms) { timeout_ms_ = timeout_ms; }
+    unsigned long getTimeout() const { return timeout_ms_; }
+
+    size_t readBytes(char* buffer, size_t length);
+    size_t readBytes(uint8_t* buffer, size_t length) { return readBytes(reinterpret_cast<char*>(buffer), length); }
+    String readStringUntil(char terminator);
+    String readString();
+
+protected:
+    int timedRead();
+
+    unsigned long timeout_ms_ = 1000;
+};
@@ -0,0 +1,183 @@
+#include "WString.h"
+
+#include <algorithm>
+#include <cctype>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+namespace {
+template <typename T>
+std::string FormatUnsigned(T value, unsigned char base) {
+    if (base < 2 || base > 36) {
+        base = 10;
+    }
+    if (value == 0) {
+        return "0";
+    }
+    std::string out;
+    while (value > 0) {
+        int digit = static_cast<int>(value % base);
+        out.push_back(static_cast<char>(digit < 10 ? '0' + digit : 'a' + digit - 10));
+        value /= base;
+    }
+    std::reverse(out.begin(), out.end());
+    return out;
+}
+
+template <typename T>
+std::string FormatSigned(T value, unsigned char base) {
+    if (value < 0 && base == 10) {
+        return "-" + FormatUnsigned(static_cast<unsigned long long>(-(value + 1)) + 1, base);
+    }
+    return FormatUnsigned(static_cast<unsigned long long>(value), base);
+}
+
+std::string FormatDouble(double value, unsigned char decimals) {
+    char buffer[64];
+    std::snprintf(buffer, sizeof(buffer), "%.*f", decimals, value);
+    return buffer;
+}
+}
+
+String::String(int value, unsigned char base) : data_(FormatSigned(value, base)) {}
+String::String(unsigned int value, unsigned char base) : data_(FormatUnsigned(value, base)) {}
+String::String(long value, unsigned char base) : data_(FormatSigned(value, base)) {}
+String::String(unsigned long value, unsigned char base) : data_(FormatUnsigned(value, base)) {}
+String::String(long long value, unsigned char base) : data_(FormatSigned(value, base)) {}
+String::String(unsigned long long value, unsigned char base) : data_(FormatUnsigned(value, base)) {}
+String::String(float value, unsigned char decimals) : data_(FormatDouble(value, decimals)) {}
+String::String(double value, unsigned char decimals) : data_(FormatDouble(value, decimals)) {}
+
+int String::indexOf(char value, unsigned int from) const {
+    size_t pos = data_.find(value, from);
+    return pos == std::string::npos ? -1 : static_cast<int>(pos);
+}
+
+int String::indexOf(const String& value, unsigned int from) const {
+    size_t pos = data_.find(value.data_, from);
+    return pos == std::string::npos ? -1 : static_cast<int>(pos);
+}
+
+int String::lastIndexOf(char value) const {
+    size_t pos = data_.rfind(value);
+    return pos == std::string::npos ? -1 : static_cast<int>(pos);
+}
+
+int String::lastIndexOf(const String& value) const {
+    size_t pos = data_.rfind(value.data_);
+    return pos == std::string::npos ? -1 : static_cast<int>(pos);
+}
+
+String String::substring(unsigned int begin) const {
+    return substring(begin, length());
+}
+
+String String::substring(unsigned int begin, unsigned int end) const {
+    if (begin > end) {
+        std::swap(begin, end);
+    }
+    if (begin >= data_.size()) {
+        return String();
+    }
+    end = std::min<unsigned int>(end, length());
+    return String(data_.substr(begin, end - begin));
+}
+
+bool String::startsWith(const String& prefix) const {
+    return data_.compare(0, prefix.data_.size(), prefix.data_) == 0;
+}
+
+bool String::endsWith(const String& suffix) const {
+    return data_.size() >= suffix.data_.size() &&
+           data_.compare(data_.size() - suffix.data_.size(), suffix.data_.size(), suffix.data_) == 0;
+}
+
+bool String::equalsIgnoreCase(const String& other) const {
+    if (data_.size() != other.data_.size()) {
+        return false;
+    }
+    for (size_t i = 0; i < data_.size(); ++i) {
+        if (std::tolower(static_cast<unsigned char>(data_[i])) !=
+            std::tolower(static_cast<unsigned char>(other.data_[i]))) {
+            return false;
+        }
+    }
+    return true;
+}
+
+void String::trim() {
+    size_t begin = 0;
+    while (begin < data_.size() && std::isspace(static_cast<unsigned char>(data_[begin]))) {
+        begin++;
+    }
+    size_t end = data_.size();
+    while (end > begin && std::isspace(static_cast<unsigned char>(data_[end - 1]))) {
+        end--;
+    }
+    data_ = data_.substr(begin, end - begin);
+}
+
+void String::toLowerCase() {
+    for (char& c : data_) {
+        c = static_cast<char>(std::tolower(static_cast<unsigned char>(c)));
+    }
+}
+
+void String::toUpperCase() {
+    for (char& c : data_) {
+        c = static_cast<char>(std::toupper(static_cast<unsigned char>(c)));
+    }
+}
+
+void String::replace(const String& find, const String& replacement) {
+    if (find.data_.empty()) {
+        return;
+    }
+    size_t pos = 0;
+    while ((pos = data_.find(find.data_, pos)) != std::string::npos) {
+        data_.replace(pos, find.data_.size(), replacement.data_);
+        pos += replacement.data_.size();
+    }
+}
+
+void String::remove(unsigned int index) {
+    if (index < data_.size()) {
+        data_.erase(index);
+    }
+}
+
+void String::remove(unsigned int index, unsigned int count) {
+    if (index < data_.size()) {
+        data_.erase(index, count);
+    }
+}
+
+long String::toInt() const {
+    return std::strtol(data_.c_str(), nullptr, 10);
+}
+
+float String::toFloat() const {
+    return std::strtof(data_.c_str(), nullptr);
+}
+
+double String::toDouble() const {
+    return std::strtod(data_.c_str(), nullptr);
+}
+
+void String::toCharArray(char* buffer, unsigned int size, unsigned int index) const {
+    getBytes(reinterpret_cast<unsigned char*>(buffer), size, index);
+}
+
+void String::getBytes(unsigned char* buffer, unsigned int size, unsigned int index) const {
+    if (!buffer || size == 0) {
+        return;
+    }
+    if (index >= data_.size()) {
+        buffer[0] = 0;
+        return;
+    }
+    size_t count = std::min<size_t>(size - 1, data_.size() - index);
+    std::memcpy(buffer, data_.data() + index, count);
+    buffer[count] = 0;
+}
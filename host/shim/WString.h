@@ -0,0 +1,140 @@
+#pragma once
+
+// Host stand-in for the Arduino String class, backed by std::string.
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+class String {
+public:
+    String() = default;
+    String(const char* value) : data_(value ? value : "") {}
+    String(const char* value, size_t length) : data_(value ? std::string(value, length) : std::string()) {}
+    String(const std::string& value) : data_(value) {}
+    explicit String(char value) : data_(1, value) {}
+    String(int value, unsigned char base = 10);
+    String(unsigned int value, unsigned char base = 10);
+    String(long value, unsigned char base = 10);
+    String(unsigned long value, unsigned char base = 10);
+    String(long long value, unsigned char base = 10);
+    String(unsigned long long value, unsigned char base = 10);
+    String(float value, unsigned char decimals = 2);
+    String(double value, unsigned char decimals = 2);
+
+    unsigned int length() const { return static_cast<unsigned int>(data_.size()); }
+    bool isEmpty() const { return data_.empty(); }
+    const char* c_str() const { return data_.c_str(); }
+    const std::string& str() const { return data_; }
+    bool reserve(unsigned int size) {
+        data_.reserve(size);
+        return true;
+    }
+
+    bool concat(const String& value) {
+        data_ += value.data_;
+        return true;
+    }
+    bool concat(const char* value) {
+        data_ += value ? value : "";
+        return true;
+    }
+    bool concat(const char* value, unsigned int length) {
+        if (value) {
+            data_.append(value, length);
+        }
+        return true;
+    }
+    bool concat(char value) {
+        data_ += value;
+        return true;
+    }
+    bool concat(int value) { return concat(String(value)); }
+    bool concat(unsigned int value) { return concat(String(value)); }
+    bool concat(long value) { return concat(String(value)); }
+    bool concat(unsigned long value) { return concat(String(value)); }
+    bool concat(double value) { return concat(String(value)); }
+
+    template <typename T>
+    String& operator+=(const T& value) {
+        concat(value);
+        return *this;
+    }
+
+    char charAt(unsigned int index) const { return index < data_.size() ? data_[index] : 0; }
+    void setCharAt(unsigned int index, char value) {
+        if (index < data_.size()) {
+            data_[index] = value;
+        }
+    }
+    char operator[](unsigned int index) const { return charAt(index); }
+    char& operator[](unsigned int index) { return data_[index]; }
+
+    int indexOf(char value, unsigned int from = 0) const;
+    int indexOf(const String& value, unsigned int from = 0) const;
+    int lastIndexOf(char value) const;
+    int lastIndexOf(const String& value) const;
+    String substring(unsigned int begin) const;
+    String substring(unsigned int begin, unsigned int end) const;
+
+    bool startsWith(const String& prefix) const;
+    bool endsWith(const String& suffix) const;
+    bool equals(const String& other) const { return data_ == other.data_; }
+    bool equalsIgnoreCase(const String& other) const;
+
+    void trim();
+    void toLowerCase();
+    void toUpperCase();
+    void replace(const String& find, const String& replacement);
+    void remove(unsigned int index);
+    void remove(unsigned int index, unsigned int count);
+
+    long toInt() const;
+    float toFloat() const;
+    double toDouble() const;
+    void toCharArray(char* buffer, unsigned int size, unsigned int index = 0) const;
+    void getBytes(unsigned char* buffer, unsigned int size, unsigned int index = 0) const;
+
+    bool operator==(const String& other) const { return data_ == other.data_; }
+    bool operator==(const char* other) const { return data_ == (other ? other : ""); }
+    bool operator!=(const String& other) const { return data_ != other.data_; }
+    bool operator!=(const char* other) const { return !(*this == other); }
+    bool operator<(const String& other) const { return data_ < other.data_; }
+
+private:
+    std::string data_;
+};
+
+// ArduinoJson's String adapter also matches the result type of operator+.
+class StringSumHelper : public String {
+public:
+    using String::String;
+    StringSumHelper(const String& value) : String(value) {}
+};
+
+inline String operator+(const String& lhs, const String& rhs) {
+    String result(lhs);
+    result.concat(rhs);
+    return result;
+}
+inline String operator+(const String& lhs, const char* rhs) {
+    String result(lhs);
+    result.concat(rhs);
+    return result;
+}
+inline String operator+(const char* lhs, const String& rhs) {
+    String result(lhs);
+    result.concat(rhs);
+    return result;
+}
+inline String operator+(const String& lhs, char rhs) {
+    String result(lhs);
+    result.concat(rhs);
+    return result;
+}
+template <typename T>
+String operator+(const String& lhs, T rhs) {
+    String result(lhs);
+    result.concat(String(rhs));
+    return result;
+}
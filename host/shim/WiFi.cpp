@@ -0,0 +1,75 @@
+#include "WiFi.h"
+
+#include <arpa/inet.h>
+#include <netdb.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <fstream>
+#include <sstream>
+#include <string>
+
+HostWiFi WiFi;
+
+IPAddress HostWiFi::localIP() {
+    // Route lookup via an unconnected UDP socket; no packet is sent
+    int fd = socket(AF_INET, SOCK_DGRAM | SOCK_CLOEXEC, 0);
+    if (fd < 0) {
+        return IPAddress(127, 0, 0, 1);
+    }
+
+    sockaddr_in remote{};
+    remote.sin_family = AF_INET;
+    remote.sin_port = htons(53);
+    inet_pton(AF_INET, "192.0.2.1", &remote.sin_addr);
+
+    IPAddress result(127, 0, 0, 1);
+    if (connect(fd, reinterpret_cast<sockaddr*>(&remote), sizeof(remote)) == 0) {
+        sockaddr_in local{};
+        socklen_t length = sizeof(local);
+        if (getsockname(fd, reinterpret_cast<sockaddr*>(&local), &length) == 0) {
+            result = IPAddress(static_cast<uint32_t>(local.sin_addr.s_addr));
+        }
+    }
+    close(fd);
+    return result;
+}
+
+IPAddress HostWiFi::dnsIP(uint8_t index) {
+    std::ifstream resolv("/etc/resolv.conf");
+    std::string line;
+    uint8_t seen = 0;
+    while (std::getline(resolv, line)) {
+        std::istringstream fields(line);
+        std::string key;
+        std::string value;
+        fields >> key >> value;
+        IPAddress address;
+        if (key == "nameserver" && address.fromString(value.c_str())) {
+            if (seen++ == index) {
+                return address;
+            }
+        }
+    }
+    return IPAddress();
+}
+
+int HostWiFi::hostByName(const char* host, IPAddress& result) {
+    if (result.fromString(host)) {
+        return 1;
+    }
+
+    addrinfo hints{};
+    hints.ai_family = AF_INET;
+    hints.ai_socktype = SOCK_STREAM;
+    addrinfo* found = nullptr;
+    if (getaddrinfo(host, nullptr, &hints, &found) != 0 || !found) {
+        return 0;
+    }
+
+    const sockaddr_in* address = reinterpret_cast<const sockaddr_in*>(found->ai_addr);
+    result = IPAddress(static_cast<uint32_t>(address->sin_addr.s_addr));
+    freeaddrinfo(found);
+    return 1;
+}
@@ -0,0 +1,40 @@
+#pragma once
+
+// Host networking status: the Linux box is always "associated", and DNS comes
+// from /etc/resolv.conf.
+
+#include "Arduino.h"
+#include "IPAddress.h"
+#include "WiFiClient.h"
+
+typedef enum {
+    WL_IDLE_STATUS = 0,
+    WL_NO_SSID_AVAIL = 1,
+    WL_SCAN_COMPLETED = 2,
+    WL_CONNECTED = 3,
+    WL_CONNECT_FAILED = 4,
+    WL_CONNECTION_LOST = 5,
+    WL_DISCONNECTED = 6,
+} wl_status_t;
+
+class HostWiFi {
+public:
+    wl_status_t status() { return WL_CONNECTED; }
+    IPAddress localIP();
+    IPAddress gatewayIP() { return IPAddress(); }
+    IPAddress subnetMask() { return IPAddress(255, 255, 255, 0); }
+    IPAddress dnsIP(uint8_t index = 0);
+    // Blocking, like the SDKs' lookup; 1 on success
+    int hostByName(const char* host, IPAddress& result);
+    int32_t RSSI() { return 0; }
+    String SSID() const { return String("host"); }
+    String psk() const { return String(); }
+    const uint8_t* BSSID() { return bssid_; }
+    int32_t channel() { return 0; }
+    String macAddress() const { return String("00:00:00:00:00:00"); }
+
+private:
+    uint8_t bssid_[6] = {0, 0, 0, 0, 0, 0};
+};
+
+extern HostWiFi WiFi;
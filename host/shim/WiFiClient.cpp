@@ -0,0 +1,237 @@
+#include "WiFiClient.h"
+
+#include <algorithm>
+#include <arpa/inet.h>
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <netdb.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+namespace {
+constexpr size_t kReadChunk = 2048;
+constexpr int kWriteTimeoutMs = 5000;
+}
+
+bool WiFiClient::ResolveHost(const char* host, IPAddress& out) {
+    if (out.fromString(host)) {
+        return true;
+    }
+
+    addrinfo hints{};
+    hints.ai_family = AF_INET;
+    hints.ai_socktype = SOCK_STREAM;
+    addrinfo* result = nullptr;
+    if (getaddrinfo(host, nullptr, &hints, &result) != 0 || !result) {
+        return false;
+    }
+
+    const sockaddr_in* address = reinterpret_cast<const sockaddr_in*>(result->ai_addr);
+    out = IPAddress(static_cast<uint32_t>(address->sin_addr.s_addr));
+    freeaddrinfo(result);
+    return true;
+}
+
+WiFiClient::~WiFiClient() {
+    stop();
+}
+
+int WiFiClient::connect(IPAddress ip, uint16_t port) {
+    stop();
+
+    fd_ = socket(AF_INET, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (fd_ < 0) {
+        return 0;
+    }
+    fcntl(fd_, F_SETFL, fcntl(fd_, F_GETFL) | O_NONBLOCK);
+
+    sockaddr_in address{};
+    address.sin_family = AF_INET;
+    address.sin_port = htons(port);
+    address.sin_addr.s_addr = static_cast<uint32_t>(ip);
+
+    int rc = ::connect(fd_, reinterpret_cast<sockaddr*>(&address), sizeof(address));
+    if (rc != 0 && errno != EINPROGRESS) {
+        stop();
+        return 0;
+    }
+
+    if (rc != 0) {
+        pollfd pfd{fd_, POLLOUT, 0};
+        if (poll(&pfd, 1, static_cast<int>(connect_timeout_ms_)) != 1) {
+            stop();
+            return 0;
+        }
+        int error = 0;
+        socklen_t length = sizeof(error);
+        getsockopt(fd_, SOL_SOCKET, SO_ERROR, &error, &length);
+        if (error != 0) {
+            stop();
+            return 0;
+        }
+    }
+
+    peer_closed_ = false;
+    return 1;
+}
+
+int WiFiClient::connect(IPAddress ip, uint16_t port, int32_t timeout_ms) {
+    const unsigned long previous = connect_timeout_ms_;
+    connect_timeout_ms_ = static_cast<unsigned long>(timeout_ms);
+    int rc = connect(ip, port);
+    connect_timeout_ms_ = previous;
+    return rc;
+}
+
+int WiFiClient::connect(const char* host, uint16_t port) {
+    IPAddress ip;
+    if (!host || !ResolveHost(host, ip)) {
+        return 0;
+    }
+    return connect(ip, port);
+}
+
+bool WiFiClient::FillBuffer() {
+    if (fd_ < 0 || peer_closed_) {
+        return false;
+    }
+
+    if (rx_pos_ > 0) {
+        rx_.erase(0, rx_pos_);
+        rx_pos_ = 0;
+    }
+
+    char chunk[kReadChunk];
+    ssize_t received = recv(fd_, chunk, sizeof(chunk), MSG_DONTWAIT);
+    if (received > 0) {
+        rx_.append(chunk, static_cast<size_t>(received));
+        return true;
+    }
+    if (received == 0 || (errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR)) {
+        peer_closed_ = true;
+    }
+    return false;
+}
+
+uint8_t WiFiClient::connected() {
+    if (fd_ < 0) {
+        return 0;
+    }
+    FillBuffer();
+    return (!peer_closed_ || rx_pos_ < rx_.size()) ? 1 : 0;
+}
+
+void WiFiClient::stop() {
+    if (fd_ >= 0) {
+        ::close(fd_);
+    }
+    fd_ = -1;
+    peer_closed_ = false;
+    rx_.clear();
+    rx_pos_ = 0;
+}
+
+int WiFiClient::available() {
+    while (FillBuffer()) {
+    }
+    return static_cast<int>(rx_.size() - rx_pos_);
+}
+
+int WiFiClient::read() {
+    if (rx_pos_ >= rx_.size() && !FillBuffer()) {
+        return -1;
+    }
+    return static_cast<uint8_t>(rx_[rx_pos_++]);
+}
+
+int WiFiClient::read(uint8_t* buffer, size_t size) {
+    available();
+    size_t count = std::min(size, rx_.size() - rx_pos_);
+    std::memcpy(buffer, rx_.data() + rx_pos_, count);
+    rx_pos_ += count;
+    return static_cast<int>(count);
+}
+
+int WiFiClient::peek() {
+    if (rx_pos_ >= rx_.size() && !FillBuffer()) {
+        return -1;
+    }
+    return static_cast<uint8_t>(rx_[rx_pos_]);
+}
+
+size_t WiFiClient::write(uint8_t value) {
+    return write(&value, 1);
+}
+
+size_t WiFiClient::write(const uint8_t* buffer, size_t size) {
+    if (fd_ < 0) {
+        return 0;
+    }
+
+    size_t written = 0;
+    while (written < size) {
+        ssize_t sent = send(fd_, buffer + written, size - written, MSG_NOSIGNAL | MSG_DONTWAIT);
+        if (sent > 0) {
+            written += static_cast<size_t>(sent);
+            continue;
+        }
+        if (sent < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+            pollfd pfd{fd_, POLLOUT, 0};
+            if (poll(&pfd, 1, kWriteTimeoutMs) == 1) {
+                continue;
+            }
+        }
+        peer_closed_ = true;
+        break;
+    }
+    return written;
+}
+
+int WiFiClient::setNoDelay(bool enabled) {
+    if (fd_ < 0) {
+        return 0;
+    }
+    int flag = enabled ? 1 : 0;
+    return setsockopt(fd_, IPPROTO_TCP, TCP_NODELAY, &flag, sizeof(flag)) == 0 ? 1 : 0;
+}
+
+bool WiFiClient::getNoDelay() {
+    if (fd_ < 0) {
+        return false;
+    }
+    int flag = 0;
+    socklen_t length = sizeof(flag);
+    getsockopt(fd_, IPPROTO_TCP, TCP_NODELAY, &flag, &length);
+    return flag != 0;
+}
+
+IPAddress WiFiClient::remoteIP() {
+    sockaddr_in address{};
+    socklen_t length = sizeof(address);
+    if (fd_ < 0 || getpeername(fd_, reinterpret_cast<sockaddr*>(&address), &length) != 0) {
+        return IPAddress();
+    }
+    return IPAddress(static_cast<uint32_t>(address.sin_addr.s_addr));
+}
+
+uint16_t WiFiClient::remotePort() {
+    sockaddr_in address{};
+    socklen_t length = sizeof(address);
+    if (fd_ < 0 || getpeername(fd_, reinterpret_cast<sockaddr*>(&address), &length) != 0) {
+        return 0;
+    }
+    return ntohs(address.sin_port);
+}
+
+IPAddress WiFiClient::localIP() {
+    sockaddr_in address{};
+    socklen_t length = sizeof(address);
+    if (fd_ < 0 || getsockname(fd_, reinterpret_cast<sockaddr*>(&address), &length) != 0) {
+        return IPAddress();
+    }
+    return IPAddress(static_cast<uint32_t>(address.sin_addr.s_addr));
+}
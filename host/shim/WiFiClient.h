@@ -0,0 +1,53 @@
+#pragma once
+
+// Blocking-connect TCP client over a POSIX socket, matching the polled
+// WiFiClient usage in pool_client.cpp.
+
+#include <string>
+
+#include "Arduino.h"
+#include "IPAddress.h"
+
+class WiFiClient : public Stream {
+public:
+    WiFiClient() = default;
+    ~WiFiClient() override;
+    WiFiClient(const WiFiClient&) = delete;
+    WiFiClient& operator=(const WiFiClient&) = delete;
+
+    virtual int connect(IPAddress ip, uint16_t port);
+    virtual int connect(const char* host, uint16_t port);
+    // The ESP32 core's bounded connect
+    int connect(IPAddress ip, uint16_t port, int32_t timeout_ms);
+    uint8_t connected();
+    virtual void stop();
+    explicit operator bool() { return connected(); }
+
+    int available() override;
+    int read() override;
+    int read(uint8_t* buffer, size_t size);
+    int peek() override;
+    size_t write(uint8_t value) override;
+    size_t write(const uint8_t* buffer, size_t size) override;
+    using Print::write;
+    void flush() override {}
+
+    int setNoDelay(bool enabled);
+    bool getNoDelay();
+    void setConnectTimeout(unsigned long timeout_ms) { connect_timeout_ms_ = timeout_ms; }
+
+    IPAddress remoteIP();
+    uint16_t remotePort();
+    IPAddress localIP();
+
+protected:
+    // Appends whatever the transport has ready to rx_; false when nothing came
+    virtual bool FillBuffer();
+    static bool ResolveHost(const char* host, IPAddress& out);
+
+    int fd_ = -1;
+    bool peer_closed_ = false;
+    std::string rx_;
+    size_t rx_pos_ = 0;
+    unsigned long connect_timeout_ms_ = 5000;
+};
@@ -0,0 +1,267 @@
+#include "WiFiClientSecure.h"
+
+#include <cctype>
+#include <csignal>
+#include <cstdlib>
+#include <poll.h>
+
+#if defined(YUMA_HOST_TLS)
+#include <openssl/err.h>
+#include <openssl/evp.h>
+#include <openssl/ssl.h>
+#include <openssl/x509.h>
+#endif
+
+WiFiClientSecure::~WiFiClientSecure() {
+    stop();
+}
+
+int WiFiClientSecure::connect(IPAddress ip, uint16_t port) {
+    return connect(ip, port, nullptr);
+}
+
+int WiFiClientSecure::connect(const char* host, uint16_t port) {
+    IPAddress ip;
+    if (!host || !ResolveHost(host, ip)) {
+        return 0;
+    }
+    return connect(ip, port, host);
+}
+
+#if defined(YUMA_HOST_TLS)
+namespace {
+int client_index = -1;
+
+int OnNewSession(SSL* ssl, SSL_SESSION* session) {
+    auto* client = static_cast<WiFiClientSecure*>(SSL_get_ex_data(ssl, client_index));
+    int length = i2d_SSL_SESSION(session, nullptr);
+    if (client && length > 0) {
+        std::vector<uint8_t> encoded(static_cast<size_t>(length));
+        unsigned char* cursor = encoded.data();
+        i2d_SSL_SESSION(session, &cursor);
+        client->StoreSession(encoded);
+    }
+    return 0;  // the caller's copy is the only cache
+}
+
+SSL_CTX* SharedContext(bool insecure) {
+    static SSL_CTX* contexts[2] = {nullptr, nullptr};
+    SSL_CTX*& context = contexts[insecure ? 1 : 0];
+    if (context) {
+        return context;
+    }
+
+    context = SSL_CTX_new(TLS_client_method());
+    if (!context) {
+        return nullptr;
+    }
+    // OpenSSL writes with plain send(); a reset pool must not kill the process
+    std::signal(SIGPIPE, SIG_IGN);
+    if (client_index < 0) {
+        client_index = SSL_get_ex_new_index(0, nullptr, nullptr, nullptr, nullptr);
+    }
+    SSL_CTX_set_session_cache_mode(context, SSL_SESS_CACHE_CLIENT | SSL_SESS_CACHE_NO_INTERNAL_STORE);
+    SSL_CTX_sess_set_new_cb(context, OnNewSession);
+    if (insecure) {
+        SSL_CTX_set_verify(context, SSL_VERIFY_NONE, nullptr);
+    } else {
+        SSL_CTX_set_default_verify_paths(context);
+        SSL_CTX_set_verify(context, SSL_VERIFY_PEER, nullptr);
+    }
+    return context;
+}
+}
+
+int WiFiClientSecure::connect(IPAddress ip, uint16_t port, const char* host) {
+    stop();
+    if (!WiFiClient::connect(ip, port)) {
+        return 0;
+    }
+    if (!Handshake(host)) {
+        stop();
+        return 0;
+    }
+    return 1;
+}
+
+bool WiFiClientSecure::WaitForSocket(int ssl_error, int timeout_ms) {
+    short events = ssl_error == SSL_ERROR_WANT_WRITE ? POLLOUT : POLLIN;
+    if (ssl_error != SSL_ERROR_WANT_READ && ssl_error != SSL_ERROR_WANT_WRITE) {
+        return false;
+    }
+    pollfd pfd{fd_, events, 0};
+    return poll(&pfd, 1, timeout_ms) == 1;
+}
+
+bool WiFiClientSecure::Handshake(const char* host) {
+    SSL_CTX* context = SharedContext(insecure_);
+    if (!context) {
+        return false;
+    }
+
+    ssl_ = SSL_new(context);
+    if (!ssl_) {
+        return false;
+    }
+    SSL_set_ex_data(ssl_, client_index, this);
+    SSL_set_fd(ssl_, fd_);
+    SSL_set_mode(ssl_, SSL_MODE_ACCEPT_MOVING_WRITE_BUFFER);
+
+    IPAddress literal;
+    if (host && *host && !literal.fromString(host)) {
+        SSL_set_tlsext_host_name(ssl_, host);
+        if (!insecure_) {
+            SSL_set1_host(ssl_, host);
+        }
+    }
+
+    if (session_ && !session_->empty()) {
+        const unsigned char* cursor = session_->data();
+        SSL_SESSION* cached = d2i_SSL_SESSION(nullptr, &cursor, static_cast<long>(session_->size()));
+        if (cached) {
+            SSL_set_session(ssl_, cached);
+            SSL_SESSION_free(cached);
+        }
+    }
+
+    unsigned long started = millis();
+    for (;;) {
+        int rc = SSL_connect(ssl_);
+        if (rc == 1) {
+            break;
+        }
+        long remaining = static_cast<long>(connect_timeout_ms_) - static_cast<long>(millis() - started);
+        if (remaining <= 0 || !WaitForSocket(SSL_get_error(ssl_, rc), static_cast<int>(remaining))) {
+            ERR_clear_error();
+            return false;
+        }
+    }
+
+    reused_ = SSL_session_reused(ssl_) == 1;
+    return true;
+}
+
+bool WiFiClientSecure::verify(const char* fingerprint, const char* domain_name) {
+    (void)domain_name;
+    if (!ssl_ || !fingerprint) {
+        return false;
+    }
+    X509* cert = SSL_get1_peer_certificate(ssl_);
+    if (!cert) {
+        return false;
+    }
+    unsigned char digest[EVP_MAX_MD_SIZE];
+    unsigned int digest_len = 0;
+    bool hashed = X509_digest(cert, EVP_sha256(), digest, &digest_len) == 1;
+    X509_free(cert);
+    if (!hashed) {
+        return false;
+    }
+
+    const char* cursor = fingerprint;
+    for (unsigned int i = 0; i < digest_len; ++i) {
+        while (*cursor == ':' || *cursor == ' ') {
+            cursor++;
+        }
+        if (!std::isxdigit(static_cast<unsigned char>(cursor[0])) ||
+            !std::isxdigit(static_cast<unsigned char>(cursor[1]))) {
+            return false;
+        }
+        char pair[3] = {cursor[0], cursor[1], '\0'};
+        if (std::strtoul(pair, nullptr, 16) != digest[i]) {
+            return false;
+        }
+        cursor += 2;
+    }
+    return true;
+}
+
+void WiFiClientSecure::StoreSession(const std::vector<uint8_t>& session) {
+    if (session_) {
+        *session_ = session;
+    }
+}
+
+void WiFiClientSecure::stop() {
+    if (ssl_) {
+        SSL_shutdown(ssl_);
+        SSL_free(ssl_);
+        ssl_ = nullptr;
+    }
+    WiFiClient::stop();
+}
+
+bool WiFiClientSecure::FillBuffer() {
+    if (!ssl_ || peer_closed_) {
+        return false;
+    }
+
+    if (rx_pos_ > 0) {
+        rx_.erase(0, rx_pos_);
+        rx_pos_ = 0;
+    }
+
+    char chunk[2048];
+    int received = SSL_read(ssl_, chunk, sizeof(chunk));
+    if (received > 0) {
+        rx_.append(chunk, static_cast<size_t>(received));
+        return true;
+    }
+
+    int error = SSL_get_error(ssl_, received);
+    if (error != SSL_ERROR_WANT_READ && error != SSL_ERROR_WANT_WRITE) {
+        ERR_clear_error();
+        peer_closed_ = true;
+    }
+    return false;
+}
+
+size_t WiFiClientSecure::write(const uint8_t* buffer, size_t size) {
+    if (!ssl_ || size == 0) {
+        return 0;
+    }
+
+    for (;;) {
+        int sent = SSL_write(ssl_, buffer, static_cast<int>(size));
+        if (sent > 0) {
+            return static_cast<size_t>(sent);
+        }
+        if (!WaitForSocket(SSL_get_error(ssl_, sent), static_cast<int>(connect_timeout_ms_))) {
+            ERR_clear_error();
+            peer_closed_ = true;
+            return 0;
+        }
+    }
+}
+#else
+int WiFiClientSecure::connect(IPAddress ip, uint16_t port, const char* host) {
+    Serial.println("TLS unavailable: host build without OpenSSL");
+    return 0;
+}
+
+bool WiFiClientSecure::WaitForSocket(int ssl_error, int timeout_ms) {
+    return false;
+}
+
+bool WiFiClientSecure::Handshake(const char* host) {
+    return false;
+}
+
+bool WiFiClientSecure::verify(const char* fingerprint, const char* domain_name) {
+    return false;
+}
+
+void WiFiClientSecure::StoreSession(const std::vector<uint8_t>& session) {}
+
+void WiFiClientSecure::stop() {
+    WiFiClient::stop();
+}
+
+bool WiFiClientSecure::FillBuffer() {
+    return false;
+}
+
+size_t WiFiClientSecure::write(const uint8_t* buffer, size_t size) {
+    return 0;
+}
+#endif
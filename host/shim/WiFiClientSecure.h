@@ -0,0 +1,48 @@
+#pragma once
+
+// TLS client over the WiFiClient shim, backed by OpenSSL. Without OpenSSL
+// (YUMA_HOST_TLS unset) every connect fails, as on a build without TLS.
+
+#include <vector>
+
+#include "WiFiClient.h"
+
+typedef struct ssl_st SSL;
+
+class WiFiClientSecure : public WiFiClient {
+public:
+    WiFiClientSecure() = default;
+    ~WiFiClientSecure() override;
+
+    void setInsecure() { insecure_ = true; }
+    // DER-encoded session offered on connect and replaced whenever the
+    // server issues a new one (TLS 1.3 tickets arrive after the handshake)
+    void setSession(std::vector<uint8_t>* session) { session_ = session; }
+    bool isSessionReused() const { return reused_; }
+    // As on ESP32: true when the peer certificate's SHA-256 matches the hex
+    // fingerprint (':' or ' ' between bytes allowed); domain_name is ignored
+    bool verify(const char* fingerprint, const char* domain_name);
+
+    int connect(IPAddress ip, uint16_t port) override;
+    int connect(const char* host, uint16_t port) override;
+    int connect(IPAddress ip, uint16_t port, const char* host);
+    void stop() override;
+
+    size_t write(const uint8_t* buffer, size_t size) override;
+    using WiFiClient::write;
+
+    // Called by OpenSSL for each new session on this connection
+    void StoreSession(const std::vector<uint8_t>& session);
+
+protected:
+    bool FillBuffer() override;
+
+private:
+    bool Handshake(const char* host);
+    bool WaitForSocket(int ssl_error, int timeout_ms);
+
+    SSL* ssl_ = nullptr;
+    std::vector<uint8_t>* session_ = nullptr;
+    bool insecure_ = false;
+    bool reused_ = false;
+};
@@ -0,0 +1,123 @@
+#include "WiFiUdp.h"
+
+#include <arpa/inet.h>
+#include <cerrno>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+namespace {
+constexpr size_t kMaxDatagram = 1500;
+}
+
+WiFiUDP::~WiFiUDP() {
+    stop();
+}
+
+uint8_t WiFiUDP::begin(uint16_t port) {
+    stop();
+
+    fd_ = socket(AF_INET, SOCK_DGRAM | SOCK_CLOEXEC | SOCK_NONBLOCK, 0);
+    if (fd_ < 0) {
+        return 0;
+    }
+
+    sockaddr_in address{};
+    address.sin_family = AF_INET;
+    address.sin_port = htons(port);
+    address.sin_addr.s_addr = htonl(INADDR_ANY);
+    if (bind(fd_, reinterpret_cast<sockaddr*>(&address), sizeof(address)) != 0) {
+        stop();
+        return 0;
+    }
+    return 1;
+}
+
+void WiFiUDP::stop() {
+    if (fd_ >= 0) {
+        ::close(fd_);
+    }
+    fd_ = -1;
+    rx_.clear();
+    rx_pos_ = 0;
+}
+
+int WiFiUDP::beginPacket(IPAddress ip, uint16_t port) {
+    if (fd_ < 0 && !begin(0)) {
+        return 0;
+    }
+    tx_ip_ = ip;
+    tx_port_ = port;
+    tx_.clear();
+    return 1;
+}
+
+int WiFiUDP::endPacket() {
+    if (fd_ < 0) {
+        return 0;
+    }
+
+    sockaddr_in address{};
+    address.sin_family = AF_INET;
+    address.sin_port = htons(tx_port_);
+    address.sin_addr.s_addr = static_cast<uint32_t>(tx_ip_);
+    ssize_t sent = sendto(fd_, tx_.data(), tx_.size(), 0, reinterpret_cast<sockaddr*>(&address), sizeof(address));
+    tx_.clear();
+    return sent >= 0 ? 1 : 0;
+}
+
+size_t WiFiUDP::write(uint8_t value) {
+    tx_.push_back(static_cast<char>(value));
+    return 1;
+}
+
+size_t WiFiUDP::write(const uint8_t* buffer, size_t size) {
+    tx_.append(reinterpret_cast<const char*>(buffer), size);
+    return size;
+}
+
+int WiFiUDP::parsePacket() {
+    rx_.clear();
+    rx_pos_ = 0;
+    if (fd_ < 0) {
+        return 0;
+    }
+
+    char buffer[kMaxDatagram];
+    sockaddr_in address{};
+    socklen_t length = sizeof(address);
+    ssize_t received = recvfrom(fd_, buffer, sizeof(buffer), MSG_DONTWAIT, reinterpret_cast<sockaddr*>(&address), &length);
+    if (received <= 0) {
+        return 0;
+    }
+
+    rx_.assign(buffer, static_cast<size_t>(received));
+    remote_ip_ = IPAddress(static_cast<uint32_t>(address.sin_addr.s_addr));
+    remote_port_ = ntohs(address.sin_port);
+    return static_cast<int>(received);
+}
+
+int WiFiUDP::available() {
+    return static_cast<int>(rx_.size() - rx_pos_);
+}
+
+int WiFiUDP::read() {
+    if (rx_pos_ >= rx_.size()) {
+        return -1;
+    }
+    return static_cast<uint8_t>(rx_[rx_pos_++]);
+}
+
+int WiFiUDP::read(uint8_t* buffer, size_t length) {
+    size_t count = std::min(length, rx_.size() - rx_pos_);
+    std::memcpy(buffer, rx_.data() + rx_pos_, count);
+    rx_pos_ += count;
+    return static_cast<int>(count);
+}
+
+int WiFiUDP::peek() {
+    if (rx_pos_ >= rx_.size()) {
+        return -1;
+    }
+    return static_cast<uint8_t>(rx_[rx_pos_]);
+}
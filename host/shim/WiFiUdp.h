@@ -0,0 +1,44 @@
+#pragma once
+
+// Non-blocking UDP socket with the WiFiUDP packet API.
+
+#include <string>
+
+#include "Arduino.h"
+#include "IPAddress.h"
+
+class WiFiUDP : public Stream {
+public:
+    WiFiUDP() = default;
+    ~WiFiUDP() override;
+
+    uint8_t begin(uint16_t port);
+    void stop();
+
+    int beginPacket(IPAddress ip, uint16_t port);
+    int endPacket();
+    size_t write(uint8_t value) override;
+    size_t write(const uint8_t* buffer, size_t size) override;
+    using Print::write;
+
+    int parsePacket();
+    int available() override;
+    int read() override;
+    int read(uint8_t* buffer, size_t length);
+    int read(char* buffer, size_t length) { return read(reinterpret_cast<uint8_t*>(buffer), length); }
+    int peek() override;
+    void flush() override {}
+
+    IPAddress remoteIP() const { return remote_ip_; }
+    uint16_t remotePort() const { return remote_port_; }
+
+private:
+    int fd_ = -1;
+    IPAddress tx_ip_;
+    uint16_t tx_port_ = 0;
+    std::string tx_;
+    std::string rx_;
+    size_t rx_pos_ = 0;
+    IPAddress remote_ip_;
+    uint16_t remote_port_ = 0;
+};
@@ -0,0 +1,139 @@
+#include "host_event_loop.h"
+
+#include <sys/epoll.h>
+#include <unistd.h>
+
+#include <cstdio>
+#include <map>
+#include <vector>
+
+#include "Arduino.h"
+
+struct HostWatch {
+    int fd;
+    bool alive;
+    HostEventHandler handler;
+};
+
+namespace {
+constexpr int kMaxEvents = 64;
+constexpr unsigned long kTickIntervalMs = 100;
+
+int epoll_fd = -1;
+std::vector<HostWatch*> retired_watches;
+std::map<uint32_t, HostTicker> tickers;
+uint32_t next_ticker_id = 1;
+unsigned long last_tick_ms = 0;
+int poll_depth = 0;
+
+int EpollFd() {
+    if (epoll_fd < 0) {
+        epoll_fd = epoll_create1(EPOLL_CLOEXEC);
+        if (epoll_fd < 0) {
+            std::perror("epoll_create1");
+            std::abort();
+        }
+    }
+    return epoll_fd;
+}
+
+void ReleaseRetired() {
+    // Watches retired mid-batch may still be referenced by pending events
+    if (poll_depth > 0) {
+        return;
+    }
+    for (HostWatch* watch : retired_watches) {
+        delete watch;
+    }
+    retired_watches.clear();
+}
+
+void RunTickers() {
+    unsigned long now = millis();
+    if (now - last_tick_ms < kTickIntervalMs) {
+        return;
+    }
+    last_tick_ms = now;
+
+    std::vector<uint32_t> ids;
+    ids.reserve(tickers.size());
+    for (const auto& entry : tickers) {
+        ids.push_back(entry.first);
+    }
+    for (uint32_t id : ids) {
+        auto it = tickers.find(id);
+        if (it != tickers.end()) {
+            HostTicker ticker = it->second;
+            ticker();
+        }
+    }
+}
+}
+
+HostWatch* HostWatchFd(int fd, uint32_t events, HostEventHandler handler) {
+    HostWatch* watch = new HostWatch{fd, true, std::move(handler)};
+
+    epoll_event event{};
+    event.events = events;
+    event.data.ptr = watch;
+    if (epoll_ctl(EpollFd(), EPOLL_CTL_ADD, fd, &event) != 0) {
+        std::perror("epoll_ctl(ADD)");
+        delete watch;
+        return nullptr;
+    }
+    return watch;
+}
+
+void HostModifyWatch(HostWatch* watch, uint32_t events) {
+    if (!watch || !watch->alive) {
+        return;
+    }
+
+    epoll_event event{};
+    event.events = events;
+    event.data.ptr = watch;
+    epoll_ctl(EpollFd(), EPOLL_CTL_MOD, watch->fd, &event);
+}
+
+void HostUnwatch(HostWatch* watch) {
+    if (!watch || !watch->alive) {
+        return;
+    }
+
+    epoll_ctl(EpollFd(), EPOLL_CTL_DEL, watch->fd, nullptr);
+    watch->alive = false;
+    watch->handler = nullptr;
+    retired_watches.push_back(watch);
+}
+
+uint32_t HostAddTicker(HostTicker ticker) {
+    uint32_t id = next_ticker_id++;
+    tickers[id] = std::move(ticker);
+    return id;
+}
+
+void HostRemoveTicker(uint32_t id) {
+    tickers.erase(id);
+}
+
+void HostPollEvents(int timeout_ms) {
+    if (timeout_ms > static_cast<int>(kTickIntervalMs)) {
+        timeout_ms = kTickIntervalMs;
+    }
+
+    epoll_event events[kMaxEvents];
+    int count = epoll_wait(EpollFd(), events, kMaxEvents, timeout_ms);
+
+    poll_depth++;
+    for (int i = 0; i < count; ++i) {
+        HostWatch* watch = static_cast<HostWatch*>(events[i].data.ptr);
+        if (watch->alive && watch->handler) {
+            HostEventHandler handler = watch->handler;
+            handler(events[i].events);
+        }
+    }
+    RunTickers();
+    poll_depth--;
+
+    ReleaseRetired();
+}
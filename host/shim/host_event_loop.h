@@ -0,0 +1,22 @@
+#pragma once
+
+// Single-threaded epoll reactor behind the host AsyncTCP/WiFiClient shims.
+// It is pumped from delay()/yield(), mirroring where the ESP cores let the
+// network stack run.
+
+#include <cstdint>
+#include <functional>
+
+struct HostWatch;
+
+using HostEventHandler = std::function<void(uint32_t events)>;
+using HostTicker = std::function<void()>;
+
+HostWatch* HostWatchFd(int fd, uint32_t events, HostEventHandler handler);
+void HostModifyWatch(HostWatch* watch, uint32_t events);
+void HostUnwatch(HostWatch* watch);
+
+uint32_t HostAddTicker(HostTicker ticker);
+void HostRemoveTicker(uint32_t id);
+
+void HostPollEvents(int timeout_ms);
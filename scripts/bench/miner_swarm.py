@@ -0,0 +1,398 @@
+#!/usr/bin/env python3
+"""Simulate a swarm of Stratum V1 miners against a YUMA device or host build.
+
+Each miner connects, subscribes, authorizes and submits shares at a fixed
+rate. Miners follow client.reconnect the way real firmware does, and the
+results count where each one ended up. With --header-jobs they ask for
+mining.notify_header work instead and, given mock_pool.py's --jobs-file,
+check every header against one rebuilt here from the pool's job. Results
+are printed and optionally written as JSON for regression tracking. Notify latency needs mock_pool.py job ids and the pool running on
+the same host as the swarm.
+"""
+from __future__ import annotations
+
+import argparse
+import asyncio
+import hashlib
+import json
+import os
+import random
+import sys
+import time
+from dataclasses import dataclass, field
+
+sys.path.insert(0, os.path.dirname(os.path.abspath(__file__)))
+from mock_pool import job_sent_at  # noqa: E402
+
+
+@dataclass
+class SwarmStats:
+    attempted: int = 0
+    established: int = 0
+    subscribed: int = 0
+    failed: int = 0
+    dropped: int = 0
+    notifies: int = 0
+    submitted: int = 0
+    accepted: int = 0
+    rejected: int = 0
+    stale: int = 0
+    extranonce_updates: int = 0
+    redirects: int = 0
+    final_targets: dict[str, int] = field(default_factory=dict)
+    notify_latency_ms: list[float] = field(default_factory=list)
+    ack_latency_ms: list[float] = field(default_factory=list)
+    authorize_latency_ms: list[float] = field(default_factory=list)
+    first_job_ms: list[float] = field(default_factory=list)
+    version_rolling: int = 0
+    header_jobs: int = 0
+    headers_checked: int = 0
+    header_mismatches: int = 0
+
+
+def percentile(samples: list[float], pct: float) -> float | None:
+    if not samples:
+        return None
+    ordered = sorted(samples)
+    index = min(len(ordered) - 1, max(0, round(pct / 100 * (len(ordered) - 1))))
+    return round(ordered[index], 3)
+
+
+def sha256d(data: bytes) -> bytes:
+    return hashlib.sha256(hashlib.sha256(data).digest()).digest()
+
+
+class PoolJobs:
+    """Notify params mock_pool.py appended to its --jobs-file, by job id."""
+
+    def __init__(self, path: str | None) -> None:
+        self.path = path
+        self.jobs: dict[str, list] = {}
+
+    def get(self, job_id: str) -> list | None:
+        if job_id not in self.jobs and self.path and os.path.exists(self.path):
+            with open(self.path, encoding="utf-8") as handle:
+                for line in handle:
+                    params = json.loads(line)
+                    self.jobs[params[0]] = params
+        return self.jobs.get(job_id)
+
+
+def build_header(params: list, extranonce1: str, extranonce2: str) -> str:
+    """The 80-byte header (nonce zero) a miner would build from a mining.notify."""
+    root = sha256d(bytes.fromhex(params[2] + extranonce1 + extranonce2 + params[3]))
+    for branch in params[4]:
+        root = sha256d(root + bytes.fromhex(branch))
+    prevhash = bytes.fromhex(params[1])
+    prevhash = b"".join(prevhash[i:i + 4][::-1] for i in range(0, 32, 4))
+    return (bytes.fromhex(params[5])[::-1] + prevhash + root + bytes.fromhex(params[7])[::-1]
+            + bytes.fromhex(params[6])[::-1] + bytes(4)).hex()
+
+
+def summarize(samples: list[float]) -> dict:
+    return {
+        "count": len(samples),
+        "p50": percentile(samples, 50),
+        "p99": percentile(samples, 99),
+        "max": round(max(samples), 3) if samples else None,
+    }
+
+
+class Miner:
+    def __init__(self, index: int, args: argparse.Namespace, stats: SwarmStats, pool_jobs: PoolJobs) -> None:
+        self.index = index
+        self.args = args
+        self.stats = stats
+        self.pool_jobs = pool_jobs
+        self.next_id = 1
+        self.pending: dict[int, tuple[str, float]] = {}
+        self.job_id: str | None = None
+        self.retired_job_id: str | None = None
+        self.extranonce1 = ""
+        self.extranonce2_size = 4
+        # Fixed by the proxy for header jobs
+        self.header_extranonce2: str | None = None
+        self.header_ntime: str | None = None
+        self.subscribed = False
+        self.writer: asyncio.StreamWriter | None = None
+        self.redirect_to: tuple[str, int] | None = None
+        self.established = False
+        self.connected_at = 0.0
+
+    def send(self, method: str, params: list) -> int:
+        request_id = self.next_id
+        self.next_id += 1
+        line = json.dumps({"id": request_id, "method": method, "params": params}, separators=(",", ":"))
+        self.writer.write((line + "\n").encode())
+        self.pending[request_id] = (method, time.perf_counter())
+        return request_id
+
+    def mark_subscribed(self) -> None:
+        if not self.subscribed:
+            self.subscribed = True
+            self.stats.subscribed += 1
+
+    def start_job(self, job_id: str, clean_jobs: bool) -> None:
+        received = time.time()
+        self.stats.notifies += 1
+        if clean_jobs:
+            self.retired_job_id = self.job_id
+        if self.job_id is None:
+            self.stats.first_job_ms.append((time.perf_counter() - self.connected_at) * 1000)
+        self.job_id = job_id
+        self.mark_subscribed()
+        sent = job_sent_at(self.job_id)
+        if sent is not None:
+            self.stats.notify_latency_ms.append((received - sent) * 1000)
+
+    def check_header(self, params: list) -> None:
+        job = self.pool_jobs.get(params[0])
+        if job is None:
+            return
+        self.stats.headers_checked += 1
+        if params[3] != job[7] or params[1] != build_header(job, self.extranonce1, params[2]):
+            self.stats.header_mismatches += 1
+
+    def handle_line(self, line: bytes) -> None:
+        try:
+            message = json.loads(line)
+        except json.JSONDecodeError:
+            return
+
+        method = message.get("method")
+        if method == "mining.notify":
+            self.header_extranonce2 = None
+            self.start_job(message["params"][0], message["params"][8])
+            return
+        if method == "mining.notify_header":
+            params = message["params"]
+            self.stats.header_jobs += 1
+            self.header_extranonce2 = params[2]
+            self.header_ntime = params[3]
+            self.start_job(params[0], params[4])
+            self.check_header(params)
+            return
+        if method == "mining.set_extranonce":
+            self.extranonce1 = message["params"][0]
+            self.extranonce2_size = message["params"][1]
+            self.stats.extranonce_updates += 1
+            return
+        if method == "client.reconnect":
+            params = message.get("params") or []
+            if len(params) >= 2:
+                self.redirect_to = (params[0] or self.args.host, int(params[1]))
+                self.stats.redirects += 1
+            return
+        if method is not None:
+            return
+
+        request_id = message.get("id")
+        if request_id not in self.pending:
+            return
+        request_method, started = self.pending.pop(request_id)
+        if request_method == "mining.subscribe":
+            result = message.get("result")
+            if isinstance(result, list) and len(result) > 2:
+                self.extranonce1 = result[1]
+                self.extranonce2_size = result[2]
+            self.mark_subscribed()
+        elif request_method == "mining.authorize":
+            self.stats.authorize_latency_ms.append((time.perf_counter() - started) * 1000)
+        elif request_method == "mining.configure":
+            if (message.get("result") or {}).get("version-rolling"):
+                self.stats.version_rolling += 1
+        elif request_method == "mining.submit":
+            self.stats.ack_latency_ms.append((time.perf_counter() - started) * 1000)
+            if message.get("result") is True:
+                self.stats.accepted += 1
+            elif (message.get("error") or [None])[0] == 21:
+                self.stats.stale += 1
+            else:
+                self.stats.rejected += 1
+
+    async def reader_loop(self, reader: asyncio.StreamReader) -> None:
+        try:
+            while line := await reader.readline():
+                self.handle_line(line)
+        except ConnectionError:
+            pass
+
+    async def submit_loop(self, deadline: float) -> None:
+        if self.args.submit_rate <= 0:
+            return
+        interval = 1.0 / self.args.submit_rate
+        nonce = self.index << 20
+        rng = random.Random(self.index)
+        while time.monotonic() < deadline:
+            await asyncio.sleep(interval)
+            if self.job_id is None:
+                continue
+            job_id = self.job_id
+            # A slow miner still finishing work from before the last clean_jobs
+            if self.retired_job_id and rng.random() < self.args.stale_ratio:
+                job_id = self.retired_job_id
+            nonce += 1
+            extranonce2 = (nonce & ((1 << (8 * self.extranonce2_size)) - 1)).to_bytes(self.extranonce2_size, "big").hex()
+            ntime = f"{int(time.time()):08x}"
+            if self.header_extranonce2 is not None:
+                extranonce2, ntime = self.header_extranonce2, self.header_ntime
+            self.send("mining.submit", [self.args.user, job_id, extranonce2, ntime, f"{nonce:08x}"])
+            self.stats.submitted += 1
+            try:
+                await self.writer.drain()
+            except ConnectionError:
+                return
+
+    async def session(self, host: str, port: int, deadline: float) -> bool:
+        """One connection; True when it ended in a client.reconnect to follow."""
+        try:
+            reader, self.writer = await asyncio.wait_for(
+                asyncio.open_connection(host, port), self.args.connect_timeout)
+        except (OSError, asyncio.TimeoutError):
+            self.stats.failed += 1
+            return False
+
+        if not self.established:
+            self.established = True
+            self.stats.established += 1
+        self.pending.clear()
+        self.job_id = None
+        self.retired_job_id = None
+        self.header_extranonce2 = None
+        self.connected_at = time.perf_counter()
+        if self.args.configure:
+            self.send("mining.configure", [["version-rolling"], {"version-rolling.mask": "1fffe000"}])
+        self.send("mining.subscribe", [f"yuma-swarm/{self.index}"])
+        if not self.args.fixed_extranonce:
+            self.send("mining.extranonce.subscribe", [])
+        self.send("mining.authorize", [self.args.user, self.args.password])
+        if self.args.header_jobs:
+            self.send("mining.header_subscribe", [])
+        try:
+            await self.writer.drain()
+        except ConnectionError:
+            pass  # turned away at the door; a client.reconnect may still be waiting
+
+        reader_task = asyncio.create_task(self.reader_loop(reader))
+        submit_task = asyncio.create_task(self.submit_loop(deadline))
+        done, _ = await asyncio.wait({reader_task}, timeout=max(0.0, deadline - time.monotonic()))
+        redirected = reader_task in done and self.redirect_to is not None
+        if reader_task in done and not redirected:
+            self.stats.dropped += 1
+
+        submit_task.cancel()
+        reader_task.cancel()
+        await asyncio.gather(submit_task, reader_task, return_exceptions=True)
+        self.writer.close()
+        if not redirected:
+            target = f"{host}:{port}"
+            self.stats.final_targets[target] = self.stats.final_targets.get(target, 0) + 1
+        return redirected
+
+    async def run(self, deadline: float) -> None:
+        self.stats.attempted += 1
+        host, port = self.args.host, self.args.port
+        while await self.session(host, port, deadline) and time.monotonic() < deadline:
+            host, port = self.redirect_to
+            self.redirect_to = None
+
+
+async def run(args: argparse.Namespace) -> dict:
+    stats = SwarmStats()
+    pool_jobs = PoolJobs(args.jobs_file)
+    started = time.monotonic()
+    deadline = started + args.ramp_s + args.duration
+    tasks = []
+    for index in range(args.miners):
+        tasks.append(asyncio.create_task(Miner(index, args, stats, pool_jobs).run(deadline)))
+        if args.ramp_s > 0 and args.miners > 1:
+            await asyncio.sleep(args.ramp_s / (args.miners - 1))
+    await asyncio.gather(*tasks, return_exceptions=True)
+    elapsed = time.monotonic() - started
+
+    return {
+        "target": f"{args.host}:{args.port}",
+        "label": args.label,
+        "timestamp": int(time.time()),
+        "config": {
+            "miners": args.miners,
+            "duration_s": args.duration,
+            "ramp_s": args.ramp_s,
+            "submit_rate": args.submit_rate,
+        },
+        "connections": {
+            "attempted": stats.attempted,
+            "established": stats.established,
+            "subscribed": stats.subscribed,
+            "failed": stats.failed,
+            "dropped": stats.dropped,
+        },
+        "notify": {
+            "received": stats.notifies,
+            "per_sec": round(stats.notifies / elapsed, 3),
+            "latency_ms": summarize(stats.notify_latency_ms),
+        },
+        "shares": {
+            "submitted": stats.submitted,
+            "accepted": stats.accepted,
+            "rejected": stats.rejected,
+            "stale": stats.stale,
+            "unanswered": stats.submitted - stats.accepted - stats.rejected - stats.stale,
+            "per_sec": round((stats.accepted + stats.rejected + stats.stale) / elapsed, 3),
+            "ack_latency_ms": summarize(stats.ack_latency_ms),
+        },
+        "handshake": {
+            "authorize_latency_ms": summarize(stats.authorize_latency_ms),
+            "first_job_ms": summarize(stats.first_job_ms),
+            "version_rolling": stats.version_rolling,
+        },
+        "header_jobs": {
+            "received": stats.header_jobs,
+            "checked": stats.headers_checked,
+            "mismatches": stats.header_mismatches,
+        },
+        "extranonce_updates": stats.extranonce_updates,
+        "redirects": stats.redirects,
+        "final_targets": stats.final_targets,
+        "elapsed_s": round(elapsed, 3),
+    }
+
+
+def parse_args(argv: list[str]) -> argparse.Namespace:
+    parser = argparse.ArgumentParser(description="Stratum V1 miner swarm benchmark")
+    parser.add_argument("--host", default="127.0.0.1", help="Proxy address (device IP or host build)")
+    parser.add_argument("--port", type=int, default=4444, help="Proxy stratum port")
+    parser.add_argument("--miners", type=int, default=10, help="Number of concurrent miner connections")
+    parser.add_argument("--duration", type=float, default=30.0, help="Seconds to run after the ramp")
+    parser.add_argument("--ramp-s", type=float, default=0.0, help="Spread connection setup over this many seconds")
+    parser.add_argument("--submit-rate", type=float, default=0.2, help="Shares per second per miner")
+    parser.add_argument("--stale-ratio", type=float, default=0.0,
+                        help="Fraction of shares sent for the job retired by the last clean_jobs")
+    parser.add_argument("--connect-timeout", type=float, default=5.0, help="TCP connect timeout in seconds")
+    parser.add_argument("--user", default="bench.worker", help="Worker name to authorize")
+    parser.add_argument("--password", default="x", help="Worker password")
+    parser.add_argument("--configure", action="store_true", help="Ask for version rolling before subscribing")
+    parser.add_argument("--fixed-extranonce", action="store_true",
+                        help="Skip mining.extranonce.subscribe, like firmware that cannot take a new extranonce")
+    parser.add_argument("--header-jobs", action="store_true", help="Ask for ready-made headers (mining.header_subscribe)")
+    parser.add_argument("--jobs-file", help="mock_pool.py --jobs-file, to check header jobs against")
+    parser.add_argument("--label", default="", help="Free-form label stored in the results")
+    parser.add_argument("--output", help="Write results as JSON to this path")
+    return parser.parse_args(argv)
+
+
+def main(argv: list[str]) -> int:
+    args = parse_args(argv)
+    results = asyncio.run(run(args))
+
+    text = json.dumps(results, indent=2)
+    print(text)
+    if args.output:
+        with open(args.output, "w", encoding="utf-8") as handle:
+            handle.write(text + "\n")
+
+    return 0 if results["connections"]["failed"] == 0 and results["header_jobs"]["mismatches"] == 0 else 1
+
+
+if __name__ == "__main__":
+    sys.exit(main(sys.argv[1:]))
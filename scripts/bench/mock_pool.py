@@ -0,0 +1,316 @@
+#!/usr/bin/env python3
+"""Scriptable Stratum V1 pool for exercising the proxy without a real upstream.
+
+Job ids carry the wall-clock send time (``<counter>-<microseconds hex>``) so
+miner_swarm.py can measure notify fan-out latency when it runs on the same
+host as the pool.
+"""
+from __future__ import annotations
+
+import argparse
+import asyncio
+import json
+import os
+import random
+import signal
+import ssl
+import sys
+import time
+from dataclasses import dataclass, field
+
+EXTRANONCE2_SIZE = 4
+# Jobs a connection may still submit against between clean notifies
+MAX_LIVE_JOBS = 16
+COINBASE1 = "01000000010000000000000000000000000000000000000000000000000000000000000000ffffffff"
+COINBASE2 = "ffffffff0100f2052a010000001976a914000000000000000000000000000000000000000088ac00000000"
+
+
+@dataclass
+class PoolStats:
+    connections: int = 0
+    notifies_sent: int = 0
+    shares_accepted: int = 0
+    shares_rejected: int = 0
+    shares_stale: int = 0
+    extranonce_rotations: int = 0
+    sessions_resumed: int = 0
+    bytes_in: int = 0
+    bytes_out: int = 0
+    started: float = field(default_factory=time.time)
+
+    def as_dict(self) -> dict:
+        return {
+            "protocol": "sv1",
+            "connections": self.connections,
+            "notifies_sent": self.notifies_sent,
+            "shares_accepted": self.shares_accepted,
+            "shares_rejected": self.shares_rejected,
+            "shares_stale": self.shares_stale,
+            "extranonce_rotations": self.extranonce_rotations,
+            "sessions_resumed": self.sessions_resumed,
+            "bytes_in": self.bytes_in,
+            "bytes_out": self.bytes_out,
+            "uptime_s": round(time.time() - self.started, 3),
+        }
+
+
+def encode_job_id(counter: int) -> str:
+    return f"{counter:x}-{time.time_ns() // 1000:x}"
+
+
+def job_sent_at(job_id: str) -> float | None:
+    """Return the send time embedded by encode_job_id, in seconds."""
+    _, sep, stamp = job_id.partition("-")
+    if not sep:
+        return None
+    try:
+        return int(stamp, 16) / 1_000_000
+    except ValueError:
+        return None
+
+
+class MockPool:
+    def __init__(self, args: argparse.Namespace) -> None:
+        self.args = args
+        self.writers: set[asyncio.StreamWriter] = set()
+        self.extranonce_watchers: set[asyncio.StreamWriter] = set()
+        self.live_jobs: dict[asyncio.StreamWriter, list[str]] = {}
+        self.issued_extranonce1: set[str] = set()
+        self.active_extranonce1: dict[asyncio.StreamWriter, str] = {}
+        # Live jobs of closed sessions, restored when the session is resumed
+        self.parked_jobs: dict[str, list[str]] = {}
+        self.job_counter = 0
+        self.next_extranonce1 = 1
+        self.difficulty = args.difficulty
+        self.stats = PoolStats()
+        self.rng = random.Random(args.seed)
+
+    async def inject_latency(self) -> None:
+        delay_ms = self.args.latency_ms
+        if self.args.jitter_ms > 0:
+            delay_ms += self.rng.uniform(0, self.args.jitter_ms)
+        if delay_ms > 0:
+            await asyncio.sleep(delay_ms / 1000)
+
+    def make_notify(self, clean_jobs: bool) -> dict:
+        self.job_counter += 1
+        branches = [os.urandom(32).hex() for _ in range(self.args.merkle_branches)]
+        notify = {
+            "id": None,
+            "method": "mining.notify",
+            "params": [
+                encode_job_id(self.job_counter),
+                os.urandom(32).hex(),
+                COINBASE1,
+                COINBASE2 + "00" * self.args.coinbase_padding,
+                branches,
+                "20000000",
+                "1d00ffff",
+                f"{int(time.time()):08x}",
+                clean_jobs,
+            ],
+        }
+        if self.args.jobs_file:
+            with open(self.args.jobs_file, "a", encoding="utf-8") as handle:
+                handle.write(json.dumps(notify["params"], separators=(",", ":")) + "\n")
+        return notify
+
+    def send(self, writer: asyncio.StreamWriter, message: dict) -> None:
+        data = (json.dumps(message, separators=(",", ":")) + "\n").encode()
+        self.stats.bytes_out += len(data)
+        writer.write(data)
+
+    def send_notify(self, writer: asyncio.StreamWriter, notify: dict) -> None:
+        params = notify["params"]
+        jobs = self.live_jobs.setdefault(writer, [])
+        if params[8]:
+            jobs.clear()
+        jobs.append(params[0])
+        del jobs[:-MAX_LIVE_JOBS]
+        self.send(writer, notify)
+
+    def broadcast(self, message: dict) -> None:
+        for writer in list(self.writers):
+            if not writer.is_closing():
+                if message.get("method") == "mining.notify":
+                    self.send_notify(writer, message)
+                else:
+                    self.send(writer, message)
+
+    async def handle(self, reader: asyncio.StreamReader, writer: asyncio.StreamWriter) -> None:
+        peer = writer.get_extra_info("peername")
+        self.stats.connections += 1
+        if not self.args.quiet:
+            print(f"client connected: {peer}", flush=True)
+        self.writers.add(writer)
+        try:
+            while line := await reader.readline():
+                self.stats.bytes_in += len(line)
+                try:
+                    request = json.loads(line)
+                except json.JSONDecodeError:
+                    continue
+                await self.inject_latency()
+                self.respond(writer, request)
+                await writer.drain()
+        except ConnectionError:
+            pass
+        finally:
+            self.writers.discard(writer)
+            self.extranonce_watchers.discard(writer)
+            jobs = self.live_jobs.pop(writer, [])
+            extranonce1 = self.active_extranonce1.pop(writer, None)
+            if extranonce1:
+                self.parked_jobs[extranonce1] = jobs
+            writer.close()
+            if not self.args.quiet:
+                print(f"client disconnected: {peer}", flush=True)
+
+    def new_extranonce1(self) -> str:
+        extranonce1 = f"{self.next_extranonce1:08x}"
+        self.next_extranonce1 += 1
+        self.issued_extranonce1.add(extranonce1)
+        return extranonce1
+
+    def respond(self, writer: asyncio.StreamWriter, request: dict) -> None:
+        method = request.get("method")
+        request_id = request.get("id")
+        params = request.get("params") or []
+
+        if method == "mining.subscribe":
+            # A session id from an earlier subscribe resumes that extranonce1
+            resume = params[1] if len(params) > 1 else None
+            if resume in self.issued_extranonce1 and resume not in self.active_extranonce1.values():
+                extranonce1 = resume
+                self.live_jobs[writer] = self.parked_jobs.pop(resume, [])
+                self.stats.sessions_resumed += 1
+            else:
+                extranonce1 = self.new_extranonce1()
+            self.active_extranonce1[writer] = extranonce1
+            result = [[["mining.notify", extranonce1]], extranonce1, EXTRANONCE2_SIZE]
+            self.send(writer, {"id": request_id, "result": result, "error": None})
+        elif method == "mining.configure":
+            extensions = params[0] if params and isinstance(params[0], list) else []
+            mask = int(self.args.version_mask, 16)
+            result = {}
+            if "version-rolling" in extensions:
+                requested = int((params[1] if len(params) > 1 else {}).get("version-rolling.mask", "ffffffff"), 16)
+                result["version-rolling"] = (mask & requested) != 0
+                if result["version-rolling"]:
+                    result["version-rolling.mask"] = f"{mask & requested:08x}"
+            self.send(writer, {"id": request_id, "result": result, "error": None})
+        elif method == "mining.extranonce.subscribe":
+            self.extranonce_watchers.add(writer)
+            self.send(writer, {"id": request_id, "result": True, "error": None})
+        elif method == "mining.authorize":
+            self.send(writer, {"id": request_id, "result": True, "error": None})
+            self.send(writer, {"id": None, "method": "mining.set_difficulty", "params": [self.difficulty]})
+            # A resumed session keeps its jobs, so the new one does not clean them
+            self.send_notify(writer, self.make_notify(not self.live_jobs.get(writer)))
+            self.stats.notifies_sent += 1
+        elif method == "mining.submit":
+            if len(params) < 5 or len(str(params[2])) != EXTRANONCE2_SIZE * 2:
+                self.stats.shares_rejected += 1
+                self.send(writer, {"id": request_id, "result": None, "error": [20, "Invalid extranonce2 size", None]})
+            elif params[1] not in self.live_jobs.get(writer, []):
+                self.stats.shares_stale += 1
+                self.send(writer, {"id": request_id, "result": None, "error": [21, "Job not found", None]})
+            elif self.rng.random() < self.args.reject_ratio:
+                self.stats.shares_rejected += 1
+                self.send(writer, {"id": request_id, "result": None, "error": [23, "Low difficulty share", None]})
+            else:
+                self.stats.shares_accepted += 1
+                self.send(writer, {"id": request_id, "result": True, "error": None})
+        else:
+            self.send(writer, {"id": request_id, "result": None, "error": [20, "Unsupported method", None]})
+
+    async def notify_loop(self) -> None:
+        if self.args.notify_interval <= 0:
+            return
+        sent = 0
+        while True:
+            await asyncio.sleep(self.args.notify_interval)
+            await self.inject_latency()
+            sent += 1
+            clean = self.args.clean_every > 0 and sent % self.args.clean_every == 0
+            self.broadcast(self.make_notify(clean))
+            self.stats.notifies_sent += len(self.writers)
+
+    async def extranonce_loop(self) -> None:
+        if self.args.extranonce_interval <= 0:
+            return
+        while True:
+            await asyncio.sleep(self.args.extranonce_interval)
+            for writer in list(self.extranonce_watchers):
+                if not writer.is_closing():
+                    self.active_extranonce1[writer] = self.new_extranonce1()
+                    self.send(writer, {"id": None, "method": "mining.set_extranonce",
+                                       "params": [self.active_extranonce1[writer], EXTRANONCE2_SIZE]})
+                    self.stats.extranonce_rotations += 1
+
+    async def difficulty_loop(self) -> None:
+        if self.args.difficulty_interval <= 0:
+            return
+        while True:
+            await asyncio.sleep(self.args.difficulty_interval)
+            self.difficulty = self.args.difficulty if self.difficulty != self.args.difficulty else self.args.difficulty * 2
+            self.broadcast({"id": None, "method": "mining.set_difficulty", "params": [self.difficulty]})
+
+
+async def run(args: argparse.Namespace) -> None:
+    pool = MockPool(args)
+    tls = None
+    if args.tls_cert:
+        tls = ssl.SSLContext(ssl.PROTOCOL_TLS_SERVER)
+        tls.load_cert_chain(args.tls_cert, args.tls_key)
+    server = await asyncio.start_server(pool.handle, args.host, args.port, ssl=tls)
+    print(f"mock pool listening on {args.host}:{args.port}", flush=True)
+
+    tasks = asyncio.gather(server.serve_forever(), pool.notify_loop(), pool.difficulty_loop(), pool.extranonce_loop())
+    loop = asyncio.get_running_loop()
+    for signum in (signal.SIGINT, signal.SIGTERM):
+        loop.add_signal_handler(signum, tasks.cancel)
+
+    try:
+        await tasks
+    except asyncio.CancelledError:
+        pass
+    finally:
+        server.close()
+        if args.stats_file:
+            with open(args.stats_file, "w", encoding="utf-8") as handle:
+                json.dump(pool.stats.as_dict(), handle, indent=2)
+
+
+def parse_args(argv: list[str]) -> argparse.Namespace:
+    parser = argparse.ArgumentParser(description="Scriptable Stratum V1 mock pool")
+    parser.add_argument("--host", default="127.0.0.1", help="Address to listen on")
+    parser.add_argument("--port", type=int, default=3333, help="Port to listen on")
+    parser.add_argument("--notify-interval", type=float, default=30.0, help="Seconds between mining.notify (0 disables)")
+    parser.add_argument("--clean-every", type=int, default=0, help="Set clean_jobs on every Nth notify (0 never)")
+    parser.add_argument("--difficulty", type=float, default=1024.0, help="Difficulty sent after authorize")
+    parser.add_argument("--difficulty-interval", type=float, default=0.0, help="Seconds between difficulty changes (0 disables)")
+    parser.add_argument("--extranonce-interval", type=float, default=0.0,
+                        help="Seconds between mining.set_extranonce to subscribed clients (0 disables)")
+    parser.add_argument("--version-mask", default="1fffe000", help="Version bits granted to mining.configure (0 refuses)")
+    parser.add_argument("--reject-ratio", type=float, default=0.0, help="Fraction of shares to reject")
+    parser.add_argument("--latency-ms", type=float, default=0.0, help="Delay added before every reply and notify")
+    parser.add_argument("--jitter-ms", type=float, default=0.0, help="Random extra delay up to this value")
+    parser.add_argument("--merkle-branches", type=int, default=0, help="Merkle branches per job")
+    parser.add_argument("--coinbase-padding", type=int, default=0, help="Extra bytes appended to coinbase2")
+    parser.add_argument("--seed", type=int, default=None, help="Random seed for reject/jitter decisions")
+    parser.add_argument("--stats-file", help="Write pool-side counters as JSON on exit")
+    parser.add_argument("--jobs-file", help="Append every job's notify params as a JSON line (for --header-jobs checks)")
+    parser.add_argument("--tls-cert", help="Serve stratum+ssl with this PEM certificate")
+    parser.add_argument("--tls-key", help="Private key for --tls-cert")
+    parser.add_argument("--quiet", action="store_true", help="Do not log connections")
+    return parser.parse_args(argv)
+
+
+def main(argv: list[str]) -> int:
+    asyncio.run(run(parse_args(argv)))
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main(sys.argv[1:]))
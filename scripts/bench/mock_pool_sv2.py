@@ -0,0 +1,260 @@
+#!/usr/bin/env python3
+"""Plaintext Stratum V2 mock pool (one extended channel per connection).
+
+Speaks the SV2 framing without the Noise handshake, matching the proxy's
+plaintext SV2 upstream. Accepts the same workload knobs as mock_pool.py
+where they apply.
+"""
+from __future__ import annotations
+
+import argparse
+import asyncio
+import json
+import os
+import random
+import signal
+import struct
+import sys
+import time
+from dataclasses import dataclass, field
+
+SETUP_CONNECTION = 0x00
+SETUP_CONNECTION_SUCCESS = 0x01
+OPEN_EXTENDED_MINING_CHANNEL = 0x13
+OPEN_EXTENDED_MINING_CHANNEL_SUCCESS = 0x14
+SUBMIT_SHARES_EXTENDED = 0x1B
+SUBMIT_SHARES_SUCCESS = 0x1C
+SUBMIT_SHARES_ERROR = 0x1D
+NEW_EXTENDED_MINING_JOB = 0x1F
+SET_NEW_PREV_HASH = 0x20
+SET_TARGET = 0x21
+CHANNEL_MSG = 0x8000
+
+COINBASE_PREFIX = bytes.fromhex("01000000010000000000000000000000000000000000000000000000000000000000000000ffffffff")
+COINBASE_SUFFIX = bytes.fromhex("ffffffff0100f2052a010000001976a914000000000000000000000000000000000000000088ac00000000")
+DIFF1 = 0xFFFF << 208
+
+
+@dataclass
+class PoolStats:
+    connections: int = 0
+    jobs_sent: int = 0
+    shares_accepted: int = 0
+    shares_rejected: int = 0
+    bytes_in: int = 0
+    bytes_out: int = 0
+    started: float = field(default_factory=time.time)
+
+    def as_dict(self) -> dict:
+        return {
+            "protocol": "sv2",
+            "connections": self.connections,
+            "jobs_sent": self.jobs_sent,
+            "shares_accepted": self.shares_accepted,
+            "shares_rejected": self.shares_rejected,
+            "bytes_in": self.bytes_in,
+            "bytes_out": self.bytes_out,
+            "uptime_s": round(time.time() - self.started, 3),
+        }
+
+
+def frame(msg_type: int, payload: bytes, channel_msg: bool = False) -> bytes:
+    header = struct.pack("<HB", CHANNEL_MSG if channel_msg else 0, msg_type)
+    return header + len(payload).to_bytes(3, "little") + payload
+
+
+def str0_255(value: str) -> bytes:
+    data = value.encode()[:255]
+    return bytes([len(data)]) + data
+
+
+def b0_32(data: bytes) -> bytes:
+    return bytes([len(data)]) + data
+
+
+def b0_64k(data: bytes) -> bytes:
+    return struct.pack("<H", len(data)) + data
+
+
+def target_for(difficulty: float) -> bytes:
+    return min(int(DIFF1 / difficulty), (1 << 256) - 1).to_bytes(32, "little")
+
+
+class Connection:
+    def __init__(self, pool: "MockPoolSv2", writer: asyncio.StreamWriter, channel_id: int) -> None:
+        self.pool = pool
+        self.writer = writer
+        self.channel_id = channel_id
+        self.open = False
+        self.pending_acks: list[int] = []
+
+    def send(self, msg_type: int, payload: bytes, channel_msg: bool = False) -> None:
+        data = frame(msg_type, payload, channel_msg)
+        self.pool.stats.bytes_out += len(data)
+        self.writer.write(data)
+
+    def send_job(self, job_id: int, future: bool) -> None:
+        args = self.pool.args
+        payload = struct.pack("<II", self.channel_id, job_id)
+        payload += b"\x00" if future else b"\x01" + struct.pack("<I", int(time.time()))
+        payload += struct.pack("<I", 0x20000000) + b"\x01"
+        branches = [os.urandom(32) for _ in range(args.merkle_branches)]
+        payload += bytes([len(branches)]) + b"".join(branches)
+        payload += b0_64k(COINBASE_PREFIX) + b0_64k(COINBASE_SUFFIX + b"\x00" * args.coinbase_padding)
+        self.send(NEW_EXTENDED_MINING_JOB, payload, True)
+        self.pool.stats.jobs_sent += 1
+
+    def send_prev_hash(self, job_id: int) -> None:
+        payload = struct.pack("<II", self.channel_id, job_id) + os.urandom(32)
+        payload += struct.pack("<II", int(time.time()), 0x1D00FFFF)
+        self.send(SET_NEW_PREV_HASH, payload, True)
+
+    def handle(self, msg_type: int, payload: bytes) -> None:
+        if msg_type == SETUP_CONNECTION:
+            self.send(SETUP_CONNECTION_SUCCESS, struct.pack("<HI", 2, 0))
+        elif msg_type == OPEN_EXTENDED_MINING_CHANNEL:
+            request_id = struct.unpack_from("<I", payload)[0]
+            extranonce_prefix = struct.pack(">I", self.channel_id)
+            body = struct.pack("<II", request_id, self.channel_id) + target_for(self.pool.difficulty)
+            body += struct.pack("<H", self.pool.args.extranonce_size) + b0_32(extranonce_prefix)
+            self.send(OPEN_EXTENDED_MINING_CHANNEL_SUCCESS, body)
+            self.open = True
+            job_id = self.pool.next_job_id()
+            self.send_job(job_id, True)
+            self.send_prev_hash(job_id)
+        elif msg_type == SUBMIT_SHARES_EXTENDED:
+            channel_id, sequence = struct.unpack_from("<II", payload)
+            if self.pool.rng.random() < self.pool.args.reject_ratio:
+                self.pool.stats.shares_rejected += 1
+                self.send(SUBMIT_SHARES_ERROR, struct.pack("<II", channel_id, sequence) + str0_255("difficulty-too-low"), True)
+                return
+            self.pool.stats.shares_accepted += 1
+            self.pending_acks.append(sequence)
+            if len(self.pending_acks) >= self.pool.args.ack_batch:
+                self.flush_acks()
+
+    def flush_acks(self) -> None:
+        if not self.pending_acks:
+            return
+        count = len(self.pending_acks)
+        last = self.pending_acks[-1]
+        self.pending_acks.clear()
+        self.send(SUBMIT_SHARES_SUCCESS, struct.pack("<IIIQ", self.channel_id, last, count, count), True)
+
+
+class MockPoolSv2:
+    def __init__(self, args: argparse.Namespace) -> None:
+        self.args = args
+        self.connections: set[Connection] = set()
+        self.stats = PoolStats()
+        self.rng = random.Random(args.seed)
+        self.difficulty = args.difficulty
+        self.job_counter = 0
+        self.channel_counter = 0
+
+    def next_job_id(self) -> int:
+        self.job_counter += 1
+        return self.job_counter
+
+    async def handle(self, reader: asyncio.StreamReader, writer: asyncio.StreamWriter) -> None:
+        self.stats.connections += 1
+        self.channel_counter += 1
+        connection = Connection(self, writer, self.channel_counter)
+        self.connections.add(connection)
+        try:
+            while True:
+                header = await reader.readexactly(6)
+                length = int.from_bytes(header[3:6], "little")
+                payload = await reader.readexactly(length)
+                self.stats.bytes_in += 6 + length
+                if self.args.latency_ms > 0:
+                    await asyncio.sleep(self.args.latency_ms / 1000)
+                connection.handle(header[2], payload)
+                await writer.drain()
+        except (asyncio.IncompleteReadError, ConnectionError):
+            pass
+        finally:
+            self.connections.discard(connection)
+            writer.close()
+
+    async def job_loop(self) -> None:
+        if self.args.notify_interval <= 0:
+            return
+        sent = 0
+        while True:
+            await asyncio.sleep(self.args.notify_interval)
+            sent += 1
+            new_block = self.args.clean_every > 0 and sent % self.args.clean_every == 0
+            job_id = self.next_job_id()
+            for connection in list(self.connections):
+                if not connection.open:
+                    continue
+                connection.send_job(job_id, new_block)
+                if new_block:
+                    connection.send_prev_hash(job_id)
+                connection.flush_acks()
+
+    async def difficulty_loop(self) -> None:
+        if self.args.difficulty_interval <= 0:
+            return
+        while True:
+            await asyncio.sleep(self.args.difficulty_interval)
+            self.difficulty = self.args.difficulty if self.difficulty != self.args.difficulty else self.args.difficulty * 2
+            for connection in list(self.connections):
+                if connection.open:
+                    connection.send(SET_TARGET, struct.pack("<I", connection.channel_id) + target_for(self.difficulty), True)
+
+    async def ack_loop(self) -> None:
+        while True:
+            await asyncio.sleep(0.2)
+            for connection in list(self.connections):
+                connection.flush_acks()
+
+
+async def run(args: argparse.Namespace) -> None:
+    pool = MockPoolSv2(args)
+    server = await asyncio.start_server(pool.handle, args.host, args.port)
+    print(f"mock SV2 pool listening on {args.host}:{args.port}", flush=True)
+
+    tasks = asyncio.gather(server.serve_forever(), pool.job_loop(), pool.difficulty_loop(), pool.ack_loop())
+    loop = asyncio.get_running_loop()
+    for signum in (signal.SIGINT, signal.SIGTERM):
+        loop.add_signal_handler(signum, tasks.cancel)
+
+    try:
+        await tasks
+    except asyncio.CancelledError:
+        pass
+    finally:
+        server.close()
+        if args.stats_file:
+            with open(args.stats_file, "w", encoding="utf-8") as handle:
+                json.dump(pool.stats.as_dict(), handle, indent=2)
+
+
+def parse_args(argv: list[str]) -> argparse.Namespace:
+    parser = argparse.ArgumentParser(description="Plaintext Stratum V2 mock pool")
+    parser.add_argument("--host", default="127.0.0.1", help="Address to listen on")
+    parser.add_argument("--port", type=int, default=3336, help="Port to listen on")
+    parser.add_argument("--notify-interval", type=float, default=30.0, help="Seconds between new jobs (0 disables)")
+    parser.add_argument("--clean-every", type=int, default=0, help="New prev hash on every Nth job (0 never)")
+    parser.add_argument("--difficulty", type=float, default=1024.0, help="Initial channel difficulty")
+    parser.add_argument("--difficulty-interval", type=float, default=0.0, help="Seconds between SetTarget (0 disables)")
+    parser.add_argument("--reject-ratio", type=float, default=0.0, help="Fraction of shares to reject")
+    parser.add_argument("--ack-batch", type=int, default=1, help="Shares acknowledged per SubmitShares.Success")
+    parser.add_argument("--extranonce-size", type=int, default=4, help="Extranonce bytes left to the proxy")
+    parser.add_argument("--latency-ms", type=float, default=0.0, help="Delay before handling each frame")
+    parser.add_argument("--merkle-branches", type=int, default=0, help="Merkle branches per job")
+    parser.add_argument("--coinbase-padding", type=int, default=0, help="Extra bytes appended to the coinbase suffix")
+    parser.add_argument("--seed", type=int, default=None, help="Random seed for reject decisions")
+    parser.add_argument("--stats-file", help="Write pool-side counters as JSON on exit")
+    return parser.parse_args(argv)
+
+
+def main(argv: list[str]) -> int:
+    asyncio.run(run(parse_args(argv)))
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main(sys.argv[1:]))
@@ -0,0 +1,70 @@
+#!/bin/bash
+
+# Stratum Benchmark Runner
+# Runs the miner swarm at several miner counts and collects JSON results.
+# With TARGET=host (default) it starts the mock pool and the host-native
+# proxy build; with TARGET=<device ip> it only runs the swarm against the
+# device, which must already point at a reachable mock pool.
+
+SCRIPT_DIR="$(cd "$(dirname "${BASH_SOURCE[0]}")" && pwd)"
+ROOT_DIR="$(cd "$SCRIPT_DIR/../.." && pwd)"
+
+TARGET="${TARGET:-host}"
+MINER_COUNTS="${MINER_COUNTS:-10 50 100}"
+DURATION="${DURATION:-30}"
+SUBMIT_RATE="${SUBMIT_RATE:-0.2}"
+NOTIFY_INTERVAL="${NOTIFY_INTERVAL:-1}"
+POOL_PORT="${POOL_PORT:-13333}"
+PROXY_PORT="${PROXY_PORT:-4444}"
+RESULTS_DIR="${RESULTS_DIR:-$ROOT_DIR/bench-results/$(date +%Y%m%d-%H%M%S)}"
+HOST_BINARY="$ROOT_DIR/.host-build/yuma_host"
+
+POOL_PID=""
+PROXY_PID=""
+
+cleanup() {
+    [ -n "$PROXY_PID" ] && kill "$PROXY_PID" 2>/dev/null
+    [ -n "$POOL_PID" ] && kill "$POOL_PID" 2>/dev/null
+    wait 2>/dev/null
+}
+trap cleanup EXIT
+
+mkdir -p "$RESULTS_DIR"
+
+if [ "$TARGET" = "host" ]; then
+    if [ ! -x "$HOST_BINARY" ]; then
+        echo "🔨 Building host-native proxy..."
+        make -C "$ROOT_DIR" host >/dev/null || exit 1
+    fi
+
+    python3 "$SCRIPT_DIR/mock_pool.py" --port "$POOL_PORT" --notify-interval "$NOTIFY_INTERVAL" \
+        --quiet --stats-file "$RESULTS_DIR/pool.json" >"$RESULTS_DIR/pool.log" 2>&1 &
+    POOL_PID=$!
+
+    "$HOST_BINARY" --data-dir "$RESULTS_DIR/data" --port "$PROXY_PORT" \
+        --pool "127.0.0.1:$POOL_PORT" >"$RESULTS_DIR/proxy.log" 2>&1 &
+    PROXY_PID=$!
+    PROXY_HOST="127.0.0.1"
+    sleep 1
+else
+    PROXY_HOST="$TARGET"
+fi
+
+status=0
+for miners in $MINER_COUNTS; do
+    echo "⛏️  $miners miners for ${DURATION}s against $PROXY_HOST:$PROXY_PORT..."
+    python3 "$SCRIPT_DIR/miner_swarm.py" --host "$PROXY_HOST" --port "$PROXY_PORT" \
+        --miners "$miners" --duration "$DURATION" --submit-rate "$SUBMIT_RATE" \
+        --label "$TARGET" --output "$RESULTS_DIR/swarm-$miners.json" >/dev/null || status=1
+    python3 - "$RESULTS_DIR/swarm-$miners.json" <<'PY'
+import json, sys
+r = json.load(open(sys.argv[1]))
+n, s = r["notify"]["latency_ms"], r["shares"]["ack_latency_ms"]
+print(f"   subscribed {r['connections']['subscribed']}/{r['connections']['attempted']}, "
+      f"notify p50/p99 {n['p50']}/{n['p99']} ms, ack p50/p99 {s['p50']}/{s['p99']} ms, "
+      f"{r['shares']['per_sec']} shares/s")
+PY
+done
+
+echo "📁 Results in $RESULTS_DIR"
+exit $status
@@ -0,0 +1,73 @@
+#!/bin/bash
+
+# Build Footprint Report
+# Builds the standard and headless environments and compares static RAM,
+# flash and the miner sessions the RAM difference is worth
+
+SCRIPT_DIR="$(cd "$(dirname "${BASH_SOURCE[0]}")" && pwd)"
+PIO_CHECK="$SCRIPT_DIR/pio_check.sh"
+
+# "standard headless" pairs; override with e.g. PAIRS="esp32dev:esp32dev_headless"
+PAIRS="${PAIRS:-esp32dev:esp32dev_headless esp_wroom_02:esp_wroom_02_headless}"
+
+# Starting per-session budget from src/miner_admission.cpp; a running board
+# replaces it with the measured average (session_budget_bytes in /api/status)
+session_budget() {
+    case "$1" in
+        esp_wroom_02*) echo 4096 ;;
+        *) echo 8192 ;;
+    esac
+}
+
+# Prints "ram_used ram_total flash_used flash_total" from the PlatformIO
+# size summary, e.g. "RAM:   [==        ]  15.2% (used 49812 bytes from 327680 bytes)"
+build_sizes() {
+    local env="$1"
+    local output
+    if ! output=$("$PIO_CHECK" run run --environment "$env" 2>&1); then
+        echo "❌ Build failed for $env" >&2
+        echo "$output" | tail -20 >&2
+        return 1
+    fi
+
+    local ram flash
+    ram=$(echo "$output" | sed -n 's/^RAM:.*used \([0-9]*\) bytes from \([0-9]*\) bytes.*/\1 \2/p' | tail -1)
+    flash=$(echo "$output" | sed -n 's/^Flash:.*used \([0-9]*\) bytes from \([0-9]*\) bytes.*/\1 \2/p' | tail -1)
+    if [ -z "$ram" ] || [ -z "$flash" ]; then
+        echo "❌ No size summary for $env" >&2
+        return 1
+    fi
+    echo "$ram $flash"
+}
+
+echo "| Environment | RAM used | Flash used | Miner slots vs standard |"
+echo "|---|---|---|---|"
+
+status=0
+for pair in $PAIRS; do
+    standard="${pair%%:*}"
+    headless="${pair##*:}"
+
+    if ! read -r std_ram std_ram_total std_flash std_flash_total < <(build_sizes "$standard"); then
+        status=1
+        continue
+    fi
+    if ! read -r hl_ram hl_ram_total hl_flash hl_flash_total < <(build_sizes "$headless"); then
+        status=1
+        continue
+    fi
+
+    budget=$(session_budget "$headless")
+    ram_saved=$((std_ram - hl_ram))
+    flash_saved=$((std_flash - hl_flash))
+    extra_slots=$((ram_saved > 0 ? ram_saved / budget : 0))
+
+    echo "| $standard | $std_ram / $std_ram_total | $std_flash / $std_flash_total | — |"
+    echo "| $headless | $hl_ram / $hl_ram_total (−$ram_saved) | $hl_flash / $hl_flash_total (−$flash_saved) | +$extra_slots (${budget} B per session) |"
+done
+
+echo ""
+echo "Static figures only: the dashboard's server, Wi-Fi manager and JSON"
+echo "buffers also take heap at run time. The live capacity a board computes"
+echo "at boot is in /api/status (standard) or the metrics record (headless)."
+exit $status
@@ -0,0 +1,92 @@
+#!/usr/bin/env python3
+"""Fetch and decode the binary metrics record served by headless builds."""
+from __future__ import annotations
+
+import argparse
+import json
+import socket
+import struct
+import sys
+
+MAGIC = b"YUMA"
+
+# Version 1 layout, see src/metrics_endpoint.h. Later versions only append.
+FIELDS_V1: tuple[tuple[str, str], ...] = (
+    ("uptime_s", "I"),
+    ("free_heap", "I"),
+    ("miners", "H"),
+    ("capacity", "H"),
+    ("shares_ok", "I"),
+    ("shares_bad", "I"),
+    ("shares_stale", "I"),
+    ("jobs", "I"),
+    ("difficulty", "I"),
+    ("flags", "B"),
+    ("rssi", "b"),
+    ("shed_level", "B"),
+    ("fragmentation_pct", "B"),
+    ("pool_bytes_rx", "I"),
+    ("pool_bytes_tx", "I"),
+    ("refused", "I"),
+    ("reaped", "I"),
+)
+
+
+def fetch(host: str, port: int, timeout: float) -> bytes:
+    with socket.create_connection((host, port), timeout=timeout) as sock:
+        sock.sendall(b"GET /metrics HTTP/1.0\r\n\r\n")
+        chunks = []
+        while True:
+            chunk = sock.recv(4096)
+            if not chunk:
+                break
+            chunks.append(chunk)
+    response = b"".join(chunks)
+    _, sep, body = response.partition(b"\r\n\r\n")
+    if not sep:
+        raise ValueError("no HTTP body in response")
+    return body
+
+
+def decode(body: bytes) -> dict:
+    if len(body) < 8 or body[:4] != MAGIC:
+        raise ValueError("not a YUMA metrics record")
+    version, size = struct.unpack_from("<HH", body, 4)
+    if len(body) < size:
+        raise ValueError(f"record truncated ({len(body)} of {size} bytes)")
+
+    layout = "<" + "".join(kind for _, kind in FIELDS_V1)
+    values = struct.unpack_from(layout, body, 8)
+    record = {"version": version, "size": size}
+    for (name, _), value in zip(FIELDS_V1, values):
+        if not name.startswith("_"):
+            record[name] = value
+    record["pool_connected"] = bool(record.pop("flags") & 0x01)
+    return record
+
+
+def main() -> int:
+    parser = argparse.ArgumentParser(description=__doc__)
+    parser.add_argument("host", help="proxy address, e.g. yuma.local")
+    parser.add_argument("--port", type=int, default=80)
+    parser.add_argument("--timeout", type=float, default=5.0)
+    parser.add_argument("--json", action="store_true", help="print one JSON object")
+    args = parser.parse_args()
+
+    try:
+        record = decode(fetch(args.host, args.port, args.timeout))
+    except (OSError, ValueError) as exc:
+        print(f"error: {exc}", file=sys.stderr)
+        return 1
+
+    if args.json:
+        print(json.dumps(record))
+    else:
+        width = max(len(name) for name in record)
+        for name, value in record.items():
+            print(f"{name:<{width}}  {value}")
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
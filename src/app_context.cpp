@@ -1,27 +1,30 @@
 #include "app_context.h"
 
-#include <WiFiClient.h>
-
-#if defined(ESP32)
+#if defined(ESP32) || defined(YUMA_HOST)
 #include <AsyncTCP.h>
 #elif defined(ESP8266)
 #include <ESPAsyncTCP.h>
 #endif
 
+#if !defined(YUMA_HOST) && !defined(YUMA_HEADLESS)
 #include <ESPAsyncWebServer.h>
+#endif
 
 Config config = CreateDefaultConfig();
 Metrics metrics{};
-WiFiClient pool_client;
+#if !defined(YUMA_HOST) && !defined(YUMA_HEADLESS)
 AsyncWebServer* server = nullptr;
-AsyncServer stratum_server(4444);
-std::vector<AsyncClient*> connected_miners;
+#endif
+AsyncServer* stratum_server = nullptr;
+std::vector<MinerSession*> connected_miners;
 
 const char* GetBoardName() {
 #if defined(ESP32)
     return "ESP32";
 #elif defined(ESP8266)
     return "ESP8266";
+#elif defined(YUMA_HOST)
+    return "Linux host";
 #else
     return "Unknown";
 #endif
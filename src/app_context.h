@@ -1,24 +1,27 @@
 #pragma once
 
 #include <vector>
-#include <WiFiClient.h>
 
-#if defined(ESP32)
+#if defined(ESP32) || defined(YUMA_HOST)
 #include <AsyncTCP.h>
 #elif defined(ESP8266)
 #include <ESPAsyncTCP.h>
 #endif
 
+#if !defined(YUMA_HOST) && !defined(YUMA_HEADLESS)
 #include <ESPAsyncWebServer.h>
+#endif
 
 #include "config_manager.h"
 #include "metrics.h"
+#include "miner_session.h"
 
 extern Config config;
 extern Metrics metrics;
-extern WiFiClient pool_client;
+#if !defined(YUMA_HOST) && !defined(YUMA_HEADLESS)
 extern AsyncWebServer* server;
-extern AsyncServer stratum_server;
-extern std::vector<AsyncClient*> connected_miners;
+#endif
+extern AsyncServer* stratum_server;
+extern std::vector<MinerSession*> connected_miners;
 
 const char* GetBoardName();
@@ -0,0 +1,36 @@
+#pragma once
+
+// Guards state handed from AsyncTCP callbacks to loop(). On ESP32 the
+// callbacks run on the async_tcp task, alongside loop(), so this is a real
+// mutex there. On ESP8266 and the host they run between loop() passes and
+// the lock costs nothing. Hold it only to move data across: no stratum work,
+// no socket writes, no logging.
+
+#if defined(ESP32)
+#include <mutex>
+#endif
+
+class AsyncLock {
+public:
+#if defined(ESP32)
+    void lock() { mutex_.lock(); }
+    void unlock() { mutex_.unlock(); }
+
+private:
+    std::mutex mutex_;
+#else
+    void lock() {}
+    void unlock() {}
+#endif
+};
+
+class AsyncLockGuard {
+public:
+    explicit AsyncLockGuard(AsyncLock& lock) : lock_(lock) { lock_.lock(); }
+    ~AsyncLockGuard() { lock_.unlock(); }
+    AsyncLockGuard(const AsyncLockGuard&) = delete;
+    AsyncLockGuard& operator=(const AsyncLockGuard&) = delete;
+
+private:
+    AsyncLock& lock_;
+};
@@ -0,0 +1,157 @@
+#include "boot_cache.h"
+
+#include <Arduino.h>
+#include <cstring>
+
+#if defined(ESP32) || defined(YUMA_HOST)
+#include <WiFi.h>
+#elif defined(ESP8266)
+#include <ESP8266WiFi.h>
+#endif
+
+#include "log.h"
+#include "platform_fs.h"
+#include "storage.h"
+
+namespace {
+constexpr char kBootCachePath[] = "/boot_cache.bin";
+constexpr uint32_t kBootCacheMagic = 0x594D4243;  // "YMBC"
+// 2 dropped the stored password and DHCP lease
+constexpr uint16_t kBootCacheVersion = 2;
+
+BootCache cache{};
+BootCache persisted{};
+bool cache_loaded = false;
+
+void ResetCache(BootCache& target) {
+    std::memset(&target, 0, sizeof(target));
+    target.magic = kBootCacheMagic;
+    target.version = kBootCacheVersion;
+}
+
+void CopyBounded(char* dest, size_t size, const char* src) {
+    std::strncpy(dest, src ? src : "", size - 1);
+    dest[size - 1] = '\0';
+}
+
+bool PersistIfChanged() {
+    // Flash wear matters more than a few stale bytes, so only write on change
+    if (std::memcmp(&cache, &persisted, sizeof(cache)) == 0) {
+        return true;
+    }
+
+    if (!EnsureStorageMounted()) {
+        return false;
+    }
+
+    File file = STORAGE_FS.open(kBootCachePath, "w");
+    if (!file) {
+        LOG_ERROR("Failed to open boot cache for writing\n");
+        return false;
+    }
+
+    size_t written = file.write(reinterpret_cast<const uint8_t*>(&cache), sizeof(cache));
+    file.close();
+
+    if (written != sizeof(cache)) {
+        LOG_ERROR("Failed to write boot cache\n");
+        return false;
+    }
+
+    persisted = cache;
+    return true;
+}
+}
+
+bool LoadBootCache() {
+    ResetCache(cache);
+    persisted = cache;
+    cache_loaded = true;
+
+    if (!EnsureStorageMounted() || !STORAGE_FS.exists(kBootCachePath)) {
+        return false;
+    }
+
+    File file = STORAGE_FS.open(kBootCachePath, "r");
+    if (!file) {
+        return false;
+    }
+
+    BootCache stored{};
+    size_t read = file.read(reinterpret_cast<uint8_t*>(&stored), sizeof(stored));
+    file.close();
+
+    if (read != sizeof(stored) || stored.magic != kBootCacheMagic || stored.version != kBootCacheVersion) {
+        LOG_ERROR("Boot cache invalid, ignoring\n");
+        return false;
+    }
+
+    stored.ssid[sizeof(stored.ssid) - 1] = '\0';
+    stored.pool_host[sizeof(stored.pool_host) - 1] = '\0';
+
+    cache = stored;
+    persisted = stored;
+    LOG_INFO("Boot cache loaded (wifi: %s, pool: %s)\n",
+             cache.wifi_valid ? "yes" : "no",
+             cache.pool_valid ? "yes" : "no");
+    return true;
+}
+
+const BootCache& CurrentBootCache() {
+    if (!cache_loaded) {
+        LoadBootCache();
+    }
+    return cache;
+}
+
+bool HasBootCache() {
+    return CurrentBootCache().wifi_valid;
+}
+
+void RememberWifiLink() {
+    CurrentBootCache();
+
+    const uint8_t* bssid = WiFi.BSSID();
+    if (!bssid) {
+        return;
+    }
+
+    cache.wifi_valid = true;
+    CopyBounded(cache.ssid, sizeof(cache.ssid), WiFi.SSID().c_str());
+    std::memcpy(cache.bssid, bssid, sizeof(cache.bssid));
+    cache.channel = WiFi.channel();
+
+    PersistIfChanged();
+}
+
+void RememberPoolAddress(const char* host, int port, const IPAddress& ip) {
+    CurrentBootCache();
+
+    if (!host || static_cast<uint32_t>(ip) == 0) {
+        return;
+    }
+
+    cache.pool_valid = true;
+    CopyBounded(cache.pool_host, sizeof(cache.pool_host), host);
+    cache.pool_port = port;
+    cache.pool_ip = static_cast<uint32_t>(ip);
+
+    PersistIfChanged();
+}
+
+bool CachedPoolAddress(const char* host, int port, IPAddress& ip_out) {
+    const BootCache& current = CurrentBootCache();
+    if (!current.pool_valid || !host || current.pool_port != port ||
+        std::strcmp(current.pool_host, host) != 0) {
+        return false;
+    }
+
+    ip_out = IPAddress(current.pool_ip);
+    return true;
+}
+
+void ForgetWifiLink() {
+    CurrentBootCache();
+    cache.wifi_valid = false;
+    PersistIfChanged();
+}
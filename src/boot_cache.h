@@ -0,0 +1,30 @@
+#pragma once
+
+#include <Arduino.h>
+#include <IPAddress.h>
+
+// Last-known-good link state persisted across reboots so a power blip can
+// skip the Wi-Fi scan and pool DNS lookup. The password stays with the SDK's
+// own stored station config, and the address always comes from DHCP: a
+// reboot loses the clock, so a cached lease could not be known to be current.
+struct BootCache {
+    uint32_t magic;
+    uint16_t version;
+    bool wifi_valid;
+    char ssid[33];
+    uint8_t bssid[6];
+    int32_t channel;
+    bool pool_valid;
+    char pool_host[64];
+    int32_t pool_port;
+    uint32_t pool_ip;
+};
+
+bool LoadBootCache();
+const BootCache& CurrentBootCache();
+bool HasBootCache();
+
+void RememberWifiLink();
+void RememberPoolAddress(const char* host, int port, const IPAddress& ip);
+bool CachedPoolAddress(const char* host, int port, IPAddress& ip_out);
+void ForgetWifiLink();
@@ -0,0 +1,321 @@
+#include "cluster.h"
+
+#include <WiFiUdp.h>
+#include <vector>
+
+#if defined(ESP32) || defined(YUMA_HOST)
+#include <WiFi.h>
+#elif defined(ESP8266)
+#include <ESP8266WiFi.h>
+#endif
+
+#include "app_context.h"
+#include "async_lock.h"
+#include "dns_wire.h"
+#include "log.h"
+#include "miner_admission.h"
+#include "stratum_server.h"
+
+namespace {
+constexpr uint16_t kMdnsPort = 5353;
+constexpr char kServiceName[] = "_stratum._tcp.local";
+constexpr unsigned long kQueryIntervalMs = 10000;
+// Three missed rounds and a peer is gone
+constexpr unsigned long kPeerExpiryMs = 35000;
+constexpr size_t kMaxPeers = 8;
+constexpr size_t kMaxAnswersPerPass = 8;
+// Load is miners over capacity; smaller gaps are not worth a reconnect
+constexpr float kImbalanceThreshold = 0.2f;
+// Peers publish their load once per round, so move a few and look again
+constexpr size_t kMaxMovesPerRound = 2;
+
+const IPAddress kMdnsGroup(224, 0, 0, 251);
+
+std::vector<ClusterPeer> peers;
+ClusterPeer empty_peer;
+ClusterStats stats;
+
+// LeastLoadedPeer() as of the last pass, for the accept callback
+AsyncLock best_peer_lock;
+bool best_peer_valid = false;
+IPAddress best_peer_address;
+uint16_t best_peer_port = 0;
+
+WiFiUDP mdns_udp;
+bool mdns_socket_open = false;
+uint16_t query_id = 0;
+unsigned long last_query_ms = 0;
+bool query_sent = false;
+
+float Load(size_t miners, size_t capacity) {
+    return capacity > 0 ? static_cast<float>(miners) / capacity : 1.0f;
+}
+
+bool IsSelf(const IPAddress& address, uint16_t port) {
+    return port == StratumServerPort() && (address == WiFi.localIP() || address[0] == 127);
+}
+
+ClusterPeer& UpsertPeer(const IPAddress& address, uint16_t port) {
+    for (ClusterPeer& peer : peers) {
+        if (peer.address == address && peer.port == port) {
+            return peer;
+        }
+    }
+    peers.push_back(ClusterPeer());
+    peers.back().address = address;
+    peers.back().port = port;
+    return peers.back();
+}
+
+void ExpirePeers(unsigned long now) {
+    for (size_t i = peers.size(); i-- > 0;) {
+        if (now - peers[i].seen_ms >= kPeerExpiryMs) {
+            LOG_INFO("Cluster peer %s:%u gone\n", peers[i].address.toString().c_str(), peers[i].port);
+            peers.erase(peers.begin() + i);
+        }
+    }
+}
+
+// One-shot query from an ephemeral port: responders answer it by unicast
+// (RFC 6762 section 6.7), so no socket has to share 5353 with the responder
+void SendQuery() {
+    if (!mdns_socket_open) {
+        mdns_socket_open = mdns_udp.begin(0);
+        if (!mdns_socket_open) {
+            return;
+        }
+    }
+
+    uint8_t packet[64];
+    query_id = static_cast<uint16_t>(random(1, 0xFFFF));
+    size_t len = Dns::EncodeQuery(packet, sizeof(packet), kServiceName, query_id, Dns::kTypePtr, false);
+
+    mdns_udp.beginPacket(kMdnsGroup, kMdnsPort);
+    mdns_udp.write(packet, len);
+    mdns_udp.endPacket();
+    stats.queries++;
+}
+
+void ParseTxt(const uint8_t* data, size_t len, ClusterPeer& peer, bool& has_load) {
+    size_t pos = 0;
+    while (pos < len) {
+        size_t item_len = data[pos++];
+        if (pos + item_len > len) {
+            return;
+        }
+        String item;
+        item.concat(reinterpret_cast<const char*>(data + pos), item_len);
+        pos += item_len;
+
+        int equals = item.indexOf('=');
+        if (equals <= 0) {
+            continue;
+        }
+        String key = item.substring(0, equals);
+        String value = item.substring(equals + 1);
+        if (key == "miners") {
+            peer.miners = value.toInt();
+            has_load = true;
+        } else if (key == "capacity") {
+            peer.capacity = value.toInt();
+        } else if (key == "heap") {
+            peer.free_heap = value.toInt() * 1024UL;
+        } else if (key == "pool") {
+            peer.pool_ok = value != "down";
+        }
+    }
+}
+
+// A responder's answer carries PTR, SRV and TXT for its one instance; the
+// peer's address is simply where the answer came from
+void ParseAnswer(const uint8_t* data, size_t len, const IPAddress& source) {
+    if (!Dns::IsResponseTo(data, len, query_id)) {
+        return;
+    }
+
+    uint16_t questions = Dns::ReadU16(data + 4);
+    uint16_t records = Dns::ReadU16(data + 6) + Dns::ReadU16(data + 8) + Dns::ReadU16(data + 10);
+    size_t pos = Dns::kHeaderSize;
+    for (uint16_t i = 0; i < questions; ++i) {
+        if (!Dns::SkipName(data, len, pos)) {
+            return;
+        }
+        pos += 4;
+    }
+
+    ClusterPeer answer;
+    bool has_load = false;
+    for (uint16_t i = 0; i < records && pos < len; ++i) {
+        if (!Dns::SkipName(data, len, pos) || pos + 10 > len) {
+            return;
+        }
+        uint16_t type = Dns::ReadU16(data + pos);
+        uint16_t rdlength = Dns::ReadU16(data + pos + 8);
+        pos += 10;
+        if (pos + rdlength > len) {
+            return;
+        }
+
+        if (type == Dns::kTypeSrv && rdlength >= 6) {
+            answer.port = Dns::ReadU16(data + pos + 4);
+        } else if (type == Dns::kTypeTxt) {
+            ParseTxt(data + pos, rdlength, answer, has_load);
+        }
+        pos += rdlength;
+    }
+
+    // Proxies without load records cannot be balanced against
+    if (answer.port == 0 || !has_load || IsSelf(source, answer.port)) {
+        return;
+    }
+
+    bool known = false;
+    for (const ClusterPeer& peer : peers) {
+        known = known || (peer.address == source && peer.port == answer.port);
+    }
+    if (!known && peers.size() >= kMaxPeers) {
+        return;
+    }
+
+    ClusterPeer& peer = UpsertPeer(source, answer.port);
+    if (!known) {
+        LOG_INFO("Cluster peer %s:%u found (%u/%u miners)\n", source.toString().c_str(), answer.port,
+                 answer.miners, answer.capacity);
+    }
+    peer.miners = answer.miners;
+    peer.capacity = answer.capacity;
+    peer.free_heap = answer.free_heap;
+    peer.pool_ok = answer.pool_ok;
+    peer.seen_ms = millis();
+    stats.answers++;
+}
+
+void PollAnswers() {
+    for (size_t i = 0; i < kMaxAnswersPerPass; ++i) {
+        int size = mdns_udp.parsePacket();
+        if (size <= 0) {
+            return;
+        }
+        uint8_t packet[512];
+        size_t len = mdns_udp.read(packet, sizeof(packet));
+        ParseAnswer(packet, len, mdns_udp.remoteIP());
+    }
+}
+
+ClusterPeer* LeastLoadedPeer() {
+    const unsigned long now = millis();
+    ClusterPeer* best = nullptr;
+    for (ClusterPeer& peer : peers) {
+        if (!peer.pool_ok || peer.miners >= peer.capacity || now - peer.seen_ms >= kPeerExpiryMs) {
+            continue;
+        }
+        if (!best) {
+            best = &peer;
+            continue;
+        }
+        float load = Load(peer.miners, peer.capacity);
+        float best_load = Load(best->miners, best->capacity);
+        if (load < best_load || (load == best_load && peer.free_heap > best->free_heap)) {
+            best = &peer;
+        }
+    }
+    return best;
+}
+
+void PublishBestPeer() {
+    ClusterPeer* peer = LeastLoadedPeer();
+    AsyncLockGuard guard(best_peer_lock);
+    best_peer_valid = peer != nullptr;
+    if (peer) {
+        best_peer_address = peer->address;
+        best_peer_port = peer->port;
+    }
+}
+
+void Rebalance() {
+    size_t capacity = CurrentMinerAdmissionStats().capacity;
+    size_t local = connected_miners.size();
+    ClusterPeer* target = LeastLoadedPeer();
+    if (!target || local < 2 || Load(local, capacity) - Load(target->miners, target->capacity) <= kImbalanceThreshold) {
+        return;
+    }
+
+    // Stop before the move would leave this proxy the lighter one
+    size_t moves = 0;
+    while (moves < kMaxMovesPerRound &&
+           Load(local - moves - 1, capacity) >= Load(target->miners + moves + 1, target->capacity) &&
+           target->miners + moves + 1 <= target->capacity) {
+        moves++;
+    }
+    if (moves == 0) {
+        return;
+    }
+
+    // Newest sessions first: they have the least share history here
+    std::vector<MinerSession*> leaving(connected_miners.end() - moves, connected_miners.end());
+    String host = target->address.toString();
+    LOG_INFO("Cluster: %u/%u miners here, %u/%u on %s:%u, moving %u\n", static_cast<unsigned int>(local),
+             static_cast<unsigned int>(capacity), target->miners, target->capacity, host.c_str(), target->port,
+             static_cast<unsigned int>(moves));
+    for (MinerSession* session : leaving) {
+        RedirectMiner(session, host, target->port);
+    }
+
+    // Counted as theirs until their next answer says otherwise
+    target->miners += moves;
+    stats.rebalanced += moves;
+}
+}
+
+void UpdateCluster() {
+    if (WiFi.status() != WL_CONNECTED || StratumServerPort() == 0) {
+        AsyncLockGuard guard(best_peer_lock);
+        best_peer_valid = false;
+        return;
+    }
+
+    if (query_sent) {
+        PollAnswers();
+    }
+
+    const unsigned long now = millis();
+    if (query_sent && now - last_query_ms < kQueryIntervalMs) {
+        PublishBestPeer();
+        return;
+    }
+
+    // Answers to the last round are in; act on them, then ask again
+    ExpirePeers(now);
+    if (config.cluster_balance) {
+        Rebalance();
+    }
+    SendQuery();
+    last_query_ms = now;
+    query_sent = true;
+    PublishBestPeer();
+}
+
+bool LeastLoadedClusterPeer(IPAddress& address_out, uint16_t& port_out) {
+    AsyncLockGuard guard(best_peer_lock);
+    if (!best_peer_valid) {
+        return false;
+    }
+    address_out = best_peer_address;
+    port_out = best_peer_port;
+    return true;
+}
+
+size_t ClusterPeerCount() {
+    return peers.size();
+}
+
+const ClusterPeer& GetClusterPeer(size_t index) {
+    if (index >= peers.size()) {
+        return empty_peer;
+    }
+    return peers[index];
+}
+
+const ClusterStats& CurrentClusterStats() {
+    return stats;
+}
@@ -0,0 +1,38 @@
+#pragma once
+
+#include <Arduino.h>
+#include <IPAddress.h>
+
+// Other YUMA proxies on the LAN, found with one-shot mDNS queries for
+// _stratum._tcp. Each proxy publishes its load in the service's TXT record
+// (see mdns_service.cpp); with cluster_balance on, a proxy noticeably
+// busier than its least loaded peer hands a few miners over to it with
+// client.reconnect every query round.
+
+struct ClusterPeer {
+    IPAddress address;
+    uint16_t port = 0;
+    uint16_t miners = 0;
+    uint16_t capacity = 0;
+    uint32_t free_heap = 0;
+    // "up", or "idle" with no miners to need it; "down" means it is failing
+    bool pool_ok = false;
+    unsigned long seen_ms = 0;
+};
+
+struct ClusterStats {
+    unsigned long queries = 0;
+    unsigned long answers = 0;
+    unsigned long rebalanced = 0;
+};
+
+void UpdateCluster();
+
+// Least loaded fresh peer with a working pool link and room for another
+// miner, as of the last UpdateCluster(). Safe to call from the socket
+// callbacks: it reads a copy, never the peer table.
+bool LeastLoadedClusterPeer(IPAddress& address_out, uint16_t& port_out);
+
+size_t ClusterPeerCount();
+const ClusterPeer& GetClusterPeer(size_t index);
+const ClusterStats& CurrentClusterStats();
@@ -1,12 +1,77 @@
 #pragma once
 
+// The YUMA_* build flags bake settings into the image. Headless builds have
+// no JSON config or dashboard, so these are the only way to set them there,
+// e.g. -DYUMA_POOL_HOST='"pool.example"' -DYUMA_POOL_PORT=3333.
 namespace ConfigDefaults {
+#ifdef YUMA_WIFI_SSID
+constexpr const char kWifiSsid[] = YUMA_WIFI_SSID;
+#else
+constexpr const char kWifiSsid[] = "";
+#endif
+#ifdef YUMA_WIFI_PASSWORD
+constexpr const char kWifiPassword[] = YUMA_WIFI_PASSWORD;
+#else
+constexpr const char kWifiPassword[] = "";
+#endif
+// Build-time only, so nothing on the unauthenticated dashboard can change it
+#ifdef YUMA_OTA_PASSWORD
+constexpr const char kOtaPassword[] = YUMA_OTA_PASSWORD;
+#else
+constexpr const char kOtaPassword[] = "";
+#endif
+// A TLS session carries the master secret, so it only goes to flash when
+// the build asks for it; otherwise a reboot costs one full handshake
+#ifdef YUMA_TLS_SESSION_PERSIST
+constexpr bool kPersistTlsSession = true;
+#else
+constexpr bool kPersistTlsSession = false;
+#endif
+#ifdef YUMA_POOL_HOST
+constexpr const char kPoolHost[] = YUMA_POOL_HOST;
+#else
 constexpr const char kPoolHost[] = "public-pool.io";
+#endif
+#ifdef YUMA_POOL_PORT
+constexpr int kPoolPort = YUMA_POOL_PORT;
+#else
 constexpr int kPoolPort = 21496;
+#endif
+constexpr bool kPoolSv2 = false;
+// Off: the window is polled on the pool task's period, so a batch can be
+// held a few milliseconds longer than configured
+constexpr int kSubmitCoalesceUs = 0;
+#ifdef YUMA_POOL_USER
+constexpr const char kPoolUser[] = YUMA_POOL_USER;
+#else
 constexpr const char kPoolUser[] = "bc1qw2raw7urfuu2032uyyx9k5pryan5gu6gmz6exm.yuna";
+#endif
+#ifdef YUMA_POOL_PASS
+constexpr const char kPoolPass[] = YUMA_POOL_PASS;
+#else
 constexpr const char kPoolPass[] = "x";
+#endif
+#ifdef YUMA_POOL_TLS_FINGERPRINT
+constexpr const char kPoolTlsFingerprint[] = YUMA_POOL_TLS_FINGERPRINT;
+#else
+constexpr const char kPoolTlsFingerprint[] = "";
+#endif
+constexpr const char kWorkerMap[] = "";
+constexpr const char kWorkerAllow[] = "";
+constexpr const char kAltPoolHost[] = "";
+constexpr int kAltPoolPort = 3333;
+constexpr const char kAltPoolUser[] = "";
+constexpr const char kAltPoolPass[] = "x";
+constexpr const char kAltPoolTlsFingerprint[] = "";
+constexpr int kAltPoolWeight = 0;
+constexpr int kPoolSliceS = 300;
+constexpr bool kHeaderJobs = true;
 constexpr int kDifficulty = 1024;
 constexpr bool kVardiffEnabled = true;
+// Off: a healthy miner on a high difficulty can go quiet for far longer
+// than any fixed limit, and the ACK timeout already catches dead ones
+constexpr int kMinerIdleTimeoutS = 0;
+constexpr int kMinerAckTimeoutMs = 10000;
 constexpr int kVardiffTarget = 30;
 constexpr int kVardiffMin = 256;
 constexpr int kVardiffMax = 16384;
@@ -15,4 +80,17 @@ constexpr const char kStaticIp[] = "";
 constexpr const char kStaticGateway[] = "";
 constexpr const char kStaticSubnet[] = "";
 constexpr const char kStaticDns[] = "";
+constexpr int kStratumPort = 4444;
+// Headless builds serve the binary metrics record where the dashboard would be
+constexpr int kMetricsPort = 80;
+constexpr const char kSiblingHost[] = "";
+constexpr int kSiblingPort = 4444;
+constexpr bool kClusterBalance = false;
+#if defined(ESP8266)
+constexpr int kShedHeapKb = 12;
+#else
+constexpr int kShedHeapKb = 32;
+#endif
+constexpr int kShedLagMs = 1000;
+constexpr int kPowerPolicy = 0;
 } // namespace ConfigDefaults
@@ -1,10 +1,14 @@
 #include "config_manager.h"
 
 #include <Arduino.h>
-#include <ArduinoJson.h>
 #include <cstring>
 
+#ifndef YUMA_HEADLESS
+#include <ArduinoJson.h>
+#endif
+
 #include "config_defaults.h"
+#include "log.h"
 #include "platform_fs.h"
 #include "storage.h"
 
@@ -27,15 +31,37 @@ void CopyLiteral(char* dest, size_t size, const char* src) {
 Config CreateDefaultConfig() {
     Config cfg{};
 
-    cfg.ssid[0] = '\0';
-    cfg.password[0] = '\0';
+    CopyLiteral(cfg.ssid, sizeof(cfg.ssid), ConfigDefaults::kWifiSsid);
+    CopyLiteral(cfg.password, sizeof(cfg.password), ConfigDefaults::kWifiPassword);
 
     CopyLiteral(cfg.pool_host, sizeof(cfg.pool_host), ConfigDefaults::kPoolHost);
     cfg.pool_port = ConfigDefaults::kPoolPort;
+    cfg.pool_sv2 = ConfigDefaults::kPoolSv2;
+    cfg.submit_coalesce_us = ConfigDefaults::kSubmitCoalesceUs;
     CopyLiteral(cfg.pool_user, sizeof(cfg.pool_user), ConfigDefaults::kPoolUser);
     CopyLiteral(cfg.pool_pass, sizeof(cfg.pool_pass), ConfigDefaults::kPoolPass);
+    CopyLiteral(cfg.pool_tls_fingerprint, sizeof(cfg.pool_tls_fingerprint), ConfigDefaults::kPoolTlsFingerprint);
+    CopyLiteral(cfg.worker_map, sizeof(cfg.worker_map), ConfigDefaults::kWorkerMap);
+    CopyLiteral(cfg.worker_allow, sizeof(cfg.worker_allow), ConfigDefaults::kWorkerAllow);
+    CopyLiteral(cfg.alt_pool_host, sizeof(cfg.alt_pool_host), ConfigDefaults::kAltPoolHost);
+    cfg.alt_pool_port = ConfigDefaults::kAltPoolPort;
+    CopyLiteral(cfg.alt_pool_user, sizeof(cfg.alt_pool_user), ConfigDefaults::kAltPoolUser);
+    CopyLiteral(cfg.alt_pool_pass, sizeof(cfg.alt_pool_pass), ConfigDefaults::kAltPoolPass);
+    CopyLiteral(cfg.alt_pool_tls_fingerprint, sizeof(cfg.alt_pool_tls_fingerprint),
+                ConfigDefaults::kAltPoolTlsFingerprint);
+    cfg.alt_pool_weight = ConfigDefaults::kAltPoolWeight;
+    cfg.pool_slice_s = ConfigDefaults::kPoolSliceS;
+    cfg.header_jobs = ConfigDefaults::kHeaderJobs;
     cfg.difficulty = ConfigDefaults::kDifficulty;
     cfg.vardiff_enabled = ConfigDefaults::kVardiffEnabled;
+    cfg.miner_idle_timeout_s = ConfigDefaults::kMinerIdleTimeoutS;
+    cfg.miner_ack_timeout_ms = ConfigDefaults::kMinerAckTimeoutMs;
+    CopyLiteral(cfg.sibling_host, sizeof(cfg.sibling_host), ConfigDefaults::kSiblingHost);
+    cfg.sibling_port = ConfigDefaults::kSiblingPort;
+    cfg.cluster_balance = ConfigDefaults::kClusterBalance;
+    cfg.shed_heap_kb = ConfigDefaults::kShedHeapKb;
+    cfg.shed_lag_ms = ConfigDefaults::kShedLagMs;
+    cfg.power_policy = ConfigDefaults::kPowerPolicy;
     cfg.vardiff_target = ConfigDefaults::kVardiffTarget;
     cfg.vardiff_min = ConfigDefaults::kVardiffMin;
     cfg.vardiff_max = ConfigDefaults::kVardiffMax;
@@ -61,26 +87,40 @@ void CopyStringField(char* dest, size_t dest_size, const String& value) {
     }
 }
 
+#ifdef YUMA_HEADLESS
+// No JSON config in headless images: every setting comes from the build flags
+// read by config_defaults.h
+bool LoadConfig(Config& cfg) {
+    cfg = CreateDefaultConfig();
+    LOG_INFO("Configuration built in (%s:%d)\n", cfg.pool_host, cfg.pool_port);
+    return true;
+}
+
+bool SaveConfig(const Config& cfg) {
+    (void)cfg;
+    return false;
+}
+#else
 bool LoadConfig(Config& cfg) {
     if (!EnsureStorageMounted()) {
-        Serial.println("Storage not mounted, using default configuration");
+        LOG_ERROR("Storage not mounted, using default configuration\n");
         cfg = CreateDefaultConfig();
         return false;
     }
 
     File file = STORAGE_FS.open("/config.json", "r");
     if (!file) {
-        Serial.println("Configuration file not found, using defaults");
+        LOG_INFO("Configuration file not found, using defaults\n");
         cfg = CreateDefaultConfig();
         return false;
     }
 
-    DynamicJsonDocument doc(1024);
+    DynamicJsonDocument doc(3072);
     DeserializationError err = deserializeJson(doc, file);
     file.close();
 
     if (err != DeserializationError::Ok) {
-        Serial.printf("Failed to parse configuration (%s), using defaults\n", err.c_str());
+        LOG_ERROR("Failed to parse configuration (%s), using defaults\n", err.c_str());
         cfg = CreateDefaultConfig();
         return false;
     }
@@ -89,10 +129,33 @@ bool LoadConfig(Config& cfg) {
 
     CopyLiteral(cfg.pool_host, sizeof(cfg.pool_host), doc["pool_host"] | ConfigDefaults::kPoolHost);
     cfg.pool_port = doc["pool_port"] | ConfigDefaults::kPoolPort;
+    cfg.pool_sv2 = doc["pool_sv2"] | ConfigDefaults::kPoolSv2;
+    cfg.submit_coalesce_us = doc["submit_coalesce_us"] | ConfigDefaults::kSubmitCoalesceUs;
     CopyLiteral(cfg.pool_user, sizeof(cfg.pool_user), doc["pool_user"] | ConfigDefaults::kPoolUser);
     CopyLiteral(cfg.pool_pass, sizeof(cfg.pool_pass), doc["pool_pass"] | ConfigDefaults::kPoolPass);
+    CopyLiteral(cfg.pool_tls_fingerprint, sizeof(cfg.pool_tls_fingerprint),
+                doc["pool_tls_fingerprint"] | ConfigDefaults::kPoolTlsFingerprint);
+    CopyLiteral(cfg.worker_map, sizeof(cfg.worker_map), doc["worker_map"] | ConfigDefaults::kWorkerMap);
+    CopyLiteral(cfg.worker_allow, sizeof(cfg.worker_allow), doc["worker_allow"] | ConfigDefaults::kWorkerAllow);
+    CopyLiteral(cfg.alt_pool_host, sizeof(cfg.alt_pool_host), doc["alt_pool_host"] | ConfigDefaults::kAltPoolHost);
+    cfg.alt_pool_port = doc["alt_pool_port"] | ConfigDefaults::kAltPoolPort;
+    CopyLiteral(cfg.alt_pool_user, sizeof(cfg.alt_pool_user), doc["alt_pool_user"] | ConfigDefaults::kAltPoolUser);
+    CopyLiteral(cfg.alt_pool_pass, sizeof(cfg.alt_pool_pass), doc["alt_pool_pass"] | ConfigDefaults::kAltPoolPass);
+    CopyLiteral(cfg.alt_pool_tls_fingerprint, sizeof(cfg.alt_pool_tls_fingerprint),
+                doc["alt_pool_tls_fingerprint"] | ConfigDefaults::kAltPoolTlsFingerprint);
+    cfg.alt_pool_weight = doc["alt_pool_weight"] | ConfigDefaults::kAltPoolWeight;
+    cfg.pool_slice_s = doc["pool_slice_s"] | ConfigDefaults::kPoolSliceS;
+    cfg.header_jobs = doc["header_jobs"] | ConfigDefaults::kHeaderJobs;
     cfg.difficulty = doc["difficulty"] | ConfigDefaults::kDifficulty;
     cfg.vardiff_enabled = doc["vardiff_enabled"] | ConfigDefaults::kVardiffEnabled;
+    cfg.miner_idle_timeout_s = doc["miner_idle_timeout_s"] | ConfigDefaults::kMinerIdleTimeoutS;
+    cfg.miner_ack_timeout_ms = doc["miner_ack_timeout_ms"] | ConfigDefaults::kMinerAckTimeoutMs;
+    CopyLiteral(cfg.sibling_host, sizeof(cfg.sibling_host), doc["sibling_host"] | ConfigDefaults::kSiblingHost);
+    cfg.sibling_port = doc["sibling_port"] | ConfigDefaults::kSiblingPort;
+    cfg.cluster_balance = doc["cluster_balance"] | ConfigDefaults::kClusterBalance;
+    cfg.shed_heap_kb = doc["shed_heap_kb"] | ConfigDefaults::kShedHeapKb;
+    cfg.shed_lag_ms = doc["shed_lag_ms"] | ConfigDefaults::kShedLagMs;
+    cfg.power_policy = doc["power_policy"] | ConfigDefaults::kPowerPolicy;
     cfg.vardiff_target = doc["vardiff_target"] | ConfigDefaults::kVardiffTarget;
     cfg.vardiff_min = doc["vardiff_min"] | ConfigDefaults::kVardiffMin;
     cfg.vardiff_max = doc["vardiff_max"] | ConfigDefaults::kVardiffMax;
@@ -103,31 +166,52 @@ bool LoadConfig(Config& cfg) {
     CopyLiteral(cfg.static_subnet, sizeof(cfg.static_subnet), doc["static_subnet"] | ConfigDefaults::kStaticSubnet);
     CopyLiteral(cfg.static_dns, sizeof(cfg.static_dns), doc["static_dns"] | ConfigDefaults::kStaticDns);
 
-    Serial.println("Configuration loaded");
-    Serial.printf("Static IP: %s, gateway: %s, subnet: %s, dns: %s, enabled: %s\n",
-                  cfg.static_ip,
-                  cfg.static_gateway,
-                  cfg.static_subnet,
-                  cfg.static_dns,
-                  cfg.use_static_ip ? "yes" : "no");
+    LOG_INFO("Configuration loaded\n");
+    LOG_INFO("Static IP: %s, gateway: %s, subnet: %s, dns: %s, enabled: %s\n",
+             cfg.static_ip,
+             cfg.static_gateway,
+             cfg.static_subnet,
+             cfg.static_dns,
+             cfg.use_static_ip ? "yes" : "no");
 
     return true;
 }
 
 bool SaveConfig(const Config& cfg) {
     if (!EnsureStorageMounted()) {
-        Serial.println("Storage not mounted, cannot save configuration");
+        LOG_ERROR("Storage not mounted, cannot save configuration\n");
         return false;
     }
 
-    DynamicJsonDocument doc(1024);
+    DynamicJsonDocument doc(3072);
 
     doc["pool_host"] = cfg.pool_host;
     doc["pool_port"] = cfg.pool_port;
+    doc["pool_sv2"] = cfg.pool_sv2;
+    doc["submit_coalesce_us"] = cfg.submit_coalesce_us;
     doc["pool_user"] = cfg.pool_user;
     doc["pool_pass"] = cfg.pool_pass;
+    doc["pool_tls_fingerprint"] = cfg.pool_tls_fingerprint;
+    doc["worker_map"] = cfg.worker_map;
+    doc["worker_allow"] = cfg.worker_allow;
+    doc["alt_pool_host"] = cfg.alt_pool_host;
+    doc["alt_pool_port"] = cfg.alt_pool_port;
+    doc["alt_pool_user"] = cfg.alt_pool_user;
+    doc["alt_pool_pass"] = cfg.alt_pool_pass;
+    doc["alt_pool_tls_fingerprint"] = cfg.alt_pool_tls_fingerprint;
+    doc["alt_pool_weight"] = cfg.alt_pool_weight;
+    doc["pool_slice_s"] = cfg.pool_slice_s;
+    doc["header_jobs"] = cfg.header_jobs;
     doc["difficulty"] = cfg.difficulty;
     doc["vardiff_enabled"] = cfg.vardiff_enabled;
+    doc["miner_idle_timeout_s"] = cfg.miner_idle_timeout_s;
+    doc["miner_ack_timeout_ms"] = cfg.miner_ack_timeout_ms;
+    doc["sibling_host"] = cfg.sibling_host;
+    doc["sibling_port"] = cfg.sibling_port;
+    doc["cluster_balance"] = cfg.cluster_balance;
+    doc["shed_heap_kb"] = cfg.shed_heap_kb;
+    doc["shed_lag_ms"] = cfg.shed_lag_ms;
+    doc["power_policy"] = cfg.power_policy;
     doc["vardiff_target"] = cfg.vardiff_target;
     doc["vardiff_min"] = cfg.vardiff_min;
     doc["vardiff_max"] = cfg.vardiff_max;
@@ -148,7 +232,7 @@ bool SaveConfig(const Config& cfg) {
     }
 #endif
     if (!file) {
-        Serial.println("Failed to open config file for writing");
+        LOG_ERROR("Failed to open config file for writing\n");
         return false;
     }
 
@@ -156,11 +240,12 @@ bool SaveConfig(const Config& cfg) {
     file.close();
 
     if (written == 0) {
-        Serial.println("Failed to write configuration to file");
+        LOG_ERROR("Failed to write configuration to file\n");
         return false;
     }
 
-    Serial.println("Configuration saved");
-    Serial.printf("Static IP saved as %s (enabled=%s)\n", cfg.static_ip, cfg.use_static_ip ? "yes" : "no");
+    LOG_INFO("Configuration saved\n");
+    LOG_INFO("Static IP saved as %s (enabled=%s)\n", cfg.static_ip, cfg.use_static_ip ? "yes" : "no");
     return true;
 }
+#endif
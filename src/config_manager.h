@@ -7,10 +7,44 @@ struct Config {
     char password[64];
     char pool_host[64];
     int pool_port;
+    bool pool_sv2;
+    int submit_coalesce_us;
     char pool_user[64];
     char pool_pass[32];
+    // Hex fingerprint the stratum+ssl pool certificate must match: SHA-256
+    // on ESP32 and the host build, SHA-1 on ESP8266; empty = not verified
+    char pool_tls_fingerprint[96];
+    // "miner=upstream" pairs, comma separated; a trailing * matches a prefix
+    char worker_map[160];
+    // Worker names allowed to authorize, comma separated; empty allows all
+    char worker_allow[96];
+    // Second pool that gets alt_pool_weight percent of the work; empty = off
+    char alt_pool_host[64];
+    int alt_pool_port;
+    char alt_pool_user[64];
+    char alt_pool_pass[32];
+    char alt_pool_tls_fingerprint[96];
+    int alt_pool_weight;
+    // Shortest time on one pool before the split moves to the other
+    int pool_slice_s;
+    // Build ready-to-hash headers for miners that send mining.header_subscribe
+    bool header_jobs;
     int difficulty;
+    // vardiff_* are read and saved but unused: the pool's vardiff sets the
+    // miners' difficulty
     bool vardiff_enabled;
+    int miner_idle_timeout_s;
+    int miner_ack_timeout_ms;
+    // Another proxy that takes miners this one has no room for
+    char sibling_host[64];
+    int sibling_port;
+    // Hand miners to less loaded proxies found over mDNS
+    bool cluster_balance;
+    // Free heap (KB) and loop lag (ms) past which load is shed; 0 = off
+    int shed_heap_kb;
+    int shed_lag_ms;
+    // PowerPolicy: 0 auto, 1 always performance, 2 always power save
+    int power_policy;
     int vardiff_target;
     int vardiff_min;
     int vardiff_max;
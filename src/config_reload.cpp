@@ -0,0 +1,113 @@
+#include "config_reload.h"
+
+#include <cstring>
+
+#include "app_context.h"
+#include "async_lock.h"
+#include "job_cache.h"
+#include "log.h"
+#include "pool_client.h"
+#include "pool_handover.h"
+#include "pool_split.h"
+#include "pool_tls.h"
+
+namespace {
+// Time for the web response to reach the browser before the restart
+constexpr unsigned long kRestartDelayMs = 3000;
+
+// Guards what the web handler shares with the loop: change_noted, which
+// the handler sets and the loop takes, and restart_pending, which the loop
+// sets and the status page reads
+AsyncLock change_lock;
+bool change_noted = false;
+bool restart_pending = false;
+
+// Loop only. A noted change is compared against the settings last acted on,
+// so saves that land before the loop gets to them are applied as one.
+Config applied;
+unsigned long restart_at_ms = 0;
+
+bool PlainV1(const Config& cfg, size_t index) {
+    return !cfg.pool_sv2 && !PoolUriUsesTls(PoolTargetAt(cfg, index).host);
+}
+
+bool PoolChanged(const Config& previous, size_t index) {
+    const PoolTarget before = PoolTargetAt(previous, index);
+    const PoolTarget after = PoolTargetAt(config, index);
+    return strcmp(before.host, after.host) != 0 || before.port != after.port || strcmp(before.user, after.user) != 0 ||
+           strcmp(before.pass, after.pass) != 0 ||
+           (PoolUriUsesTls(after.host) && strcmp(before.tls_fingerprint, after.tls_fingerprint) != 0);
+}
+
+bool NetworkChanged(const Config& previous) {
+    return previous.use_static_ip != config.use_static_ip || strcmp(previous.static_ip, config.static_ip) != 0 ||
+           strcmp(previous.static_gateway, config.static_gateway) != 0 ||
+           strcmp(previous.static_subnet, config.static_subnet) != 0 ||
+           strcmp(previous.static_dns, config.static_dns) != 0;
+}
+
+void ApplyConfigChange(const Config& previous) {
+    // Only the pool being mined matters now; the other is read at the next switch
+    const size_t index = ActivePoolIndex();
+    if (PoolChanged(previous, index) || previous.pool_sv2 != config.pool_sv2) {
+        // Without a live link the next connect already uses the new pool
+        if (PoolClient().connected() || PoolHandoverActive()) {
+            if (PlainV1(previous, index) && PlainV1(config, index)) {
+                BeginPoolHandover(index);
+            } else {
+                LOG_INFO("Pool changed, reconnecting\n");
+                DisconnectFromPool();
+            }
+        }
+    } else if (previous.difficulty != config.difficulty) {
+        // A new pool gets the difficulty with its authorize
+        SuggestPoolDifficulty();
+    }
+
+    if (PoolChanged(previous, kPrimaryPool) || PoolChanged(previous, kAlternatePool) ||
+        previous.alt_pool_weight != config.alt_pool_weight || previous.pool_sv2 != config.pool_sv2) {
+        ResetPoolSplit();
+    }
+
+    if (NetworkChanged(previous) && !restart_pending) {
+        restart_at_ms = millis();
+        {
+            AsyncLockGuard guard(change_lock);
+            restart_pending = true;
+        }
+        LOG_INFO("Network settings changed, restarting in %lu s\n", kRestartDelayMs / 1000);
+    }
+}
+}
+
+void InitConfigReload() {
+    applied = config;
+}
+
+void NoteConfigChange() {
+    AsyncLockGuard guard(change_lock);
+    change_noted = true;
+}
+
+void UpdateConfigReload() {
+    bool noted;
+    {
+        AsyncLockGuard guard(change_lock);
+        noted = change_noted;
+        change_noted = false;
+    }
+    if (noted) {
+        ApplyConfigChange(applied);
+        applied = config;
+    }
+
+    if (restart_pending && millis() - restart_at_ms >= kRestartDelayMs) {
+        SaveJobCache();
+        ESP.restart();
+    }
+}
+
+bool ConfigRestartPending() {
+    AsyncLockGuard guard(change_lock);
+    return restart_pending;
+}
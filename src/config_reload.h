@@ -0,0 +1,23 @@
+#pragma once
+
+#include "config_manager.h"
+
+// Applies a saved configuration live instead of on the next boot:
+// - pool host, port, user or password of the pool being mined: handover to
+//   the new pool, miners stay connected (a plain reconnect for TLS or Stratum
+//   V2 links). Any pool or weight change restarts the split measurement;
+// - difficulty: suggested to the pool on the live link, which then sends
+//   every session its set_difficulty;
+// - static IP settings: a controlled restart a few seconds later.
+// The rest are read where they are used (Wi-Fi credentials at the next
+// association) and need nothing here. The vardiff_* fields are kept in
+// config.json but unused: the pool's vardiff sets the miners' difficulty.
+
+// Takes the loaded settings as the ones in effect; call once the boot
+// configuration is final, before anything can save a change
+void InitConfigReload();
+// Call once the new settings are saved. Safe from a web handler: it only
+// flags the change, and UpdateConfigReload() compares and acts on the loop.
+void NoteConfigChange();
+void UpdateConfigReload();
+bool ConfigRestartPending();
@@ -0,0 +1,76 @@
+#include "dns_wire.h"
+
+#include <cstring>
+
+namespace Dns {
+uint16_t ReadU16(const uint8_t* data) {
+    return (static_cast<uint16_t>(data[0]) << 8) | data[1];
+}
+
+uint32_t ReadU32(const uint8_t* data) {
+    return (static_cast<uint32_t>(data[0]) << 24) | (static_cast<uint32_t>(data[1]) << 16) |
+           (static_cast<uint32_t>(data[2]) << 8) | data[3];
+}
+
+bool SkipName(const uint8_t* data, size_t len, size_t& pos) {
+    while (pos < len) {
+        uint8_t label = data[pos];
+        if ((label & 0xC0) == 0xC0) {
+            pos += 2;
+            return pos <= len;
+        }
+        pos++;
+        if (label == 0) {
+            return true;
+        }
+        pos += label;
+    }
+    return false;
+}
+
+size_t EncodeQuery(uint8_t* buffer, size_t size, const char* name, uint16_t id, uint16_t type,
+                   bool recursion_desired) {
+    const size_t name_len = strlen(name);
+    if (size < kHeaderSize + name_len + 6) {
+        return 0;
+    }
+
+    size_t pos = 0;
+    buffer[pos++] = id >> 8;
+    buffer[pos++] = id & 0xFF;
+    buffer[pos++] = recursion_desired ? 0x01 : 0x00;
+    buffer[pos++] = 0x00;
+    buffer[pos++] = 0x00;
+    buffer[pos++] = 0x01;  // one question
+    for (int i = 0; i < 6; ++i) {
+        buffer[pos++] = 0x00;
+    }
+
+    const char* label = name;
+    while (true) {
+        const char* dot = strchr(label, '.');
+        size_t label_len = dot ? static_cast<size_t>(dot - label) : strlen(label);
+        if (label_len == 0 || label_len > 63) {
+            return 0;
+        }
+        buffer[pos++] = static_cast<uint8_t>(label_len);
+        memcpy(buffer + pos, label, label_len);
+        pos += label_len;
+        if (!dot) {
+            break;
+        }
+        label = dot + 1;
+    }
+    buffer[pos++] = 0x00;
+
+    buffer[pos++] = type >> 8;
+    buffer[pos++] = type & 0xFF;
+    buffer[pos++] = kClassIn >> 8;
+    buffer[pos++] = kClassIn & 0xFF;
+    return pos;
+}
+
+bool IsResponseTo(const uint8_t* data, size_t len, uint16_t id) {
+    return len >= kHeaderSize && ReadU16(data) == id && (data[2] & 0x80) != 0;
+}
+}
@@ -0,0 +1,30 @@
+#pragma once
+
+#include <Arduino.h>
+
+// The bits of the RFC 1035 wire format shared by the pool resolver (unicast
+// A queries) and cluster discovery (mDNS PTR queries). Integers are big
+// endian; names in answers may be compressed.
+namespace Dns {
+constexpr size_t kHeaderSize = 12;
+
+constexpr uint16_t kTypeA = 1;
+constexpr uint16_t kTypePtr = 12;
+constexpr uint16_t kTypeTxt = 16;
+constexpr uint16_t kTypeSrv = 33;
+constexpr uint16_t kClassIn = 1;
+
+uint16_t ReadU16(const uint8_t* data);
+uint32_t ReadU32(const uint8_t* data);
+
+// Moves pos past the name starting there; false if it runs off the end
+bool SkipName(const uint8_t* data, size_t len, size_t& pos);
+
+// One-question query for a dotted name. Returns its length, or 0 when the
+// name has an empty or over-long label or the buffer is too small.
+size_t EncodeQuery(uint8_t* buffer, size_t size, const char* name, uint16_t id, uint16_t type,
+                   bool recursion_desired);
+
+// Header of an answer to query id: false for anything else
+bool IsResponseTo(const uint8_t* data, size_t len, uint16_t id);
+}
@@ -0,0 +1,252 @@
+#include "header_jobs.h"
+
+#include <ArduinoJson.h>
+#include <vector>
+
+#include "app_context.h"
+#include "job_cache.h"
+#include "log.h"
+#include "miner_extranonce.h"
+#include "scheduler.h"
+#include "sha256.h"
+#include "stratum_server.h"
+
+namespace {
+// Per scheduler run, so a job for many header miners does not stall the pool link
+constexpr size_t kHeadersPerRun = 4;
+constexpr size_t kHeaderBytes = 80;
+constexpr size_t kJsonDocOverhead = 1024;
+
+// The current job, with everything that is the same for every miner done
+struct JobTemplate {
+    String job_id;
+    String ntime;
+    // Merkle root and nonce left zero
+    uint8_t header[kHeaderBytes] = {};
+    // State after coinb1, shared by every miner's coinbase
+    Sha256State coinbase1;
+    std::vector<uint8_t> coinbase2;
+    // 32 bytes per branch
+    std::vector<uint8_t> branches;
+    bool valid = false;
+};
+
+JobTemplate job;
+// Bumped per job; 0 is never a generation, so new subscribers are due one
+uint32_t job_generation = 1;
+uint32_t template_generation = 0;
+// Generation of the last clean_jobs notify; a miner that skipped it still
+// has to drop its work, even if the job it gets next is not clean
+uint32_t clean_generation = 0;
+// One counter for all miners, so no two headers share a coinbase even when
+// the upstream extranonce2 is too small to give miners their own slot
+uint32_t next_extranonce2 = 0;
+HeaderJobStats stats;
+
+int HexNibble(char c) {
+    if (c >= '0' && c <= '9') {
+        return c - '0';
+    }
+    if (c >= 'a' && c <= 'f') {
+        return c - 'a' + 10;
+    }
+    if (c >= 'A' && c <= 'F') {
+        return c - 'A' + 10;
+    }
+    return -1;
+}
+
+bool ParseHex(const char* hex, std::vector<uint8_t>& out) {
+    out.clear();
+    size_t length = hex ? strlen(hex) : 0;
+    if (length % 2 != 0) {
+        return false;
+    }
+    out.reserve(length / 2);
+    for (size_t i = 0; i < length; i += 2) {
+        int high = HexNibble(hex[i]);
+        int low = HexNibble(hex[i + 1]);
+        if (high < 0 || low < 0) {
+            return false;
+        }
+        out.push_back(static_cast<uint8_t>((high << 4) | low));
+    }
+    return true;
+}
+
+// Stratum sends version, nbits and ntime as big-endian hex; the header
+// holds them little-endian
+bool PutWord(const char* hex, uint8_t* out) {
+    std::vector<uint8_t> bytes;
+    if (!ParseHex(hex, bytes) || bytes.size() != 4) {
+        return false;
+    }
+    for (int i = 0; i < 4; ++i) {
+        out[i] = bytes[3 - i];
+    }
+    return true;
+}
+
+String ToHex(const uint8_t* data, size_t length) {
+    static const char kDigits[] = "0123456789abcdef";
+    String hex;
+    hex.reserve(length * 2);
+    for (size_t i = 0; i < length; ++i) {
+        hex += kDigits[data[i] >> 4];
+        hex += kDigits[data[i] & 0x0F];
+    }
+    return hex;
+}
+
+bool ParseTemplate(const String& line) {
+    job.valid = false;
+    DynamicJsonDocument doc(kJsonDocOverhead + line.length());
+    if (line.length() == 0 || deserializeJson(doc, line) != DeserializationError::Ok) {
+        return false;
+    }
+    // job_id, prevhash, coinb1, coinb2, merkle_branch, version, nbits, ntime, clean_jobs
+    JsonArrayConst params = doc["params"];
+    if (params.size() < 9) {
+        return false;
+    }
+
+    std::vector<uint8_t> prevhash;
+    std::vector<uint8_t> coinbase1;
+    if (!ParseHex(params[1].as<const char*>(), prevhash) || prevhash.size() != kSha256Bytes ||
+        !ParseHex(params[2].as<const char*>(), coinbase1) || !ParseHex(params[3].as<const char*>(), job.coinbase2) ||
+        !PutWord(params[5].as<const char*>(), job.header) || !PutWord(params[7].as<const char*>(), job.header + 68) ||
+        !PutWord(params[6].as<const char*>(), job.header + 72)) {
+        return false;
+    }
+    // Stratum's prevhash has each 4-byte word byte-swapped
+    for (size_t i = 0; i < kSha256Bytes; ++i) {
+        job.header[4 + i] = prevhash[(i & ~3u) + 3 - (i & 3u)];
+    }
+    memset(job.header + 36, 0, kSha256Bytes);
+    memset(job.header + 76, 0, 4);
+
+    job.branches.clear();
+    std::vector<uint8_t> branch;
+    for (JsonVariantConst entry : params[4].as<JsonArrayConst>()) {
+        if (!ParseHex(entry.as<const char*>(), branch) || branch.size() != kSha256Bytes) {
+            return false;
+        }
+        job.branches.insert(job.branches.end(), branch.begin(), branch.end());
+    }
+
+    Sha256Init(job.coinbase1);
+    Sha256Update(job.coinbase1, coinbase1.data(), coinbase1.size());
+    job.job_id = params[0].as<String>();
+    job.ntime = params[7].as<String>();
+    job.valid = true;
+    stats.templates++;
+    return true;
+}
+
+void SendHeaderJob(MinerSession* session) {
+    const unsigned long started_us = micros();
+
+    std::vector<uint8_t> extranonce1;
+    ParseHex(MinerExtranonce1(session).c_str(), extranonce1);
+    uint8_t extranonce2[8] = {};
+    const size_t extranonce2_size = constrain(MinerExtranonce2Size(), 0, 8);
+    const uint32_t counter = next_extranonce2++;
+    for (size_t i = 0; i < extranonce2_size && i < 4; ++i) {
+        extranonce2[extranonce2_size - 1 - i] = static_cast<uint8_t>(counter >> (8 * i));
+    }
+
+    Sha256State coinbase = job.coinbase1;
+    Sha256Update(coinbase, extranonce1.data(), extranonce1.size());
+    Sha256Update(coinbase, extranonce2, extranonce2_size);
+    Sha256Update(coinbase, job.coinbase2.data(), job.coinbase2.size());
+    uint8_t root[kSha256Bytes];
+    Sha256dFinish(coinbase, root);
+
+    for (size_t offset = 0; offset < job.branches.size(); offset += kSha256Bytes) {
+        Sha256State node;
+        Sha256Init(node);
+        Sha256Update(node, root, sizeof(root));
+        Sha256Update(node, job.branches.data() + offset, kSha256Bytes);
+        Sha256dFinish(node, root);
+    }
+
+    uint8_t header[kHeaderBytes];
+    memcpy(header, job.header, sizeof(header));
+    memcpy(header + 36, root, sizeof(root));
+
+    // The first header a miner gets replaces whatever it was doing
+    const bool clean = session->header_generation == 0 || session->header_generation < clean_generation;
+    session->header_generation = job_generation;
+    SendToMiner(session, "{\"id\":null,\"method\":\"mining.notify_header\",\"params\":[\"" + job.job_id + "\",\"" +
+                             ToHex(header, sizeof(header)) + "\",\"" + ToHex(extranonce2, extranonce2_size) +
+                             "\",\"" + job.ntime + "\"," + (clean ? "true" : "false") + "]}");
+
+    const unsigned long elapsed_us = micros() - started_us;
+    stats.headers++;
+    stats.build_us_total += elapsed_us;
+    stats.build_us_max = max(stats.build_us_max, elapsed_us);
+}
+}
+
+void AnswerHeaderSubscribe(MinerSession* session, const String& id) {
+    if (!config.header_jobs) {
+        SendToMiner(session, "{\"id\":" + id + ",\"result\":false,\"error\":null}");
+        return;
+    }
+    session->header_jobs = true;
+    SendToMiner(session, "{\"id\":" + id + ",\"result\":true,\"error\":null}");
+    SignalTask(BuildHeaderJobs);
+}
+
+void NoteHeaderJob(bool clean_jobs) {
+    job_generation++;
+    if (clean_jobs) {
+        clean_generation = job_generation;
+    }
+    if (HeaderJobMinerCount() > 0) {
+        SignalTask(BuildHeaderJobs);
+    }
+}
+
+void BuildHeaderJobs() {
+    if (HeaderJobMinerCount() == 0) {
+        return;
+    }
+    if (template_generation != job_generation) {
+        template_generation = job_generation;
+        if (!ParseTemplate(CurrentPoolJob()) && CurrentPoolJob().length() > 0) {
+            LOG_ERROR("Cannot build header jobs from the current notify\n");
+        }
+    }
+    if (!job.valid) {
+        return;
+    }
+
+    size_t built = 0;
+    for (MinerSession* session : connected_miners) {
+        // Waits for its subscribe answer, which fixes its extranonce1
+        if (!session->header_jobs || session->header_generation == job_generation || session->extranonce_slot < 0) {
+            continue;
+        }
+        if (built == kHeadersPerRun) {
+            SignalTask(BuildHeaderJobs);
+            return;
+        }
+        SendHeaderJob(session);
+        built++;
+    }
+}
+
+size_t HeaderJobMinerCount() {
+    size_t count = 0;
+    for (const MinerSession* session : connected_miners) {
+        if (session->header_jobs) {
+            count++;
+        }
+    }
+    return count;
+}
+
+const HeaderJobStats& CurrentHeaderJobStats() {
+    return stats;
+}
@@ -0,0 +1,30 @@
+#pragma once
+
+#include <Arduino.h>
+
+#include "miner_session.h"
+
+// Ready-to-hash work for miners too small to build their own. A miner that
+// sends mining.header_subscribe gets, instead of mining.notify,
+//   mining.notify_header [job_id, header, extranonce2, ntime, clean_jobs]
+// where header is the 80-byte block header in hex with the nonce zeroed:
+// the proxy picks the extranonce2 and builds the coinbase and merkle root
+// for it. Shares come back as a normal mining.submit with that extranonce2.
+// Headers are built once per job for every such miner, a few per scheduler
+// run, with the coinbase prefix hashed once for all of them.
+
+struct HeaderJobStats {
+    unsigned long templates = 0;
+    unsigned long headers = 0;
+    unsigned long build_us_total = 0;
+    unsigned long build_us_max = 0;
+};
+
+void AnswerHeaderSubscribe(MinerSession* session, const String& id);
+// The job in job_cache.h changed; every header miner is due a new header
+void NoteHeaderJob(bool clean_jobs);
+// Scheduler task, signalled by the calls above
+void BuildHeaderJobs();
+
+size_t HeaderJobMinerCount();
+const HeaderJobStats& CurrentHeaderJobStats();
@@ -0,0 +1,181 @@
+#include "health_monitor.h"
+
+#include <algorithm>
+
+#if defined(ESP32)
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+#endif
+
+#include "app_context.h"
+#include "job_tracker.h"
+#include "log.h"
+#include "miner_admission.h"
+#include "scheduler.h"
+#include "sv2_upstream.h"
+
+bool log_quiet = false;
+
+namespace {
+constexpr unsigned long kSampleIntervalMs = 1000;
+constexpr uint8_t kRecoverSamples = 5;
+
+#if defined(ESP32)
+// Tasks whose stacks are sized by hand; any that does not exist is skipped
+const char* const kWatchedTasks[kMaxStackMarks] = {"loopTask", "async_tcp", "oled"};
+#endif
+
+HealthStats stats;
+unsigned long last_sample_ms = 0;
+uint8_t calm_samples = 0;
+
+void SampleHeap() {
+    stats.free_heap = ESP.getFreeHeap();
+#if defined(ESP32)
+    stats.largest_block = ESP.getMaxAllocHeap();
+    stats.min_free_heap = ESP.getMinFreeHeap();
+#elif defined(ESP8266)
+    stats.largest_block = ESP.getMaxFreeBlockSize();
+    stats.min_free_heap = stats.samples == 0 ? stats.free_heap : std::min(stats.min_free_heap, stats.free_heap);
+#else
+    stats.largest_block = stats.free_heap;
+    stats.min_free_heap = stats.samples == 0 ? stats.free_heap : std::min(stats.min_free_heap, stats.free_heap);
+#endif
+    stats.fragmentation =
+        stats.free_heap > 0 ? static_cast<uint8_t>(100 - static_cast<uint64_t>(stats.largest_block) * 100 / stats.free_heap)
+                            : 0;
+}
+
+void SampleStacks() {
+    stats.stack_count = 0;
+#if defined(ESP32)
+    for (const char* name : kWatchedTasks) {
+        TaskHandle_t task = xTaskGetHandle(name);
+        if (task == nullptr) {
+            continue;
+        }
+        TaskStackMark& mark = stats.stacks[stats.stack_count++];
+        mark.name = name;
+        // ESP-IDF reports the high-water mark in bytes, not words
+        mark.free_bytes = uxTaskGetStackHighWaterMark(task);
+    }
+#elif defined(ESP8266)
+    TaskStackMark& mark = stats.stacks[stats.stack_count++];
+    mark.name = "cont";
+    mark.free_bytes = ESP.getFreeContStack();
+#endif
+}
+
+// Level the current figures call for; loop lag only ever adds one step at
+// a time and stops short of turning miners away
+ShedLevel TargetLevel() {
+    uint8_t target = 0;
+
+    const uint32_t shed_heap = static_cast<uint32_t>(std::max(config.shed_heap_kb, 0)) * 1024;
+    if (shed_heap > 0 && stats.free_heap < shed_heap) {
+        target = 1;
+        if (stats.free_heap < shed_heap * 3 / 4) {
+            target = 2;
+        }
+        if (stats.free_heap < shed_heap / 2) {
+            target = 3;
+        }
+        if (stats.free_heap < shed_heap / 4) {
+            target = 4;
+        }
+    }
+
+    // No block big enough for another session: admitting one would fail anyway
+    const uint32_t session_budget = CurrentMinerAdmissionStats().session_budget;
+    if (session_budget > 0 && stats.largest_block < session_budget) {
+        target = std::max<uint8_t>(target, static_cast<uint8_t>(ShedLevel::kRefuseMiners));
+    }
+
+    if (config.shed_lag_ms > 0 && stats.loop_lag_window_ms > static_cast<unsigned long>(config.shed_lag_ms)) {
+        uint8_t lag_target = std::min<uint8_t>(static_cast<uint8_t>(stats.level) + 1,
+                                               static_cast<uint8_t>(ShedLevel::kNoDisplay));
+        target = std::max(target, lag_target);
+    }
+
+    return static_cast<ShedLevel>(target);
+}
+
+void ApplyLevel(ShedLevel level) {
+    if (level == stats.level) {
+        return;
+    }
+    if (level > stats.level) {
+        stats.shed_events++;
+    }
+    LOG_ERROR("Health: %s -> %s (%u bytes free, largest block %u, loop lag %lu ms)\n", ShedLevelName(stats.level),
+              ShedLevelName(level), static_cast<unsigned int>(stats.free_heap),
+              static_cast<unsigned int>(stats.largest_block), stats.loop_lag_window_ms);
+    stats.level = level;
+    log_quiet = level >= ShedLevel::kQuietLog;
+}
+}
+
+void UpdateHealth() {
+    const unsigned long now = millis();
+    // A low-priority task, so it is the first to feel the others running long
+    stats.loop_lag_ms = CurrentTaskLateMs();
+    stats.loop_lag_window_ms = std::max(stats.loop_lag_window_ms, stats.loop_lag_ms);
+    stats.loop_lag_peak_ms = std::max(stats.loop_lag_peak_ms, stats.loop_lag_ms);
+
+    if (stats.samples > 0 && now - last_sample_ms < kSampleIntervalMs) {
+        return;
+    }
+    last_sample_ms = now;
+
+    SampleHeap();
+    SampleStacks();
+    stats.samples++;
+
+    const ShedLevel target = TargetLevel();
+    if (target > stats.level) {
+        calm_samples = 0;
+        ApplyLevel(static_cast<ShedLevel>(static_cast<uint8_t>(stats.level) + 1));
+    } else if (target < stats.level) {
+        if (++calm_samples >= kRecoverSamples) {
+            calm_samples = 0;
+            ApplyLevel(static_cast<ShedLevel>(static_cast<uint8_t>(stats.level) - 1));
+        }
+    } else {
+        calm_samples = 0;
+    }
+
+    if (stats.level >= ShedLevel::kDropJobs) {
+        stats.jobs_dropped += DropRetiredPoolJobs();
+        stats.jobs_dropped += Sv2DropQueuedJobs();
+    }
+
+    stats.loop_lag_window_ms = 0;
+}
+
+ShedLevel CurrentShedLevel() {
+    return stats.level;
+}
+
+bool IsShedding(ShedLevel level) {
+    return stats.level >= level;
+}
+
+const char* ShedLevelName(ShedLevel level) {
+    switch (level) {
+        case ShedLevel::kNone:
+            return "normal";
+        case ShedLevel::kQuietLog:
+            return "quiet_log";
+        case ShedLevel::kNoDisplay:
+            return "no_display";
+        case ShedLevel::kRefuseMiners:
+            return "refuse_miners";
+        case ShedLevel::kDropJobs:
+            return "drop_jobs";
+    }
+    return "unknown";
+}
+
+const HealthStats& CurrentHealthStats() {
+    return stats;
+}
@@ -0,0 +1,48 @@
+#pragma once
+
+#include <Arduino.h>
+
+// Samples heap, stack and scheduler timing once a second and sheds load step
+// by step when the heap runs low, fragments, or the tasks fall behind. Each
+// level keeps everything the one below it does:
+//   1  mute info and debug logging
+//   2  stop OLED updates
+//   3  refuse new miners (they are redirected like on a full proxy)
+//   4  drop jobs that no longer have work riding on them
+// A level is added per sample while pressure lasts and taken away after
+// five calm samples in a row, so a brief dip does not flap.
+
+enum class ShedLevel : uint8_t { kNone, kQuietLog, kNoDisplay, kRefuseMiners, kDropJobs };
+
+struct TaskStackMark {
+    const char* name = "";
+    // Least stack the task has had left since it started
+    uint32_t free_bytes = 0;
+};
+
+constexpr size_t kMaxStackMarks = 3;
+
+struct HealthStats {
+    uint32_t free_heap = 0;
+    uint32_t min_free_heap = 0;
+    uint32_t largest_block = 0;
+    uint8_t fragmentation = 0;  // percent of free heap outside the largest block
+    // How late the scheduler started this monitor's task past its due time
+    unsigned long loop_lag_ms = 0;
+    unsigned long loop_lag_window_ms = 0;  // worst in the last sample period
+    unsigned long loop_lag_peak_ms = 0;
+    TaskStackMark stacks[kMaxStackMarks];
+    size_t stack_count = 0;
+    ShedLevel level = ShedLevel::kNone;
+    unsigned long samples = 0;
+    unsigned long shed_events = 0;
+    unsigned long jobs_dropped = 0;
+};
+
+// Scheduler task; samples once a second however often it runs
+void UpdateHealth();
+ShedLevel CurrentShedLevel();
+bool IsShedding(ShedLevel level);
+
+const char* ShedLevelName(ShedLevel level);
+const HealthStats& CurrentHealthStats();
@@ -0,0 +1,139 @@
+#include "host_lookup.h"
+
+#if defined(ESP32) || defined(YUMA_HOST)
+#include <WiFi.h>
+#elif defined(ESP8266)
+#include <ESP8266WiFi.h>
+#endif
+
+#include "dns_wire.h"
+#include "log.h"
+
+namespace {
+constexpr uint16_t kDnsPort = 53;
+constexpr unsigned long kDnsTimeoutMs = 1500;
+constexpr uint8_t kDnsMaxAttempts = 2;
+
+// The first A record in an answer to id; returns -1 for a packet that is
+// not one, 0 for an answer without an address
+int ParseAddress(const uint8_t* data, size_t len, uint16_t id, IPAddress& address) {
+    if (!Dns::IsResponseTo(data, len, id)) {
+        return -1;
+    }
+    if ((data[3] & 0x0F) != 0) {
+        return 0;
+    }
+
+    uint16_t questions = Dns::ReadU16(data + 4);
+    uint16_t answers = Dns::ReadU16(data + 6);
+    size_t pos = Dns::kHeaderSize;
+    for (uint16_t i = 0; i < questions; ++i) {
+        if (!Dns::SkipName(data, len, pos)) {
+            return 0;
+        }
+        pos += 4;
+    }
+
+    for (uint16_t i = 0; i < answers && pos < len; ++i) {
+        if (!Dns::SkipName(data, len, pos) || pos + 10 > len) {
+            break;
+        }
+        uint16_t type = Dns::ReadU16(data + pos);
+        uint16_t klass = Dns::ReadU16(data + pos + 2);
+        uint16_t rdlength = Dns::ReadU16(data + pos + 8);
+        pos += 10;
+        if (pos + rdlength > len) {
+            break;
+        }
+        if (type == Dns::kTypeA && klass == Dns::kClassIn && rdlength == 4) {
+            address = IPAddress(data[pos], data[pos + 1], data[pos + 2], data[pos + 3]);
+            return 1;
+        }
+        pos += rdlength;
+    }
+    return 0;
+}
+}
+
+void HostLookup::Start(const String& host) {
+    host_ = host;
+    attempts_ = 0;
+    if (address_.fromString(host_)) {
+        state_ = State::kDone;
+        return;
+    }
+    state_ = State::kPending;
+    SendQuery();
+}
+
+void HostLookup::SendQuery() {
+    IPAddress dns_server = WiFi.dnsIP();
+    if (static_cast<uint32_t>(dns_server) == 0) {
+        state_ = State::kFailed;
+        return;
+    }
+    if (!socket_open_) {
+        socket_open_ = udp_.begin(0);
+        if (!socket_open_) {
+            state_ = State::kFailed;
+            return;
+        }
+    }
+
+    uint8_t packet[300];
+    query_id_ = static_cast<uint16_t>(random(1, 0xFFFF));
+    size_t len = Dns::EncodeQuery(packet, sizeof(packet), host_.c_str(), query_id_, Dns::kTypeA, true);
+    if (len == 0) {
+        LOG_ERROR("Host %s cannot be encoded as a DNS query\n", host_.c_str());
+        state_ = State::kFailed;
+        return;
+    }
+
+    udp_.beginPacket(dns_server, kDnsPort);
+    udp_.write(packet, len);
+    udp_.endPacket();
+    sent_ms_ = millis();
+    attempts_++;
+}
+
+HostLookup::State HostLookup::Update() {
+    if (state_ != State::kPending) {
+        return state_;
+    }
+
+    int size = udp_.parsePacket();
+    if (size <= 0) {
+        if (millis() - sent_ms_ >= kDnsTimeoutMs) {
+            if (attempts_ < kDnsMaxAttempts) {
+                SendQuery();
+            } else {
+                state_ = State::kFailed;
+            }
+        }
+        return state_;
+    }
+
+    uint8_t packet[512];
+    size_t len = udp_.read(packet, sizeof(packet));
+    int found = ParseAddress(packet, len, query_id_, address_);
+    if (found > 0) {
+        state_ = State::kDone;
+    } else if (found == 0) {
+        state_ = State::kFailed;
+    }
+    return state_;
+}
+
+void HostLookup::Cancel() {
+    state_ = State::kIdle;
+}
+
+bool ConnectWithTimeout(WiFiClient& client, const IPAddress& address, uint16_t port, unsigned long timeout_ms) {
+#if defined(ESP32) || defined(YUMA_HOST)
+    return client.connect(address, port, static_cast<int32_t>(timeout_ms));
+#elif defined(ESP8266)
+    // The ESP8266 core bounds connect() by the stream timeout
+    client.setTimeout(timeout_ms);
+    return client.connect(address, port);
+#endif
+}
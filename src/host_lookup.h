@@ -0,0 +1,40 @@
+#pragma once
+
+#include <Arduino.h>
+#include <IPAddress.h>
+#include <WiFiClient.h>
+#include <WiFiUdp.h>
+
+// Resolves one host name to an IPv4 address without blocking: the A query
+// goes to the Wi-Fi DNS server and the owner polls for the answer from its
+// task, the way the pool resolver does for the pool host. Dotted addresses
+// finish at once. For connections other than the live pool link, such as a
+// handover or a probe, which must not stall the loop on hostByName().
+class HostLookup {
+public:
+    enum class State : uint8_t { kIdle, kPending, kDone, kFailed };
+
+    void Start(const String& host);
+    // Call until it is no longer kPending
+    State Update();
+    void Cancel();
+
+    State state() const { return state_; }
+    const IPAddress& address() const { return address_; }
+
+private:
+    void SendQuery();
+
+    WiFiUDP udp_;
+    bool socket_open_ = false;
+    String host_;
+    IPAddress address_;
+    State state_ = State::kIdle;
+    uint16_t query_id_ = 0;
+    uint8_t attempts_ = 0;
+    unsigned long sent_ms_ = 0;
+};
+
+// Connects by address, giving up after timeout_ms instead of the core's
+// default of several seconds
+bool ConnectWithTimeout(WiFiClient& client, const IPAddress& address, uint16_t port, unsigned long timeout_ms);
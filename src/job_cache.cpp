@@ -0,0 +1,115 @@
+#include "job_cache.h"
+
+#include <ArduinoJson.h>
+
+#include "app_context.h"
+#include "header_jobs.h"
+#include "log.h"
+#include "platform_fs.h"
+#include "pool_split.h"
+#include "scheduler.h"
+#include "storage.h"
+#include "stratum_server.h"
+
+namespace {
+constexpr char kJobCachePath[] = "/job_cache.json";
+constexpr size_t kJsonDocOverhead = 512;
+
+String session_id;
+String difficulty_line;
+String job_line;
+}
+
+void RememberPoolDifficulty(const String& line) {
+    difficulty_line = line;
+}
+
+void RememberPoolJob(const String& line) {
+    job_line = line;
+}
+
+void SendCurrentJob(MinerSession* session) {
+    if (difficulty_line.length() > 0) {
+        SendToMiner(session, difficulty_line);
+        session->difficulty = metrics.current_difficulty;
+    }
+    // A header miner's job is built for it on the scheduler
+    if (session->header_jobs) {
+        SignalTask(BuildHeaderJobs);
+    } else if (job_line.length() > 0) {
+        SendToMiner(session, job_line);
+    }
+}
+
+const String& CurrentPoolJob() {
+    return job_line;
+}
+
+String ResumableSessionId() {
+    return session_id;
+}
+
+void NoteUpstreamSession(const String& extranonce1) {
+    if (session_id.length() > 0 && extranonce1 == session_id) {
+        LOG_INFO("Pool resumed session %s, keeping the current job\n", session_id.c_str());
+    } else {
+        // The old job was built for someone else's extranonce1
+        difficulty_line = "";
+        job_line = "";
+    }
+    session_id = extranonce1;
+}
+
+bool SaveJobCache() {
+    if (session_id.length() == 0 || job_line.length() == 0 || !EnsureStorageMounted()) {
+        return false;
+    }
+
+    DynamicJsonDocument doc(kJsonDocOverhead + session_id.length() + difficulty_line.length() + job_line.length());
+    // A job from the alternate pool of a split is dropped at boot, which starts on the primary
+    doc["pool_host"] = ActivePool().host;
+    doc["pool_port"] = ActivePool().port;
+    doc["session_id"] = session_id;
+    doc["difficulty"] = difficulty_line;
+    doc["job"] = job_line;
+
+    File file = STORAGE_FS.open(kJobCachePath, "w");
+    if (!file) {
+        LOG_ERROR("Failed to open job cache for writing\n");
+        return false;
+    }
+    size_t written = serializeJson(doc, file);
+    file.close();
+
+    if (written == 0) {
+        LOG_ERROR("Failed to write job cache\n");
+        return false;
+    }
+    LOG_INFO("Job cache saved (%u bytes)\n", static_cast<unsigned int>(written));
+    return true;
+}
+
+bool LoadJobCache() {
+    if (!EnsureStorageMounted() || !STORAGE_FS.exists(kJobCachePath)) {
+        return false;
+    }
+
+    File file = STORAGE_FS.open(kJobCachePath, "r");
+    if (!file) {
+        return false;
+    }
+    DynamicJsonDocument doc(kJsonDocOverhead + file.size() * 2);
+    DeserializationError err = deserializeJson(doc, file);
+    file.close();
+    STORAGE_FS.remove(kJobCachePath);
+
+    if (err || String(ActivePool().host) != (doc["pool_host"] | "") || ActivePool().port != (doc["pool_port"] | 0)) {
+        return false;
+    }
+
+    session_id = doc["session_id"] | "";
+    difficulty_line = doc["difficulty"] | "";
+    job_line = doc["job"] | "";
+    LOG_INFO("Job cache loaded, will ask the pool to resume session %s\n", session_id.c_str());
+    return session_id.length() > 0;
+}
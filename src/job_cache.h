@@ -0,0 +1,28 @@
+#pragma once
+
+#include <Arduino.h>
+
+#include "miner_session.h"
+
+// The difficulty and job currently in force upstream. A miner gets both as
+// soon as its subscribe is answered instead of idling until the next
+// notify, and a planned reboot saves them so the proxy can resume the same
+// pool session afterwards.
+
+void RememberPoolDifficulty(const String& line);
+void RememberPoolJob(const String& line);
+void SendCurrentJob(MinerSession* session);
+// The mining.notify line in force, empty if none
+const String& CurrentPoolJob();
+
+// Extranonce1 to offer in mining.subscribe so the pool can resume the
+// session; empty when there is nothing to resume
+String ResumableSessionId();
+// Called with the pool's subscribe result. A session that did not resume
+// invalidates the remembered job.
+void NoteUpstreamSession(const String& extranonce1);
+
+// Persisted only for planned reboots; a load consumes the file so a crash
+// loop never replays an old job
+bool SaveJobCache();
+bool LoadJobCache();
@@ -0,0 +1,64 @@
+#include "job_tracker.h"
+
+#include <algorithm>
+#include <vector>
+
+namespace {
+// Pools rarely keep more than a handful of jobs alive between clean notifies
+constexpr size_t kMaxTrackedJobs = 32;
+
+struct TrackedJob {
+    String job_id;
+    uint32_t epoch;
+};
+
+// Oldest first; a job belongs to the epoch of the clean notify before it
+std::vector<TrackedJob> jobs;
+uint32_t epoch = 0;
+
+TrackedJob* FindJob(const String& job_id) {
+    for (TrackedJob& job : jobs) {
+        if (job.job_id == job_id) {
+            return &job;
+        }
+    }
+    return nullptr;
+}
+}
+
+void TrackPoolJob(const String& job_id, bool clean_jobs) {
+    if (clean_jobs) {
+        epoch++;
+    }
+
+    TrackedJob* existing = FindJob(job_id);
+    if (existing) {
+        existing->epoch = epoch;
+        return;
+    }
+
+    if (jobs.size() >= kMaxTrackedJobs) {
+        jobs.erase(jobs.begin());
+    }
+    jobs.push_back({job_id, epoch});
+}
+
+bool IsPoolJobStale(const String& job_id) {
+    const TrackedJob* job = FindJob(job_id);
+    return job && job->epoch != epoch;
+}
+
+void ResetPoolJobs() {
+    jobs.clear();
+    epoch = 0;
+}
+
+size_t DropRetiredPoolJobs() {
+    const size_t before = jobs.size();
+    jobs.erase(std::remove_if(jobs.begin(), jobs.end(), [](const TrackedJob& job) { return job.epoch != epoch; }),
+               jobs.end());
+    if (jobs.size() != before) {
+        jobs.shrink_to_fit();
+    }
+    return before - jobs.size();
+}
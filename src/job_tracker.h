@@ -0,0 +1,16 @@
+#pragma once
+
+#include <Arduino.h>
+
+// Remembers which upstream job ids are still worth hashing. A notify with
+// clean_jobs set retires every job seen before it, so submits against those
+// can be answered here instead of costing a round trip and a pool reject.
+
+void TrackPoolJob(const String& job_id, bool clean_jobs);
+// True only for jobs a later clean_jobs notify retired; unknown ids are
+// left for the pool to judge
+bool IsPoolJobStale(const String& job_id);
+void ResetPoolJobs();
+// Forgets retired jobs to free their memory; submits against them then go to
+// the pool like any unknown job. Returns how many were dropped.
+size_t DropRetiredPoolJobs();
@@ -0,0 +1,52 @@
+#pragma once
+
+#include <Arduino.h>
+
+// Serial logging by level. Calls above YUMA_LOG_LEVEL compile away together
+// with their arguments, so neither the format strings nor the String work
+// to build them end up in the image:
+//   0  silent
+//   1  errors and failures
+//   2  plus connection and lifecycle events
+//   3  plus every stratum line and share result (default)
+// Info and debug output also stops while log_quiet is set, which the health
+// monitor does when it sheds load.
+#ifndef YUMA_LOG_LEVEL
+#define YUMA_LOG_LEVEL 3
+#endif
+
+#if YUMA_LOG_LEVEL >= 1
+#define LOG_ERROR(...) Serial.printf(__VA_ARGS__)
+#else
+#define LOG_ERROR(...) \
+    do {               \
+    } while (0)
+#endif
+
+extern bool log_quiet;
+
+#if YUMA_LOG_LEVEL >= 2
+#define LOG_INFO(...)                   \
+    do {                                \
+        if (!log_quiet) {               \
+            Serial.printf(__VA_ARGS__); \
+        }                               \
+    } while (0)
+#else
+#define LOG_INFO(...) \
+    do {              \
+    } while (0)
+#endif
+
+#if YUMA_LOG_LEVEL >= 3
+#define LOG_DEBUG(...)                  \
+    do {                                \
+        if (!log_quiet) {               \
+            Serial.printf(__VA_ARGS__); \
+        }                               \
+    } while (0)
+#else
+#define LOG_DEBUG(...) \
+    do {               \
+    } while (0)
+#endif
@@ -7,16 +7,112 @@
 #endif
 
 #include "app_context.h"
+#include "boot_cache.h"
+#include "cluster.h"
+#include "config_defaults.h"
 #include "config_manager.h"
+#include "config_reload.h"
+#include "header_jobs.h"
+#include "health_monitor.h"
+#include "job_cache.h"
+#include "log.h"
 #include "mdns_service.h"
+#include "metrics_endpoint.h"
+#include "ota_update.h"
 #include "pool_client.h"
+#include "pool_handover.h"
+#include "pool_probe.h"
+#include "pool_resolver.h"
+#include "pool_split.h"
+#include "power_policy.h"
+#include "scheduler.h"
 #include "status_display.h"
+#include "stratum_capture.h"
 #include "storage.h"
 #include "stratum_server.h"
 #include "web_interface.h"
 #include "wifi_setup.h"
 
 static bool services_initialized = false;
+// Time a WiFi reconnect gets before it is reported failed and started over
+static constexpr unsigned long kWifiReconnectWaitMs = 15000;
+
+static void StartServices() {
+    SetupMDNS();
+#ifdef YUMA_HEADLESS
+    SetupMetricsEndpoint(ConfigDefaults::kMetricsPort);
+#else
+    SetupWebServer();
+#endif
+    SetupStratumServer();
+    services_initialized = true;
+}
+
+// Non-blocking: a reconnect is started here and finished on later runs
+static void MaintainWifi() {
+    static unsigned long reconnect_started_ms = 0;
+    static bool reconnecting = false;
+
+    if (WiFi.status() == WL_CONNECTED) {
+        if (reconnecting) {
+            reconnecting = false;
+            LOG_INFO("WiFi reconnected!\n");
+            DebugWifiStatus();
+        }
+        // Initialize services once WiFi is connected
+        if (!services_initialized) {
+            LOG_INFO("WiFi connected! Initializing services...\n");
+            StartServices();
+            LOG_INFO("Services initialized!\n");
+        }
+        return;
+    }
+
+    if (reconnecting && millis() - reconnect_started_ms < kWifiReconnectWaitMs) {
+        return;
+    }
+    if (reconnecting) {
+        LOG_ERROR("Failed to reconnect automatically\n");
+        LOG_INFO("To reconfigure WiFi, restart device or call ResetWifiSettings()\n");
+    }
+
+    LOG_INFO("WiFi disconnected (status: %d), attempting reconnection...\n", WiFi.status());
+    // Try to reconnect with saved credentials
+    WiFi.begin();
+    reconnect_started_ms = millis();
+    reconnecting = true;
+}
+
+static void RegisterTasks() {
+    // Stratum traffic first; housekeeping fills the time in between. The
+    // budget is for reading the link: a run that dials the pool (up to 1 s,
+    // 5 s for a TLS handshake) is the one expected overrun
+    AddTask("pool", ServicePoolLink, 5, 20000, TaskPriority::kHigh);
+    // Signalled from the miner socket callbacks
+    AddTask("stratum", ServiceMinerSessions, 100, 20000, TaskPriority::kHigh);
+    AddTask("handover", UpdatePoolHandover, 10, 20000, TaskPriority::kHigh);
+    // Signalled per job; behind the pool link so fan-out to the rest goes first
+    AddTask("headers", BuildHeaderJobs, 100, 10000, TaskPriority::kNormal);
+    AddTask("wifi", MaintainWifi, 1000, 5000, TaskPriority::kNormal);
+    AddTask("config", UpdateConfigReload, 100, 20000, TaskPriority::kNormal);
+    AddTask("resolver", UpdatePoolResolver, 100, 5000, TaskPriority::kNormal);
+    AddTask("split", UpdatePoolSplit, 1000, 20000, TaskPriority::kNormal);
+#ifndef YUMA_HEADLESS
+    // Signalled as upload data arrives
+    AddTask("ota", ServiceOtaUpdate, 100, 50000, TaskPriority::kNormal);
+    // Started from /test_pool; polls the probed pool every 5 ms while it runs
+    AddTask("probe", UpdatePoolProbe, 5, 20000, TaskPriority::kNormal);
+#endif
+    AddTask("health", UpdateHealth, 100, 2000, TaskPriority::kLow);
+    AddTask("power", UpdatePowerPolicy, 1000, 1000, TaskPriority::kLow);
+#ifdef USE_OLED_STATUS
+    AddTask("display", UpdateStatusDisplay, 100, 10000, TaskPriority::kLow);
+#endif
+    AddTask("miners", HandleMinerConnections, 1000, 2000, TaskPriority::kLow);
+    AddTask("cluster", UpdateCluster, 100, 5000, TaskPriority::kLow);
+    AddTask("capture", [] { FlushStratumCapture(); }, 100, 20000, TaskPriority::kLow);
+    AddTask("mdns", UpdateMDNS, 100, 2000, TaskPriority::kLow);
+}
 
 void setup() {
     Serial.begin(115200);
@@ -31,80 +127,29 @@ void setup() {
     metrics.uptime_start = millis();
 
     if (!SetupStorage()) {
-        Serial.println("Storage initialization failed; continuing with defaults");
+        LOG_ERROR("Storage initialization failed; continuing with defaults\n");
     }
 
     LoadConfig(config);
+    InitConfigReload();
+    LoadBootCache();
+    LoadJobCache();
     SetupWifi();
+    metrics.boot_wifi_ms = millis();
+    LOG_INFO("Boot phase: WiFi up after %lu ms (%s)\n", metrics.boot_wifi_ms,
+             metrics.boot_fast_wifi ? "fast path" : "full association");
 
     // Only setup services after WiFi is connected
     if (WiFi.status() == WL_CONNECTED) {
-        SetupMDNS();
-        SetupWebServer();
-        SetupStratumServer();
-        services_initialized = true;
-        Serial.println("System initialized!");
+        StartServices();
+        LOG_INFO("System initialized!\n");
     } else {
-        Serial.println("WiFi not connected, services will start after connection");
+        LOG_INFO("WiFi not connected, services will start after connection\n");
     }
+
+    RegisterTasks();
 }
 
 void loop() {
-    static unsigned long last_wifi_check = 0;
-
-    if (WiFi.status() != WL_CONNECTED && millis() - last_wifi_check > 10000) {
-        last_wifi_check = millis();
-        Serial.printf("WiFi disconnected (status: %d), attempting reconnection...\n", WiFi.status());
-
-        // Try to reconnect with saved credentials
-        WiFi.begin();
-
-        // Wait for connection with timeout
-        int attempts = 0;
-        while (WiFi.status() != WL_CONNECTED && attempts < 30) {
-            delay(500);
-            Serial.print(".");
-            attempts++;
-        }
-
-        if (WiFi.status() == WL_CONNECTED) {
-            Serial.println("\nWiFi reconnected!");
-            DebugWifiStatus();
-        } else {
-            Serial.println("\nFailed to reconnect automatically");
-            Serial.println("To reconfigure WiFi, restart device or call ResetWifiSettings()");
-        }
-        return;
-    }
-
-    // Initialize services once WiFi is connected
-    if (!services_initialized && WiFi.status() == WL_CONNECTED) {
-        Serial.println("WiFi connected! Initializing services...");
-        SetupMDNS();
-        SetupWebServer();
-        SetupStratumServer();
-        services_initialized = true;
-        Serial.println("Services initialized!");
-    }
-
-    if (ShouldConnectToPool() && !pool_client.connected()) {
-        ConnectToPool();
-    }
-
-    if (pool_client.connected() && connected_miners.empty()) {
-        DisconnectFromPool();
-    }
-
-    if (pool_client.connected()) {
-        HandlePoolData();
-    }
-
-#ifdef USE_OLED_STATUS
-    UpdateStatusDisplay();
-#endif
-
-    HandleMinerConnections();
-    UpdateMDNS();
-
-    delay(100);
+    RunScheduler();
 }
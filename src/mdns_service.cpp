@@ -2,7 +2,7 @@
 
 #include <Arduino.h>
 
-#if defined(ESP32)
+#if defined(ESP32) || defined(YUMA_HOST)
 #include <WiFi.h>
 #include <ESPmDNS.h>
 #elif defined(ESP8266)
@@ -11,38 +11,81 @@
 #endif
 
 #include "app_context.h"
+#include "log.h"
+#include "miner_admission.h"
 
-void SetupMDNS() {
+namespace {
+constexpr unsigned long kLoadTxtIntervalMs = 1000;
+
+bool mdns_started = false;
+unsigned long last_load_txt_ms = 0;
+String published_load;
+
+// Read by cluster.cpp on the other proxies. Only rewritten when it changes,
+// since every rewrite makes the responder announce the service again
+void PublishLoad() {
+    String miners(static_cast<unsigned int>(connected_miners.size()));
+    String capacity(static_cast<unsigned int>(CurrentMinerAdmissionStats().capacity));
+    // In KB, rounded down to 8 KB so allocator noise does not count as a change
+    String heap(static_cast<unsigned int>(ESP.getFreeHeap() / 8192 * 8));
+    // A proxy without miners has no reason to hold a pool link open
+    const char* pool = metrics.pool_connected ? "up" : connected_miners.empty() ? "idle" : "down";
+
+    String load = miners + "," + capacity + "," + heap + "," + pool;
+    if (load == published_load) {
+        return;
+    }
+    published_load = load;
+
+    MDNS.addServiceTxt("stratum", "tcp", "miners", miners.c_str());
+    MDNS.addServiceTxt("stratum", "tcp", "capacity", capacity.c_str());
+    MDNS.addServiceTxt("stratum", "tcp", "heap", heap.c_str());
+    MDNS.addServiceTxt("stratum", "tcp", "pool", pool);
+}
+}
+
+void SetupMDNS(uint16_t stratum_port) {
     // Initialize mDNS responder
     if (!MDNS.begin("yuma")) {
-        Serial.println("Error setting up MDNS responder!");
+        LOG_ERROR("Error setting up MDNS responder!\n");
         return;
     }
+    mdns_started = true;
 
-    Serial.println("mDNS responder started");
-    Serial.println("Device available at: yuma.local");
+    LOG_INFO("mDNS responder started\n");
+    LOG_INFO("Device available at: yuma.local\n");
 
+#ifndef YUMA_HOST
     // Add service descriptions
     MDNS.addService("http", "tcp", 80);
     MDNS.addServiceTxt("http", "tcp", "device", "YUMA Stratum Proxy");
     MDNS.addServiceTxt("http", "tcp", "version", "1.0");
     MDNS.addServiceTxt("http", "tcp", "board", GetBoardName());
+#endif
 
     // Add Stratum service
-    MDNS.addService("stratum", "tcp", 3333);
+    MDNS.addService("stratum", "tcp", stratum_port);
     MDNS.addServiceTxt("stratum", "tcp", "device", "YUMA Stratum Proxy");
     MDNS.addServiceTxt("stratum", "tcp", "protocol", "stratum+tcp");
     MDNS.addServiceTxt("stratum", "tcp", "version", "1.0");
+    PublishLoad();
 
-    Serial.println("mDNS services registered:");
-    Serial.println("  - HTTP: http://yuma.local/");
-    Serial.println("  - Stratum: stratum+tcp://yuma.local:3333");
+    LOG_INFO("mDNS services registered:\n");
+#ifndef YUMA_HOST
+    LOG_INFO("  - HTTP: http://yuma.local/\n");
+#endif
+    LOG_INFO("  - Stratum: stratum+tcp://yuma.local:%u\n", static_cast<unsigned int>(stratum_port));
 }
 
 void UpdateMDNS() {
-#if defined(ESP8266)
-    // ESP8266 requires periodic update
+#if defined(ESP8266) || defined(YUMA_HOST)
+    // ESP8266 requires periodic update; the host responder is polled too
     MDNS.update();
 #endif
     // ESP32 handles mDNS updates automatically
-}
\ No newline at end of file
+
+    if (mdns_started && millis() - last_load_txt_ms >= kLoadTxtIntervalMs) {
+        last_load_txt_ms = millis();
+        PublishLoad();
+    }
+}
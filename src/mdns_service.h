@@ -1,4 +1,8 @@
 #pragma once
 
-void SetupMDNS();
-void UpdateMDNS();
\ No newline at end of file
+#include <Arduino.h>
+
+#include "config_defaults.h"
+
+void SetupMDNS(uint16_t stratum_port = ConfigDefaults::kStratumPort);
+void UpdateMDNS();
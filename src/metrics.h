@@ -5,6 +5,7 @@
 struct Metrics {
     unsigned long shares_ok = 0;
     unsigned long shares_bad = 0;
+    unsigned long shares_stale = 0;
     unsigned long jobs_received = 0;
     unsigned long uptime_start = 0;
     bool pool_connected = false;
@@ -12,4 +13,13 @@ struct Metrics {
     String last_job_id = "";
     unsigned long last_share_time = 0;
     int connected_miners_count = 0;
+    unsigned long miners_reaped_idle = 0;
+    unsigned long miners_reaped_ack = 0;
+    unsigned long boot_wifi_ms = 0;
+    unsigned long boot_pool_ms = 0;
+    unsigned long boot_first_notify_ms = 0;
+    bool boot_fast_wifi = false;
+    bool boot_cached_pool = false;
+    unsigned long pool_bytes_rx = 0;
+    unsigned long pool_bytes_tx = 0;
 };
@@ -0,0 +1,108 @@
+#include "metrics_endpoint.h"
+
+#include <cmath>
+
+#if defined(ESP32) || defined(YUMA_HOST)
+#include <WiFi.h>
+#include <AsyncTCP.h>
+#elif defined(ESP8266)
+#include <ESP8266WiFi.h>
+#include <ESPAsyncTCP.h>
+#endif
+
+#include "app_context.h"
+#include "health_monitor.h"
+#include "log.h"
+#include "miner_admission.h"
+
+namespace {
+constexpr char kResponseHeader[] =
+    "HTTP/1.0 200 OK\r\n"
+    "Content-Type: application/octet-stream\r\n"
+    "Connection: close\r\n"
+    "Content-Length: 60\r\n"
+    "\r\n";
+static_assert(kMetricsRecordSize == 60, "update Content-Length in kResponseHeader");
+
+constexpr uint32_t kClientTimeoutS = 5;
+
+AsyncServer* metrics_server = nullptr;
+
+void PutU16(uint8_t* out, uint16_t value) {
+    out[0] = value & 0xFF;
+    out[1] = value >> 8;
+}
+
+void PutU32(uint8_t* out, uint32_t value) {
+    PutU16(out, static_cast<uint16_t>(value & 0xFFFF));
+    PutU16(out + 2, static_cast<uint16_t>(value >> 16));
+}
+
+uint16_t Clamp16(size_t value) {
+    return value > 0xFFFF ? 0xFFFF : static_cast<uint16_t>(value);
+}
+}
+
+size_t BuildMetricsRecord(uint8_t* out, size_t size) {
+    if (size < kMetricsRecordSize) {
+        return 0;
+    }
+
+    const MinerAdmissionStats& admission = CurrentMinerAdmissionStats();
+    const int32_t rssi = WiFi.status() == WL_CONNECTED ? WiFi.RSSI() : 0;
+
+    memset(out, 0, kMetricsRecordSize);
+    memcpy(out, "YUMA", 4);
+    PutU16(out + 4, kMetricsRecordVersion);
+    PutU16(out + 6, kMetricsRecordSize);
+    PutU32(out + 8, (millis() - metrics.uptime_start) / 1000);
+    PutU32(out + 12, ESP.getFreeHeap());
+    PutU16(out + 16, Clamp16(connected_miners.size()));
+    PutU16(out + 18, Clamp16(admission.capacity));
+    PutU32(out + 20, metrics.shares_ok);
+    PutU32(out + 24, metrics.shares_bad);
+    PutU32(out + 28, metrics.shares_stale);
+    PutU32(out + 32, metrics.jobs_received);
+    PutU32(out + 36, static_cast<uint32_t>(std::lround(metrics.current_difficulty)));
+    out[40] = metrics.pool_connected ? 0x01 : 0x00;
+    out[41] = static_cast<uint8_t>(static_cast<int8_t>(constrain(rssi, -128, 127)));
+    out[42] = static_cast<uint8_t>(CurrentShedLevel());
+    out[43] = CurrentHealthStats().fragmentation;
+    PutU32(out + 44, metrics.pool_bytes_rx);
+    PutU32(out + 48, metrics.pool_bytes_tx);
+    PutU32(out + 52, admission.refused);
+    PutU32(out + 56, metrics.miners_reaped_idle + metrics.miners_reaped_ack);
+    return kMetricsRecordSize;
+}
+
+void SetupMetricsEndpoint(uint16_t port) {
+    if (metrics_server != nullptr) {
+        delete metrics_server;
+    }
+    metrics_server = new AsyncServer(port);
+
+    metrics_server->onClient([](void* arg, AsyncClient* client) {
+        // A client that connects and never asks is closed by the library
+        client->setRxTimeout(kClientTimeoutS);
+        client->onDisconnect([](void* arg, AsyncClient* client) {
+            delete client;
+        }, nullptr);
+
+        // Whatever the request line says, the answer is the record
+        client->onData([](void* arg, AsyncClient* client, void* data, size_t len) {
+            if (client->disconnecting()) {
+                return;
+            }
+            uint8_t record[kMetricsRecordSize];
+            size_t record_len = BuildMetricsRecord(record, sizeof(record));
+            client->add(kResponseHeader, sizeof(kResponseHeader) - 1);
+            client->add(reinterpret_cast<const char*>(record), record_len);
+            client->send();
+            client->close();
+        }, nullptr);
+
+    }, nullptr);
+
+    metrics_server->begin();
+    LOG_INFO("Metrics endpoint started on port %u\n", static_cast<unsigned int>(port));
+}
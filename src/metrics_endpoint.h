@@ -0,0 +1,38 @@
+#pragma once
+
+#include <Arduino.h>
+
+// Binary counters for builds without the web dashboard. Any request on the
+// port, HTTP or not, is answered with a plain HTTP/1.0 response whose body is
+// one fixed little-endian record; scripts/read_metrics.py decodes it. Fields
+// are only ever appended, and the record carries its own size, so older
+// readers keep working.
+//
+//   off  size  field
+//     0     4  magic "YUMA"
+//     4     2  version (1)
+//     6     2  record size in bytes
+//     8     4  uptime, seconds
+//    12     4  free heap, bytes
+//    16     2  connected miners
+//    18     2  miner capacity
+//    20     4  shares accepted
+//    24     4  shares rejected
+//    28     4  shares stale
+//    32     4  jobs received
+//    36     4  pool difficulty, rounded
+//    40     1  flags, bit 0 pool connected
+//    41     1  Wi-Fi RSSI, dBm (signed)
+//    42     1  load shedding level (0 none to 4, see health_monitor.h)
+//    43     1  heap fragmentation, percent
+//    44     4  pool bytes received
+//    48     4  pool bytes sent
+//    52     4  miners refused, proxy full
+//    56     4  miners reaped (idle or unacknowledged)
+
+constexpr uint16_t kMetricsRecordVersion = 1;
+constexpr size_t kMetricsRecordSize = 60;
+
+void SetupMetricsEndpoint(uint16_t port);
+// Fills out with the current record; returns its size
+size_t BuildMetricsRecord(uint8_t* out, size_t size);
@@ -0,0 +1,151 @@
+#include "miner_admission.h"
+
+#include <algorithm>
+
+#if defined(ESP32) || defined(YUMA_HOST)
+#include <AsyncTCP.h>
+#elif defined(ESP8266)
+#include <ESPAsyncTCP.h>
+#endif
+
+#include "app_context.h"
+#include "async_lock.h"
+#include "cluster.h"
+#include "health_monitor.h"
+#include "log.h"
+#include "stratum_server.h"
+
+namespace {
+// Heap one subscribed miner costs: AsyncClient, session, line buffers and
+// the subscribe answer and first job still queued for it. This is only the
+// starting point (a TCP_MSS-sized lwIP send buffer plus a margin, rounded
+// up); every subscribe measures the real cost and the budget becomes a
+// running average of those samples.
+#if defined(ESP8266)
+constexpr uint32_t kSessionBudgetBytes = 4 * 1024;
+// Kept back at startup for the web UI, the pool link and a TLS handshake
+constexpr uint32_t kHeapReserveBytes = 20 * 1024;
+// Below this a burst of notifies can run the allocator dry
+constexpr uint32_t kHeapFloorBytes = 8 * 1024;
+#else
+constexpr uint32_t kSessionBudgetBytes = 8 * 1024;
+constexpr uint32_t kHeapReserveBytes = 48 * 1024;
+constexpr uint32_t kHeapFloorBytes = 16 * 1024;
+#endif
+// One extranonce slot per miner
+constexpr size_t kMaxMiners = 256;
+// Samples outside kSessionBudgetBytes divided or multiplied by this caught
+// someone else's allocation or free, and are ignored
+constexpr uint32_t kSampleSpread = 4;
+// A new sample moves the average by 1/kAverageWeight of the difference
+constexpr int32_t kAverageWeight = 8;
+
+// The accept callback reads the limits and counts refusals; the loop
+// measures sessions and reports
+AsyncLock stats_lock;
+MinerAdmissionStats stats;
+
+void UpdateCapacity() {
+    uint32_t usable = stats.startup_free_heap > kHeapReserveBytes ? stats.startup_free_heap - kHeapReserveBytes : 0;
+    stats.capacity = std::min<size_t>(usable / stats.session_budget, kMaxMiners);
+}
+
+void Refuse(AsyncClient* client) {
+    client->onDisconnect([](void* arg, AsyncClient* client) { delete client; }, nullptr);
+
+    String host = config.sibling_host;
+    uint16_t port = config.sibling_port > 0 ? config.sibling_port : 0;
+    IPAddress peer_address;
+    if ((host.length() == 0 || port == 0) && config.cluster_balance && LeastLoadedClusterPeer(peer_address, port)) {
+        host = peer_address.toString();
+    }
+
+    if (host.length() > 0 && port > 0) {
+        // Sent before subscribe; miners honour client.reconnect at any time
+        String reconnect = "{\"id\":null,\"method\":\"client.reconnect\",\"params\":[\"" + host + "\"," +
+                           String(port) + ",0]}\n";
+        client->write(reconnect.c_str(), reconnect.length());
+        {
+            AsyncLockGuard guard(stats_lock);
+            stats.redirected++;
+        }
+        LOG_INFO("Miner %s redirected to %s:%u, proxy full\n", client->remoteIP().toString().c_str(),
+                 host.c_str(), static_cast<unsigned int>(port));
+    } else {
+        LOG_INFO("Miner %s refused, proxy full\n", client->remoteIP().toString().c_str());
+    }
+    {
+        AsyncLockGuard guard(stats_lock);
+        stats.refused++;
+    }
+    client->close();
+}
+}
+
+void InitMinerAdmission() {
+    stats.startup_free_heap = ESP.getFreeHeap();
+    stats.session_budget = kSessionBudgetBytes;
+    stats.session_samples = 0;
+    UpdateCapacity();
+    LOG_INFO("Miner capacity: %u (%u bytes free, %u per session until measured)\n",
+             static_cast<unsigned int>(stats.capacity), static_cast<unsigned int>(stats.startup_free_heap),
+             static_cast<unsigned int>(stats.session_budget));
+}
+
+bool AdmitMiner(AsyncClient* client) {
+    size_t capacity;
+    uint32_t session_budget;
+    {
+        AsyncLockGuard guard(stats_lock);
+        capacity = stats.capacity;
+        session_budget = stats.session_budget;
+    }
+    if (!IsShedding(ShedLevel::kRefuseMiners) && MinerSessionCount() < capacity &&
+        ESP.getFreeHeap() >= kHeapFloorBytes + session_budget) {
+        return true;
+    }
+    Refuse(client);
+    return false;
+}
+
+void MeasureMinerSession(MinerSession* session) {
+    const uint32_t before = session->heap_at_accept;
+    session->heap_at_accept = 0;
+    const uint32_t free_heap = ESP.getFreeHeap();
+    if (before == 0 || free_heap >= before) {
+        return;
+    }
+    const uint32_t sample = before - free_heap;
+    if (sample < kSessionBudgetBytes / kSampleSpread || sample > kSessionBudgetBytes * kSampleSpread) {
+        return;
+    }
+
+    const size_t previous_capacity = stats.capacity;
+    {
+        AsyncLockGuard guard(stats_lock);
+        const int32_t step =
+            (static_cast<int32_t>(sample) - static_cast<int32_t>(stats.session_budget)) / kAverageWeight;
+        stats.session_budget = static_cast<uint32_t>(static_cast<int32_t>(stats.session_budget) + step);
+        stats.session_samples++;
+        UpdateCapacity();
+    }
+    if (stats.capacity != previous_capacity) {
+        LOG_INFO("Miner capacity: %u (%u bytes per session over %lu samples)\n",
+                 static_cast<unsigned int>(stats.capacity), static_cast<unsigned int>(stats.session_budget),
+                 stats.session_samples);
+    }
+}
+
+MinerAdmissionStats CurrentMinerAdmissionStats() {
+    MinerAdmissionStats copy;
+    {
+        AsyncLockGuard guard(stats_lock);
+        copy = stats;
+    }
+    uint32_t free_heap = ESP.getFreeHeap();
+    copy.measured_session_bytes = 0;
+    if (!connected_miners.empty() && free_heap < copy.startup_free_heap) {
+        copy.measured_session_bytes = (copy.startup_free_heap - free_heap) / connected_miners.size();
+    }
+    return copy;
+}
@@ -0,0 +1,35 @@
+#pragma once
+
+#include <Arduino.h>
+
+#include "miner_session.h"
+
+class AsyncClient;
+
+// Caps miner sessions at what the heap can carry: the free heap when the
+// stratum server starts, divided by what one session costs. That cost is
+// measured on every subscribe and kept as a running average, so the limit
+// follows the board. A live heap check on every accept covers whatever
+// else grew since.
+
+struct MinerAdmissionStats {
+    uint32_t startup_free_heap = 0;
+    // Running average of the measured per-session cost
+    uint32_t session_budget = 0;
+    unsigned long session_samples = 0;
+    uint32_t measured_session_bytes = 0;
+    size_t capacity = 0;
+    unsigned long refused = 0;
+    unsigned long redirected = 0;
+};
+
+void InitMinerAdmission();
+// Called from the accept callback. False when the client was turned away;
+// it is closed and freed then.
+bool AdmitMiner(AsyncClient* client);
+// A miner has its subscribe answer and first job: its heap cost since accept
+// goes into the budget
+void MeasureMinerSession(MinerSession* session);
+
+// A copy, since AdmitMiner() updates the counters from the accept callback
+MinerAdmissionStats CurrentMinerAdmissionStats();
@@ -0,0 +1,196 @@
+#include "miner_extranonce.h"
+
+#include <bitset>
+#include <vector>
+
+#if defined(ESP32) || defined(YUMA_HOST)
+#include <AsyncTCP.h>
+#elif defined(ESP8266)
+#include <ESPAsyncTCP.h>
+#endif
+
+#include "app_context.h"
+#include "job_cache.h"
+#include "log.h"
+#include "miner_admission.h"
+#include "stratum_server.h"
+
+namespace {
+constexpr int kMaxSlots = 256;
+// Miners keep at least this much extranonce2 after the slot byte
+constexpr int kMinMinerExtranonce2Size = 2;
+
+struct UpstreamExtranonce {
+    String extranonce1;
+    int extranonce2_size = 0;
+
+    bool operator==(const UpstreamExtranonce& other) const {
+        return extranonce1 == other.extranonce1 && extranonce2_size == other.extranonce2_size;
+    }
+};
+
+UpstreamExtranonce current;
+UpstreamExtranonce staged;
+bool ready = false;
+bool has_staged = false;
+uint32_t generation = 1;
+
+// Too small an upstream extranonce2 leaves nothing to split
+int SlotBytes() {
+    return current.extranonce2_size > kMinMinerExtranonce2Size ? 1 : 0;
+}
+
+String SlotHex(const MinerSession* session) {
+    if (SlotBytes() == 0) {
+        return String();
+    }
+    char slot[3];
+    snprintf(slot, sizeof(slot), "%02x", static_cast<unsigned int>(session->extranonce_slot));
+    return String(slot);
+}
+
+bool AssignSlot(MinerSession* session) {
+    if (session->extranonce_slot >= 0) {
+        return true;
+    }
+
+    std::bitset<kMaxSlots> used;
+    for (const MinerSession* other : connected_miners) {
+        if (other->extranonce_slot >= 0) {
+            used.set(other->extranonce_slot);
+        }
+    }
+    for (int slot = 0; slot < kMaxSlots; ++slot) {
+        if (!used.test(slot)) {
+            session->extranonce_slot = slot;
+            return true;
+        }
+    }
+    return false;
+}
+
+void SendSubscribeResult(MinerSession* session, const String& id) {
+    if (!AssignSlot(session)) {
+        SendToMiner(session, "{\"id\":" + id + ",\"result\":null,\"error\":[20,\"No extranonce range left\",null]}");
+        return;
+    }
+
+    session->extranonce_generation = generation;
+    SendToMiner(session, "{\"id\":" + id + ",\"result\":[[[\"mining.set_difficulty\",\"1\"],[\"mining.notify\",\"1\"]],\"" +
+                             MinerExtranonce1(session) + "\"," + String(MinerExtranonce2Size()) + "],\"error\":null}");
+    SendCurrentJob(session);
+    MeasureMinerSession(session);
+}
+
+void Apply(const UpstreamExtranonce& update) {
+    if (update == current) {
+        return;
+    }
+    current = update;
+    generation++;
+    LOG_INFO("Upstream extranonce %s/%d\n", current.extranonce1.c_str(), current.extranonce2_size);
+    if (SlotBytes() == 0) {
+        LOG_INFO("Upstream extranonce2 too small to split, miners share one range\n");
+    }
+}
+}
+
+String MinerExtranonce1(const MinerSession* session) {
+    return current.extranonce1 + SlotHex(session);
+}
+
+int MinerExtranonce2Size() {
+    return current.extranonce2_size - SlotBytes();
+}
+
+void SetUpstreamExtranonce(const String& extranonce1, int extranonce2_size) {
+    Apply({extranonce1, extranonce2_size});
+    ready = true;
+    has_staged = false;
+
+    for (MinerSession* session : connected_miners) {
+        if (session->subscribe_pending) {
+            session->subscribe_pending = false;
+            SendSubscribeResult(session, session->subscribe_id);
+            session->subscribe_id = "";
+        }
+    }
+}
+
+void StageUpstreamExtranonce(const String& extranonce1, int extranonce2_size) {
+    staged = {extranonce1, extranonce2_size};
+    has_staged = true;
+}
+
+void ResetUpstreamExtranonce() {
+    ready = false;
+    has_staged = false;
+}
+
+bool SyncMinerExtranonces() {
+    if (!ready) {
+        return false;
+    }
+    if (has_staged) {
+        has_staged = false;
+        Apply(staged);
+    }
+
+    bool pushed = false;
+    std::vector<MinerSession*> stale;
+    for (MinerSession* session : connected_miners) {
+        if (session->extranonce_slot < 0 || session->extranonce_generation == generation) {
+            continue;
+        }
+        session->extranonce_generation = generation;
+        if (session->header_jobs) {
+            // Its next header is built on the new extranonce; the clean job retires the old ones
+            pushed = true;
+        } else if (session->extranonce_updates) {
+            SendToMiner(session, "{\"id\":null,\"method\":\"mining.set_extranonce\",\"params\":[\"" +
+                                     MinerExtranonce1(session) + "\"," + String(MinerExtranonce2Size()) + "]}");
+            pushed = true;
+        } else {
+            stale.push_back(session);
+        }
+    }
+
+    for (MinerSession* session : stale) {
+        LOG_ERROR("Miner %s cannot take a new extranonce, reconnecting it\n",
+                  session->client->remoteIP().toString().c_str());
+        session->client->close();
+    }
+    return pushed;
+}
+
+size_t FixedExtranonceMinerCount() {
+    size_t count = 0;
+    for (const MinerSession* session : connected_miners) {
+        if (session->extranonce_slot >= 0 && !session->extranonce_updates && !session->header_jobs) {
+            count++;
+        }
+    }
+    return count;
+}
+
+void AnswerMinerSubscribe(MinerSession* session, const String& id) {
+    if (ready) {
+        SendSubscribeResult(session, id);
+        return;
+    }
+    // Answered as soon as the upstream session hands out its extranonce
+    session->subscribe_pending = true;
+    session->subscribe_id = id;
+}
+
+void AnswerExtranonceSubscribe(MinerSession* session, const String& id) {
+    session->extranonce_updates = true;
+    SendToMiner(session, "{\"id\":" + id + ",\"result\":true,\"error\":null}");
+}
+
+String UpstreamExtranonce2(const MinerSession* session, const char* extranonce2) {
+    if (session->extranonce_slot < 0 || !extranonce2) {
+        return String();
+    }
+    return SlotHex(session) + extranonce2;
+}
@@ -0,0 +1,32 @@
+#pragma once
+
+#include <Arduino.h>
+
+#include "miner_session.h"
+
+// Splits the upstream extranonce2 space so every miner hashes its own range:
+// a miner's extranonce1 is the upstream extranonce1 plus a one-byte slot,
+// and its extranonce2 is widened back with that slot when it submits.
+
+// A fresh upstream session: takes effect now and answers queued subscribes
+void SetUpstreamExtranonce(const String& extranonce1, int extranonce2_size);
+// A pool-side rotation: takes effect at the next job boundary
+void StageUpstreamExtranonce(const String& extranonce1, int extranonce2_size);
+void ResetUpstreamExtranonce();
+
+// Call at every job boundary before fanning the job out. Pushes the current
+// extranonce to miners still working on an older one; true when it did, so
+// the job must be sent with clean_jobs set.
+bool SyncMinerExtranonces();
+// Subscribed miners that take neither mining.set_extranonce nor header
+// jobs, so an upstream extranonce change has to reconnect them
+size_t FixedExtranonceMinerCount();
+
+// A subscribed miner's current extranonce1 (hex) and extranonce2 size
+String MinerExtranonce1(const MinerSession* session);
+int MinerExtranonce2Size();
+
+void AnswerMinerSubscribe(MinerSession* session, const String& id);
+void AnswerExtranonceSubscribe(MinerSession* session, const String& id);
+// Upstream form of a miner's extranonce2; empty if the miner never subscribed
+String UpstreamExtranonce2(const MinerSession* session, const char* extranonce2);
@@ -0,0 +1,283 @@
+#include "miner_handshake.h"
+
+#include <vector>
+
+#include "app_context.h"
+#include "header_jobs.h"
+#include "log.h"
+#include "pool_client.h"
+#include "pool_split.h"
+#include "stratum_server.h"
+
+namespace {
+// BIP 320: the bits miners may roll when the pool does not say otherwise
+constexpr uint32_t kRequestedVersionMask = 0x1FFFE000;
+constexpr int kUnauthorizedError = 24;
+
+// Worker names authorized on the current upstream session, by id offset
+std::vector<String> upstream_workers;
+bool upstream_ready = false;
+
+bool configure_answered = false;
+bool version_rolling = false;
+uint32_t version_mask = 0;
+
+String Hex32(uint32_t value) {
+    char text[9];
+    snprintf(text, sizeof(text), "%08x", static_cast<unsigned int>(value));
+    return String(text);
+}
+
+// Entries are comma separated; a trailing '*' matches any suffix
+bool MatchesPattern(const String& pattern, const String& name) {
+    if (pattern.endsWith("*")) {
+        return name.startsWith(pattern.substring(0, pattern.length() - 1));
+    }
+    return name == pattern;
+}
+
+bool WorkerAllowed(const String& worker) {
+    String list = config.worker_allow;
+    list.trim();
+    if (list.length() == 0) {
+        return true;
+    }
+
+    int start = 0;
+    while (start <= static_cast<int>(list.length())) {
+        int comma = list.indexOf(',', start);
+        String entry = list.substring(start, comma == -1 ? list.length() : comma);
+        entry.trim();
+        if (entry.length() > 0 && MatchesPattern(entry, worker)) {
+            return true;
+        }
+        if (comma == -1) {
+            break;
+        }
+        start = comma + 1;
+    }
+    return false;
+}
+
+// "miner=upstream" pairs; the first matching entry wins. An empty result
+// means the miner's own name is used.
+String MappedWorker(const String& worker) {
+    String list = config.worker_map;
+    int start = 0;
+    while (start < static_cast<int>(list.length())) {
+        int comma = list.indexOf(',', start);
+        String entry = list.substring(start, comma == -1 ? list.length() : comma);
+        int equals = entry.indexOf('=');
+        if (equals > 0) {
+            String pattern = entry.substring(0, equals);
+            pattern.trim();
+            if (MatchesPattern(pattern, worker)) {
+                String mapped = entry.substring(equals + 1);
+                mapped.trim();
+                return mapped;
+            }
+        }
+        if (comma == -1) {
+            break;
+        }
+        start = comma + 1;
+    }
+    return String();
+}
+
+String UpstreamWorkerName(const String& worker) {
+    // The alternate pool of a split only knows the proxy's own account there
+    if (ActivePoolIndex() != kPrimaryPool) {
+        return ActivePool().user;
+    }
+    String mapped = MappedWorker(worker);
+    return mapped.length() > 0 ? mapped : worker;
+}
+
+void AuthorizeUpstream(const String& name, const String& password) {
+    // The proxy's own account is authorized with its subscribe
+    if (!upstream_ready || config.pool_sv2 || ActivePoolIndex() != kPrimaryPool || name == config.pool_user) {
+        return;
+    }
+    for (const String& worker : upstream_workers) {
+        if (worker == name) {
+            return;
+        }
+    }
+    if (upstream_workers.size() >= kMaxUpstreamWorkers) {
+        LOG_ERROR("No room to authorize worker %s upstream\n", name.c_str());
+        return;
+    }
+
+    upstream_workers.push_back(name);
+
+    DynamicJsonDocument doc(256);
+    doc["id"] = kFirstWorkerAuthId + upstream_workers.size() - 1;
+    doc["method"] = "mining.authorize";
+    doc["params"][0] = name;
+    doc["params"][1] = password;
+    String message;
+    serializeJson(doc, message);
+    SendToPool(message);
+}
+
+void AnswerConfigure(MinerSession* session, const String& id, uint32_t requested_mask) {
+    uint32_t mask = version_mask & requested_mask;
+    if (version_rolling && mask != 0) {
+        SendToMiner(session, "{\"id\":" + id + ",\"result\":{\"version-rolling\":true,\"version-rolling.mask\":\"" +
+                                 Hex32(mask) + "\"},\"error\":null}");
+    } else {
+        SendToMiner(session, "{\"id\":" + id + ",\"result\":{\"version-rolling\":false},\"error\":null}");
+    }
+}
+
+void HandleAuthorize(MinerSession* session, JsonDocument& request, const String& id) {
+    String worker = request["params"][0] | "";
+    if (!WorkerAllowed(worker)) {
+        LOG_INFO("Worker '%s' from %s is not on the allow-list\n", worker.c_str(),
+                 session->client->remoteIP().toString().c_str());
+        SendToMiner(session, "{\"id\":" + id + ",\"result\":false,\"error\":[" + String(kUnauthorizedError) +
+                                 ",\"Unauthorized worker\",null]}");
+        session->client->close();
+        return;
+    }
+
+    // A mapped name belongs to the proxy's operator, so it takes the pool password
+    String mapped = MappedWorker(worker);
+    session->authorized = true;
+    session->upstream_worker = mapped.length() > 0 ? mapped : worker;
+    session->upstream_password = mapped.length() > 0 ? String(config.pool_pass) : String(request["params"][1] | "");
+    SendToMiner(session, "{\"id\":" + id + ",\"result\":true,\"error\":null}");
+
+    AuthorizeUpstream(session->upstream_worker, session->upstream_password);
+}
+
+void HandleConfigure(MinerSession* session, JsonDocument& request, const String& id) {
+    bool wants_rolling = false;
+    for (JsonVariant extension : request["params"][0].as<JsonArray>()) {
+        if (extension == "version-rolling") {
+            wants_rolling = true;
+        }
+    }
+    if (!wants_rolling) {
+        SendToMiner(session, "{\"id\":" + id + ",\"result\":{},\"error\":null}");
+        return;
+    }
+
+    uint32_t requested_mask = 0xFFFFFFFF;
+    const char* mask_hex = request["params"][1]["version-rolling.mask"] | "";
+    if (strlen(mask_hex) > 0) {
+        requested_mask = strtoul(mask_hex, nullptr, 16);
+    }
+
+    if (configure_answered) {
+        AnswerConfigure(session, id, requested_mask);
+        return;
+    }
+    // Answered once the pool says what it allows
+    session->configure_id = id;
+    session->configure_mask = requested_mask;
+}
+}
+
+bool AnswerMinerHandshake(MinerSession* session, JsonDocument& request) {
+    String method = request["method"] | "";
+    String id;
+    serializeJson(request["id"], id);
+
+    if (method == "mining.authorize") {
+        HandleAuthorize(session, request, id);
+        return true;
+    }
+
+    if (method == "mining.configure") {
+        HandleConfigure(session, request, id);
+        return true;
+    }
+
+    if (method == "mining.header_subscribe") {
+        AnswerHeaderSubscribe(session, id);
+        return true;
+    }
+
+    if (method == "mining.suggest_difficulty") {
+        session->suggested_difficulty = request["params"][0] | 0.0;
+        if (!request["id"].isNull()) {
+            SendToMiner(session, "{\"id\":" + id + ",\"result\":true,\"error\":null}");
+        }
+        return true;
+    }
+
+    return false;
+}
+
+bool PrepareMinerSubmit(MinerSession* session, JsonDocument& request) {
+    if (!session->authorized) {
+        String id;
+        serializeJson(request["id"], id);
+        SendToMiner(session, "{\"id\":" + id + ",\"result\":null,\"error\":[" + String(kUnauthorizedError) +
+                                 ",\"Unauthorized worker\",null]}");
+        return false;
+    }
+
+    String worker = request["params"][0] | "";
+    request["params"][0] = UpstreamWorkerName(worker);
+    return true;
+}
+
+String PoolConfigureRequest() {
+    return "{\"id\":" + String(kPoolConfigureId) +
+           ",\"method\":\"mining.configure\",\"params\":[[\"version-rolling\"],{\"version-rolling.mask\":\"" +
+           Hex32(kRequestedVersionMask) + "\",\"version-rolling.min-bit-count\":2}]}";
+}
+
+void NotePoolConfigureResult(JsonVariantConst result) {
+    version_rolling = result["version-rolling"] | false;
+    const char* mask_hex = result["version-rolling.mask"] | "";
+    version_mask = version_rolling ? strtoul(mask_hex, nullptr, 16) : 0;
+    configure_answered = true;
+    LOG_INFO("Pool version rolling: %s\n", version_rolling ? Hex32(version_mask).c_str() : "off");
+
+    for (MinerSession* session : connected_miners) {
+        if (session->configure_id.length() > 0) {
+            AnswerConfigure(session, session->configure_id, session->configure_mask);
+            session->configure_id = "";
+        }
+    }
+}
+
+void ConcludePoolConfigure() {
+    if (!configure_answered) {
+        NotePoolConfigureResult(JsonVariantConst());
+    }
+}
+
+void ResetUpstreamHandshake() {
+    upstream_workers.clear();
+    upstream_ready = false;
+    // Miners keep the mask they were given; a new pool answers again
+    configure_answered = false;
+}
+
+void AuthorizeMinerWorkers() {
+    upstream_ready = true;
+    for (MinerSession* session : connected_miners) {
+        if (session->authorized) {
+            AuthorizeUpstream(session->upstream_worker, session->upstream_password);
+        }
+    }
+}
+
+bool NoteWorkerAuthorizeResult(uint32_t id, bool ok) {
+    if (id < kFirstWorkerAuthId || id >= kFirstWorkerAuthId + upstream_workers.size()) {
+        return false;
+    }
+
+    const String& worker = upstream_workers[id - kFirstWorkerAuthId];
+    if (ok) {
+        LOG_DEBUG("Worker %s authorized upstream\n", worker.c_str());
+    } else {
+        LOG_ERROR("Pool refused worker %s; its shares will be rejected\n", worker.c_str());
+    }
+    return true;
+}
@@ -0,0 +1,45 @@
+#pragma once
+
+#include <Arduino.h>
+#include <ArduinoJson.h>
+
+#include "miner_session.h"
+
+// Answers the rest of the miner handshake here instead of relaying it, so a
+// miner is hashing one LAN round trip after it connects:
+// - mining.authorize: checked against worker_allow and answered at once. On
+//   a V1 pool the worker, renamed by worker_map, is authorized upstream in
+//   the background, once per upstream session.
+// - mining.configure: version rolling with the mask the pool granted the
+//   proxy, narrowed to the one the miner asked for. Over SV2 the first job
+//   decides (see sv2_upstream.cpp).
+// - mining.header_subscribe: see header_jobs.h.
+// - mining.suggest_difficulty: noted on the session. The upstream link is
+//   shared, so one miner's wish is not passed on to the pool.
+
+// Proxy-originated worker authorizations use ids from here up
+constexpr uint32_t kFirstWorkerAuthId = 100;
+constexpr size_t kMaxUpstreamWorkers = 64;
+// Id of the proxy's own mining.configure
+constexpr uint32_t kPoolConfigureId = 5;
+
+// True when the request was answered here
+bool AnswerMinerHandshake(MinerSession* session, JsonDocument& request);
+
+// For a mining.submit: false, with the error already sent, when the miner
+// never authorized. Otherwise puts the upstream worker name in params[0].
+bool PrepareMinerSubmit(MinerSession* session, JsonDocument& request);
+
+// The proxy's version-rolling request, sent before its subscribe
+String PoolConfigureRequest();
+// The pool's answer to it; also answers miners waiting on their configure
+void NotePoolConfigureResult(JsonVariantConst result);
+// The pool answered its subscribe; a configure it never answered was ignored
+void ConcludePoolConfigure();
+
+// A fresh upstream session: nothing is authorized or negotiated on it yet
+void ResetUpstreamHandshake();
+// The proxy itself is authorized; authorize every connected miner's worker
+void AuthorizeMinerWorkers();
+// Reply to an id from kFirstWorkerAuthId; false if the id is not one of them
+bool NoteWorkerAuthorizeResult(uint32_t id, bool ok);
@@ -0,0 +1,66 @@
+#pragma once
+
+#include <Arduino.h>
+
+class AsyncClient;
+
+// Per-connection state for a downstream miner. Only loop() touches it,
+// except for the fields under MinerSessionLock() that the socket callbacks
+// hand over through (see stratum_server.cpp).
+struct MinerSession {
+    AsyncClient* client = nullptr;
+    // Bytes received but not yet split into lines; guarded
+    String rx_queue;
+    // Set by the disconnect callback; the session is freed on loop(); guarded
+    bool closed = false;
+    // Set by the ACK timeout callback, in ms; loop() reaps the session; guarded
+    uint32_t ack_timed_out_ms = 0;
+    // Partial line carried between reads
+    String rx_buffer;
+    unsigned long connected_ms = 0;
+    unsigned long last_rx_ms = 0;
+    // Free heap before the session was allocated, 0 once measured
+    uint32_t heap_at_accept = 0;
+
+    // Extranonce slot handed out on subscribe, -1 until then
+    int extranonce_slot = -1;
+    uint32_t extranonce_generation = 0;
+    bool extranonce_updates = false;
+    bool subscribe_pending = false;
+    String subscribe_id;
+
+    // Stale shares are kept apart from rejects: a miner that is merely slow
+    // to switch jobs looks very different from one producing bad work
+    unsigned long shares_accepted = 0;
+    unsigned long shares_rejected = 0;
+    unsigned long shares_stale = 0;
+
+    // Set by a local authorize answer; submits before it are refused
+    bool authorized = false;
+    // Name and password its shares go upstream under, after worker_map
+    String upstream_worker;
+    String upstream_password;
+    double suggested_difficulty = 0;
+    // A mining.configure held until the pool grants version rolling
+    String configure_id;
+    uint32_t configure_mask = 0;
+
+    // Sent mining.header_subscribe: gets built headers instead of notifies
+    bool header_jobs = false;
+    // Job generation of the last header sent, 0 before the first
+    uint32_t header_generation = 0;
+
+    // What the miner calls itself, for telling devices apart in /api/miners
+    String worker;
+    String user_agent;
+    // Last difficulty sent to this miner
+    double difficulty = 0;
+    unsigned long last_share_ms = 0;
+    unsigned long bytes_rx = 0;
+    unsigned long bytes_tx = 0;
+    // Accepted work, summed share difficulty, in two back-to-back windows
+    // for the hashrate estimate (see miner_stats.cpp)
+    double work_current = 0;
+    double work_previous = 0;
+    unsigned long work_window_start_ms = 0;
+};
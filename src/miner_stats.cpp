@@ -0,0 +1,88 @@
+#include "miner_stats.h"
+
+#include <ArduinoJson.h>
+
+#if defined(ESP32) || defined(YUMA_HOST)
+#include <AsyncTCP.h>
+#elif defined(ESP8266)
+#include <ESPAsyncTCP.h>
+#endif
+
+namespace {
+// Long enough that a few shares at a miner's difficulty land in each window
+constexpr unsigned long kWorkWindowMs = 10UL * 60 * 1000;
+constexpr unsigned int kMaxLabelLength = 48;
+// A share at difficulty 1 stands for 2^32 hashes
+constexpr double kHashesPerShare = 4294967296.0;
+
+void CopyLabel(String& dest, const char* value) {
+    dest = value ? value : "";
+    if (dest.length() > kMaxLabelLength) {
+        dest.remove(kMaxLabelLength);
+    }
+}
+}
+
+void NoteMinerUserAgent(MinerSession* session, const char* user_agent) {
+    CopyLabel(session->user_agent, user_agent);
+}
+
+void NoteMinerWorker(MinerSession* session, const char* worker) {
+    CopyLabel(session->worker, worker);
+}
+
+void NoteMinerShareAccepted(MinerSession* session) {
+    const unsigned long now = millis();
+    if (session->work_window_start_ms == 0) {
+        session->work_window_start_ms = session->connected_ms;
+    }
+    if (now - session->work_window_start_ms >= kWorkWindowMs) {
+        // A miner silent for a whole window gets no credit from before it
+        session->work_previous = now - session->work_window_start_ms >= 2 * kWorkWindowMs ? 0 : session->work_current;
+        session->work_current = 0;
+        session->work_window_start_ms = now;
+    }
+    session->work_current += session->difficulty;
+}
+
+double EstimateMinerHashrate(const MinerSession* session, unsigned long now) {
+    const unsigned long window_start = session->work_window_start_ms != 0 ? session->work_window_start_ms
+                                                                          : session->connected_ms;
+    double elapsed_ms = static_cast<double>(now - window_start);
+    double work = session->work_current;
+    if (session->work_previous > 0) {
+        elapsed_ms += kWorkWindowMs;
+        work += session->work_previous;
+    }
+    if (elapsed_ms < 1000) {
+        return 0;
+    }
+    return work * kHashesPerShare * 1000.0 / elapsed_ms;
+}
+
+String MinerStatsJson(const MinerSession* session, unsigned long now) {
+    StaticJsonDocument<512> doc;
+    doc["ip"] = session->client->remoteIP().toString();
+    doc["worker"] = session->worker.c_str();
+    doc["upstream_worker"] = session->upstream_worker.c_str();
+    doc["suggested_difficulty"] = session->suggested_difficulty;
+    doc["user_agent"] = session->user_agent.c_str();
+    doc["connected_s"] = (now - session->connected_ms) / 1000;
+    doc["difficulty"] = session->difficulty;
+    doc["accepted"] = session->shares_accepted;
+    doc["rejected"] = session->shares_rejected;
+    doc["stale"] = session->shares_stale;
+    if (session->last_share_ms != 0) {
+        doc["last_share_s"] = (now - session->last_share_ms) / 1000;
+    } else {
+        doc["last_share_s"] = nullptr;
+    }
+    doc["idle_s"] = (now - session->last_rx_ms) / 1000;
+    doc["bytes_rx"] = session->bytes_rx;
+    doc["bytes_tx"] = session->bytes_tx;
+    doc["hashrate"] = EstimateMinerHashrate(session, now);
+
+    String json;
+    serializeJson(doc, json);
+    return json;
+}
@@ -0,0 +1,18 @@
+#pragma once
+
+#include <Arduino.h>
+
+#include "miner_session.h"
+
+// Per-miner figures behind /api/miners: who the miner says it is, what it
+// sends and how much accepted work it produces.
+
+void NoteMinerUserAgent(MinerSession* session, const char* user_agent);
+void NoteMinerWorker(MinerSession* session, const char* worker);
+void NoteMinerShareAccepted(MinerSession* session);
+
+// Hashes per second implied by accepted shares over the last 10 to 20 minutes
+double EstimateMinerHashrate(const MinerSession* session, unsigned long now);
+
+// One /api/miners entry as a JSON object
+String MinerStatsJson(const MinerSession* session, unsigned long now);
@@ -0,0 +1,300 @@
+#include "ota_update.h"
+
+#include <ESPAsyncWebServer.h>
+#include <algorithm>
+#include <vector>
+
+#if defined(ESP32)
+#include <AsyncTCP.h>
+#include <Update.h>
+#elif defined(ESP8266)
+#include <ESPAsyncTCP.h>
+#include <Updater.h>
+#endif
+
+#include "app_context.h"
+#include "async_lock.h"
+#include "config_defaults.h"
+#include "job_cache.h"
+#include "log.h"
+#include "scheduler.h"
+
+namespace {
+// One flash sector per task run: an erase plus write costs tens of ms
+constexpr size_t kSliceBytes = 4096;
+
+// HTTP auth user name; the password is ConfigDefaults::kOtaPassword
+constexpr char kOtaUser[] = "yuma";
+
+// The upload handler claims an upload (upload_request, status.state set to
+// kReceiving, begin_pending) and appends to incoming; the ota task begins
+// the image, swaps incoming for the drained pending buffer and writes from
+// there without holding the lock. status.state, error and reboot_at_ms are
+// also read and set from web handlers, so they change under the lock too;
+// the counters are only written by the ota task.
+AsyncLock queue_lock;
+OtaStatus status;
+AsyncWebServerRequest* upload_request = nullptr;
+bool begin_pending = false;
+long requested_reboot_ms = 0;
+std::vector<uint8_t> incoming;
+AsyncClient* upload_client = nullptr;
+bool upload_done = false;
+bool upload_lost = false;
+
+// ota task only
+long reboot_delay_ms = 0;
+std::vector<uint8_t> pending;
+size_t pending_offset = 0;
+
+bool BeginImage() {
+#if defined(ESP32)
+    return Update.begin(UPDATE_SIZE_UNKNOWN);
+#elif defined(ESP8266)
+    Update.runAsync(true);
+    return Update.begin((ESP.getFreeSketchSpace() - 0x1000) & 0xFFFFF000);
+#endif
+}
+
+String UpdateError() {
+#if defined(ESP32)
+    return String(Update.errorString());
+#elif defined(ESP8266)
+    return Update.getErrorString();
+#endif
+}
+
+void Fail(const String& error) {
+    // Ending an unfinished image discards it and leaves the running one active
+    Update.end(false);
+    pending.clear();
+    pending.shrink_to_fit();
+    pending_offset = 0;
+    AsyncClient* client = nullptr;
+    {
+        AsyncLockGuard guard(queue_lock);
+        upload_request = nullptr;
+        begin_pending = false;
+        incoming.clear();
+        incoming.shrink_to_fit();
+        if (!upload_done && !upload_lost) {
+            client = upload_client;
+        }
+        upload_client = nullptr;
+        status.state = OtaState::kFailed;
+        status.error = error;
+    }
+    if (client) {
+        // Its unacknowledged bytes would otherwise stall it until a timeout
+        client->close();
+    }
+    LOG_ERROR("OTA failed: %s\n", error.c_str());
+}
+
+// Runs on the ota task once the handler has claimed an upload
+void Begin(long reboot_ms) {
+    status.received = 0;
+    status.written = 0;
+    status.started_ms = millis();
+    status.last_slice_us = 0;
+    status.max_slice_us = 0;
+    reboot_delay_ms = reboot_ms;
+    pending.clear();
+    pending_offset = 0;
+
+    if (!BeginImage()) {
+        Fail("Cannot start update: " + UpdateError());
+        return;
+    }
+    LOG_INFO("OTA upload started\n");
+}
+
+void Finish() {
+    pending.clear();
+    pending.shrink_to_fit();
+    pending_offset = 0;
+    {
+        AsyncLockGuard guard(queue_lock);
+        upload_request = nullptr;
+        incoming.shrink_to_fit();
+        upload_client = nullptr;
+    }
+    if (!Update.end(true)) {
+        Fail("Image rejected: " + UpdateError());
+        return;
+    }
+
+    {
+        AsyncLockGuard guard(queue_lock);
+        status.state = OtaState::kReady;
+    }
+    LOG_INFO("OTA image verified, %u bytes in %lu ms\n", static_cast<unsigned int>(status.written),
+             millis() - status.started_ms);
+    if (reboot_delay_ms >= 0) {
+        ScheduleOtaReboot(static_cast<unsigned long>(reboot_delay_ms));
+    }
+}
+}
+
+bool OtaEnabled() {
+    return ConfigDefaults::kOtaPassword[0] != '\0';
+}
+
+bool OtaRequestAllowed(AsyncWebServerRequest* request) {
+    return OtaEnabled() && request->authenticate(kOtaUser, ConfigDefaults::kOtaPassword);
+}
+
+void HandleOtaUpload(AsyncWebServerRequest* request, const String& filename, size_t index, uint8_t* data, size_t len,
+                     bool final) {
+    bool started = false;
+    if (index == 0 && OtaRequestAllowed(request)) {
+        long reboot_ms = 0;
+        if (request->hasParam("reboot")) {
+            String reboot = request->getParam("reboot")->value();
+            reboot_ms = reboot == "manual" ? -1 : reboot.toInt() * 1000L;
+        }
+
+        // Claimed here, begun by the ota task
+        AsyncLockGuard guard(queue_lock);
+        if (status.state != OtaState::kReceiving) {
+            status.state = OtaState::kReceiving;
+            status.error = "";
+            status.reboot_at_ms = 0;
+            upload_request = request;
+            begin_pending = true;
+            requested_reboot_ms = reboot_ms;
+            incoming.clear();
+            upload_client = request->client();
+            upload_done = false;
+            upload_lost = false;
+            started = true;
+        }
+    }
+    if (started) {
+        // The ota task notices and fails an unfinished upload
+        request->onDisconnect([]() {
+            AsyncLockGuard guard(queue_lock);
+            upload_client = nullptr;
+            upload_lost = true;
+        });
+    }
+
+    {
+        AsyncLockGuard guard(queue_lock);
+        // A second upload while one is running is ignored
+        if (request != upload_request || status.state != OtaState::kReceiving) {
+            return;
+        }
+        incoming.insert(incoming.end(), data, data + len);
+        if (final) {
+            upload_done = true;
+        }
+    }
+    // Flash is slower than Wi-Fi: hold the ACK until the bytes are written so
+    // the uploader backs off instead of filling the heap
+    request->client()->ackLater();
+    SignalTask(ServiceOtaUpdate);
+}
+
+bool ScheduleOtaReboot(unsigned long delay_ms) {
+    {
+        AsyncLockGuard guard(queue_lock);
+        if (status.state != OtaState::kReady) {
+            return false;
+        }
+        status.reboot_at_ms = millis() + delay_ms;
+        if (status.reboot_at_ms == 0) {
+            status.reboot_at_ms = 1;
+        }
+    }
+    LOG_INFO("Rebooting into the new firmware in %lu s\n", delay_ms / 1000);
+    return true;
+}
+
+void ServiceOtaUpdate() {
+    bool begin = false;
+    long reboot_ms = 0;
+    {
+        AsyncLockGuard guard(queue_lock);
+        begin = begin_pending;
+        begin_pending = false;
+        reboot_ms = requested_reboot_ms;
+    }
+    if (begin) {
+        Begin(reboot_ms);
+    }
+
+    OtaState state;
+    bool done = false;
+    bool lost = false;
+    unsigned long reboot_at_ms;
+    {
+        AsyncLockGuard guard(queue_lock);
+        state = status.state;
+        reboot_at_ms = status.reboot_at_ms;
+    }
+    if (state == OtaState::kReceiving) {
+        AsyncLockGuard guard(queue_lock);
+        if (pending_offset == pending.size()) {
+            pending.clear();
+            pending_offset = 0;
+            pending.swap(incoming);
+            status.received += pending.size();
+        }
+        done = upload_done && incoming.empty();
+        lost = upload_lost && !upload_done;
+    }
+    if (lost) {
+        Fail("Upload interrupted");
+        return;
+    }
+
+    if (state == OtaState::kReceiving && pending_offset < pending.size()) {
+        size_t slice = std::min(pending.size() - pending_offset, kSliceBytes);
+        unsigned long started_us = micros();
+        size_t written = Update.write(pending.data() + pending_offset, slice);
+        status.last_slice_us = micros() - started_us;
+        status.max_slice_us = std::max(status.max_slice_us, status.last_slice_us);
+
+        if (written != slice) {
+            Fail("Flash write failed: " + UpdateError());
+            return;
+        }
+        pending_offset += slice;
+        status.written += slice;
+        AsyncLockGuard guard(queue_lock);
+        if (upload_client) {
+            upload_client->ack(slice);
+        }
+    }
+
+    if (state == OtaState::kReceiving && done && pending_offset == pending.size()) {
+        Finish();
+    }
+
+    if (reboot_at_ms != 0 && static_cast<long>(millis() - reboot_at_ms) >= 0) {
+        // Miners reconnecting after the reboot pick up this job right away
+        SaveJobCache();
+        LOG_INFO("Rebooting into the new firmware\n");
+        delay(100);
+        ESP.restart();
+    }
+}
+
+const char* OtaStateName(OtaState state) {
+    switch (state) {
+        case OtaState::kReceiving:
+            return "receiving";
+        case OtaState::kReady:
+            return "ready";
+        case OtaState::kFailed:
+            return "failed";
+        default:
+            return "idle";
+    }
+}
+
+OtaStatus CurrentOtaStatus() {
+    AsyncLockGuard guard(queue_lock);
+    return status;
+}
@@ -0,0 +1,45 @@
+#pragma once
+
+#include <Arduino.h>
+
+class AsyncWebServerRequest;
+
+// Firmware upload into the inactive partition while the proxy keeps
+// running. The web server only queues what arrives and holds back the TCP
+// ACK; the ota task writes one flash sector per run and then releases the
+// ACK, so the uploader is paced by flash speed and a run never stalls
+// forwarding for more than one sector write.
+// Uploads are off unless the image is built with YUMA_OTA_PASSWORD; then
+// POST /api/ota and /api/ota/reboot need HTTP auth as user "yuma".
+
+enum class OtaState : uint8_t { kIdle, kReceiving, kReady, kFailed };
+
+struct OtaStatus {
+    OtaState state = OtaState::kIdle;
+    size_t received = 0;
+    size_t written = 0;
+    unsigned long started_ms = 0;
+    unsigned long last_slice_us = 0;
+    unsigned long max_slice_us = 0;
+    // 0 until a reboot is scheduled
+    unsigned long reboot_at_ms = 0;
+    String error;
+};
+
+// An OTA password was built in
+bool OtaEnabled();
+// OTA is enabled and the request carries the right credentials
+bool OtaRequestAllowed(AsyncWebServerRequest* request);
+
+// ESPAsyncWebServer upload handler for POST /api/ota. The request's
+// "reboot" parameter picks when to switch over once the image verifies:
+// seconds to wait (default 0) or "manual" for ScheduleOtaReboot()
+void HandleOtaUpload(AsyncWebServerRequest* request, const String& filename, size_t index, uint8_t* data, size_t len,
+                     bool final);
+// Only once a verified image is waiting
+bool ScheduleOtaReboot(unsigned long delay_ms);
+void ServiceOtaUpdate();
+
+const char* OtaStateName(OtaState state);
+// A copy, taken under the lock the upload handler shares with the ota task
+OtaStatus CurrentOtaStatus();
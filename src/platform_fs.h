@@ -7,6 +7,9 @@
 #include <FS.h>
 #include <LittleFS.h>
 #define STORAGE_FS LittleFS
+#elif defined(YUMA_HOST)
+#include <HostFS.h>
+#define STORAGE_FS HostFS
 #else
 #error "Unsupported board: STORAGE_FS not defined"
 #endif
@@ -3,20 +3,198 @@
 #include <Arduino.h>
 #include <ArduinoJson.h>
 #include <WiFiClient.h>
+#include <algorithm>
+#include <vector>
 
-#if defined(ESP32)
+#if defined(ESP32) || defined(YUMA_HOST)
 #include <AsyncTCP.h>
 #elif defined(ESP8266)
 #include <ESPAsyncTCP.h>
 #endif
 
 #include "app_context.h"
+#include "boot_cache.h"
+#include "header_jobs.h"
+#include "host_lookup.h"
+#include "job_cache.h"
+#include "job_tracker.h"
+#include "log.h"
+#include "miner_extranonce.h"
+#include "miner_handshake.h"
+#include "miner_stats.h"
+#include "pool_resolver.h"
+#include "pool_split.h"
+#include "pool_tls.h"
+#include "pool_handover.h"
+#include "pool_tx.h"
+#include "power_policy.h"
+#include "scheduler.h"
+#include "stratum_capture.h"
+#include "stratum_server.h"
+#include "sv2_upstream.h"
 
 namespace {
-String extranonce1 = "";
-int extranonce2_size = 4;
+constexpr unsigned long kBootWarmupMs = 120000;
+constexpr int kMaxPoolLinesPerCall = 16;
+constexpr size_t kMaxPendingRequests = 64;
+// Ids below this are reserved for the proxy's own subscribe/authorize
+constexpr uint32_t kFirstMinerRequestId = 1000;
+constexpr uint32_t kMaxUpstreamId = 0x7FFFFFFF;
+// Node overhead on top of the copied strings of one JSON-RPC line
+constexpr size_t kJsonDocOverhead = 1024;
+// Stratum's "job not found", which pools also use for stale work
+constexpr int kStaleShareError = 21;
+// How long a replaced pool link is kept open for replies still in flight
+constexpr unsigned long kPoolDrainMs = 10000;
+constexpr unsigned long kPoolRetryMs = 30000;
+// Per dial; one address is tried per run of the pool task, so an
+// unreachable pool holds the other tasks up for this long at most
+constexpr unsigned long kConnectTimeoutMs = 1000;
+
+struct PendingRequest {
+    uint32_t upstream_id = 0;
+    MinerSession* session = nullptr;
+    String miner_id;
+    bool is_submit = false;
+    unsigned long sent_ms = 0;
+    // Where an accepted share is credited in a pool split
+    size_t pool_index = kPrimaryPool;
+    double difficulty = 0;
+};
+
+// Two plaintext slots: the live link, and a spare that a handover dials the
+// next pool on and that the replaced link drains in afterwards
+WiFiClient tcp_clients[2];
+size_t live_slot = 0;
+bool pool_tls = false;
+bool draining = false;
+unsigned long drain_started_ms = 0;
+
+unsigned long retry_at_ms = 0;
+bool retry_pending = false;
+
+// A connect goes through the cached addresses one run at a time, then
+// looks the host up in the background and dials what that returns
+enum class ConnectPhase : uint8_t { kIdle, kEndpoints, kResolving };
+ConnectPhase connect_phase = ConnectPhase::kIdle;
+size_t endpoint_attempts = 0;
+bool boot_seeded = false;
+IPAddress boot_cached_ip;
+HostLookup pool_lookup;
+
 bool subscribed = false;
 bool authorized = false;
+IPAddress connected_endpoint;
+
+std::vector<PendingRequest> pending_requests;
+uint32_t next_upstream_id = kFirstMinerRequestId;
+
+bool OpenPoolConnection(const IPAddress& endpoint, const String& host) {
+    // Plaintext SV2 would hand the shares and credentials to every hop
+    if (config.pool_sv2 && !Sv2EndpointAllowed(endpoint)) {
+        LOG_ERROR("SV2 is plaintext/local only: %s (%s) is not a local address, not connecting\n", host.c_str(),
+                  endpoint.toString().c_str());
+        return false;
+    }
+    if (pool_tls) {
+        return ConnectPoolTls(endpoint, host, ActivePool().port, ActivePool().tls_fingerprint);
+    }
+    return ConnectWithTimeout(tcp_clients[live_slot], endpoint, ActivePool().port, kConnectTimeoutMs);
+}
+
+void RouteMinerResponse(DynamicJsonDocument& doc, uint32_t id) {
+    auto it = std::find_if(pending_requests.begin(), pending_requests.end(),
+                           [id](const PendingRequest& request) { return request.upstream_id == id; });
+    if (it == pending_requests.end()) {
+        return;
+    }
+
+    PendingRequest request = *it;
+    pending_requests.erase(it);
+    RecordPoolReplyLatency(millis() - request.sent_ms);
+
+    if (request.is_submit) {
+        if (doc["result"].as<bool>()) {
+            metrics.shares_ok++;
+            metrics.last_share_time = millis();
+            CreditPoolShare(request.pool_index, request.difficulty);
+            if (request.session) {
+                request.session->shares_accepted++;
+                NoteMinerShareAccepted(request.session);
+            }
+            LOG_DEBUG("Share accepted!\n");
+        } else if ((doc["error"][0] | 0) == kStaleShareError) {
+            // The job changed while the share was in flight
+            metrics.shares_stale++;
+            if (request.session) {
+                request.session->shares_stale++;
+            }
+            LOG_DEBUG("Share stale upstream\n");
+        } else {
+            metrics.shares_bad++;
+            if (request.session) {
+                request.session->shares_rejected++;
+            }
+            LOG_DEBUG("Share rejected!\n");
+            if (doc.containsKey("error") && doc["error"].size() > 1) {
+                LOG_DEBUG("Error: %s\n", doc["error"][1].as<String>().c_str());
+            }
+        }
+    }
+
+    if (!request.session) {
+        return;
+    }
+
+    doc["id"] = serialized(request.miner_id);
+    String reply;
+    serializeJson(doc, reply);
+    SendToMiner(request.session, reply);
+}
+
+WiFiClient& SpareClient() {
+    return tcp_clients[live_slot ^ 1];
+}
+
+void EndPoolDrain() {
+    if (draining) {
+        SpareClient().stop();
+        draining = false;
+    }
+}
+
+// The replaced link only answers requests forwarded before the switch
+void DrainReplacedPool() {
+    if (!draining) {
+        return;
+    }
+    WiFiClient& link = SpareClient();
+    if (!link.connected() || millis() - drain_started_ms >= kPoolDrainMs) {
+        EndPoolDrain();
+        return;
+    }
+
+    for (int processed = 0; processed < kMaxPoolLinesPerCall && link.available(); ++processed) {
+        String line = link.readStringUntil('\n');
+        line.trim();
+
+        DynamicJsonDocument doc(kJsonDocOverhead + line.length());
+        if (line.length() == 0 || deserializeJson(doc, line) != DeserializationError::Ok) {
+            continue;
+        }
+        uint32_t id = doc["id"] | 0;
+        if (id >= kFirstMinerRequestId && doc.containsKey("result")) {
+            RouteMinerResponse(doc, id);
+        }
+    }
+}
+}
+
+void SendToPool(const String& line, bool share) {
+    CaptureLine(CaptureDirection::kPoolTx, kCapturePoolPeer, line);
+    metrics.pool_bytes_tx += line.length() + 1;
+    PoolTxWrite(line + "\n", share);
+}
 
 String SanitizePoolHost(const char* raw_host) {
     String host = String(raw_host);
@@ -43,49 +221,60 @@ String SanitizePoolHost(const char* raw_host) {
 
     return host;
 }
+
+WiFiClient& PoolClient() {
+    return pool_tls ? PoolTlsClient() : tcp_clients[live_slot];
 }
 
-void ConnectToPool() {
-    String host = SanitizePoolHost(config.pool_host);
-    Serial.printf("Connecting to pool %s:%d\n", host.c_str(), config.pool_port);
-
-    if (pool_client.connect(host.c_str(), config.pool_port)) {
-        Serial.println("Connected to pool!");
-        metrics.pool_connected = true;
-
-        DynamicJsonDocument doc(256);
-        doc["id"] = 1;
-        doc["method"] = "mining.subscribe";
-        doc["params"][0] = "ESPStratumProxy/1.0";
-
-        String message;
-        serializeJson(doc, message);
-        message += "\n";
-
-        pool_client.print(message);
-        Serial.println("Subscribe sent");
-    } else {
-        Serial.println("Failed to connect to pool");
-        metrics.pool_connected = false;
-        delay(30000);
-    }
+WiFiClient& ClaimStandbyPoolClient() {
+    EndPoolDrain();
+    return SpareClient();
 }
 
-void HandlePoolData() {
-    if (!pool_client.available()) {
-        return;
-    }
+void AdoptStandbyPool(const String& extranonce1, int extranonce2_size) {
+    // Anything batched for the old link still goes out on it
+    FlushPoolTx();
+
+    const PoolTarget pool = ActivePool();
+    String host = SanitizePoolHost(pool.host);
+    pool_tls = false;
+    live_slot ^= 1;
+    draining = true;
+    drain_started_ms = millis();
+
+    subscribed = true;
+    authorized = true;
+    metrics.pool_connected = true;
+    connected_endpoint = PoolClient().remoteIP();
+    SetPoolResolverTarget(host, pool.port);
+    SeedPoolEndpoint(connected_endpoint);
+    ReportPoolEndpointResult(connected_endpoint, true);
+    RememberPoolAddress(host.c_str(), pool.port, connected_endpoint);
+    ConfigurePoolLink();
 
-    String line = pool_client.readStringUntil('\n');
-    line.trim();
+    // A different pool, so no cached job carries over even if extranonce1 matches
+    NoteUpstreamSession(String());
+    NoteUpstreamSession(extranonce1);
+    // Miners move to the new extranonce with the first job from the new pool
+    StageUpstreamExtranonce(extranonce1, extranonce2_size);
 
-    if (line.length() == 0) {
+    ResetUpstreamHandshake();
+    AuthorizeMinerWorkers();
+}
+
+void SuggestPoolDifficulty() {
+    if (config.difficulty <= 0 || config.pool_sv2 || !PoolClient().connected()) {
         return;
     }
+    SendToPool("{\"id\":4,\"method\":\"mining.suggest_difficulty\",\"params\":[" + String(config.difficulty) + "]}");
+}
 
-    Serial.println("Pool: " + line);
+void ProcessPoolLine(const String& line) {
+    CaptureLine(CaptureDirection::kPoolRx, kCapturePoolPeer, line);
+    LOG_DEBUG("Pool: %s\n", line.c_str());
 
-    DynamicJsonDocument doc(1024);
+    // Notifies with many merkle branches easily exceed a fixed 1 KB document
+    DynamicJsonDocument doc(kJsonDocOverhead + line.length());
     if (deserializeJson(doc, line) != DeserializationError::Ok) {
         return;
     }
@@ -96,70 +285,391 @@ void HandlePoolData() {
         if (method == "mining.set_difficulty") {
             if (doc["params"].is<JsonArray>() && doc["params"].size() > 0) {
                 metrics.current_difficulty = doc["params"][0];
-                Serial.printf("New difficulty: %.2f\n", metrics.current_difficulty);
+                LOG_DEBUG("New difficulty: %.2f\n", metrics.current_difficulty);
+                RememberPoolDifficulty(line);
+                for (MinerSession* session : connected_miners) {
+                    session->difficulty = metrics.current_difficulty;
+                }
             }
         } else if (method == "mining.notify") {
             if (doc["params"].is<JsonArray>() && doc["params"].size() > 0) {
                 metrics.last_job_id = doc["params"][0].as<String>();
                 metrics.jobs_received++;
-                Serial.println("New job received: " + metrics.last_job_id);
+                LOG_DEBUG("New job received: %s\n", metrics.last_job_id.c_str());
+
+                if (metrics.boot_first_notify_ms == 0) {
+                    metrics.boot_first_notify_ms = millis();
+                    LOG_INFO("Boot to first notify: %lu ms (wifi %lu ms, pool %lu ms)\n",
+                             metrics.boot_first_notify_ms, metrics.boot_wifi_ms,
+                             metrics.boot_pool_ms);
+                }
+            }
+
+            // Work on an outdated extranonce is worthless upstream
+            bool forced_clean = SyncMinerExtranonces() && doc["params"].size() > 8;
+            if (forced_clean) {
+                doc["params"][8] = true;
+            }
+            if (doc["params"].size() > 8) {
+                TrackPoolJob(doc["params"][0].as<String>(), doc["params"][8].as<bool>());
+            }
+            if (forced_clean) {
+                String clean_line;
+                serializeJson(doc, clean_line);
+                RememberPoolJob(clean_line);
+                NoteHeaderJob(true);
+                BroadcastToMiners(clean_line, true);
+                return;
+            }
+            RememberPoolJob(line);
+            NoteHeaderJob(doc["params"][8] | false);
+            BroadcastToMiners(line, true);
+            return;
+        } else if (method == "mining.set_extranonce") {
+            // Miners get their derived extranonce at the next job instead
+            if (doc["params"].is<JsonArray>() && doc["params"].size() > 1) {
+                StageUpstreamExtranonce(doc["params"][0].as<String>(), doc["params"][1].as<int>());
+                LOG_DEBUG("Extranonce update staged for the next job\n");
             }
+            return;
         }
+
+        BroadcastToMiners(line);
     } else if (doc.containsKey("result")) {
-        int id = doc["id"] | 0;
+        uint32_t id = doc["id"] | 0;
 
         if (id == 1) {
             if (doc["result"].is<JsonArray>() && doc["result"].size() >= 3) {
-                extranonce1 = doc["result"][1].as<String>();
-                extranonce2_size = doc["result"][2];
+                NoteUpstreamSession(doc["result"][1].as<String>());
+                SetUpstreamExtranonce(doc["result"][1].as<String>(), doc["result"][2].as<int>());
                 subscribed = true;
-                Serial.println("Subscribe OK, sending authorize");
+                ConcludePoolConfigure();
+                LOG_INFO("Subscribe OK, sending authorize\n");
 
                 DynamicJsonDocument auth_doc(256);
                 auth_doc["id"] = 2;
                 auth_doc["method"] = "mining.authorize";
-                auth_doc["params"][0] = config.pool_user;
-                auth_doc["params"][1] = config.pool_pass;
+                auth_doc["params"][0] = ActivePool().user;
+                auth_doc["params"][1] = ActivePool().pass;
 
                 String auth_message;
                 serializeJson(auth_doc, auth_message);
-                auth_message += "\n";
-
-                pool_client.print(auth_message);
+                SendToPool(auth_message);
             }
         } else if (id == 2) {
             if (doc["result"].as<bool>()) {
                 authorized = true;
-                Serial.println("Authorized OK");
+                LOG_INFO("Authorized OK\n");
+
+                // Lets the pool rotate the extranonce without a reconnect
+                SendToPool("{\"id\":3,\"method\":\"mining.extranonce.subscribe\",\"params\":[]}");
+                SuggestPoolDifficulty();
+                AuthorizeMinerWorkers();
             } else {
-                Serial.println("Authorization failed");
+                LOG_ERROR("Authorization failed\n");
             }
-        } else if (id >= 1000) {
-            if (doc["result"].as<bool>()) {
-                metrics.shares_ok++;
-                metrics.last_share_time = millis();
-                Serial.println("Share accepted!");
-            } else {
-                metrics.shares_bad++;
-                Serial.println("Share rejected!");
-                if (doc.containsKey("error") && doc["error"].size() > 1) {
-                    Serial.println("Error: " + doc["error"][1].as<String>());
-                }
+        } else if (id == 3) {
+            LOG_INFO("%s\n", doc["result"].as<bool>() ? "Extranonce updates enabled" : "Pool does not rotate extranonce");
+        } else if (id == 4) {
+            LOG_DEBUG("Difficulty suggestion %s\n", doc["result"].as<bool>() ? "accepted" : "ignored");
+        } else if (id == kPoolConfigureId) {
+            NotePoolConfigureResult(doc["result"]);
+        } else if (NoteWorkerAuthorizeResult(id, doc["result"].as<bool>())) {
+            return;
+        } else if (id >= kFirstMinerRequestId) {
+            RouteMinerResponse(doc, id);
+        }
+    }
+}
+
+namespace {
+void BeginPoolConnect(const String& host, const PoolTarget& pool) {
+    pool_tls = PoolUriUsesTls(pool.host);
+    ResetUpstreamExtranonce();
+    SetPoolResolverTarget(host, pool.port);
+
+    // An unexpected drop rotates to the next address without a new lookup
+    if (metrics.pool_connected) {
+        metrics.pool_connected = false;
+        ReportPoolEndpointResult(connected_endpoint, false);
+        if (config.pool_sv2) {
+            Sv2NoteLinkDropped();
+        }
+    }
+
+    // The boot cache seeds the resolver so the first connect needs no lookup
+    boot_seeded = CachedPoolAddress(host.c_str(), pool.port, boot_cached_ip);
+    if (boot_seeded) {
+        SeedPoolEndpoint(boot_cached_ip);
+    }
+
+    connect_phase = ConnectPhase::kEndpoints;
+    endpoint_attempts = 0;
+}
+
+void PoolConnected(const String& host, const PoolTarget& pool, const IPAddress& endpoint, bool used_endpoint) {
+    connect_phase = ConnectPhase::kIdle;
+    LOG_INFO("Connected to pool!\n");
+    metrics.pool_connected = true;
+
+    connected_endpoint = endpoint;
+    pending_requests.clear();
+    ResetPoolJobs();
+    ResetPoolTx();
+    ConfigurePoolLink();
+
+    if (metrics.boot_pool_ms == 0) {
+        metrics.boot_pool_ms = millis();
+        metrics.boot_cached_pool = used_endpoint && boot_seeded && endpoint == boot_cached_ip;
+    }
+    RememberPoolAddress(host.c_str(), pool.port, endpoint);
+
+    ResetUpstreamHandshake();
+    if (config.pool_sv2) {
+        Sv2BeginSession(host, pool.port);
+        return;
+    }
+
+    // BIP 310 wants extensions negotiated before the subscribe
+    SendToPool(PoolConfigureRequest());
+
+    DynamicJsonDocument doc(256);
+    doc["id"] = 1;
+    doc["method"] = "mining.subscribe";
+    doc["params"][0] = "ESPStratumProxy/1.0";
+    // Pools that support it hand back the same extranonce1, so work in
+    // progress on the miners stays valid across the reconnect
+    String session_id = ResumableSessionId();
+    if (session_id.length() > 0) {
+        doc["params"][1] = session_id;
+    }
+
+    String message;
+    serializeJson(doc, message);
+    SendToPool(message);
+    LOG_INFO("Subscribe sent\n");
+}
+
+void PoolConnectFailed() {
+    connect_phase = ConnectPhase::kIdle;
+    pool_lookup.Cancel();
+    LOG_ERROR("Failed to connect to pool, retrying in %lu s\n", kPoolRetryMs / 1000);
+    metrics.pool_connected = false;
+    retry_at_ms = millis() + kPoolRetryMs;
+    retry_pending = true;
+}
+}
+
+void ConnectToPool() {
+    const PoolTarget pool = ActivePool();
+    String host = SanitizePoolHost(pool.host);
+    if (connect_phase == ConnectPhase::kIdle) {
+        BeginPoolConnect(host, pool);
+    }
+
+    if (connect_phase == ConnectPhase::kEndpoints) {
+        IPAddress endpoint;
+        if (endpoint_attempts < PoolEndpointCount() && SelectPoolEndpoint(endpoint)) {
+            endpoint_attempts++;
+            LOG_INFO("Connecting to pool %s:%d via %s%s\n", host.c_str(), pool.port,
+                     endpoint.toString().c_str(), pool_tls ? " (TLS)" : "");
+            bool connected = OpenPoolConnection(endpoint, host);
+            ReportPoolEndpointResult(endpoint, connected);
+            if (connected) {
+                PoolConnected(host, pool, endpoint, true);
             }
+            return;
+        }
+        LOG_INFO("Connecting to pool %s:%d\n", host.c_str(), pool.port);
+        connect_phase = ConnectPhase::kResolving;
+        pool_lookup.Start(host);
+    }
+
+    HostLookup::State lookup_state = pool_lookup.Update();
+    if (lookup_state == HostLookup::State::kPending) {
+        return;
+    }
+    if (lookup_state != HostLookup::State::kDone) {
+        LOG_ERROR("Pool DNS lookup for %s failed\n", host.c_str());
+        PoolConnectFailed();
+        return;
+    }
+    const IPAddress endpoint = pool_lookup.address();
+    if (!OpenPoolConnection(endpoint, host)) {
+        PoolConnectFailed();
+        return;
+    }
+    SeedPoolEndpoint(endpoint);
+    ReportPoolEndpointResult(endpoint, true);
+    PoolConnected(host, pool, endpoint, false);
+}
+
+void HandlePoolData() {
+    if (config.pool_sv2) {
+        Sv2HandlePoolData();
+        return;
+    }
+
+    DrainReplacedPool();
+
+    // Drain a bounded number of lines so one burst cannot starve loop()
+    for (int processed = 0; processed < kMaxPoolLinesPerCall && PoolClient().available(); ++processed) {
+        String line = PoolClient().readStringUntil('\n');
+        metrics.pool_bytes_rx += line.length() + 1;
+        line.trim();
+
+        if (line.length() > 0) {
+            ProcessPoolLine(line);
+        }
+    }
+}
+
+void ForwardMinerRequest(MinerSession* session, const String& line) {
+    DynamicJsonDocument doc(kJsonDocOverhead + line.length());
+    if (deserializeJson(doc, line) != DeserializationError::Ok) {
+        LOG_ERROR("Dropping malformed miner request\n");
+        return;
+    }
+
+    String method = doc["method"] | "";
+    if (method == "mining.subscribe") {
+        NoteMinerUserAgent(session, doc["params"][0] | "");
+    } else if (method == "mining.authorize") {
+        NoteMinerWorker(session, doc["params"][0] | "");
+    } else if (method == "mining.submit") {
+        session->last_share_ms = millis();
+    }
+
+    // Each miner gets its own extranonce range from the upstream session
+    if (method == "mining.subscribe" || method == "mining.extranonce.subscribe") {
+        String id;
+        serializeJson(doc["id"], id);
+        if (method == "mining.subscribe") {
+            AnswerMinerSubscribe(session, id);
+        } else {
+            AnswerExtranonceSubscribe(session, id);
+        }
+        return;
+    }
+
+    // So is the rest of the handshake, whether or not the pool is up yet
+    if (AnswerMinerHandshake(session, doc)) {
+        return;
+    }
+
+    if (!PoolClient().connected()) {
+        return;
+    }
+
+    if (method == "mining.submit" && !PrepareMinerSubmit(session, doc)) {
+        return;
+    }
+
+    // Work for a retired job would only come back as a pool reject
+    if (method == "mining.submit" && IsPoolJobStale(doc["params"][1] | "")) {
+        String id;
+        serializeJson(doc["id"], id);
+        metrics.shares_stale++;
+        session->shares_stale++;
+        SendToMiner(session, "{\"id\":" + id + ",\"result\":null,\"error\":[" + String(kStaleShareError) +
+                                 ",\"Stale job\",null]}");
+        return;
+    }
+
+    if (method == "mining.submit" && doc["params"].size() > 2) {
+        String extranonce2 = UpstreamExtranonce2(session, doc["params"][2]);
+        if (extranonce2.length() > 0) {
+            doc["params"][2] = extranonce2;
+        }
+    }
+
+    // Rewrite the id so the reply can be routed back to this miner
+    if (!doc["id"].isNull()) {
+        if (pending_requests.size() >= kMaxPendingRequests) {
+            pending_requests.erase(pending_requests.begin());
+        }
+
+        PendingRequest request;
+        request.upstream_id = next_upstream_id;
+        request.session = session;
+        serializeJson(doc["id"], request.miner_id);
+        request.is_submit = method == "mining.submit";
+        request.sent_ms = millis();
+        request.pool_index = ActivePoolIndex();
+        request.difficulty = session->difficulty;
+        pending_requests.push_back(request);
+
+        doc["id"] = next_upstream_id;
+        next_upstream_id = next_upstream_id >= kMaxUpstreamId ? kFirstMinerRequestId : next_upstream_id + 1;
+    }
+
+    if (config.pool_sv2) {
+        Sv2ForwardMinerRequest(doc, doc["id"].as<uint32_t>());
+        return;
+    }
+
+    String message;
+    serializeJson(doc, message);
+    SendToPool(message, method == "mining.submit");
+}
+
+void ForgetMinerRequests(MinerSession* session) {
+    for (PendingRequest& request : pending_requests) {
+        if (request.session == session) {
+            request.session = nullptr;
         }
     }
 }
 
 void DisconnectFromPool() {
-    if (pool_client.connected()) {
-        pool_client.stop();
+    if (PoolClient().connected()) {
+        PoolClient().stop();
         metrics.pool_connected = false;
         subscribed = false;
         authorized = false;
-        Serial.println("Disconnected from pool (no miners connected)");
+        pending_requests.clear();
+        ResetPoolJobs();
+        ResetPoolTx();
+        ResetUpstreamExtranonce();
+        Sv2ResetSession();
+        ResetUpstreamHandshake();
+        EndPoolDrain();
+        LOG_INFO("Disconnected from pool\n");
     }
 }
 
 bool ShouldConnectToPool() {
-    return connected_miners.size() > 0;
+    if (connected_miners.size() > 0) {
+        return true;
+    }
+
+    // After a reboot with a known pool, warm the upstream up before miners return
+    return CurrentBootCache().pool_valid && metrics.boot_first_notify_ms == 0 && millis() < kBootWarmupMs;
+}
+
+void ServicePoolLink() {
+    const bool wanted = ShouldConnectToPool();
+    const bool retry_wait = retry_pending && static_cast<long>(millis() - retry_at_ms) < 0;
+
+    // A handover under way brings its own connection
+    if (wanted && !PoolClient().connected() && !PoolHandoverActive() && !retry_wait) {
+        retry_pending = false;
+        ConnectToPool();
+    } else if (!wanted && connect_phase != ConnectPhase::kIdle) {
+        connect_phase = ConnectPhase::kIdle;
+        pool_lookup.Cancel();
+    }
+
+    if (PoolClient().connected() && !wanted) {
+        DisconnectFromPool();
+    }
+
+    if (PoolClient().connected()) {
+        HandlePoolData();
+        ServicePoolTx();
+    }
+}
+
+void WakePoolLink() {
+    SignalTask(ServicePoolLink);
 }
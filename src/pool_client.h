@@ -1,6 +1,44 @@
 #pragma once
 
+#include <Arduino.h>
+#include <WiFiClient.h>
+
+#include "miner_session.h"
+
+// Plaintext or TLS transport, picked from the pool URI on each connect
+WiFiClient& PoolClient();
+
+// Writes one JSON-RPC line to the live pool link; shares may be batched
+void SendToPool(const String& line, bool share = false);
+
+// Host name from the configured pool URI, without scheme, port or path
+String SanitizePoolHost(const char* raw_host);
+
+// One step of a connect: a single dial to one cached address, bounded by a
+// short timeout, or a poll of the background host lookup. Called on every
+// run of the pool task until the link is up or the attempt has failed.
 void ConnectToPool();
 void HandlePoolData();
 void DisconnectFromPool();
+void ProcessPoolLine(const String& line);
 bool ShouldConnectToPool();
+
+// Connects, disconnects and reads the pool link as the miners need; the
+// scheduler's high-priority task
+void ServicePoolLink();
+// Has ServicePoolLink run now instead of at its next period
+void WakePoolLink();
+
+// Sends mining.suggest_difficulty with the configured difficulty, if any
+void SuggestPoolDifficulty();
+
+// The plaintext slot not carrying traffic, for a pool handover to dial the
+// next pool on. Claiming it closes a replaced link that is still draining.
+WiFiClient& ClaimStandbyPoolClient();
+// Makes the subscribed and authorized standby link the live one. The old
+// link stays open a few seconds to route replies still in flight; miners
+// get the new extranonce with the next job processed.
+void AdoptStandbyPool(const String& extranonce1, int extranonce2_size);
+
+void ForwardMinerRequest(MinerSession* session, const String& line);
+void ForgetMinerRequests(MinerSession* session);
@@ -0,0 +1,224 @@
+#include "pool_handover.h"
+
+#include <ArduinoJson.h>
+#include <WiFiClient.h>
+
+#include "app_context.h"
+#include "host_lookup.h"
+#include "log.h"
+#include "miner_handshake.h"
+#include "pool_client.h"
+#include "pool_split.h"
+
+namespace {
+constexpr unsigned long kHandoverTimeoutMs = 30000;
+// The task runs at high priority, so an unreachable pool must fail fast
+constexpr unsigned long kConnectTimeoutMs = 1000;
+constexpr int kMaxLinesPerCall = 16;
+constexpr size_t kJsonDocOverhead = 1024;
+
+HandoverState state = HandoverState::kIdle;
+HandoverStats stats;
+unsigned long started_ms = 0;
+size_t target_index = kPrimaryPool;
+String extranonce1;
+int extranonce2_size = 0;
+String configure_line;
+String difficulty_line;
+String notify_line;
+
+WiFiClient* link = nullptr;
+HostLookup lookup;
+
+void Send(const String& line) {
+    LOG_DEBUG("Handover to pool: %s\n", line.c_str());
+    link->print(line + "\n");
+}
+
+void Abandon(const char* reason) {
+    LOG_ERROR("Pool handover failed: %s; staying on the current pool\n", reason);
+    lookup.Cancel();
+    link->stop();
+    link = nullptr;
+    state = HandoverState::kIdle;
+    stats.failed++;
+    stats.last_error = reason;
+}
+
+void Complete() {
+    // A clean job, so nothing mined for the old pool is submitted to the new one
+    DynamicJsonDocument doc(kJsonDocOverhead + notify_line.length());
+    deserializeJson(doc, notify_line);
+    if (doc["params"].size() > 8) {
+        doc["params"][8] = true;
+        notify_line = "";
+        serializeJson(doc, notify_line);
+    }
+
+    SetActivePool(target_index);
+    AdoptStandbyPool(extranonce1, extranonce2_size);
+    if (configure_line.length() > 0) {
+        ProcessPoolLine(configure_line);
+    }
+    ConcludePoolConfigure();
+    if (difficulty_line.length() > 0) {
+        ProcessPoolLine(difficulty_line);
+    }
+    ProcessPoolLine(notify_line);
+
+    link = nullptr;
+    state = HandoverState::kIdle;
+    stats.completed++;
+    stats.last_duration_ms = millis() - started_ms;
+    stats.last_error = "";
+    LOG_INFO("Pool handover to %s:%d done in %lu ms\n", ActivePool().host, ActivePool().port, stats.last_duration_ms);
+}
+
+void Dial() {
+    const PoolTarget target = PoolTargetAt(target_index);
+    if (!ConnectWithTimeout(*link, lookup.address(), target.port, kConnectTimeoutMs)) {
+        Abandon("connect failed");
+        return;
+    }
+    link->setNoDelay(true);
+    state = HandoverState::kSubscribing;
+    Send(PoolConfigureRequest());
+    Send("{\"id\":1,\"method\":\"mining.subscribe\",\"params\":[\"ESPStratumProxy/1.0\"]}");
+}
+
+void HandleLine(const String& line) {
+    DynamicJsonDocument doc(kJsonDocOverhead + line.length());
+    if (deserializeJson(doc, line) != DeserializationError::Ok) {
+        return;
+    }
+
+    if (doc.containsKey("method")) {
+        String method = doc["method"];
+        if (method == "mining.set_difficulty") {
+            difficulty_line = line;
+        } else if (method == "mining.notify") {
+            notify_line = line;
+        } else if (method == "mining.set_extranonce" && doc["params"].size() > 1) {
+            extranonce1 = doc["params"][0].as<String>();
+            extranonce2_size = doc["params"][1].as<int>();
+        }
+        return;
+    }
+
+    uint32_t id = doc["id"] | 0;
+    if (id == kPoolConfigureId) {
+        configure_line = line;
+    } else if (id == 1 && state == HandoverState::kSubscribing) {
+        if (!doc["result"].is<JsonArray>() || doc["result"].size() < 3) {
+            Abandon("subscribe refused");
+            return;
+        }
+        extranonce1 = doc["result"][1].as<String>();
+        extranonce2_size = doc["result"][2].as<int>();
+
+        DynamicJsonDocument auth_doc(256);
+        auth_doc["id"] = 2;
+        auth_doc["method"] = "mining.authorize";
+        auth_doc["params"][0] = PoolTargetAt(target_index).user;
+        auth_doc["params"][1] = PoolTargetAt(target_index).pass;
+        String auth_message;
+        serializeJson(auth_doc, auth_message);
+        Send(auth_message);
+        state = HandoverState::kAuthorizing;
+    } else if (id == 2 && state == HandoverState::kAuthorizing) {
+        if (!doc["result"].as<bool>()) {
+            Abandon("authorization refused");
+            return;
+        }
+        Send("{\"id\":3,\"method\":\"mining.extranonce.subscribe\",\"params\":[]}");
+        if (config.difficulty > 0) {
+            Send("{\"id\":4,\"method\":\"mining.suggest_difficulty\",\"params\":[" + String(config.difficulty) + "]}");
+        }
+        state = HandoverState::kWaitingForJob;
+    }
+}
+}
+
+void BeginPoolHandover(size_t pool_index) {
+    if (state != HandoverState::kIdle) {
+        link->stop();
+        LOG_INFO("Pool changed again, restarting handover\n");
+    }
+
+    configure_line = "";
+    difficulty_line = "";
+    notify_line = "";
+    started_ms = millis();
+    target_index = pool_index;
+    link = &ClaimStandbyPoolClient();
+
+    const PoolTarget target = PoolTargetAt(target_index);
+    String host = SanitizePoolHost(target.host);
+    LOG_INFO("Pool handover: connecting to %s:%d alongside the current pool\n", host.c_str(), target.port);
+    state = HandoverState::kResolving;
+    lookup.Start(host);
+}
+
+void UpdatePoolHandover() {
+    if (state == HandoverState::kIdle) {
+        return;
+    }
+    if (millis() - started_ms >= kHandoverTimeoutMs) {
+        Abandon("timed out");
+        return;
+    }
+    if (state == HandoverState::kResolving) {
+        HostLookup::State lookup_state = lookup.Update();
+        if (lookup_state == HostLookup::State::kFailed) {
+            Abandon("DNS lookup failed");
+        } else if (lookup_state == HostLookup::State::kDone) {
+            Dial();
+        }
+        return;
+    }
+
+    for (int processed = 0; processed < kMaxLinesPerCall && link->available(); ++processed) {
+        String line = link->readStringUntil('\n');
+        line.trim();
+        if (line.length() > 0) {
+            HandleLine(line);
+        }
+        if (state == HandoverState::kIdle) {
+            return;
+        }
+    }
+
+    if (state == HandoverState::kWaitingForJob && notify_line.length() > 0) {
+        Complete();
+    } else if (!link->connected()) {
+        Abandon("connection closed");
+    }
+}
+
+bool PoolHandoverActive() {
+    return state != HandoverState::kIdle;
+}
+
+const char* HandoverStateName(HandoverState handover_state) {
+    switch (handover_state) {
+        case HandoverState::kIdle:
+            return "idle";
+        case HandoverState::kResolving:
+            return "resolving";
+        case HandoverState::kSubscribing:
+            return "subscribing";
+        case HandoverState::kAuthorizing:
+            return "authorizing";
+        case HandoverState::kWaitingForJob:
+            return "waiting_for_job";
+    }
+    return "idle";
+}
+
+HandoverState CurrentHandoverState() {
+    return state;
+}
+
+const HandoverStats& CurrentHandoverStats() {
+    return stats;
+}
@@ -0,0 +1,31 @@
+#pragma once
+
+#include <Arduino.h>
+
+// Moves the proxy to another pool without dropping miners: a newly
+// configured one, or the other side of a pool split. The new pool is
+// resolved without blocking, dialled by address with a short connect
+// timeout, subscribed and authorized on a second connection while the
+// current one keeps serving jobs; at the first job from the new
+// pool the second connection becomes the live one and that job goes out
+// with clean_jobs set. Stratum V1 over plaintext only: TLS and V2 links have
+// one connection slot each and are simply reconnected.
+
+enum class HandoverState : uint8_t { kIdle, kResolving, kSubscribing, kAuthorizing, kWaitingForJob };
+
+struct HandoverStats {
+    unsigned long completed = 0;
+    unsigned long failed = 0;
+    // Dial to switch for the last completed handover
+    unsigned long last_duration_ms = 0;
+    const char* last_error = "";
+};
+
+// Dials the pool at pool_index (see pool_split.h) with its settings now in config
+void BeginPoolHandover(size_t pool_index);
+void UpdatePoolHandover();
+bool PoolHandoverActive();
+
+const char* HandoverStateName(HandoverState state);
+HandoverState CurrentHandoverState();
+const HandoverStats& CurrentHandoverStats();
@@ -0,0 +1,390 @@
+#include "pool_probe.h"
+
+#include <ArduinoJson.h>
+#include <WiFiClient.h>
+#include <algorithm>
+#include <vector>
+
+#include "app_context.h"
+#include "host_lookup.h"
+#include "log.h"
+#include "pool_client.h"
+#include "pool_split.h"
+#include "pool_tls.h"
+
+namespace {
+constexpr unsigned long kReplyTimeoutMs = 10000;
+// The connect still runs on the loop, so an unreachable pool fails fast
+constexpr unsigned long kConnectTimeoutMs = 1000;
+constexpr int kMaxLinesPerCall = 16;
+constexpr size_t kMaxLineLength = 2048;
+constexpr size_t kJsonDocOverhead = 512;
+constexpr long kUnmeasured = -1;
+
+enum Metric : uint8_t { kDns, kConnect, kSubscribe, kAuthorize, kFirstNotify, kNotifyInterval, kMetricCount };
+const char* const kMetricNames[kMetricCount] = {
+    "dns_ms", "connect_ms", "subscribe_ms", "authorize_ms", "first_notify_ms", "notify_interval_ms",
+};
+
+enum class ProbePhase : uint8_t { kIdle, kStarting, kResolving, kSubscribing, kAuthorizing, kWaitingForJob, kWatching, kDone };
+
+struct ProbeSample {
+    // Microseconds, kUnmeasured when the sample ended before the step
+    long us[kMetricCount];
+    const char* error = "";
+};
+
+PoolProbeRequest target;
+ProbeSample samples[kMaxProbeSamples];
+int samples_done = 0;
+ProbePhase phase = ProbePhase::kIdle;
+unsigned long started_ms = 0;
+unsigned long phase_started_ms = 0;
+unsigned long request_sent_us = 0;
+unsigned long lookup_started_us = 0;
+unsigned long connected_us = 0;
+unsigned long first_notify_us = 0;
+bool authorized = false;
+
+WiFiClient link;
+HostLookup lookup;
+// Bytes read but not yet a whole line
+String rx_buffer;
+
+const char* PhaseName(ProbePhase probe_phase) {
+    switch (probe_phase) {
+        case ProbePhase::kIdle:
+            return "idle";
+        case ProbePhase::kStarting:
+            return "connecting";
+        case ProbePhase::kResolving:
+            return "resolving";
+        case ProbePhase::kSubscribing:
+            return "subscribing";
+        case ProbePhase::kAuthorizing:
+            return "authorizing";
+        case ProbePhase::kWaitingForJob:
+            return "waiting_for_job";
+        case ProbePhase::kWatching:
+            return "watching_notify_interval";
+        case ProbePhase::kDone:
+            return "done";
+    }
+    return "idle";
+}
+
+ProbeSample& CurrentSample() {
+    return samples[samples_done];
+}
+
+void EnterPhase(ProbePhase next) {
+    phase = next;
+    phase_started_ms = millis();
+}
+
+void Send(const String& line) {
+    LOG_DEBUG("Probe to pool: %s\n", line.c_str());
+    link.print(line + "\n");
+    request_sent_us = micros();
+}
+
+void FinishSample(const char* error) {
+    lookup.Cancel();
+    link.stop();
+    ProbeSample& sample = CurrentSample();
+    sample.error = error;
+    if (error[0] != '\0') {
+        LOG_ERROR("Pool probe %d/%d of %s:%d: %s\n", samples_done + 1, target.samples, target.host.c_str(),
+                  target.port, error);
+    } else {
+        LOG_INFO("Pool probe %d/%d of %s:%d: connect %ld us, subscribe %ld us, authorize %ld us, first job %ld us\n",
+                 samples_done + 1, target.samples, target.host.c_str(), target.port, sample.us[kConnect],
+                 sample.us[kSubscribe], sample.us[kAuthorize], sample.us[kFirstNotify]);
+    }
+
+    samples_done++;
+    EnterPhase(samples_done < target.samples ? ProbePhase::kStarting : ProbePhase::kDone);
+}
+
+void StartSample() {
+    ProbeSample& sample = CurrentSample();
+    sample = ProbeSample();
+    std::fill(sample.us, sample.us + kMetricCount, kUnmeasured);
+    authorized = false;
+    rx_buffer = "";
+
+    EnterPhase(ProbePhase::kResolving);
+    lookup_started_us = micros();
+    lookup.Start(target.host);
+}
+
+// Polled while resolving; connects once the address is known
+void UpdateLookup() {
+    HostLookup::State lookup_state = lookup.Update();
+    if (lookup_state == HostLookup::State::kPending) {
+        return;
+    }
+    if (lookup_state != HostLookup::State::kDone) {
+        FinishSample("DNS lookup failed");
+        return;
+    }
+    ProbeSample& sample = CurrentSample();
+    sample.us[kDns] = micros() - lookup_started_us;
+
+    const unsigned long step_us = micros();
+    if (!ConnectWithTimeout(link, lookup.address(), target.port, kConnectTimeoutMs)) {
+        FinishSample("connect failed");
+        return;
+    }
+    connected_us = micros();
+    sample.us[kConnect] = connected_us - step_us;
+    link.setNoDelay(true);
+
+    EnterPhase(ProbePhase::kSubscribing);
+    Send("{\"id\":1,\"method\":\"mining.subscribe\",\"params\":[\"ESPStratumProxy/1.0 probe\"]}");
+}
+
+// A sample ends once it has its first job on an authorized session and,
+// when asked for, the gap to the next job
+void CheckSampleComplete() {
+    ProbeSample& sample = CurrentSample();
+    if (!authorized || sample.us[kFirstNotify] == kUnmeasured) {
+        return;
+    }
+    if (target.watch_s == 0 || sample.us[kNotifyInterval] != kUnmeasured) {
+        FinishSample("");
+        return;
+    }
+    if (phase != ProbePhase::kWatching) {
+        EnterPhase(ProbePhase::kWatching);
+    }
+}
+
+void HandleLine(const String& line) {
+    DynamicJsonDocument doc(kJsonDocOverhead + line.length());
+    if (deserializeJson(doc, line) != DeserializationError::Ok) {
+        return;
+    }
+    const unsigned long now_us = micros();
+    ProbeSample& sample = CurrentSample();
+
+    if (doc.containsKey("method")) {
+        String method = doc["method"];
+        if (method != "mining.notify") {
+            return;
+        }
+        // Some pools send the first job before the authorize reply
+        if (sample.us[kFirstNotify] == kUnmeasured) {
+            sample.us[kFirstNotify] = now_us - connected_us;
+            first_notify_us = now_us;
+        } else if (sample.us[kNotifyInterval] == kUnmeasured) {
+            sample.us[kNotifyInterval] = now_us - first_notify_us;
+        }
+        CheckSampleComplete();
+        return;
+    }
+
+    uint32_t id = doc["id"] | 0;
+    if (id == 1 && phase == ProbePhase::kSubscribing) {
+        sample.us[kSubscribe] = now_us - request_sent_us;
+        if (!doc["result"].is<JsonArray>() || doc["result"].size() < 3) {
+            FinishSample("subscribe refused");
+            return;
+        }
+        DynamicJsonDocument auth_doc(256);
+        auth_doc["id"] = 2;
+        auth_doc["method"] = "mining.authorize";
+        auth_doc["params"][0] = target.user;
+        auth_doc["params"][1] = target.pass;
+        String auth_message;
+        serializeJson(auth_doc, auth_message);
+        EnterPhase(ProbePhase::kAuthorizing);
+        Send(auth_message);
+    } else if (id == 2 && phase == ProbePhase::kAuthorizing) {
+        sample.us[kAuthorize] = now_us - request_sent_us;
+        if (!doc["result"].as<bool>()) {
+            FinishSample("authorization refused");
+            return;
+        }
+        authorized = true;
+        EnterPhase(ProbePhase::kWaitingForJob);
+        CheckSampleComplete();
+    }
+}
+
+// Nearest rank; values is sorted
+long Percentile(const std::vector<long>& values, int pct) {
+    size_t rank = (values.size() * pct + 99) / 100;
+    return values[rank > 0 ? rank - 1 : 0];
+}
+}
+
+const char* StartPoolProbe(const PoolProbeRequest& request) {
+    if (PoolProbeActive()) {
+        return "a probe is already running";
+    }
+
+    PoolProbeRequest next = request;
+    const PoolTarget pool = ActivePool();
+    if (next.host.length() == 0) {
+        if (config.pool_sv2) {
+            return "Stratum V2 pools are not probed";
+        }
+        next.host = pool.host;
+        next.port = pool.port;
+    }
+    if (next.user.length() == 0) {
+        next.user = pool.user;
+        next.pass = pool.pass;
+    }
+    if (PoolUriUsesTls(next.host.c_str())) {
+        return "stratum+ssl pools are not probed";
+    }
+    next.host = SanitizePoolHost(next.host.c_str());
+    if (next.port <= 0 || next.port > 65535) {
+        return "port must be 1-65535";
+    }
+    if (next.samples < 1 || next.samples > kMaxProbeSamples) {
+        return "samples must be 1-10";
+    }
+    if (next.watch_s < 0 || next.watch_s > kMaxProbeWatchS) {
+        return "watch_s must be 0-300";
+    }
+
+    target = next;
+    samples_done = 0;
+    started_ms = millis();
+    EnterPhase(ProbePhase::kStarting);
+    LOG_INFO("Pool probe: %d samples of %s:%d\n", target.samples, target.host.c_str(), target.port);
+    return nullptr;
+}
+
+void UpdatePoolProbe() {
+    if (!PoolProbeActive()) {
+        return;
+    }
+    if (phase == ProbePhase::kStarting) {
+        StartSample();
+    }
+    if (phase == ProbePhase::kResolving) {
+        UpdateLookup();
+        if (phase != ProbePhase::kSubscribing) {
+            return;
+        }
+    }
+
+    // Only what has arrived: readStringUntil() would wait out the stream
+    // timeout on a line the pool has only sent part of
+    char chunk[256];
+    int available = link.available();
+    while (available > 0) {
+        int got = link.read(reinterpret_cast<uint8_t*>(chunk), std::min<int>(available, sizeof(chunk)));
+        if (got <= 0) {
+            break;
+        }
+        rx_buffer.concat(chunk, got);
+        available -= got;
+    }
+
+    int newline = rx_buffer.indexOf('\n');
+    for (int processed = 0; processed < kMaxLinesPerCall && PoolProbeActive() && phase != ProbePhase::kStarting &&
+                            newline != -1;
+         ++processed) {
+        String line = rx_buffer.substring(0, newline);
+        rx_buffer.remove(0, newline + 1);
+        line.trim();
+        if (line.length() > 0) {
+            HandleLine(line);
+        }
+        newline = rx_buffer.indexOf('\n');
+    }
+    if (!PoolProbeActive() || phase == ProbePhase::kStarting) {
+        return;
+    }
+    if (rx_buffer.length() > kMaxLineLength) {
+        FinishSample("oversized line");
+        return;
+    }
+
+    const unsigned long now = millis();
+    if (phase == ProbePhase::kWatching) {
+        if (now - phase_started_ms >= static_cast<unsigned long>(target.watch_s) * 1000) {
+            FinishSample("");
+        } else if (!link.connected()) {
+            FinishSample("connection closed");
+        }
+        return;
+    }
+    if (now - phase_started_ms >= kReplyTimeoutMs) {
+        FinishSample("timed out");
+        return;
+    }
+    if (!link.connected()) {
+        FinishSample("connection closed");
+    }
+}
+
+bool PoolProbeActive() {
+    return phase != ProbePhase::kIdle && phase != ProbePhase::kDone;
+}
+
+String PoolProbeJson() {
+    DynamicJsonDocument doc(kJsonDocOverhead + kMaxProbeSamples * 192 + kMetricCount * 96);
+    doc["state"] = phase == ProbePhase::kIdle ? "idle" : (phase == ProbePhase::kDone ? "done" : "running");
+    if (PoolProbeActive()) {
+        doc["phase"] = PhaseName(phase);
+    }
+    if (phase != ProbePhase::kIdle) {
+        doc["target"] = target.host + ":" + String(target.port);
+        doc["samples_wanted"] = target.samples;
+        doc["watch_s"] = target.watch_s;
+        doc["elapsed_ms"] = millis() - started_ms;
+    }
+
+    int failed = 0;
+    JsonArray rows = doc.createNestedArray("samples");
+    for (int i = 0; i < samples_done; ++i) {
+        const ProbeSample& sample = samples[i];
+        JsonObject row = rows.createNestedObject();
+        for (int metric = 0; metric < kMetricCount; ++metric) {
+            if (sample.us[metric] != kUnmeasured) {
+                row[kMetricNames[metric]] = sample.us[metric] / 1000.0;
+            }
+        }
+        if (sample.error[0] != '\0') {
+            row["error"] = sample.error;
+            failed++;
+        }
+    }
+    doc["failed"] = failed;
+
+    // Every step a sample got through counts, so a refused authorize still
+    // contributes its connect and subscribe times
+    JsonObject summary = doc.createNestedObject("summary");
+    std::vector<long> values;
+    for (int metric = 0; metric < kMetricCount; ++metric) {
+        values.clear();
+        for (int i = 0; i < samples_done; ++i) {
+            if (samples[i].us[metric] != kUnmeasured) {
+                values.push_back(samples[i].us[metric]);
+            }
+        }
+        if (values.empty()) {
+            continue;
+        }
+        std::sort(values.begin(), values.end());
+        double total = 0;
+        for (long value : values) {
+            total += value;
+        }
+        JsonObject entry = summary.createNestedObject(kMetricNames[metric]);
+        entry["count"] = values.size();
+        entry["min"] = values.front() / 1000.0;
+        entry["avg"] = total / values.size() / 1000.0;
+        entry["p95"] = Percentile(values, 95) / 1000.0;
+    }
+
+    String json;
+    serializeJson(doc, json);
+    return json;
+}
@@ -0,0 +1,35 @@
+#pragma once
+
+#include <Arduino.h>
+
+// Measures a pool from where the proxy sits, on a connection of its own so
+// the live session is not touched. Each sample resolves the host, connects,
+// subscribes and authorizes, waits for the first mining.notify and then
+// watches for the next one to time the notify interval. Several samples
+// give min/avg/p95 for comparing endpoints before switching to one.
+// Stratum V1 over plaintext only. The host is resolved in the background;
+// the TCP connect blocks the probe task for at most a second. Replies are
+// read on the task's 5 ms period, which bounds the timings' resolution.
+
+constexpr int kMaxProbeSamples = 10;
+constexpr int kMaxProbeWatchS = 300;
+
+struct PoolProbeRequest {
+    // Empty host probes the pool the proxy is on, with its credentials
+    String host;
+    int port = 0;
+    String user;
+    String pass;
+    int samples = 1;
+    // How long each sample waits for a second notify; 0 skips the interval
+    int watch_s = 60;
+};
+
+// nullptr when the probe started, otherwise why it did not
+const char* StartPoolProbe(const PoolProbeRequest& request);
+// Scheduler task
+void UpdatePoolProbe();
+bool PoolProbeActive();
+
+// Progress, every sample so far and the summary, as JSON
+String PoolProbeJson();
@@ -0,0 +1,445 @@
+#include "pool_resolver.h"
+
+#include <Arduino.h>
+#include <WiFiUdp.h>
+#include <vector>
+
+#if defined(ESP32) || defined(YUMA_HOST)
+#include <WiFi.h>
+#include <AsyncTCP.h>
+#elif defined(ESP8266)
+#include <ESP8266WiFi.h>
+#include <ESPAsyncTCP.h>
+#endif
+
+#include "dns_wire.h"
+#include "log.h"
+
+namespace {
+constexpr size_t kMaxEndpoints = 8;
+constexpr uint16_t kDnsPort = 53;
+constexpr unsigned long kDnsTimeoutMs = 3000;
+constexpr uint8_t kDnsMaxAttempts = 3;
+constexpr unsigned long kDnsRetryBackoffMs = 30000;
+constexpr uint32_t kMinTtlSeconds = 30;
+constexpr uint32_t kMaxTtlSeconds = 3600;
+constexpr uint32_t kLiteralTtlSeconds = 0xFFFFFFFF;
+constexpr unsigned long kProbeIntervalMs = 60000;
+constexpr unsigned long kProbeTimeoutMs = 5000;
+
+String target_host = "";
+int target_port = 0;
+bool target_is_literal = false;
+
+std::vector<PoolEndpoint> endpoints;
+IPAddress active_address;
+PoolEndpoint empty_endpoint{};
+
+WiFiUDP dns_udp;
+bool dns_socket_open = false;
+bool query_pending = false;
+uint16_t query_id = 0;
+uint8_t query_attempts = 0;
+unsigned long query_sent_ms = 0;
+unsigned long last_query_failure_ms = 0;
+bool query_failed_recently = false;
+
+// Written from the TCP callback context, consumed in loop(). A single client is
+// reused for every probe so callbacks never race a delete.
+struct ProbeState {
+    IPAddress address;
+    unsigned long started_ms = 0;
+    bool active = false;
+    volatile bool finished = false;
+    volatile bool ok = false;
+    volatile unsigned long rtt_ms = 0;
+};
+ProbeState probe;
+AsyncClient probe_client;
+bool probe_callbacks_set = false;
+size_t next_probe_index = 0;
+
+int FindEndpoint(const IPAddress& address) {
+    for (size_t i = 0; i < endpoints.size(); ++i) {
+        if (endpoints[i].address == address) {
+            return static_cast<int>(i);
+        }
+    }
+    return -1;
+}
+
+PoolEndpoint& UpsertEndpoint(const IPAddress& address) {
+    int index = FindEndpoint(address);
+    if (index >= 0) {
+        return endpoints[index];
+    }
+
+    PoolEndpoint endpoint{};
+    endpoint.address = address;
+    endpoint.rtt_ms = -1;
+    endpoint.healthy = true;
+    endpoints.push_back(endpoint);
+    return endpoints.back();
+}
+
+bool EndpointExpired(const PoolEndpoint& endpoint, unsigned long now) {
+    if (endpoint.ttl_s == kLiteralTtlSeconds) {
+        return false;
+    }
+    return now - endpoint.resolved_ms >= endpoint.ttl_s * 1000UL;
+}
+
+bool AnyEndpointExpired(unsigned long now) {
+    if (endpoints.empty()) {
+        return true;
+    }
+    for (const PoolEndpoint& endpoint : endpoints) {
+        if (EndpointExpired(endpoint, now)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+// Drops addresses the latest answer no longer lists
+void PruneExpiredEndpoints(unsigned long now) {
+    for (size_t i = endpoints.size(); i-- > 0;) {
+        if (EndpointExpired(endpoints[i], now)) {
+            endpoints.erase(endpoints.begin() + i);
+        }
+    }
+    next_probe_index = 0;
+}
+
+// Returns the number of A records merged into the endpoint table
+int ParseResponse(const uint8_t* data, size_t len) {
+    if (!Dns::IsResponseTo(data, len, query_id)) {
+        return -1;
+    }
+    if ((data[3] & 0x0F) != 0) {
+        return 0;
+    }
+
+    uint16_t questions = Dns::ReadU16(data + 4);
+    uint16_t answers = Dns::ReadU16(data + 6);
+    size_t pos = Dns::kHeaderSize;
+
+    for (uint16_t i = 0; i < questions; ++i) {
+        if (!Dns::SkipName(data, len, pos)) {
+            return 0;
+        }
+        pos += 4;
+    }
+
+    const unsigned long now = millis();
+    int records = 0;
+    for (uint16_t i = 0; i < answers && pos < len; ++i) {
+        if (!Dns::SkipName(data, len, pos) || pos + 10 > len) {
+            break;
+        }
+        uint16_t type = Dns::ReadU16(data + pos);
+        uint16_t klass = Dns::ReadU16(data + pos + 2);
+        uint32_t ttl = Dns::ReadU32(data + pos + 4);
+        uint16_t rdlength = Dns::ReadU16(data + pos + 8);
+        pos += 10;
+        if (pos + rdlength > len) {
+            break;
+        }
+
+        if (type == Dns::kTypeA && klass == Dns::kClassIn && rdlength == 4) {
+            IPAddress address(data[pos], data[pos + 1], data[pos + 2], data[pos + 3]);
+            // The cap is on the table; addresses already in it still get their TTL refreshed
+            if (FindEndpoint(address) < 0 && endpoints.size() >= kMaxEndpoints) {
+                pos += rdlength;
+                continue;
+            }
+            PoolEndpoint& endpoint = UpsertEndpoint(address);
+            endpoint.resolved_ms = now;
+            endpoint.ttl_s = constrain(ttl, kMinTtlSeconds, kMaxTtlSeconds);
+            records++;
+        }
+        pos += rdlength;
+    }
+
+    return records;
+}
+
+void SendQuery() {
+    IPAddress dns_server = WiFi.dnsIP();
+    if (static_cast<uint32_t>(dns_server) == 0) {
+        return;
+    }
+
+    if (!dns_socket_open) {
+        dns_socket_open = dns_udp.begin(0);
+        if (!dns_socket_open) {
+            return;
+        }
+    }
+
+    uint8_t packet[300];
+    query_id = static_cast<uint16_t>(random(1, 0xFFFF));
+    size_t len = Dns::EncodeQuery(packet, sizeof(packet), target_host.c_str(), query_id, Dns::kTypeA, true);
+    if (len == 0) {
+        LOG_ERROR("Pool host %s cannot be encoded as a DNS query\n", target_host.c_str());
+        return;
+    }
+
+    dns_udp.beginPacket(dns_server, kDnsPort);
+    dns_udp.write(packet, len);
+    dns_udp.endPacket();
+
+    query_pending = true;
+    query_sent_ms = millis();
+    query_attempts++;
+}
+
+void PollQuery() {
+    int size = dns_udp.parsePacket();
+    if (size <= 0) {
+        if (millis() - query_sent_ms < kDnsTimeoutMs) {
+            return;
+        }
+        query_pending = false;
+        if (query_attempts < kDnsMaxAttempts) {
+            SendQuery();
+        } else {
+            LOG_ERROR("Pool DNS lookup for %s timed out, keeping %u cached endpoints\n",
+                      target_host.c_str(), static_cast<unsigned int>(endpoints.size()));
+            query_failed_recently = true;
+            last_query_failure_ms = millis();
+        }
+        return;
+    }
+
+    uint8_t packet[512];
+    size_t len = dns_udp.read(packet, sizeof(packet));
+    int records = ParseResponse(packet, len);
+    if (records < 0) {
+        return;  // stray or mismatched packet, keep waiting
+    }
+
+    query_pending = false;
+    if (records == 0) {
+        query_failed_recently = true;
+        last_query_failure_ms = millis();
+        LOG_ERROR("Pool DNS lookup for %s returned no A records\n", target_host.c_str());
+        return;
+    }
+
+    query_failed_recently = false;
+    PruneExpiredEndpoints(millis());
+    LOG_INFO("Pool DNS: %s has %d addresses\n", target_host.c_str(), records);
+}
+
+void SetProbeCallbacks() {
+    probe_client.onConnect([](void* arg, AsyncClient* c) {
+        probe.rtt_ms = millis() - probe.started_ms;
+        probe.ok = true;
+        probe.finished = true;
+        c->close(true);
+    }, nullptr);
+    probe_client.onError([](void* arg, AsyncClient* c, int8_t error) {
+        probe.finished = true;
+    }, nullptr);
+    probe_client.onTimeout([](void* arg, AsyncClient* c, uint32_t time) {
+        probe.finished = true;
+        c->close(true);
+    }, nullptr);
+    probe_client.onDisconnect([](void* arg, AsyncClient* c) {
+        probe.finished = true;
+    }, nullptr);
+    probe_callbacks_set = true;
+}
+
+void StartProbe(PoolEndpoint& endpoint) {
+    if (!probe_callbacks_set) {
+        SetProbeCallbacks();
+    }
+
+    probe.address = endpoint.address;
+    probe.started_ms = millis();
+    probe.active = true;
+    probe.finished = false;
+    probe.ok = false;
+    endpoint.last_probe_ms = probe.started_ms;
+
+    if (!probe_client.connect(endpoint.address, target_port)) {
+        probe.finished = true;
+    }
+}
+
+void FinishProbe() {
+    probe.active = false;
+
+    int index = FindEndpoint(probe.address);
+    if (index < 0) {
+        return;
+    }
+
+    PoolEndpoint& endpoint = endpoints[index];
+    if (probe.ok) {
+        endpoint.rtt_ms = probe.rtt_ms;
+        endpoint.healthy = true;
+        endpoint.failures = 0;
+    } else {
+        endpoint.healthy = false;
+        if (endpoint.failures < 255) {
+            endpoint.failures++;
+        }
+    }
+}
+
+void ServiceProbes(unsigned long now) {
+    if (probe.active) {
+        if (!probe.finished && now - probe.started_ms < kProbeTimeoutMs) {
+            return;
+        }
+        if (!probe.finished) {
+            probe_client.close(true);
+        }
+        FinishProbe();
+    }
+
+    if (endpoints.empty() || target_port <= 0) {
+        return;
+    }
+
+    // Unmeasured endpoints go first, then a slow round-robin refresh
+    for (PoolEndpoint& endpoint : endpoints) {
+        if (endpoint.last_probe_ms == 0) {
+            StartProbe(endpoint);
+            return;
+        }
+    }
+
+    next_probe_index %= endpoints.size();
+    PoolEndpoint& candidate = endpoints[next_probe_index];
+    if (now - candidate.last_probe_ms >= kProbeIntervalMs) {
+        next_probe_index++;
+        StartProbe(candidate);
+    }
+}
+}
+
+void SetPoolResolverTarget(const String& host, int port) {
+    if (host == target_host && port == target_port) {
+        return;
+    }
+
+    target_host = host;
+    target_port = port;
+    endpoints.clear();
+    active_address = IPAddress();
+    query_pending = false;
+    query_attempts = 0;
+    query_failed_recently = false;
+    next_probe_index = 0;
+
+    IPAddress literal;
+    target_is_literal = literal.fromString(host);
+    if (target_is_literal) {
+        PoolEndpoint& endpoint = UpsertEndpoint(literal);
+        endpoint.ttl_s = kLiteralTtlSeconds;
+        endpoint.resolved_ms = millis();
+    }
+}
+
+void SeedPoolEndpoint(const IPAddress& address) {
+    if (static_cast<uint32_t>(address) == 0 || FindEndpoint(address) >= 0) {
+        return;
+    }
+
+    // Seeds come from flash and are stale by definition; DNS refreshes them
+    PoolEndpoint& endpoint = UpsertEndpoint(address);
+    endpoint.resolved_ms = millis();
+    endpoint.ttl_s = 0;
+}
+
+void UpdatePoolResolver() {
+    if (target_host.length() == 0 || WiFi.status() != WL_CONNECTED) {
+        return;
+    }
+
+    const unsigned long now = millis();
+
+    if (query_pending) {
+        PollQuery();
+    } else if (!target_is_literal && AnyEndpointExpired(now) &&
+               (!query_failed_recently || now - last_query_failure_ms >= kDnsRetryBackoffMs)) {
+        // Stale entries stay usable while the refresh is in flight
+        query_attempts = 0;
+        SendQuery();
+    }
+
+    ServiceProbes(now);
+}
+
+bool SelectPoolEndpoint(IPAddress& address_out) {
+    int best = -1;
+    for (size_t i = 0; i < endpoints.size(); ++i) {
+        const PoolEndpoint& endpoint = endpoints[i];
+        if (!endpoint.healthy) {
+            continue;
+        }
+        if (best < 0) {
+            best = i;
+            continue;
+        }
+
+        const PoolEndpoint& current = endpoints[best];
+        if (current.rtt_ms < 0 || (endpoint.rtt_ms >= 0 && endpoint.rtt_ms < current.rtt_ms)) {
+            best = i;
+        }
+    }
+
+    if (best < 0) {
+        return false;
+    }
+
+    active_address = endpoints[best].address;
+    address_out = endpoints[best].address;
+    return true;
+}
+
+void ReportPoolEndpointResult(const IPAddress& address, bool ok) {
+    int index = FindEndpoint(address);
+    if (index < 0) {
+        return;
+    }
+
+    PoolEndpoint& endpoint = endpoints[index];
+    if (ok) {
+        endpoint.healthy = true;
+        endpoint.failures = 0;
+        active_address = address;
+        return;
+    }
+
+    endpoint.healthy = false;
+    if (endpoint.failures < 255) {
+        endpoint.failures++;
+    }
+    if (active_address == address) {
+        active_address = IPAddress();
+    }
+    LOG_ERROR("Pool endpoint %s marked unhealthy\n", address.toString().c_str());
+}
+
+size_t PoolEndpointCount() {
+    return endpoints.size();
+}
+
+const PoolEndpoint& GetPoolEndpoint(size_t index) {
+    if (index >= endpoints.size()) {
+        return empty_endpoint;
+    }
+    return endpoints[index];
+}
+
+int ActivePoolEndpoint() {
+    if (static_cast<uint32_t>(active_address) == 0) {
+        return -1;
+    }
+    return FindEndpoint(active_address);
+}
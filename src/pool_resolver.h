@@ -0,0 +1,26 @@
+#pragma once
+
+#include <Arduino.h>
+#include <IPAddress.h>
+
+// One A record of the pool host, ranked by background TCP connect RTT.
+struct PoolEndpoint {
+    IPAddress address;
+    unsigned long resolved_ms;
+    uint32_t ttl_s;
+    long rtt_ms;  // -1 until the first probe completes
+    uint8_t failures;
+    bool healthy;
+    unsigned long last_probe_ms;
+};
+
+void SetPoolResolverTarget(const String& host, int port);
+void SeedPoolEndpoint(const IPAddress& address);
+void UpdatePoolResolver();
+
+bool SelectPoolEndpoint(IPAddress& address_out);
+void ReportPoolEndpointResult(const IPAddress& address, bool ok);
+
+size_t PoolEndpointCount();
+const PoolEndpoint& GetPoolEndpoint(size_t index);
+int ActivePoolEndpoint();
@@ -0,0 +1,167 @@
+#include "pool_split.h"
+
+#include "app_context.h"
+#include "log.h"
+#include "miner_extranonce.h"
+#include "pool_client.h"
+#include "pool_handover.h"
+#include "pool_tls.h"
+
+namespace {
+// Before trying again after a handover to the other pool failed
+constexpr unsigned long kSwitchRetryMs = 60000;
+
+PoolSplitStats stats;
+size_t active = kPrimaryPool;
+unsigned long active_since_ms = 0;
+unsigned long last_update_ms = 0;
+unsigned long attempt_ms = 0;
+bool attempted = false;
+
+const char* PoolLabel(size_t index) {
+    return index == kPrimaryPool ? "primary" : "alternate";
+}
+
+bool PlainLink(size_t index) {
+    return !config.pool_sv2 && !PoolUriUsesTls(PoolTargetAt(index).host);
+}
+
+// The pool behind on its weighted part of the work; the active one until
+// it has had its part, so slices stretch or shrink to correct drift. The
+// primary pool while a miner could not follow the extranonce change.
+size_t WantedPool() {
+    const size_t held_by = FixedExtranonceMinerCount();
+    if (held_by > 0 && stats.held_by == 0) {
+        LOG_INFO("Pool split: held on the primary pool, %u miners cannot take a new extranonce\n",
+                 static_cast<unsigned int>(held_by));
+    } else if (held_by == 0 && stats.held_by > 0) {
+        LOG_INFO("Pool split: resumed\n");
+    }
+    stats.held_by = held_by;
+    if (held_by > 0) {
+        return kPrimaryPool;
+    }
+
+    const double total = stats.work[kPrimaryPool] + stats.work[kAlternatePool];
+    if (total <= 0) {
+        return active;
+    }
+    if (stats.work[active] * 100 < total * PoolWeightPercent(active)) {
+        return active;
+    }
+    return active == kPrimaryPool ? kAlternatePool : kPrimaryPool;
+}
+
+void SwitchTo(size_t index) {
+    LOG_INFO("Pool split: moving to the %s pool (%.1f%% of the work so far, %d%% wanted)\n", PoolLabel(index),
+             PoolWorkPercent(index), PoolWeightPercent(index));
+    stats.switches++;
+    attempt_ms = millis();
+    attempted = true;
+
+    if (PoolClient().connected() && PlainLink(active) && PlainLink(index)) {
+        BeginPoolHandover(index);
+        return;
+    }
+    // TLS links have one slot, so they reconnect; the miners stay
+    SetActivePool(index);
+    if (PoolClient().connected()) {
+        DisconnectFromPool();
+    }
+}
+}
+
+PoolTarget PoolTargetAt(const Config& cfg, size_t index) {
+    if (index == kAlternatePool) {
+        return {cfg.alt_pool_host, cfg.alt_pool_port, cfg.alt_pool_user, cfg.alt_pool_pass,
+                cfg.alt_pool_tls_fingerprint};
+    }
+    return {cfg.pool_host, cfg.pool_port, cfg.pool_user, cfg.pool_pass, cfg.pool_tls_fingerprint};
+}
+
+PoolTarget PoolTargetAt(size_t index) {
+    return PoolTargetAt(config, index);
+}
+
+size_t ActivePoolIndex() {
+    return active;
+}
+
+PoolTarget ActivePool() {
+    return PoolTargetAt(active);
+}
+
+void SetActivePool(size_t index) {
+    if (index != active) {
+        LOG_INFO("Pool split: now on the %s pool %s:%d\n", PoolLabel(index), PoolTargetAt(index).host,
+                 PoolTargetAt(index).port);
+    }
+    active = index;
+    active_since_ms = millis();
+}
+
+bool PoolSplitEnabled() {
+    return !config.pool_sv2 && config.alt_pool_host[0] != '\0' && config.alt_pool_weight > 0;
+}
+
+int PoolWeightPercent(size_t index) {
+    if (!PoolSplitEnabled()) {
+        return index == kPrimaryPool ? 100 : 0;
+    }
+    const int alternate = constrain(config.alt_pool_weight, 0, 100);
+    return index == kAlternatePool ? alternate : 100 - alternate;
+}
+
+float PoolWorkPercent(size_t index) {
+    const double total = stats.work[kPrimaryPool] + stats.work[kAlternatePool];
+    return total > 0 ? static_cast<float>(stats.work[index] * 100 / total) : 0;
+}
+
+void CreditPoolShare(size_t index, double difficulty) {
+    if (index >= kPoolCount) {
+        return;
+    }
+    stats.work[index] += difficulty;
+    stats.shares[index]++;
+}
+
+void ResetPoolSplit() {
+    const unsigned long switches = stats.switches;
+    stats = PoolSplitStats();
+    stats.switches = switches;
+    attempted = false;
+}
+
+void UpdatePoolSplit() {
+    const unsigned long now = millis();
+    const bool live = PoolClient().connected();
+    if (live) {
+        stats.ms_on_pool[active] += now - last_update_ms;
+    }
+    last_update_ms = now;
+
+    if (PoolHandoverActive() || (attempted && now - attempt_ms < kSwitchRetryMs)) {
+        return;
+    }
+
+    if (!PoolSplitEnabled()) {
+        if (active != kPrimaryPool) {
+            SwitchTo(kPrimaryPool);
+        }
+        return;
+    }
+
+    const unsigned long slice_ms = static_cast<unsigned long>(max(config.pool_slice_s, kMinPoolSliceS)) * 1000;
+    if (!live || now - active_since_ms < slice_ms) {
+        return;
+    }
+
+    const size_t wanted = WantedPool();
+    if (wanted != active) {
+        SwitchTo(wanted);
+    }
+}
+
+const PoolSplitStats& CurrentPoolSplitStats() {
+    return stats;
+}
@@ -0,0 +1,64 @@
+#pragma once
+
+#include <Arduino.h>
+
+#include "config_manager.h"
+
+// Splits the proxy's hashrate between the configured pool and an alternate
+// one by weight, e.g. 80/20. All miners mine one pool at a time, in slices
+// of at least pool_slice_s: accepted share difficulty is credited to the
+// pool that took the share, and a slice ends once its pool has had its
+// weighted part of the work so far, so drift from luck or a slow pool is
+// made up in the slices that follow. The move is a pool handover, which
+// lands on a clean job from the new pool with no miner reconnecting.
+// Stratum V1 only; a V2 upstream stays on the primary pool.
+//
+// Each move changes the upstream extranonce, which a miner can only follow
+// through mining.extranonce.subscribe or header jobs. While any miner that
+// does neither is connected the split is held: it stays on the primary
+// pool, or goes back there at the end of the current slice, and those
+// miners are never reconnected by a slice change more than once.
+
+constexpr size_t kPrimaryPool = 0;
+constexpr size_t kAlternatePool = 1;
+constexpr size_t kPoolCount = 2;
+constexpr int kMinPoolSliceS = 60;
+
+// Points into config, so it stays valid until the next settings change
+struct PoolTarget {
+    const char* host;
+    int port;
+    const char* user;
+    const char* pass;
+    const char* tls_fingerprint;
+};
+
+struct PoolSplitStats {
+    // Accepted share difficulty per pool since the split settings last changed
+    double work[kPoolCount] = {};
+    unsigned long shares[kPoolCount] = {};
+    unsigned long ms_on_pool[kPoolCount] = {};
+    unsigned long switches = 0;
+    // Miners holding the split on the primary pool, at the last check
+    size_t held_by = 0;
+};
+
+PoolTarget PoolTargetAt(const Config& cfg, size_t index);
+PoolTarget PoolTargetAt(size_t index);
+// The pool the live link belongs to, or the next connect goes to
+size_t ActivePoolIndex();
+PoolTarget ActivePool();
+// A link to this pool is now the live one
+void SetActivePool(size_t index);
+
+bool PoolSplitEnabled();
+int PoolWeightPercent(size_t index);
+// Measured part of the credited work, 0-100
+float PoolWorkPercent(size_t index);
+
+void CreditPoolShare(size_t index, double difficulty);
+// Starts the measurement over, after the pools or weights change
+void ResetPoolSplit();
+void UpdatePoolSplit();
+
+const PoolSplitStats& CurrentPoolSplitStats();
@@ -0,0 +1,359 @@
+#include "pool_tls.h"
+
+#include <cctype>
+#include <cstring>
+#include <vector>
+
+#if defined(ESP8266)
+#include <WiFiClientSecureBearSSL.h>
+#else
+#include <WiFiClientSecure.h>
+#endif
+
+#include "config_defaults.h"
+#include "log.h"
+#include "platform_fs.h"
+#include "storage.h"
+
+namespace {
+constexpr char kSessionPath[] = "/tls_session.bin";
+constexpr uint32_t kSessionMagic = 0x594D5453;  // "YMTS"
+constexpr uint16_t kSessionVersion = 2;
+constexpr size_t kMaxSessionBytes = 2048;
+// The pool task is stuck in connect and handshake until they finish, so a
+// server that stalls either gives up the miners' time for this long at most
+constexpr unsigned long kTlsTimeoutMs = 5000;
+
+struct SessionFileHeader {
+    uint32_t magic;
+    uint16_t version;
+    uint16_t length;
+    char host[64];
+    int32_t port;
+    char pin[65];
+};
+
+std::vector<uint8_t> session_blob;
+std::vector<uint8_t> persisted_blob;
+String session_host;
+int session_port = 0;
+String session_pin;
+bool session_loaded = false;
+PoolTlsStats stats;
+
+#if defined(ESP8266)
+// BearSSL in the core only pins the SHA-1 of the certificate
+constexpr size_t kPinBytes = 20;
+constexpr char kPinName[] = "SHA-1";
+BearSSL::WiFiClientSecure tls_client;
+BearSSL::Session tls_session;
+
+void PinCertificate(const String& pin) {
+    if (pin.length() == 0) {
+        tls_client.setInsecure();
+    } else {
+        tls_client.setFingerprint(pin.c_str());
+    }
+}
+
+// A mismatch already fails the handshake
+bool CertificateMatches(const String& pin) {
+    (void)pin;
+    return true;
+}
+
+void OfferSession() {
+    tls_session = BearSSL::Session();
+    if (session_blob.size() == sizeof(br_ssl_session_parameters)) {
+        std::memcpy(tls_session.getSession(), session_blob.data(), session_blob.size());
+    }
+    tls_client.setSession(&tls_session);
+}
+
+void ReadSession() {
+    const br_ssl_session_parameters* params = tls_session.getSession();
+    if (params->session_id_len == 0) {
+        session_blob.clear();
+        return;
+    }
+    const uint8_t* raw = reinterpret_cast<const uint8_t*>(params);
+    session_blob.assign(raw, raw + sizeof(*params));
+}
+
+bool HandshakeResumed(const std::vector<uint8_t>& offered) {
+    // BearSSL keeps the offered parameters only when the server accepts them
+    ReadSession();
+    return !offered.empty() && offered == session_blob;
+}
+
+bool OpenTls(const IPAddress& endpoint, const String& host, int port) {
+    // Bounds the TCP connect and every handshake read
+    tls_client.setTimeout(kTlsTimeoutMs);
+    // BearSSL sends no SNI for address connects; that keeps the resolver's choice
+    return tls_client.connect(endpoint, port);
+}
+#elif defined(ESP32)
+// The core's WiFiClientSecure has no hook to offer a session before its
+// handshake, so ESP32 always does a full (hardware-accelerated) handshake.
+constexpr size_t kPinBytes = 32;
+constexpr char kPinName[] = "SHA-256";
+WiFiClientSecure tls_client;
+
+// The pin is checked once the handshake is done, as verify() needs the
+// peer certificate
+void PinCertificate(const String& pin) {
+    (void)pin;
+    tls_client.setInsecure();
+}
+
+bool CertificateMatches(const String& pin) {
+    return pin.length() == 0 || tls_client.verify(pin.c_str(), nullptr);
+}
+
+void OfferSession() {}
+
+void ReadSession() {}
+
+bool HandshakeResumed(const std::vector<uint8_t>& offered) {
+    (void)offered;
+    return false;
+}
+
+bool OpenTls(const IPAddress& endpoint, const String& host, int port) {
+    tls_client.setHandshakeTimeout(kTlsTimeoutMs / 1000);
+    return tls_client.connect(endpoint, port, host.c_str(), nullptr, nullptr, nullptr);
+}
+#elif defined(YUMA_HOST)
+constexpr size_t kPinBytes = 32;
+constexpr char kPinName[] = "SHA-256";
+WiFiClientSecure tls_client;
+
+void PinCertificate(const String& pin) {
+    (void)pin;
+    tls_client.setInsecure();
+}
+
+bool CertificateMatches(const String& pin) {
+    return pin.length() == 0 || tls_client.verify(pin.c_str(), nullptr);
+}
+
+void OfferSession() {
+    // The shim rewrites the blob whenever the server issues a new ticket
+    tls_client.setSession(&session_blob);
+}
+
+void ReadSession() {}
+
+bool HandshakeResumed(const std::vector<uint8_t>& offered) {
+    (void)offered;
+    return tls_client.isSessionReused();
+}
+
+bool OpenTls(const IPAddress& endpoint, const String& host, int port) {
+    tls_client.setConnectTimeout(kTlsTimeoutMs);
+    return tls_client.connect(endpoint, port, host.c_str());
+}
+#endif
+
+// The fingerprint as bare lowercase hex, or empty when it is not kPinBytes
+// bytes of hex; ':' or ' ' may separate the bytes
+String NormalizePin(const char* text) {
+    String hex;
+    for (const char* c = text; *c != '\0'; ++c) {
+        if (*c == ':' || *c == ' ') {
+            continue;
+        }
+        if (!isxdigit(static_cast<unsigned char>(*c))) {
+            return String();
+        }
+        hex += static_cast<char>(tolower(static_cast<unsigned char>(*c)));
+    }
+    return hex.length() == kPinBytes * 2 ? hex : String();
+}
+
+void LoadSession() {
+    session_loaded = true;
+    if (!EnsureStorageMounted() || !STORAGE_FS.exists(kSessionPath)) {
+        return;
+    }
+    if (!ConfigDefaults::kPersistTlsSession) {
+        // Left by a build that persisted sessions; no secret stays at rest
+        STORAGE_FS.remove(kSessionPath);
+        return;
+    }
+
+    File file = STORAGE_FS.open(kSessionPath, "r");
+    if (!file) {
+        return;
+    }
+
+    SessionFileHeader header{};
+    bool valid = file.read(reinterpret_cast<uint8_t*>(&header), sizeof(header)) == sizeof(header) &&
+                 header.magic == kSessionMagic && header.version == kSessionVersion &&
+                 header.length > 0 && header.length <= kMaxSessionBytes;
+    if (valid) {
+        header.host[sizeof(header.host) - 1] = '\0';
+        header.pin[sizeof(header.pin) - 1] = '\0';
+        session_blob.resize(header.length);
+        valid = file.read(session_blob.data(), header.length) == header.length;
+    }
+    file.close();
+
+    if (!valid) {
+        session_blob.clear();
+        LOG_ERROR("TLS session cache invalid, ignoring\n");
+        return;
+    }
+
+    session_host = header.host;
+    session_port = header.port;
+    session_pin = header.pin;
+    persisted_blob = session_blob;
+    LOG_INFO("TLS session cached for %s:%d\n", session_host.c_str(), session_port);
+}
+
+void PersistSession() {
+    // One flash write per full handshake; resumed sessions are unchanged
+    if (!ConfigDefaults::kPersistTlsSession || session_blob.empty() || session_blob.size() > kMaxSessionBytes || session_blob == persisted_blob) {
+        return;
+    }
+    if (!EnsureStorageMounted()) {
+        return;
+    }
+
+    SessionFileHeader header{};
+    header.magic = kSessionMagic;
+    header.version = kSessionVersion;
+    header.length = static_cast<uint16_t>(session_blob.size());
+    std::strncpy(header.host, session_host.c_str(), sizeof(header.host) - 1);
+    header.port = session_port;
+    std::strncpy(header.pin, session_pin.c_str(), sizeof(header.pin) - 1);
+
+    File file = STORAGE_FS.open(kSessionPath, "w");
+    if (!file) {
+        LOG_ERROR("Failed to open TLS session cache for writing\n");
+        return;
+    }
+    size_t written = file.write(reinterpret_cast<const uint8_t*>(&header), sizeof(header));
+    written += file.write(session_blob.data(), session_blob.size());
+    file.close();
+
+    if (written != sizeof(header) + session_blob.size()) {
+        LOG_ERROR("Failed to write TLS session cache\n");
+        return;
+    }
+    persisted_blob = session_blob;
+}
+}
+
+bool PoolUriUsesTls(const char* raw_host) {
+    String host = String(raw_host);
+    host.trim();
+    host.toLowerCase();
+    return host.startsWith("stratum+ssl://") || host.startsWith("stratum+tls://") ||
+           host.startsWith("ssl://") || host.startsWith("tls://");
+}
+
+bool PoolTlsResumes() {
+#if defined(ESP32)
+    return false;
+#else
+    return true;
+#endif
+}
+
+WiFiClient& PoolTlsClient() {
+    return tls_client;
+}
+
+bool ConnectPoolTls(const IPAddress& endpoint, const String& host, int port, const char* fingerprint) {
+    stats.verified = false;
+    const String pin = NormalizePin(fingerprint);
+    if (fingerprint[0] != '\0' && pin.length() == 0) {
+        stats.handshake_failures++;
+        LOG_ERROR("TLS fingerprint for %s is not a %s hash in hex, not connecting\n", host.c_str(), kPinName);
+        return false;
+    }
+    if (pin.length() == 0) {
+        LOG_ERROR("TLS pool %s has no certificate fingerprint set: the link is encrypted but NOT authenticated, "
+                  "and anyone on the path can pose as the pool\n",
+                  host.c_str());
+    }
+
+    if (!session_loaded) {
+        LoadSession();
+    }
+
+    // A session only resumes against the server that issued it, and a
+    // resumed handshake shows no certificate, so it is bound to the pin too
+    if (session_host != host || session_port != port || session_pin != pin) {
+        session_blob.clear();
+        session_host = host;
+        session_port = port;
+        session_pin = pin;
+    }
+
+    PinCertificate(pin);
+    OfferSession();
+
+    std::vector<uint8_t> offered = session_blob;
+    uint32_t heap_before = ESP.getFreeHeap();
+    unsigned long started = millis();
+    bool connected = OpenTls(endpoint, host, port);
+    stats.last_handshake_ms = millis() - started;
+
+    if (!connected) {
+        stats.handshake_failures++;
+        // The failure may be a rejected resumption, so retry without it
+        if (!offered.empty()) {
+            ForgetPoolTlsSession();
+        }
+        LOG_ERROR("TLS handshake failed after %lu ms%s\n", stats.last_handshake_ms,
+                  pin.length() > 0 ? " (or the certificate does not match the fingerprint)" : "");
+        return false;
+    }
+
+    if (!CertificateMatches(pin)) {
+        tls_client.stop();
+        stats.handshake_failures++;
+        stats.pin_mismatches++;
+        ForgetPoolTlsSession();
+        LOG_ERROR("TLS pool %s certificate does not match the configured %s fingerprint, dropping it\n",
+                  host.c_str(), kPinName);
+        return false;
+    }
+    stats.verified = pin.length() > 0;
+
+    uint32_t heap_after = ESP.getFreeHeap();
+    stats.heap_cost = heap_before > heap_after ? heap_before - heap_after : 0;
+
+    bool resumed = HandshakeResumed(offered);
+    if (resumed) {
+        stats.handshakes_resumed++;
+    } else {
+        stats.handshakes_full++;
+    }
+    LOG_INFO("TLS %s handshake in %lu ms (%u bytes heap)\n", resumed ? "resumed" : "full",
+             stats.last_handshake_ms, static_cast<unsigned>(stats.heap_cost));
+
+    // BearSSL is TLS 1.2 only, so the session is final once the handshake
+    // is done. The host's OpenSSL may issue a TLS 1.3 ticket later; the shim
+    // writes that straight into the RAM copy.
+    ReadSession();
+    PersistSession();
+    return true;
+}
+
+void ForgetPoolTlsSession() {
+    session_blob.clear();
+    stats.session_cached = false;
+    if (!persisted_blob.empty() && EnsureStorageMounted()) {
+        STORAGE_FS.remove(kSessionPath);
+    }
+    persisted_blob.clear();
+}
+
+const PoolTlsStats& CurrentPoolTlsStats() {
+    stats.session_cached = !session_blob.empty();
+    return stats;
+}
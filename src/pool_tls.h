@@ -0,0 +1,40 @@
+#pragma once
+
+#include <Arduino.h>
+#include <IPAddress.h>
+#include <WiFiClient.h>
+
+// TLS transport for stratum+ssl:// pools. The negotiated session is kept in
+// RAM so a reconnect can resume it instead of paying for a full handshake,
+// on ESP8266 and the host build; see PoolTlsResumes().
+// It holds the master secret, so it is only written to flash, to survive a
+// reboot, in builds with YUMA_TLS_SESSION_PERSIST.
+// The certificate is checked against the pool's configured fingerprint.
+// Without one the link is encrypted but the pool is not authenticated.
+
+struct PoolTlsStats {
+    unsigned long handshakes_full = 0;
+    unsigned long handshakes_resumed = 0;
+    unsigned long handshake_failures = 0;
+    unsigned long last_handshake_ms = 0;
+    uint32_t heap_cost = 0;
+    unsigned long pin_mismatches = 0;
+    bool session_cached = false;
+    // The current link's certificate matched the configured fingerprint
+    bool verified = false;
+};
+
+bool PoolUriUsesTls(const char* raw_host);
+// False on ESP32: its WiFiClientSecure runs the whole mbedTLS handshake
+// inside connect() with no way to offer a session first, so every
+// handshake there is a full one
+bool PoolTlsResumes();
+
+WiFiClient& PoolTlsClient();
+// Connects to endpoint and offers the cached session for host:port. Blocks
+// for the handshake, bounded by a timeout of a few seconds. Fails unless
+// the certificate matches fingerprint, when one is given.
+bool ConnectPoolTls(const IPAddress& endpoint, const String& host, int port, const char* fingerprint);
+void ForgetPoolTlsSession();
+
+const PoolTlsStats& CurrentPoolTlsStats();
@@ -0,0 +1,79 @@
+#include "pool_tx.h"
+
+#include <vector>
+
+#include "app_context.h"
+#include "pool_client.h"
+
+namespace {
+// Stays inside one TCP segment even with TLS record overhead
+constexpr size_t kMaxBatchBytes = 1024;
+
+std::vector<uint8_t> batch;
+unsigned long batch_started_us = 0;
+PoolTxStats stats;
+
+void WriteNow(const uint8_t* data, size_t length) {
+    PoolClient().write(data, length);
+    stats.writes++;
+}
+}
+
+void PoolTxWrite(const uint8_t* data, size_t length, bool share) {
+    if (share) {
+        stats.shares++;
+        stats.share_bytes += length;
+    }
+
+    if (!share || config.submit_coalesce_us <= 0) {
+        FlushPoolTx();
+        WriteNow(data, length);
+        if (share) {
+            stats.share_writes++;
+        }
+        return;
+    }
+
+    if (batch.empty()) {
+        batch_started_us = micros();
+    }
+    batch.insert(batch.end(), data, data + length);
+
+    if (batch.size() >= kMaxBatchBytes ||
+        micros() - batch_started_us >= static_cast<unsigned long>(config.submit_coalesce_us)) {
+        FlushPoolTx();
+    }
+}
+
+void PoolTxWrite(const String& data, bool share) {
+    PoolTxWrite(reinterpret_cast<const uint8_t*>(data.c_str()), data.length(), share);
+}
+
+void FlushPoolTx() {
+    if (batch.empty()) {
+        return;
+    }
+    WriteNow(batch.data(), batch.size());
+    stats.share_writes++;
+    batch.clear();
+}
+
+void ServicePoolTx() {
+    if (!batch.empty() && micros() - batch_started_us >= static_cast<unsigned long>(config.submit_coalesce_us)) {
+        FlushPoolTx();
+    }
+}
+
+void ResetPoolTx() {
+    batch.clear();
+}
+
+void ConfigurePoolLink() {
+    // Batching is done here, so Nagle would only add delayed-ACK stalls
+    PoolClient().setNoDelay(true);
+    batch.reserve(kMaxBatchBytes);
+}
+
+const PoolTxStats& CurrentPoolTxStats() {
+    return stats;
+}
@@ -0,0 +1,28 @@
+#pragma once
+
+#include <Arduino.h>
+
+// Upstream transmit stage. Shares that arrive within the coalescing window
+// leave in one write, so a burst costs one Wi-Fi frame instead of one per
+// share. Anything else flushes the batch first and is written at once. The
+// window is checked by the pool task, so a batch may wait up to one more
+// task period than configured.
+
+struct PoolTxStats {
+    unsigned long writes = 0;
+    unsigned long share_writes = 0;
+    unsigned long shares = 0;
+    unsigned long share_bytes = 0;
+};
+
+void PoolTxWrite(const uint8_t* data, size_t length, bool share);
+void PoolTxWrite(const String& data, bool share);
+void FlushPoolTx();
+// Flushes a batch whose window has passed; called from the pool task
+void ServicePoolTx();
+// Drops anything still batched, for a connection that went away
+void ResetPoolTx();
+// Socket options for a freshly connected pool link
+void ConfigurePoolLink();
+
+const PoolTxStats& CurrentPoolTxStats();
@@ -0,0 +1,120 @@
+#include "power_policy.h"
+
+#if defined(ESP32)
+#include <WiFi.h>
+#elif defined(ESP8266)
+#include <ESP8266WiFi.h>
+#endif
+
+#include "app_context.h"
+#include "log.h"
+#include "pool_client.h"
+
+namespace {
+// Long enough to ride out a miner reconnecting or a pool link bouncing
+constexpr unsigned long kIdleHoldMs = 30000;
+
+PowerStats stats;
+bool applied = false;
+unsigned long last_update_ms = 0;
+unsigned long active_ms = 0;
+
+void ApplyMode(PowerMode mode) {
+#if defined(ESP32)
+    if (mode == PowerMode::kPerformance) {
+        WiFi.setSleep(false);
+        WiFi.setTxPower(WIFI_POWER_19_5dBm);
+    } else {
+        WiFi.setSleep(true);
+    }
+#elif defined(ESP8266)
+    if (mode == PowerMode::kPerformance) {
+        WiFi.setSleepMode(WIFI_NONE_SLEEP);
+        WiFi.setOutputPower(20.5f);
+    } else {
+        WiFi.setSleepMode(WIFI_MODEM_SLEEP);
+    }
+#endif
+    if (applied && mode != stats.mode) {
+        stats.switches++;
+        LOG_INFO("Wi-Fi power: %s\n", PowerModeName(mode));
+    }
+    stats.mode = mode;
+    applied = true;
+}
+
+PowerMode WantedMode(unsigned long now) {
+    switch (static_cast<PowerPolicy>(config.power_policy)) {
+        case PowerPolicy::kPerformance:
+            return PowerMode::kPerformance;
+        case PowerPolicy::kPowerSave:
+            return PowerMode::kPowerSave;
+        case PowerPolicy::kAuto:
+            break;
+    }
+
+    if (!connected_miners.empty() || PoolClient().connected()) {
+        active_ms = now;
+        return PowerMode::kPerformance;
+    }
+    return now - active_ms < kIdleHoldMs ? PowerMode::kPerformance : PowerMode::kPowerSave;
+}
+}
+
+void UpdatePowerPolicy() {
+    const unsigned long now = millis();
+    if (applied) {
+        stats.ms_in_mode[static_cast<size_t>(stats.mode)] += now - last_update_ms;
+    } else {
+        active_ms = now;
+    }
+    last_update_ms = now;
+
+    PowerMode mode = WantedMode(now);
+    if (!applied || mode != stats.mode) {
+        ApplyMode(mode);
+    }
+}
+
+void RecordPoolReplyLatency(unsigned long latency_ms) {
+    LatencyHistogram& histogram = stats.reply_latency[static_cast<size_t>(stats.mode)];
+    histogram.count++;
+    histogram.total_ms += latency_ms;
+    histogram.max_ms = max(histogram.max_ms, latency_ms);
+
+    size_t bucket = 0;
+    while (bucket < kLatencyBucketCount - 1 && latency_ms >= kLatencyBucketMs[bucket]) {
+        bucket++;
+    }
+    histogram.buckets[bucket]++;
+}
+
+const char* PowerPolicyName(PowerPolicy policy) {
+    switch (policy) {
+        case PowerPolicy::kAuto:
+            return "auto";
+        case PowerPolicy::kPerformance:
+            return "performance";
+        case PowerPolicy::kPowerSave:
+            return "powersave";
+    }
+    return "auto";
+}
+
+bool ParsePowerPolicy(const String& name, PowerPolicy& out) {
+    for (PowerPolicy policy : {PowerPolicy::kAuto, PowerPolicy::kPerformance, PowerPolicy::kPowerSave}) {
+        if (name == PowerPolicyName(policy)) {
+            out = policy;
+            return true;
+        }
+    }
+    return false;
+}
+
+const char* PowerModeName(PowerMode mode) {
+    return mode == PowerMode::kPerformance ? "performance" : "powersave";
+}
+
+const PowerStats& CurrentPowerStats() {
+    return stats;
+}
@@ -0,0 +1,44 @@
+#pragma once
+
+#include <Arduino.h>
+
+// Wi-Fi modem sleep against job latency. In modem sleep the AP holds
+// inbound frames until the next DTIM beacon, so a notify can sit there for
+// hundreds of milliseconds. The auto policy keeps the radio awake, at full
+// TX power, while miners are connected or the pool link is up, and lets it
+// sleep after kIdleHoldMs with neither.
+//
+// Each mode keeps a histogram of pool reply latency (request out to reply
+// in). Replies and notifies wait at the AP the same way. Notifies carry no
+// send time to measure against, so replies are used as the proxy.
+
+enum class PowerPolicy : uint8_t { kAuto, kPerformance, kPowerSave };
+enum class PowerMode : uint8_t { kPerformance, kPowerSave };
+
+constexpr size_t kPowerModeCount = 2;
+constexpr size_t kLatencyBucketCount = 8;
+// Upper bounds in ms; the last bucket takes everything slower
+constexpr unsigned long kLatencyBucketMs[kLatencyBucketCount - 1] = {10, 25, 50, 100, 250, 500, 1000};
+
+struct LatencyHistogram {
+    unsigned long count = 0;
+    unsigned long total_ms = 0;
+    unsigned long max_ms = 0;
+    unsigned long buckets[kLatencyBucketCount] = {};
+};
+
+struct PowerStats {
+    PowerMode mode = PowerMode::kPerformance;
+    unsigned long switches = 0;
+    unsigned long ms_in_mode[kPowerModeCount] = {};
+    LatencyHistogram reply_latency[kPowerModeCount];
+};
+
+// Scheduler task
+void UpdatePowerPolicy();
+void RecordPoolReplyLatency(unsigned long latency_ms);
+
+const char* PowerPolicyName(PowerPolicy policy);
+bool ParsePowerPolicy(const String& name, PowerPolicy& out);
+const char* PowerModeName(PowerMode mode);
+const PowerStats& CurrentPowerStats();
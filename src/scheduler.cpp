@@ -0,0 +1,118 @@
+#include "scheduler.h"
+
+namespace {
+struct Task {
+    TaskFunction function = nullptr;
+    unsigned long due_ms = 0;
+    volatile bool signalled = false;
+    TaskStats stats;
+};
+
+Task tasks[kMaxTasks];
+size_t task_count = 0;
+unsigned long current_late_ms = 0;
+
+bool Due(const Task& task, unsigned long now) {
+    return static_cast<long>(now - task.due_ms) >= 0;
+}
+
+// Most urgent ready task: highest priority first, then the one due longest
+Task* NextReadyTask(unsigned long now) {
+    Task* best = nullptr;
+    for (size_t i = 0; i < task_count; ++i) {
+        Task& task = tasks[i];
+        if (!task.signalled && !Due(task, now)) {
+            continue;
+        }
+        if (!best || task.stats.priority < best->stats.priority ||
+            (task.stats.priority == best->stats.priority &&
+             static_cast<long>(task.due_ms - best->due_ms) < 0)) {
+            best = &task;
+        }
+    }
+    return best;
+}
+}
+
+bool AddTask(const char* name, TaskFunction function, unsigned long period_ms, unsigned long budget_us,
+             TaskPriority priority) {
+    if (task_count >= kMaxTasks) {
+        return false;
+    }
+
+    Task& task = tasks[task_count++];
+    task.function = function;
+    task.due_ms = millis();
+    task.stats.name = name;
+    task.stats.priority = priority;
+    task.stats.period_ms = period_ms;
+    task.stats.budget_us = budget_us;
+    return true;
+}
+
+void SignalTask(TaskFunction function) {
+    for (size_t i = 0; i < task_count; ++i) {
+        if (tasks[i].function == function) {
+            tasks[i].signalled = true;
+            return;
+        }
+    }
+}
+
+void RunScheduler() {
+    const unsigned long now = millis();
+    Task* task = NextReadyTask(now);
+    if (!task) {
+        delay(1);
+        return;
+    }
+
+    const bool by_signal = task->signalled && !Due(*task, now);
+    task->signalled = false;
+    current_late_ms = by_signal ? 0 : now - task->due_ms;
+
+    const unsigned long started_us = micros();
+    task->function();
+    const unsigned long elapsed_us = micros() - started_us;
+
+    TaskStats& stats = task->stats;
+    stats.runs++;
+    if (by_signal) {
+        stats.signalled_runs++;
+    }
+    stats.last_us = elapsed_us;
+    stats.max_us = max(stats.max_us, elapsed_us);
+    stats.max_late_ms = max(stats.max_late_ms, current_late_ms);
+    if (elapsed_us > stats.budget_us) {
+        stats.overruns++;
+    }
+
+    // Late tasks are not run again to catch up on missed periods
+    if (!by_signal) {
+        task->due_ms = now + stats.period_ms;
+    }
+}
+
+unsigned long CurrentTaskLateMs() {
+    return current_late_ms;
+}
+
+const char* TaskPriorityName(TaskPriority priority) {
+    switch (priority) {
+        case TaskPriority::kHigh:
+            return "high";
+        case TaskPriority::kNormal:
+            return "normal";
+        case TaskPriority::kLow:
+            return "low";
+    }
+    return "normal";
+}
+
+size_t TaskCount() {
+    return task_count;
+}
+
+const TaskStats& GetTaskStats(size_t index) {
+    return tasks[index].stats;
+}
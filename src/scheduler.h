@@ -0,0 +1,49 @@
+#pragma once
+
+#include <Arduino.h>
+
+// Cooperative scheduler behind loop(). Each subsystem is a task with a
+// period, a priority and a time budget; loop() runs the most urgent ready
+// task and returns, so the SDK gets the CPU between every two tasks. A task
+// is ready when its period has passed or when something signalled it, which
+// async callbacks use to have stratum work picked up at once rather than at
+// the next period. When nothing is ready loop() sleeps a millisecond.
+// Tasks run to completion: one that overruns its budget is only counted.
+
+enum class TaskPriority : uint8_t { kHigh, kNormal, kLow };
+
+using TaskFunction = void (*)();
+
+struct TaskStats {
+    const char* name = "";
+    TaskPriority priority = TaskPriority::kNormal;
+    unsigned long period_ms = 0;
+    unsigned long budget_us = 0;
+    unsigned long runs = 0;
+    // Runs started by a signal instead of the period
+    unsigned long signalled_runs = 0;
+    unsigned long overruns = 0;
+    unsigned long last_us = 0;
+    unsigned long max_us = 0;
+    // Worst start past the due time
+    unsigned long max_late_ms = 0;
+};
+
+constexpr size_t kMaxTasks = 20;
+
+// Returns false when the table is full
+bool AddTask(const char* name, TaskFunction function, unsigned long period_ms, unsigned long budget_us,
+             TaskPriority priority);
+// Runs the task registered with this function as soon as possible. Safe
+// from async callbacks; does nothing for a function that is not a task.
+void SignalTask(TaskFunction function);
+
+// Once per loop()
+void RunScheduler();
+
+// How far past its due time the running task was started
+unsigned long CurrentTaskLateMs();
+
+const char* TaskPriorityName(TaskPriority priority);
+size_t TaskCount();
+const TaskStats& GetTaskStats(size_t index);
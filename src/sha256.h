@@ -0,0 +1,26 @@
+#pragma once
+
+#include <Arduino.h>
+
+// Plain SHA-256, the same code on every target. The state is a value type:
+// hash a shared prefix once, copy the state, and finish each copy with its
+// own tail. Header jobs use that to hash a job's coinbase prefix once for
+// all miners.
+
+constexpr size_t kSha256Bytes = 32;
+
+struct Sha256State {
+    uint32_t h[8];
+    uint8_t block[64];
+    size_t block_used;
+    uint64_t total_bytes;
+};
+
+void Sha256Init(Sha256State& state);
+void Sha256Update(Sha256State& state, const uint8_t* data, size_t length);
+void Sha256Finish(Sha256State& state, uint8_t digest[kSha256Bytes]);
+
+// Bitcoin's double SHA-256
+void Sha256d(const uint8_t* data, size_t length, uint8_t digest[kSha256Bytes]);
+// Finishes state, then hashes that digest once more
+void Sha256dFinish(Sha256State& state, uint8_t digest[kSha256Bytes]);
@@ -1,18 +1,30 @@
 #include "status_display.h"
 
+namespace {
+DisplayStats stats;
+}
+
+const DisplayStats& CurrentDisplayStats() {
+    return stats;
+}
+
 #ifdef USE_OLED_STATUS
 
 #include <Adafruit_GFX.h>
 #include <Adafruit_SSD1306.h>
 #include <Wire.h>
+#include <algorithm>
 
 #if defined(ESP32)
 #include <WiFi.h>
+#include <atomic>
+#include <cstring>
 #elif defined(ESP8266)
 #include <ESP8266WiFi.h>
 #endif
 
 #include "app_context.h"
+#include "health_monitor.h"
 
 namespace {
 constexpr uint8_t SCREEN_WIDTH = 128;
@@ -21,20 +33,135 @@ constexpr uint8_t SDA_PIN = 2;
 constexpr uint8_t SCL_PIN = 14;
 constexpr uint8_t TEXT_SIZE_SMALL = 1;
 constexpr uint8_t TEXT_SIZE_LARGE = 2;
-
-Adafruit_SSD1306 status_display(SCREEN_WIDTH, SCREEN_HEIGHT, &Wire);
+constexpr uint8_t DISPLAY_ADDRESS = 0x3C;
+// The SSD1306 is rated for fast-mode I2C; 100 kHz took ~25 ms per frame
+constexpr uint32_t I2C_CLOCK_HZ = 400000;
+// One page is an 8-pixel band of the screen, which is one line of small text
+constexpr uint8_t PAGE_COUNT = SCREEN_HEIGHT / 8;
+constexpr uint8_t TITLE_PAGES = 2;
+constexpr uint8_t LINE_COUNT = 5;
+// Data bytes per I2C transaction, leaving room for the control byte in a
+// 32-byte Wire buffer
+constexpr size_t I2C_CHUNK = 31;
+
+Adafruit_SSD1306 status_display(SCREEN_WIDTH, SCREEN_HEIGHT, &Wire, -1, I2C_CLOCK_HZ, I2C_CLOCK_HZ);
 bool status_display_ready = false;
 unsigned long last_display_update_ms = 0;
+bool title_drawn = false;
+String shown_lines[LINE_COUNT];
+
+#if defined(ESP32)
+// Pages copied out of the framebuffer for the display task to send
+uint8_t tx_buffer[SCREEN_WIDTH * PAGE_COUNT];
+std::atomic<uint8_t> tx_pages{0};
+uint8_t pending_pages = 0;
+TaskHandle_t display_task = nullptr;
+#else
+// Sent one per display task run so no run waits on more than one page
+uint8_t pending_pages = 0;
+#endif
+
+void SendPage(const uint8_t* framebuffer, uint8_t page) {
+    Wire.beginTransmission(DISPLAY_ADDRESS);
+    Wire.write(static_cast<uint8_t>(0x00));
+    Wire.write(static_cast<uint8_t>(SSD1306_COLUMNADDR));
+    Wire.write(static_cast<uint8_t>(0));
+    Wire.write(static_cast<uint8_t>(SCREEN_WIDTH - 1));
+    Wire.write(static_cast<uint8_t>(SSD1306_PAGEADDR));
+    Wire.write(page);
+    Wire.write(page);
+    Wire.endTransmission();
+
+    const uint8_t* data = framebuffer + page * SCREEN_WIDTH;
+    for (size_t offset = 0; offset < SCREEN_WIDTH; offset += I2C_CHUNK) {
+        Wire.beginTransmission(DISPLAY_ADDRESS);
+        Wire.write(static_cast<uint8_t>(0x40));
+        Wire.write(data + offset, std::min(I2C_CHUNK, SCREEN_WIDTH - offset));
+        Wire.endTransmission();
+    }
+}
+
+void SendPages(const uint8_t* framebuffer, uint8_t pages) {
+    unsigned long started_us = micros();
+    for (uint8_t page = 0; page < PAGE_COUNT; ++page) {
+        if (pages & (1 << page)) {
+            SendPage(framebuffer, page);
+            stats.pages_sent++;
+        }
+    }
+    unsigned long elapsed_us = micros() - started_us;
+    stats.io_us_total += elapsed_us;
+    stats.io_us_max = std::max(stats.io_us_max, elapsed_us);
+}
+
+#if defined(ESP32)
+void DisplayTask(void*) {
+    for (;;) {
+        ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+        SendPages(tx_buffer, tx_pages.load());
+        tx_pages.store(0);
+    }
+}
+#endif
+
+String StatusLine(uint8_t index) {
+    switch (index) {
+        case 0:
+            return WiFi.status() == WL_CONNECTED ? "IP: " + WiFi.localIP().toString() : String("WiFi: offline");
+        case 1:
+            return String("Pool: ") + (metrics.pool_connected ? "up" : "down");
+        case 2:
+            return "Miners: " + String(connected_miners.size());
+        case 3:
+            return "Shares " + String(metrics.shares_ok) + "/" + String(metrics.shares_bad);
+        default:
+            return "Diff: " + String(metrics.current_difficulty, 0);
+    }
+}
+
+// Redraws the lines whose text changed and returns their pages
+uint8_t RenderChangedLines() {
+    uint8_t changed = 0;
+
+    if (!title_drawn) {
+        status_display.clearDisplay();
+        status_display.setTextColor(SSD1306_WHITE);
+        status_display.setCursor(0, 0);
+        status_display.setTextSize(TEXT_SIZE_LARGE);
+        status_display.print("YUNA Proxy");
+        status_display.setTextSize(TEXT_SIZE_SMALL);
+        for (String& line : shown_lines) {
+            line = "";
+        }
+        title_drawn = true;
+        changed = 0xFF;
+    }
+
+    for (uint8_t i = 0; i < LINE_COUNT; ++i) {
+        String line = StatusLine(i);
+        if (line == shown_lines[i]) {
+            continue;
+        }
+        uint8_t page = TITLE_PAGES + i;
+        status_display.fillRect(0, page * 8, SCREEN_WIDTH, 8, SSD1306_BLACK);
+        status_display.setCursor(0, page * 8);
+        status_display.print(line);
+        shown_lines[i] = line;
+        changed |= 1 << page;
+    }
+    return changed;
+}
 }
 
 void SetupStatusDisplay() {
     Wire.begin(SDA_PIN, SCL_PIN);
 
-    if (!status_display.begin(SSD1306_SWITCHCAPVCC, 0x3C)) {
+    if (!status_display.begin(SSD1306_SWITCHCAPVCC, DISPLAY_ADDRESS)) {
         Serial.println("Failed to initialize SSD1306 display");
         status_display_ready = false;
         return;
     }
+    Wire.setClock(I2C_CLOCK_HZ);
 
     status_display_ready = true;
     status_display.clearDisplay();
@@ -46,49 +173,54 @@ void SetupStatusDisplay() {
     status_display.print("Board: ");
     status_display.println(GetBoardName());
     status_display.display();
+
+#if defined(ESP32)
+    // Core 0 next to the Wi-Fi stack, below everything that moves shares
+    xTaskCreatePinnedToCore(DisplayTask, "oled", 2048, nullptr, 1, &display_task, 0);
+#endif
 }
 
 void UpdateStatusDisplay() {
-    if (!status_display_ready) {
+    // The frame stays as it was; redrawing and I2C time go back to the miners
+    if (!status_display_ready || IsShedding(ShedLevel::kNoDisplay)) {
         return;
     }
 
+#if defined(ESP8266)
+    if (pending_pages != 0) {
+        uint8_t page = __builtin_ctz(pending_pages);
+        SendPages(status_display.getBuffer(), 1 << page);
+        pending_pages &= ~(1 << page);
+    }
+#endif
+
     unsigned long now = millis();
     if (now - last_display_update_ms < 1000) {
         return;
     }
     last_display_update_ms = now;
 
-    status_display.clearDisplay();
-    status_display.setTextColor(SSD1306_WHITE);
-    status_display.setCursor(0, 0);
-
-    status_display.setTextSize(TEXT_SIZE_LARGE);
-    status_display.println("YUNA Proxy");
-
-    status_display.setTextSize(TEXT_SIZE_SMALL);
-    if (WiFi.status() == WL_CONNECTED) {
-        status_display.print("IP: ");
-        status_display.println(WiFi.localIP());
-    } else {
-        status_display.println("WiFi: offline");
+    uint8_t changed = RenderChangedLines();
+    if (changed != 0) {
+        stats.refreshes++;
     }
+    pending_pages |= changed;
 
-    status_display.print("Pool: ");
-    status_display.println(metrics.pool_connected ? "up" : "down");
-
-    status_display.print("Miners: ");
-    status_display.println(connected_miners.size());
-
-    status_display.print("Shares ");
-    status_display.print(metrics.shares_ok);
-    status_display.print('/');
-    status_display.println(metrics.shares_bad);
-
-    status_display.print("Diff: ");
-    status_display.println(metrics.current_difficulty, 0);
-
-    status_display.display();
+#if defined(ESP32)
+    // A transfer still running keeps its pages; the rest wait for the next tick
+    if (pending_pages == 0 || tx_pages.load() != 0) {
+        return;
+    }
+    const uint8_t* framebuffer = status_display.getBuffer();
+    for (uint8_t page = 0; page < PAGE_COUNT; ++page) {
+        if (pending_pages & (1 << page)) {
+            std::memcpy(tx_buffer + page * SCREEN_WIDTH, framebuffer + page * SCREEN_WIDTH, SCREEN_WIDTH);
+        }
+    }
+    tx_pages.store(pending_pages);
+    pending_pages = 0;
+    xTaskNotifyGive(display_task);
+#endif
 }
 
 #else
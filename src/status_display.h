@@ -1,4 +1,14 @@
 #pragma once
 
+// Time the display spends on I2C; on ESP32 the transfer runs in its own
+// task, so none of it is taken from loop()
+struct DisplayStats {
+    unsigned long refreshes = 0;
+    unsigned long pages_sent = 0;
+    unsigned long io_us_total = 0;
+    unsigned long io_us_max = 0;
+};
+
 void SetupStatusDisplay();
 void UpdateStatusDisplay();
+const DisplayStats& CurrentDisplayStats();
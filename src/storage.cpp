@@ -2,13 +2,14 @@
 
 #include <Arduino.h>
 
+#include "log.h"
 #include "platform_fs.h"
 
 namespace {
 bool g_storage_mounted = false;
 }
 
-#if defined(ESP32)
+#if defined(ESP32) || defined(YUMA_HOST)
 static bool MountStorage(bool format_on_fail) {
     if (STORAGE_FS.begin(format_on_fail)) {
         g_storage_mounted = true;
@@ -34,22 +35,22 @@ static bool MountStorage(bool format_on_fail) {
 bool SetupStorage() {
 #if defined(ESP8266)
     if (!MountStorage(false)) {
-        Serial.println("Error mounting LittleFS, attempting to format...");
+        LOG_ERROR("Error mounting LittleFS, attempting to format...\n");
         if (MountStorage(true)) {
-            Serial.println("LittleFS formatted and mounted");
+            LOG_INFO("LittleFS formatted and mounted\n");
             return true;
         }
-        Serial.println("LittleFS mount failed");
+        LOG_ERROR("LittleFS mount failed\n");
         return false;
     }
-    Serial.println("LittleFS mounted");
+    LOG_INFO("LittleFS mounted\n");
     return true;
 #else
     if (!MountStorage(false) && !MountStorage(true)) {
-        Serial.println("Error mounting SPIFFS");
+        LOG_ERROR("Error mounting SPIFFS\n");
         return false;
     }
-    Serial.println("SPIFFS mounted");
+    LOG_INFO("SPIFFS mounted\n");
     return true;
 #endif
 }
@@ -61,17 +62,17 @@ bool EnsureStorageMounted() {
 
 #if defined(ESP8266)
     if (MountStorage(false)) {
-        Serial.println("LittleFS remounted");
+        LOG_INFO("LittleFS remounted\n");
         return true;
     }
-    Serial.println("LittleFS remount failed");
+    LOG_ERROR("LittleFS remount failed\n");
     return false;
 #else
     if (MountStorage(false) || MountStorage(true)) {
-        Serial.println("SPIFFS remounted");
+        LOG_INFO("SPIFFS remounted\n");
         return true;
     }
-    Serial.println("SPIFFS remount failed");
+    LOG_ERROR("SPIFFS remount failed\n");
     return false;
 #endif
 }
@@ -0,0 +1,247 @@
+#include "stratum_capture.h"
+
+#include <Arduino.h>
+#include <algorithm>
+
+#include "log.h"
+#include "platform_fs.h"
+#include "storage.h"
+
+const char kCaptureFilePath[] = "/capture.bin";
+const char kCaptureOldFilePath[] = "/capture.old";
+
+CaptureMode capture_mode = CaptureMode::kOff;
+
+namespace {
+#if defined(ESP8266)
+constexpr size_t kRingSize = 8 * 1024;
+constexpr size_t kFileLimit = 64 * 1024;
+#elif defined(YUMA_HOST)
+constexpr size_t kRingSize = 1024 * 1024;
+constexpr size_t kFileLimit = 16 * 1024 * 1024;
+#else
+constexpr size_t kRingSize = 32 * 1024;
+constexpr size_t kFileLimit = 256 * 1024;
+#endif
+constexpr size_t kMaxPayload = 0xFFFF;
+constexpr unsigned long kFlushIntervalMs = 1000;
+
+// Offsets are running byte counts; ring position is offset % kRingSize.
+// Records are only ever evicted whole, so tail and flushed stay aligned.
+std::vector<uint8_t> ring;
+uint32_t head = 0;
+uint32_t tail = 0;
+uint32_t flushed = 0;
+unsigned long capture_start_ms = 0;
+unsigned long last_flush_ms = 0;
+unsigned long records = 0;
+unsigned long dropped = 0;
+
+void RingWrite(uint32_t offset, const uint8_t* data, size_t len) {
+    for (size_t i = 0; i < len; ++i) {
+        ring[(offset + i) % kRingSize] = data[i];
+    }
+}
+
+void RingRead(uint32_t offset, uint8_t* data, size_t len) {
+    for (size_t i = 0; i < len; ++i) {
+        data[i] = ring[(offset + i) % kRingSize];
+    }
+}
+
+uint16_t RecordLengthAt(uint32_t offset) {
+    uint8_t length_bytes[2];
+    RingRead(offset + 6, length_bytes, sizeof(length_bytes));
+    return static_cast<uint16_t>(length_bytes[0] | (length_bytes[1] << 8));
+}
+
+void EvictOldest() {
+    uint32_t record_size = kCaptureRecordHeaderSize + RecordLengthAt(tail);
+    if (flushed == tail && capture_mode == CaptureMode::kFlash) {
+        dropped++;
+    }
+    tail += record_size;
+    if (static_cast<int32_t>(flushed - tail) < 0) {
+        flushed = tail;
+    }
+}
+
+void PutLe16(uint8_t* out, uint16_t value) {
+    out[0] = value & 0xFF;
+    out[1] = value >> 8;
+}
+
+void PutLe32(uint8_t* out, uint32_t value) {
+    for (int i = 0; i < 4; ++i) {
+        out[i] = (value >> (8 * i)) & 0xFF;
+    }
+}
+
+void WriteFileHeader(uint8_t* out) {
+    PutLe32(out, kCaptureMagic);
+    PutLe16(out + 4, kCaptureVersion);
+    PutLe16(out + 6, 0);
+}
+
+File OpenCaptureFile() {
+    bool rotate = false;
+    if (STORAGE_FS.exists(kCaptureFilePath)) {
+        File existing = STORAGE_FS.open(kCaptureFilePath, "r");
+        rotate = existing && existing.size() >= kFileLimit;
+        existing.close();
+    }
+
+    if (rotate) {
+        STORAGE_FS.remove(kCaptureOldFilePath);
+        STORAGE_FS.rename(kCaptureFilePath, kCaptureOldFilePath);
+    }
+
+    if (!STORAGE_FS.exists(kCaptureFilePath)) {
+        File created = STORAGE_FS.open(kCaptureFilePath, "w");
+        if (!created) {
+            return created;
+        }
+        uint8_t header[kCaptureFileHeaderSize];
+        WriteFileHeader(header);
+        created.write(header, sizeof(header));
+        created.close();
+    }
+
+    return STORAGE_FS.open(kCaptureFilePath, "a");
+}
+}
+
+void SetCaptureMode(CaptureMode mode) {
+    if (mode == capture_mode) {
+        return;
+    }
+
+    if (capture_mode == CaptureMode::kFlash) {
+        FlushStratumCapture(true);
+    }
+
+    if (mode != CaptureMode::kOff && ring.empty()) {
+        ring.assign(kRingSize, 0);
+    }
+    if (capture_mode == CaptureMode::kOff) {
+        head = tail = flushed = 0;
+        records = 0;
+        dropped = 0;
+        capture_start_ms = millis();
+    }
+    if (mode == CaptureMode::kFlash) {
+        flushed = head;
+    }
+    if (mode == CaptureMode::kOff) {
+        // Keep the last capture readable until the next start; only shrink
+        // the buffer on memory-constrained boards.
+#if defined(ESP8266)
+        std::vector<uint8_t>().swap(ring);
+        head = tail = flushed = 0;
+#endif
+    }
+
+    capture_mode = mode;
+    LOG_INFO("Stratum capture: %s\n", CaptureModeName(mode));
+}
+
+const char* CaptureModeName(CaptureMode mode) {
+    switch (mode) {
+        case CaptureMode::kRam:
+            return "ram";
+        case CaptureMode::kFlash:
+            return "flash";
+        default:
+            return "off";
+    }
+}
+
+bool ParseCaptureMode(const String& name, CaptureMode& mode_out) {
+    if (name == "off") {
+        mode_out = CaptureMode::kOff;
+    } else if (name == "ram") {
+        mode_out = CaptureMode::kRam;
+    } else if (name == "flash") {
+        mode_out = CaptureMode::kFlash;
+    } else {
+        return false;
+    }
+    return true;
+}
+
+void RecordCapture(CaptureDirection direction, uint8_t peer, const char* data, size_t len) {
+    if (capture_mode == CaptureMode::kOff || ring.empty()) {
+        return;
+    }
+
+    len = std::min(len, std::min(kMaxPayload, kRingSize - kCaptureRecordHeaderSize));
+    const uint32_t record_size = kCaptureRecordHeaderSize + len;
+    while (head - tail + record_size > kRingSize) {
+        EvictOldest();
+    }
+
+    uint8_t header[kCaptureRecordHeaderSize];
+    PutLe32(header, millis() - capture_start_ms);
+    header[4] = static_cast<uint8_t>(direction);
+    header[5] = peer;
+    PutLe16(header + 6, static_cast<uint16_t>(len));
+
+    RingWrite(head, header, sizeof(header));
+    RingWrite(head + sizeof(header), reinterpret_cast<const uint8_t*>(data), len);
+    head += record_size;
+    records++;
+}
+
+void FlushStratumCapture(bool force) {
+    if (capture_mode != CaptureMode::kFlash || flushed == head) {
+        return;
+    }
+
+    // Batch flash writes instead of touching the filesystem per line
+    if (!force && millis() - last_flush_ms < kFlushIntervalMs && head - flushed < kRingSize / 2) {
+        return;
+    }
+    last_flush_ms = millis();
+
+    if (!EnsureStorageMounted()) {
+        return;
+    }
+
+    File file = OpenCaptureFile();
+    if (!file) {
+        LOG_ERROR("Failed to open capture file\n");
+        return;
+    }
+
+    uint8_t chunk[256];
+    while (flushed != head) {
+        size_t count = std::min(static_cast<size_t>(head - flushed), sizeof(chunk));
+        RingRead(flushed, chunk, count);
+        if (file.write(chunk, count) != count) {
+            LOG_ERROR("Failed to write capture file\n");
+            break;
+        }
+        flushed += count;
+    }
+    file.close();
+}
+
+void SnapshotCapture(std::vector<uint8_t>& out) {
+    out.resize(kCaptureFileHeaderSize + (head - tail));
+    WriteFileHeader(out.data());
+    if (!ring.empty()) {
+        RingRead(tail, out.data() + kCaptureFileHeaderSize, head - tail);
+    }
+}
+
+size_t CaptureBufferedBytes() {
+    return head - tail;
+}
+
+unsigned long CaptureRecordCount() {
+    return records;
+}
+
+unsigned long CaptureDroppedCount() {
+    return dropped;
+}
@@ -0,0 +1,54 @@
+#pragma once
+
+#include <Arduino.h>
+#include <vector>
+
+// Timestamped record of every Stratum line crossing the proxy. Records are
+// kept in a RAM ring and, in flash mode, appended to a rotating file pair.
+//
+// Layout (little endian): file header "YMCP", uint16 version, uint16 reserved,
+// then per record uint32 ms since capture start, uint8 direction, uint8 peer
+// (0 = pool, n = miner slot + 1, 0xFF = all miners), uint16 length, payload
+// without newline.
+enum class CaptureDirection : uint8_t {
+    kPoolRx = 0,
+    kPoolTx = 1,
+    kMinerRx = 2,
+    kMinerTx = 3,
+};
+
+enum class CaptureMode : uint8_t {
+    kOff = 0,
+    kRam = 1,
+    kFlash = 2,
+};
+
+constexpr uint32_t kCaptureMagic = 0x50434D59;  // "YMCP"
+constexpr uint16_t kCaptureVersion = 1;
+constexpr size_t kCaptureFileHeaderSize = 8;
+constexpr size_t kCaptureRecordHeaderSize = 8;
+constexpr uint8_t kCapturePoolPeer = 0;
+constexpr uint8_t kCaptureAllMiners = 0xFF;
+
+extern CaptureMode capture_mode;
+
+void SetCaptureMode(CaptureMode mode);
+const char* CaptureModeName(CaptureMode mode);
+bool ParseCaptureMode(const String& name, CaptureMode& mode_out);
+
+void RecordCapture(CaptureDirection direction, uint8_t peer, const char* data, size_t len);
+inline void CaptureLine(CaptureDirection direction, uint8_t peer, const String& line) {
+    if (capture_mode != CaptureMode::kOff) {
+        RecordCapture(direction, peer, line.c_str(), line.length());
+    }
+}
+
+void FlushStratumCapture(bool force = false);
+void SnapshotCapture(std::vector<uint8_t>& out);
+
+size_t CaptureBufferedBytes();
+unsigned long CaptureRecordCount();
+unsigned long CaptureDroppedCount();
+
+extern const char kCaptureFilePath[];
+extern const char kCaptureOldFilePath[];
@@ -2,47 +2,285 @@
 
 #include <Arduino.h>
 #include <algorithm>
+#include <vector>
 
-#if defined(ESP32)
+#if defined(ESP32) || defined(YUMA_HOST)
 #include <AsyncTCP.h>
 #elif defined(ESP8266)
 #include <ESPAsyncTCP.h>
 #endif
 
 #include "app_context.h"
+#include "log.h"
+#include "miner_admission.h"
 #include "pool_client.h"
+#include "scheduler.h"
+#include "stratum_capture.h"
 
-void SetupStratumServer() {
-    stratum_server.onClient([](void* arg, AsyncClient* client) {
-        Serial.printf("New miner connected from %s\n", client->remoteIP().toString().c_str());
+namespace {
+constexpr size_t kMaxMinerLineLength = 2048;
 
-        connected_miners.push_back(client);
-        metrics.connected_miners_count = connected_miners.size();
+uint16_t listen_port = 0;
 
-        client->onDisconnect([](void* arg, AsyncClient* client) {
-            Serial.printf("Miner disconnected from %s\n", client->remoteIP().toString().c_str());
+// The socket callbacks only queue: new sessions here, bytes in rx_queue,
+// the closed flag and ACK timeouts. ServiceMinerSessions does the rest on
+// loop(), so the request table, connected_miners and every session are only
+// changed there.
+AsyncLock session_lock;
+std::vector<MinerSession*> accepted;
+size_t session_count = 0;
+
+uint8_t CapturePeer(const MinerSession* session) {
+    auto it = std::find(connected_miners.begin(), connected_miners.end(), session);
+    size_t slot = static_cast<size_t>(it - connected_miners.begin());
+    return static_cast<uint8_t>(std::min<size_t>(slot + 1, kCaptureAllMiners - 1));
+}
+
+bool WriteToMiner(MinerSession* session, const String& line) {
+    if (!session || !session->client || !session->client->connected()) {
+        return false;
+    }
+
+    String message = line;
+    if (!message.endsWith("\n")) {
+        message += "\n";
+    }
+
+    if (session->client->space() < message.length()) {
+        LOG_ERROR("Miner %s send buffer full, dropping message\n",
+                  session->client->remoteIP().toString().c_str());
+        return false;
+    }
+
+    if (session->client->write(message.c_str(), message.length()) != message.length()) {
+        return false;
+    }
+    session->bytes_tx += message.length();
+    return true;
+}
+
+// Miners may split or batch JSON-RPC lines across TCP segments
+void ConsumeMinerData(MinerSession* session, const String& data) {
+    session->bytes_rx += data.length();
+    session->last_rx_ms = millis();
+    session->rx_buffer += data;
+
+    int newline = session->rx_buffer.indexOf('\n');
+    while (newline != -1) {
+        String line = session->rx_buffer.substring(0, newline);
+        session->rx_buffer.remove(0, newline + 1);
+        line.trim();
+        if (line.length() > 0) {
+            if (capture_mode != CaptureMode::kOff) {
+                CaptureLine(CaptureDirection::kMinerRx, CapturePeer(session), line);
+            }
+            LOG_DEBUG("Miner data: %s\n", line.c_str());
+            ForwardMinerRequest(session, line);
+        }
+        newline = session->rx_buffer.indexOf('\n');
+    }
+
+    if (session->rx_buffer.length() > kMaxMinerLineLength) {
+        LOG_ERROR("Miner %s sent an oversized line, dropping buffer\n",
+                  session->client->remoteIP().toString().c_str());
+        session->rx_buffer = "";
+    }
+}
+}
+
+void SetupStratumServer(uint16_t port) {
+    if (stratum_server != nullptr) {
+        delete stratum_server;
+    }
+    stratum_server = new AsyncServer(port);
+    listen_port = port;
+    InitMinerAdmission();
+
+    stratum_server->onClient([](void* arg, AsyncClient* client) {
+        if (!AdmitMiner(client)) {
+            return;
+        }
+        LOG_INFO("New miner connected from %s\n", client->remoteIP().toString().c_str());
 
-            auto it = std::find(connected_miners.begin(), connected_miners.end(), client);
-            if (it != connected_miners.end()) {
-                connected_miners.erase(it);
+        const uint32_t heap_at_accept = ESP.getFreeHeap();
+        MinerSession* session = new MinerSession();
+        session->heap_at_accept = heap_at_accept;
+        session->client = client;
+        session->connected_ms = millis();
+        session->last_rx_ms = session->connected_ms;
+
+        // A miner that lost power never ACKs the next notify; drop it then
+        // instead of waiting minutes for lwIP's retransmissions to give up.
+        // The RX idle check lives in HandleMinerConnections, because the
+        // library's own RX timeout closes without telling us why.
+        client->setRxTimeout(0);
+        client->setAckTimeout(config.miner_ack_timeout_ms);
+        // Jobs and replies are small writes; with Nagle they wait behind the
+        // miner's delayed ACK for up to 40 ms
+        client->setNoDelay(true);
+
+        {
+            AsyncLockGuard guard(session_lock);
+            accepted.push_back(session);
+            session_count++;
+        }
+        SignalTask(ServiceMinerSessions);
+
+        client->onDisconnect([](void* arg, AsyncClient* client) {
+            MinerSession* session = static_cast<MinerSession*>(arg);
+            {
+                AsyncLockGuard guard(session_lock);
+                session->closed = true;
             }
-            metrics.connected_miners_count = connected_miners.size();
-        }, nullptr);
+            SignalTask(ServiceMinerSessions);
+        }, session);
 
         client->onData([](void* arg, AsyncClient* client, void* data, size_t len) {
-            String message = String(reinterpret_cast<const char*>(data)).substring(0, len);
-            Serial.println("Miner data: " + message);
-            if (pool_client.connected()) {
-                pool_client.write(reinterpret_cast<const uint8_t*>(data), len);
+            MinerSession* session = static_cast<MinerSession*>(arg);
+            {
+                AsyncLockGuard guard(session_lock);
+                session->rx_queue.concat(static_cast<const char*>(data), len);
             }
-        }, nullptr);
+            SignalTask(ServiceMinerSessions);
+        }, session);
+
+        client->onTimeout([](void* arg, AsyncClient* client, uint32_t time) {
+            MinerSession* session = static_cast<MinerSession*>(arg);
+            {
+                AsyncLockGuard guard(session_lock);
+                session->ack_timed_out_ms = time > 0 ? time : 1;
+            }
+            SignalTask(ServiceMinerSessions);
+        }, session);
 
     }, nullptr);
 
-    stratum_server.begin();
-    Serial.println("Stratum server started on port 4444");
+    stratum_server->begin();
+    LOG_INFO("Stratum server started on port %u\n", static_cast<unsigned int>(port));
+}
+
+void ServiceMinerSessions() {
+    std::vector<MinerSession*> closed;
+    bool changed = false;
+    {
+        AsyncLockGuard guard(session_lock);
+        if (!accepted.empty()) {
+            connected_miners.insert(connected_miners.end(), accepted.begin(), accepted.end());
+            accepted.clear();
+            changed = true;
+        }
+    }
+
+    for (MinerSession* session : connected_miners) {
+        String data;
+        bool is_closed;
+        uint32_t ack_timed_out_ms;
+        {
+            AsyncLockGuard guard(session_lock);
+            data = session->rx_queue;
+            session->rx_queue = "";
+            is_closed = session->closed;
+            ack_timed_out_ms = session->ack_timed_out_ms;
+            session->ack_timed_out_ms = 0;
+        }
+        // Nobody is left to answer; ForgetMinerRequests drops what is in flight
+        if (is_closed) {
+            closed.push_back(session);
+            continue;
+        }
+        if (ack_timed_out_ms > 0) {
+            // The disconnect callback that follows frees it on a later pass
+            metrics.miners_reaped_ack++;
+            LOG_INFO("Miner %s left data unacknowledged for %u ms, reaping\n",
+                     session->client->remoteIP().toString().c_str(), static_cast<unsigned int>(ack_timed_out_ms));
+            session->client->close(true);
+            continue;
+        }
+        if (data.length() > 0) {
+            ConsumeMinerData(session, data);
+        }
+    }
+
+    for (MinerSession* session : closed) {
+        LOG_INFO("Miner disconnected from %s (%lu accepted, %lu rejected, %lu stale)\n",
+                 session->client->remoteIP().toString().c_str(), session->shares_accepted, session->shares_rejected,
+                 session->shares_stale);
+        ForgetMinerRequests(session);
+        {
+            AsyncLockGuard guard(session_lock);
+            connected_miners.erase(std::find(connected_miners.begin(), connected_miners.end(), session));
+            session_count--;
+        }
+        delete session->client;
+        delete session;
+        changed = true;
+    }
+
+    if (changed) {
+        metrics.connected_miners_count = connected_miners.size();
+        // The first miner needs the pool link up, and the last one lets it go
+        WakePoolLink();
+    }
+}
+
+AsyncLock& MinerSessionLock() {
+    return session_lock;
+}
+
+size_t MinerSessionCount() {
+    AsyncLockGuard guard(session_lock);
+    return session_count;
 }
 
 void HandleMinerConnections() {
-    // Future hook for additional miner management logic
+    if (config.miner_idle_timeout_s <= 0) {
+        return;
+    }
+
+    const unsigned long now = millis();
+    const unsigned long idle_limit_ms = static_cast<unsigned long>(config.miner_idle_timeout_s) * 1000UL;
+    std::vector<MinerSession*> idle;
+    for (MinerSession* session : connected_miners) {
+        if (now - session->last_rx_ms >= idle_limit_ms) {
+            idle.push_back(session);
+        }
+    }
+
+    for (MinerSession* session : idle) {
+        metrics.miners_reaped_idle++;
+        LOG_INFO("Miner %s silent for %lu s, reaping\n", session->client->remoteIP().toString().c_str(),
+                 (now - session->last_rx_ms) / 1000);
+        session->client->close(true);
+    }
+}
+
+uint16_t StratumServerPort() {
+    return listen_port;
+}
+
+bool SendToMiner(MinerSession* session, const String& line) {
+    if (capture_mode != CaptureMode::kOff) {
+        CaptureLine(CaptureDirection::kMinerTx, CapturePeer(session), line);
+    }
+    return WriteToMiner(session, line);
+}
+
+void BroadcastToMiners(const String& line, bool job) {
+    // One capture record covers the whole fan-out
+    CaptureLine(CaptureDirection::kMinerTx, kCaptureAllMiners, line);
+    for (MinerSession* session : connected_miners) {
+        if (job && session->header_jobs) {
+            continue;
+        }
+        WriteToMiner(session, line);
+    }
+}
+
+void RedirectMiner(MinerSession* session, const String& host, uint16_t port) {
+    LOG_DEBUG("Redirecting miner %s to %s:%u\n", session->client->remoteIP().toString().c_str(), host.c_str(),
+              static_cast<unsigned int>(port));
+    SendToMiner(session, "{\"id\":null,\"method\":\"client.reconnect\",\"params\":[\"" + host + "\"," + String(port) +
+                             ",0]}");
+    // Graceful, so the reconnect goes out ahead of the FIN
+    session->client->close();
 }
@@ -1,4 +1,26 @@
 #pragma once
 
-void SetupStratumServer();
+#include <Arduino.h>
+
+#include "async_lock.h"
+#include "config_defaults.h"
+#include "miner_session.h"
+
+void SetupStratumServer(uint16_t port = ConfigDefaults::kStratumPort);
+// Scheduler task, signalled by the socket callbacks: adopts new miners,
+// handles their requests and frees the sessions that closed
+void ServiceMinerSessions();
 void HandleMinerConnections();
+// Held by code off loop() that walks connected_miners (the web handlers on
+// ESP32); loop() takes it whenever it adds or removes a session
+AsyncLock& MinerSessionLock();
+// Sessions accepted and not yet freed, callable from the socket callbacks
+size_t MinerSessionCount();
+// 0 until the server is started
+uint16_t StratumServerPort();
+
+bool SendToMiner(MinerSession* session, const String& line);
+// A job line skips miners that take built header jobs instead
+void BroadcastToMiners(const String& line, bool job = false);
+// Sends client.reconnect to host:port and closes the session
+void RedirectMiner(MinerSession* session, const String& host, uint16_t port);
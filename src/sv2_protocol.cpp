@@ -0,0 +1,278 @@
+#include "sv2_protocol.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+namespace Sv2 {
+void Writer::U16(uint16_t value) {
+    U8(value & 0xFF);
+    U8(value >> 8);
+}
+
+void Writer::U24(uint32_t value) {
+    U16(value & 0xFFFF);
+    U8((value >> 16) & 0xFF);
+}
+
+void Writer::U32(uint32_t value) {
+    U16(value & 0xFFFF);
+    U16(value >> 16);
+}
+
+void Writer::U64(uint64_t value) {
+    U32(static_cast<uint32_t>(value));
+    U32(static_cast<uint32_t>(value >> 32));
+}
+
+void Writer::F32(float value) {
+    uint32_t bits;
+    std::memcpy(&bits, &value, sizeof(bits));
+    U32(bits);
+}
+
+void Writer::U256(const uint8_t* value) {
+    data_.insert(data_.end(), value, value + 32);
+}
+
+void Writer::Str0_255(const String& value) {
+    size_t length = std::min<size_t>(value.length(), 255);
+    U8(static_cast<uint8_t>(length));
+    data_.insert(data_.end(), value.c_str(), value.c_str() + length);
+}
+
+void Writer::BytesWithU8Length(const Bytes& value, size_t max_length) {
+    size_t length = std::min(value.size(), max_length);
+    U8(static_cast<uint8_t>(length));
+    data_.insert(data_.end(), value.begin(), value.begin() + length);
+}
+
+bool Reader::Take(size_t count) {
+    if (!ok_ || length_ - offset_ < count) {
+        ok_ = false;
+        return false;
+    }
+    return true;
+}
+
+uint8_t Reader::U8() {
+    if (!Take(1)) {
+        return 0;
+    }
+    return data_[offset_++];
+}
+
+uint16_t Reader::U16() {
+    uint16_t low = U8();
+    return static_cast<uint16_t>(low | (U8() << 8));
+}
+
+uint32_t Reader::U24() {
+    uint32_t low = U16();
+    return low | (static_cast<uint32_t>(U8()) << 16);
+}
+
+uint32_t Reader::U32() {
+    uint32_t low = U16();
+    return low | (static_cast<uint32_t>(U16()) << 16);
+}
+
+uint64_t Reader::U64() {
+    uint64_t low = U32();
+    return low | (static_cast<uint64_t>(U32()) << 32);
+}
+
+void Reader::U256(uint8_t* out) {
+    if (!Take(32)) {
+        std::memset(out, 0, 32);
+        return;
+    }
+    std::memcpy(out, data_ + offset_, 32);
+    offset_ += 32;
+}
+
+String Reader::Str0_255() {
+    size_t length = U8();
+    if (!Take(length)) {
+        return String();
+    }
+    String value(reinterpret_cast<const char*>(data_ + offset_), length);
+    offset_ += length;
+    return value;
+}
+
+Bytes Reader::BytesWithLength(size_t count, size_t max_length) {
+    if (count > max_length || !Take(count)) {
+        ok_ = false;
+        return Bytes();
+    }
+    Bytes value(data_ + offset_, data_ + offset_ + count);
+    offset_ += count;
+    return value;
+}
+
+Bytes EncodeFrame(uint8_t msg_type, bool channel_msg, const Bytes& payload) {
+    Writer writer;
+    writer.U16(channel_msg ? kChannelMsgBit : 0);
+    writer.U8(msg_type);
+    writer.U24(static_cast<uint32_t>(payload.size()));
+    Bytes frame = writer.data();
+    frame.insert(frame.end(), payload.begin(), payload.end());
+    return frame;
+}
+
+long DecodeFrame(const uint8_t* data, size_t length, size_t max_payload, Frame& out) {
+    if (length < kFrameHeaderSize) {
+        return 0;
+    }
+
+    Reader header(data, kFrameHeaderSize);
+    uint16_t extension_type = header.U16();
+    uint8_t msg_type = header.U8();
+    uint32_t payload_length = header.U24();
+
+    if (payload_length > max_payload) {
+        return -1;
+    }
+    if (length < kFrameHeaderSize + payload_length) {
+        return 0;
+    }
+
+    out.extension_type = extension_type;
+    out.msg_type = msg_type;
+    out.payload.assign(data + kFrameHeaderSize, data + kFrameHeaderSize + payload_length);
+    return static_cast<long>(kFrameHeaderSize + payload_length);
+}
+
+Bytes Encode(const SetupConnection& message) {
+    Writer writer;
+    writer.U8(kProtocolMining);
+    writer.U16(kProtocolVersion);
+    writer.U16(kProtocolVersion);
+    writer.U32(message.flags);
+    writer.Str0_255(message.endpoint_host);
+    writer.U16(message.endpoint_port);
+    writer.Str0_255(message.vendor);
+    writer.Str0_255(message.hardware_version);
+    writer.Str0_255(message.firmware);
+    writer.Str0_255(message.device_id);
+    return writer.data();
+}
+
+Bytes Encode(const OpenExtendedMiningChannel& message) {
+    Writer writer;
+    writer.U32(message.request_id);
+    writer.Str0_255(message.user_identity);
+    writer.F32(message.nominal_hash_rate);
+    writer.U256(message.max_target);
+    writer.U16(message.min_extranonce_size);
+    return writer.data();
+}
+
+Bytes Encode(const SubmitSharesExtended& message) {
+    Writer writer;
+    writer.U32(message.channel_id);
+    writer.U32(message.sequence_number);
+    writer.U32(message.job_id);
+    writer.U32(message.nonce);
+    writer.U32(message.ntime);
+    writer.U32(message.version);
+    writer.B0_32(message.extranonce);
+    return writer.data();
+}
+
+bool Decode(const Bytes& payload, OpenExtendedMiningChannelSuccess& out) {
+    Reader reader(payload);
+    out.request_id = reader.U32();
+    out.channel_id = reader.U32();
+    reader.U256(out.target);
+    out.extranonce_size = reader.U16();
+    out.extranonce_prefix = reader.B0_32();
+    return reader.ok();
+}
+
+bool Decode(const Bytes& payload, NewExtendedMiningJob& out) {
+    Reader reader(payload);
+    out.channel_id = reader.U32();
+    out.job_id = reader.U32();
+    out.has_min_ntime = reader.Bool();
+    if (out.has_min_ntime) {
+        out.min_ntime = reader.U32();
+    }
+    out.version = reader.U32();
+    out.version_rolling_allowed = reader.Bool();
+
+    uint8_t branches = reader.U8();
+    out.merkle_path.clear();
+    for (uint8_t i = 0; i < branches && reader.ok(); ++i) {
+        Bytes branch(32);
+        reader.U256(branch.data());
+        out.merkle_path.push_back(branch);
+    }
+
+    out.coinbase_prefix = reader.B0_64K();
+    out.coinbase_suffix = reader.B0_64K();
+    return reader.ok();
+}
+
+bool Decode(const Bytes& payload, SetNewPrevHash& out) {
+    Reader reader(payload);
+    out.channel_id = reader.U32();
+    out.job_id = reader.U32();
+    reader.U256(out.prev_hash);
+    out.min_ntime = reader.U32();
+    out.nbits = reader.U32();
+    return reader.ok();
+}
+
+bool Decode(const Bytes& payload, SubmitSharesSuccess& out) {
+    Reader reader(payload);
+    out.channel_id = reader.U32();
+    out.last_sequence_number = reader.U32();
+    out.new_submits_accepted_count = reader.U32();
+    out.new_shares_sum = reader.U64();
+    return reader.ok();
+}
+
+bool Decode(const Bytes& payload, SubmitSharesError& out) {
+    Reader reader(payload);
+    out.channel_id = reader.U32();
+    out.sequence_number = reader.U32();
+    out.error_code = reader.Str0_255();
+    return reader.ok();
+}
+
+bool DecodeSetTarget(const Bytes& payload, uint32_t& channel_id, uint8_t* target) {
+    Reader reader(payload);
+    channel_id = reader.U32();
+    reader.U256(target);
+    return reader.ok();
+}
+
+bool DecodeSetExtranoncePrefix(const Bytes& payload, uint32_t& channel_id, Bytes& extranonce_prefix) {
+    Reader reader(payload);
+    channel_id = reader.U32();
+    extranonce_prefix = reader.B0_32();
+    return reader.ok();
+}
+
+String DecodeErrorCode(const Bytes& payload, size_t skip) {
+    if (payload.size() < skip) {
+        return String();
+    }
+    Reader reader(payload.data() + skip, payload.size() - skip);
+    return reader.Str0_255();
+}
+
+double TargetToDifficulty(const uint8_t* target) {
+    // Difficulty 1 is 0xffff * 2^208; targets are 256-bit little endian
+    double value = 0;
+    for (int i = 31; i >= 0; --i) {
+        value = value * 256.0 + target[i];
+    }
+    if (value <= 0) {
+        return 0;
+    }
+    return 65535.0 * std::pow(2.0, 208) / value;
+}
+}  // namespace Sv2
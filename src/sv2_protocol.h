@@ -0,0 +1,174 @@
+#pragma once
+
+#include <Arduino.h>
+#include <vector>
+
+// Stratum V2 binary framing and the subset of Mining Protocol messages the
+// proxy needs for a single extended channel. All integers are little endian.
+namespace Sv2 {
+constexpr size_t kFrameHeaderSize = 6;
+constexpr uint16_t kChannelMsgBit = 0x8000;
+
+constexpr uint8_t kMsgSetupConnection = 0x00;
+constexpr uint8_t kMsgSetupConnectionSuccess = 0x01;
+constexpr uint8_t kMsgSetupConnectionError = 0x02;
+constexpr uint8_t kMsgOpenMiningChannelError = 0x12;
+constexpr uint8_t kMsgOpenExtendedMiningChannel = 0x13;
+constexpr uint8_t kMsgOpenExtendedMiningChannelSuccess = 0x14;
+constexpr uint8_t kMsgSetExtranoncePrefix = 0x19;
+constexpr uint8_t kMsgSubmitSharesExtended = 0x1b;
+constexpr uint8_t kMsgSubmitSharesSuccess = 0x1c;
+constexpr uint8_t kMsgSubmitSharesError = 0x1d;
+constexpr uint8_t kMsgNewExtendedMiningJob = 0x1f;
+constexpr uint8_t kMsgSetNewPrevHash = 0x20;
+constexpr uint8_t kMsgSetTarget = 0x21;
+
+constexpr uint8_t kProtocolMining = 0;
+constexpr uint16_t kProtocolVersion = 2;
+
+using Bytes = std::vector<uint8_t>;
+
+struct Frame {
+    uint16_t extension_type = 0;
+    uint8_t msg_type = 0;
+    Bytes payload;
+};
+
+class Writer {
+public:
+    void U8(uint8_t value) { data_.push_back(value); }
+    void Bool(bool value) { U8(value ? 1 : 0); }
+    void U16(uint16_t value);
+    void U24(uint32_t value);
+    void U32(uint32_t value);
+    void U64(uint64_t value);
+    void F32(float value);
+    void U256(const uint8_t* value);
+    void Str0_255(const String& value);
+    void B0_32(const Bytes& value) { BytesWithU8Length(value, 32); }
+    const Bytes& data() const { return data_; }
+
+private:
+    void BytesWithU8Length(const Bytes& value, size_t max_length);
+
+    Bytes data_;
+};
+
+// Every read is bounds checked; ok() turns false on the first short read
+class Reader {
+public:
+    Reader(const uint8_t* data, size_t length) : data_(data), length_(length) {}
+    explicit Reader(const Bytes& data) : Reader(data.data(), data.size()) {}
+
+    uint8_t U8();
+    bool Bool() { return U8() != 0; }
+    uint16_t U16();
+    uint32_t U24();
+    uint32_t U32();
+    uint64_t U64();
+    void U256(uint8_t* out);
+    String Str0_255();
+    Bytes B0_32() { return BytesWithLength(U8(), 32); }
+    Bytes B0_64K() { return BytesWithLength(U16(), 0xFFFF); }
+    bool ok() const { return ok_; }
+
+private:
+    bool Take(size_t count);
+    Bytes BytesWithLength(size_t count, size_t max_length);
+
+    const uint8_t* data_;
+    size_t length_;
+    size_t offset_ = 0;
+    bool ok_ = true;
+};
+
+struct SetupConnection {
+    uint32_t flags = 0;
+    String endpoint_host;
+    uint16_t endpoint_port = 0;
+    String vendor;
+    String hardware_version;
+    String firmware;
+    String device_id;
+};
+
+struct OpenExtendedMiningChannel {
+    uint32_t request_id = 0;
+    String user_identity;
+    float nominal_hash_rate = 0;
+    uint8_t max_target[32];
+    uint16_t min_extranonce_size = 0;
+};
+
+struct OpenExtendedMiningChannelSuccess {
+    uint32_t request_id = 0;
+    uint32_t channel_id = 0;
+    uint8_t target[32];
+    uint16_t extranonce_size = 0;
+    Bytes extranonce_prefix;
+};
+
+struct NewExtendedMiningJob {
+    uint32_t channel_id = 0;
+    uint32_t job_id = 0;
+    bool has_min_ntime = false;  // false marks a future job
+    uint32_t min_ntime = 0;
+    uint32_t version = 0;
+    bool version_rolling_allowed = false;
+    std::vector<Bytes> merkle_path;
+    Bytes coinbase_prefix;
+    Bytes coinbase_suffix;
+};
+
+struct SetNewPrevHash {
+    uint32_t channel_id = 0;
+    uint32_t job_id = 0;
+    uint8_t prev_hash[32];
+    uint32_t min_ntime = 0;
+    uint32_t nbits = 0;
+};
+
+struct SubmitSharesExtended {
+    uint32_t channel_id = 0;
+    uint32_t sequence_number = 0;
+    uint32_t job_id = 0;
+    uint32_t nonce = 0;
+    uint32_t ntime = 0;
+    uint32_t version = 0;
+    Bytes extranonce;
+};
+
+struct SubmitSharesSuccess {
+    uint32_t channel_id = 0;
+    uint32_t last_sequence_number = 0;
+    uint32_t new_submits_accepted_count = 0;
+    uint64_t new_shares_sum = 0;
+};
+
+struct SubmitSharesError {
+    uint32_t channel_id = 0;
+    uint32_t sequence_number = 0;
+    String error_code;
+};
+
+Bytes EncodeFrame(uint8_t msg_type, bool channel_msg, const Bytes& payload);
+// Returns the bytes consumed, 0 when more data is needed, or -1 on a frame
+// larger than max_payload.
+long DecodeFrame(const uint8_t* data, size_t length, size_t max_payload, Frame& out);
+
+Bytes Encode(const SetupConnection& message);
+Bytes Encode(const OpenExtendedMiningChannel& message);
+Bytes Encode(const SubmitSharesExtended& message);
+
+bool Decode(const Bytes& payload, OpenExtendedMiningChannelSuccess& out);
+bool Decode(const Bytes& payload, NewExtendedMiningJob& out);
+bool Decode(const Bytes& payload, SetNewPrevHash& out);
+bool Decode(const Bytes& payload, SubmitSharesSuccess& out);
+bool Decode(const Bytes& payload, SubmitSharesError& out);
+bool DecodeSetTarget(const Bytes& payload, uint32_t& channel_id, uint8_t* target);
+bool DecodeSetExtranoncePrefix(const Bytes& payload, uint32_t& channel_id, Bytes& extranonce_prefix);
+String DecodeErrorCode(const Bytes& payload, size_t skip);
+
+// Pool difficulty relative to the difficulty-1 target, as mining.set_difficulty uses
+double TargetToDifficulty(const uint8_t* target);
+}  // namespace Sv2
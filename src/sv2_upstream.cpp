@@ -0,0 +1,526 @@
+#include "sv2_upstream.h"
+
+#include <Arduino.h>
+#include <ArduinoJson.h>
+#include <algorithm>
+#include <cstring>
+#include <vector>
+
+#include "app_context.h"
+#include "job_cache.h"
+#include "log.h"
+#include "miner_extranonce.h"
+#include "miner_handshake.h"
+#include "pool_client.h"
+#include "pool_tx.h"
+#include "stratum_server.h"
+#include "sv2_protocol.h"
+
+// Frames are exchanged unencrypted. The Noise_NX handshake that public SV2
+// pools require is not implemented, so the proxy only dials plaintext SV2
+// endpoints on the local network (a local job declarator/translator or a
+// pool's trusted-LAN port); see Sv2EndpointAllowed().
+
+namespace {
+#if defined(ESP8266)
+constexpr size_t kMaxFramePayload = 8 * 1024;
+#else
+constexpr size_t kMaxFramePayload = 32 * 1024;
+#endif
+constexpr size_t kMaxJobs = 8;
+constexpr size_t kMaxPendingShares = 64;
+constexpr uint16_t kMinExtranonceSize = 4;
+constexpr float kNominalHashRate = 1e12f;
+// SV2 lets miners roll the BIP 320 bits, and only on jobs that allow it
+constexpr uint32_t kVersionRollingMask = 0x1fffe000;
+constexpr size_t kResultDocSize = 128;
+constexpr uint32_t kOpenChannelRequestId = 1;
+
+enum class SessionState : uint8_t { kIdle, kSetup, kOpening, kOpen };
+
+struct PendingShare {
+    uint32_t sequence_number;
+    uint32_t upstream_id;
+};
+
+SessionState state = SessionState::kIdle;
+Sv2::Bytes rx_buffer;
+uint32_t channel_id = 0;
+String extranonce1_hex;
+uint16_t extranonce_size = 0;
+double difficulty = 0;
+std::vector<Sv2::NewExtendedMiningJob> jobs;
+Sv2::SetNewPrevHash prev_hash{};
+bool have_prev_hash = false;
+uint32_t next_sequence = 0;
+std::vector<PendingShare> pending_shares;
+// What the miners were last told about version rolling; unset until the first job
+bool rolling_known = false;
+bool rolling_allowed = false;
+
+const char kHexDigits[] = "0123456789abcdef";
+
+void AppendHex(String& out, const uint8_t* data, size_t length) {
+    out.reserve(out.length() + length * 2);
+    for (size_t i = 0; i < length; ++i) {
+        out += kHexDigits[data[i] >> 4];
+        out += kHexDigits[data[i] & 0x0F];
+    }
+}
+
+String Hex32(uint32_t value) {
+    char buffer[9];
+    snprintf(buffer, sizeof(buffer), "%08x", static_cast<unsigned int>(value));
+    return String(buffer);
+}
+
+String JobIdHex(uint32_t value) {
+    char buffer[9];
+    snprintf(buffer, sizeof(buffer), "%x", static_cast<unsigned int>(value));
+    return String(buffer);
+}
+
+bool ParseHex(const char* text, Sv2::Bytes& out) {
+    if (!text) {
+        return false;
+    }
+    size_t length = strlen(text);
+    if (length % 2 != 0) {
+        return false;
+    }
+    out.clear();
+    for (size_t i = 0; i < length; i += 2) {
+        char pair[3] = {text[i], text[i + 1], '\0'};
+        char* end = nullptr;
+        out.push_back(static_cast<uint8_t>(strtoul(pair, &end, 16)));
+        if (end != pair + 2) {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool ParseHex32(const char* text, uint32_t& out) {
+    if (!text || strlen(text) == 0 || strlen(text) > 8) {
+        return false;
+    }
+    char* end = nullptr;
+    out = static_cast<uint32_t>(strtoul(text, &end, 16));
+    return *end == '\0';
+}
+
+void SendFrame(uint8_t msg_type, bool channel_msg, const Sv2::Bytes& payload) {
+    Sv2::Bytes frame = Sv2::EncodeFrame(msg_type, channel_msg, payload);
+    metrics.pool_bytes_tx += frame.size();
+    PoolTxWrite(frame.data(), frame.size(), msg_type == Sv2::kMsgSubmitSharesExtended);
+}
+
+void DeliverPoolLine(const String& line) {
+    // Reuse the V1 path so metrics, capture and miner routing stay identical
+    ProcessPoolLine(line);
+}
+
+void DeliverResult(uint32_t upstream_id, bool accepted, int error_code, const String& message) {
+    // The message can come from the pool, so let the serializer escape it
+    DynamicJsonDocument doc(kResultDocSize + message.length());
+    doc["id"] = upstream_id;
+    doc["result"] = accepted;
+    if (accepted) {
+        doc["error"] = nullptr;
+    } else {
+        JsonArray error = doc.createNestedArray("error");
+        error.add(error_code);
+        error.add(message);
+        error.add(nullptr);
+    }
+    String line;
+    serializeJson(doc, line);
+    DeliverPoolLine(line);
+}
+
+// The first job answers the miners' mining.configure; a later job that
+// changes its mind moves them with mining.set_version_mask
+void NoteJobVersionRolling(const Sv2::NewExtendedMiningJob& job) {
+    if (rolling_known && job.version_rolling_allowed == rolling_allowed) {
+        return;
+    }
+    const bool announce = rolling_known;
+    rolling_known = true;
+    rolling_allowed = job.version_rolling_allowed;
+
+    DynamicJsonDocument result(kResultDocSize);
+    result["version-rolling"] = rolling_allowed;
+    result["version-rolling.mask"] = Hex32(kVersionRollingMask);
+    NotePoolConfigureResult(result.as<JsonVariantConst>());
+    if (announce) {
+        DeliverPoolLine("{\"id\":null,\"method\":\"mining.set_version_mask\",\"params\":[\"" +
+                        Hex32(rolling_allowed ? kVersionRollingMask : 0) + "\"]}");
+    }
+}
+
+void BroadcastDifficulty() {
+    DeliverPoolLine("{\"id\":null,\"method\":\"mining.set_difficulty\",\"params\":[" + String(difficulty, 4) + "]}");
+}
+
+Sv2::NewExtendedMiningJob* FindJob(uint32_t job_id) {
+    for (Sv2::NewExtendedMiningJob& job : jobs) {
+        if (job.job_id == job_id) {
+            return &job;
+        }
+    }
+    return nullptr;
+}
+
+void EmitNotify(const Sv2::NewExtendedMiningJob& job, bool clean_jobs) {
+    if (!have_prev_hash) {
+        return;
+    }
+
+    // V1 sends the previous hash as eight 32-bit words, each byte swapped
+    String prev_hex;
+    for (int word = 0; word < 8; ++word) {
+        for (int byte = 3; byte >= 0; --byte) {
+            AppendHex(prev_hex, &prev_hash.prev_hash[word * 4 + byte], 1);
+        }
+    }
+
+    String line = "{\"id\":null,\"method\":\"mining.notify\",\"params\":[\"" + JobIdHex(job.job_id) + "\",\"" + prev_hex +
+                  "\",\"";
+    AppendHex(line, job.coinbase_prefix.data(), job.coinbase_prefix.size());
+    line += "\",\"";
+    AppendHex(line, job.coinbase_suffix.data(), job.coinbase_suffix.size());
+    line += "\",[";
+    for (size_t i = 0; i < job.merkle_path.size(); ++i) {
+        line += i == 0 ? "\"" : ",\"";
+        AppendHex(line, job.merkle_path[i].data(), job.merkle_path[i].size());
+        line += "\"";
+    }
+    uint32_t ntime = job.has_min_ntime ? std::max(job.min_ntime, prev_hash.min_ntime) : prev_hash.min_ntime;
+    line += "],\"" + Hex32(job.version) + "\",\"" + Hex32(prev_hash.nbits) + "\",\"" + Hex32(ntime) + "\"," +
+            (clean_jobs ? "true" : "false") + "]}";
+
+    DeliverPoolLine(line);
+}
+
+int V1ErrorCode(const String& sv2_error) {
+    if (sv2_error == "stale-share" || sv2_error == "invalid-job-id") {
+        return 21;
+    }
+    if (sv2_error == "duplicate-share") {
+        return 22;
+    }
+    if (sv2_error == "difficulty-too-low") {
+        return 23;
+    }
+    return 20;
+}
+
+// A pool that wants Noise_NX answers the plaintext SetupConnection with
+// handshake bytes or just hangs up, so say so instead of retrying silently
+void FailSetup(const char* reason) {
+    LOG_ERROR("SV2 setup failed: %s. Only plaintext SV2 is supported; a pool that requires the Noise_NX "
+              "handshake needs a plaintext endpoint or a local translator\n", reason);
+    state = SessionState::kIdle;
+}
+
+void OpenChannel() {
+    Sv2::OpenExtendedMiningChannel open;
+    open.request_id = kOpenChannelRequestId;
+    open.user_identity = config.pool_user;
+    open.nominal_hash_rate = kNominalHashRate;
+    std::memset(open.max_target, 0xFF, sizeof(open.max_target));
+    open.min_extranonce_size = kMinExtranonceSize;
+    SendFrame(Sv2::kMsgOpenExtendedMiningChannel, false, Sv2::Encode(open));
+    state = SessionState::kOpening;
+}
+
+void HandleFrame(const Sv2::Frame& frame) {
+    if (state == SessionState::kSetup && frame.msg_type != Sv2::kMsgSetupConnectionSuccess &&
+        frame.msg_type != Sv2::kMsgSetupConnectionError) {
+        FailSetup("the pool did not answer SetupConnection");
+        PoolClient().stop();
+        return;
+    }
+
+    switch (frame.msg_type) {
+        case Sv2::kMsgSetupConnectionSuccess:
+            LOG_INFO("SV2 connection set up, opening channel\n");
+            OpenChannel();
+            break;
+
+        case Sv2::kMsgSetupConnectionError:
+            LOG_ERROR("SV2 setup rejected: %s\n", Sv2::DecodeErrorCode(frame.payload, 4).c_str());
+            PoolClient().stop();
+            break;
+
+        case Sv2::kMsgOpenExtendedMiningChannelSuccess: {
+            Sv2::OpenExtendedMiningChannelSuccess success;
+            if (!Sv2::Decode(frame.payload, success)) {
+                break;
+            }
+            channel_id = success.channel_id;
+            extranonce1_hex = "";
+            AppendHex(extranonce1_hex, success.extranonce_prefix.data(), success.extranonce_prefix.size());
+            extranonce_size = success.extranonce_size;
+            difficulty = Sv2::TargetToDifficulty(success.target);
+            state = SessionState::kOpen;
+            LOG_INFO("SV2 channel %u open, extranonce prefix %s, %u bytes for miners\n",
+                     static_cast<unsigned int>(channel_id), extranonce1_hex.c_str(),
+                     static_cast<unsigned int>(extranonce_size));
+            NoteUpstreamSession(extranonce1_hex);
+            SetUpstreamExtranonce(extranonce1_hex, extranonce_size);
+            BroadcastDifficulty();
+            break;
+        }
+
+        case Sv2::kMsgSetExtranoncePrefix: {
+            uint32_t prefix_channel;
+            Sv2::Bytes prefix;
+            if (Sv2::DecodeSetExtranoncePrefix(frame.payload, prefix_channel, prefix)) {
+                extranonce1_hex = "";
+                AppendHex(extranonce1_hex, prefix.data(), prefix.size());
+                // Applied with the next job, like mining.set_extranonce
+                StageUpstreamExtranonce(extranonce1_hex, extranonce_size);
+                LOG_DEBUG("SV2 extranonce prefix %s staged for the next job\n", extranonce1_hex.c_str());
+            }
+            break;
+        }
+
+        case Sv2::kMsgOpenMiningChannelError:
+            LOG_ERROR("SV2 channel rejected: %s\n", Sv2::DecodeErrorCode(frame.payload, 4).c_str());
+            PoolClient().stop();
+            break;
+
+        case Sv2::kMsgNewExtendedMiningJob: {
+            Sv2::NewExtendedMiningJob job;
+            if (!Sv2::Decode(frame.payload, job)) {
+                break;
+            }
+            if (jobs.size() >= kMaxJobs) {
+                jobs.erase(jobs.begin());
+            }
+            jobs.push_back(job);
+            NoteJobVersionRolling(job);
+            // Future jobs wait for their SetNewPrevHash
+            if (job.has_min_ntime) {
+                EmitNotify(job, false);
+            }
+            break;
+        }
+
+        case Sv2::kMsgSetNewPrevHash: {
+            Sv2::SetNewPrevHash update;
+            if (!Sv2::Decode(frame.payload, update)) {
+                break;
+            }
+            prev_hash = update;
+            have_prev_hash = true;
+            // Everything built on the old tip is stale now
+            Sv2::NewExtendedMiningJob* job = FindJob(update.job_id);
+            if (job) {
+                Sv2::NewExtendedMiningJob current = *job;
+                jobs.clear();
+                jobs.push_back(current);
+                EmitNotify(current, true);
+            }
+            break;
+        }
+
+        case Sv2::kMsgSetTarget: {
+            uint32_t target_channel;
+            uint8_t target[32];
+            if (Sv2::DecodeSetTarget(frame.payload, target_channel, target)) {
+                difficulty = Sv2::TargetToDifficulty(target);
+                BroadcastDifficulty();
+            }
+            break;
+        }
+
+        case Sv2::kMsgSubmitSharesSuccess: {
+            Sv2::SubmitSharesSuccess success;
+            if (!Sv2::Decode(frame.payload, success)) {
+                break;
+            }
+            // One success acknowledges every share up to last_sequence_number
+            std::vector<PendingShare> acknowledged;
+            auto acked = std::stable_partition(pending_shares.begin(), pending_shares.end(), [&](const PendingShare& share) {
+                return static_cast<int32_t>(share.sequence_number - success.last_sequence_number) > 0;
+            });
+            acknowledged.assign(acked, pending_shares.end());
+            pending_shares.erase(acked, pending_shares.end());
+            for (const PendingShare& share : acknowledged) {
+                DeliverResult(share.upstream_id, true, 0, String());
+            }
+            break;
+        }
+
+        case Sv2::kMsgSubmitSharesError: {
+            Sv2::SubmitSharesError error;
+            if (!Sv2::Decode(frame.payload, error)) {
+                break;
+            }
+            auto it = std::find_if(pending_shares.begin(), pending_shares.end(), [&](const PendingShare& share) {
+                return share.sequence_number == error.sequence_number;
+            });
+            if (it != pending_shares.end()) {
+                uint32_t upstream_id = it->upstream_id;
+                pending_shares.erase(it);
+                DeliverResult(upstream_id, false, V1ErrorCode(error.error_code), error.error_code);
+            }
+            break;
+        }
+
+        default:
+            break;
+    }
+}
+}
+
+bool Sv2EndpointAllowed(const IPAddress& endpoint) {
+    const uint8_t a = endpoint[0];
+    const uint8_t b = endpoint[1];
+    return a == 127 || a == 10 || (a == 172 && b >= 16 && b <= 31) || (a == 192 && b == 168) ||
+           (a == 169 && b == 254);
+}
+
+void Sv2BeginSession(const String& host, int port) {
+    Sv2ResetSession();
+
+    Sv2::SetupConnection setup;
+    setup.endpoint_host = host;
+    setup.endpoint_port = static_cast<uint16_t>(port);
+    setup.vendor = "YUMA";
+    setup.hardware_version = GetBoardName();
+    setup.firmware = "ESPStratumProxy/1.0";
+    SendFrame(Sv2::kMsgSetupConnection, false, Sv2::Encode(setup));
+    state = SessionState::kSetup;
+    LOG_INFO("SV2 SetupConnection sent\n");
+}
+
+void Sv2HandlePoolData() {
+    uint8_t chunk[512];
+    while (PoolClient().available()) {
+        int count = PoolClient().read(chunk, sizeof(chunk));
+        if (count <= 0) {
+            break;
+        }
+        metrics.pool_bytes_rx += count;
+        rx_buffer.insert(rx_buffer.end(), chunk, chunk + count);
+    }
+
+    size_t offset = 0;
+    Sv2::Frame frame;
+    while (true) {
+        long consumed = Sv2::DecodeFrame(rx_buffer.data() + offset, rx_buffer.size() - offset, kMaxFramePayload, frame);
+        if (consumed < 0 && state == SessionState::kSetup) {
+            FailSetup("the pool's reply is not an SV2 frame");
+            rx_buffer.clear();
+            PoolClient().stop();
+            return;
+        }
+        if (consumed < 0) {
+            LOG_ERROR("SV2 frame too large, dropping upstream\n");
+            rx_buffer.clear();
+            PoolClient().stop();
+            return;
+        }
+        if (consumed == 0) {
+            break;
+        }
+        offset += consumed;
+        HandleFrame(frame);
+    }
+    rx_buffer.erase(rx_buffer.begin(), rx_buffer.begin() + offset);
+}
+
+void Sv2NoteLinkDropped() {
+    if (state == SessionState::kSetup) {
+        FailSetup("the pool closed the connection during setup");
+    }
+}
+
+void Sv2ResetSession() {
+    state = SessionState::kIdle;
+    rx_buffer.clear();
+    jobs.clear();
+    have_prev_hash = false;
+    pending_shares.clear();
+    rolling_known = false;
+}
+
+size_t Sv2DropQueuedJobs() {
+    if (!have_prev_hash) {
+        return 0;
+    }
+
+    auto is_active = [](const Sv2::NewExtendedMiningJob& job) {
+        return job.has_min_ntime || job.job_id == prev_hash.job_id;
+    };
+    auto newest = std::find_if(jobs.rbegin(), jobs.rend(), is_active);
+    if (newest == jobs.rend()) {
+        return 0;
+    }
+
+    const uint32_t keep_id = newest->job_id;
+    const size_t before = jobs.size();
+    jobs.erase(std::remove_if(jobs.begin(), jobs.end(),
+                              [&](const Sv2::NewExtendedMiningJob& job) {
+                                  return is_active(job) && job.job_id != keep_id;
+                              }),
+               jobs.end());
+    if (jobs.size() == before) {
+        return 0;
+    }
+
+    jobs.shrink_to_fit();
+    // Shares for the dropped jobs could no longer be translated
+    EmitNotify(*FindJob(keep_id), true);
+    return before - jobs.size();
+}
+
+void Sv2ForwardMinerRequest(JsonDocument& request, uint32_t upstream_id) {
+    if (request["method"] != "mining.submit") {
+        DeliverResult(upstream_id, false, 20, "Unsupported method");
+        return;
+    }
+
+    // params: worker, job_id, extranonce2, ntime, nonce[, version_bits]
+    JsonArray params = request["params"];
+    uint32_t job_id = 0;
+    Sv2::SubmitSharesExtended share;
+    if (state != SessionState::kOpen || params.size() < 5 || !ParseHex32(params[1], job_id) ||
+        !ParseHex(params[2], share.extranonce) || !ParseHex32(params[3], share.ntime) ||
+        !ParseHex32(params[4], share.nonce)) {
+        DeliverResult(upstream_id, false, 20, "Malformed share");
+        return;
+    }
+
+    const Sv2::NewExtendedMiningJob* job = FindJob(job_id);
+    if (!job) {
+        DeliverResult(upstream_id, false, 21, "Job not found");
+        return;
+    }
+
+    share.version = job->version;
+    uint32_t version_bits = 0;
+    if (params.size() > 5 && ParseHex32(params[5], version_bits)) {
+        const uint32_t rolled = (job->version & ~kVersionRollingMask) | (version_bits & kVersionRollingMask);
+        // The pool would reject it anyway; no need to spend the round trip
+        if (rolled != job->version && !job->version_rolling_allowed) {
+            DeliverResult(upstream_id, false, 20, "Version rolling not allowed on this job");
+            return;
+        }
+        share.version = rolled;
+    }
+
+    share.channel_id = channel_id;
+    share.sequence_number = next_sequence++;
+    share.job_id = job_id;
+
+    if (pending_shares.size() >= kMaxPendingShares) {
+        pending_shares.erase(pending_shares.begin());
+    }
+    pending_shares.push_back({share.sequence_number, upstream_id});
+    SendFrame(Sv2::kMsgSubmitSharesExtended, true, Sv2::Encode(share));
+}
+
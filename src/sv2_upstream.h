@@ -0,0 +1,25 @@
+#pragma once
+
+#include <Arduino.h>
+#include <ArduinoJson.h>
+#include <IPAddress.h>
+
+#include "miner_session.h"
+
+// Stratum V2 upstream for a single extended channel, translated to and from
+// the Stratum V1 protocol spoken by the miners.
+// Frames are plaintext, so the pool must be on the local network: loopback,
+// link-local or a private (RFC 1918) address. Other endpoints are refused.
+bool Sv2EndpointAllowed(const IPAddress& endpoint);
+void Sv2BeginSession(const String& host, int port);
+void Sv2HandlePoolData();
+void Sv2ResetSession();
+// The pool link dropped on its own; explains a drop during setup
+void Sv2NoteLinkDropped();
+// Keeps only the newest active job and any future ones, and points the
+// miners at it with clean_jobs; returns how many jobs were dropped
+size_t Sv2DropQueuedJobs();
+
+// Translates a V1 request whose id has been rewritten to upstream_id. Replies
+// come back through ProcessPoolLine() as V1 responses with that id.
+void Sv2ForwardMinerRequest(JsonDocument& request, uint32_t upstream_id);
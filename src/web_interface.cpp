@@ -4,6 +4,8 @@
 #include <ArduinoJson.h>
 #include <ESPAsyncWebServer.h>
 #include <cstring>
+#include <memory>
+#include <vector>
 
 #if defined(ESP32)
 #include <WiFi.h>
@@ -12,9 +14,80 @@
 #endif
 
 #include "app_context.h"
+#include "cluster.h"
 #include "config_manager.h"
+#include "config_reload.h"
+#include "header_jobs.h"
+#include "health_monitor.h"
+#include "job_cache.h"
+#include "miner_admission.h"
+#include "miner_stats.h"
+#include "ota_update.h"
+#include "platform_fs.h"
+#include "pool_handover.h"
+#include "pool_probe.h"
+#include "pool_resolver.h"
+#include "pool_split.h"
+#include "pool_tls.h"
+#include "pool_tx.h"
+#include "power_policy.h"
+#include "scheduler.h"
+#include "status_display.h"
+#include "stratum_capture.h"
+#include "stratum_server.h"
 #include "wifi_setup.h"
 
+namespace {
+constexpr size_t kMinersPageSize = 50;
+constexpr size_t kMinersMaxPageSize = 100;
+
+// Cursor for one /api/miners response. Rows are rendered one at a time as
+// the server asks for more body, so a page never sits in RAM as a whole.
+// Sessions are looked up by index on every call, never held across calls,
+// since a miner can disconnect while the response is still going out.
+struct MinersStream {
+    size_t next = 0;
+    size_t end = 0;
+    bool first_row = true;
+    bool closed = false;
+    String pending;
+    size_t pending_pos = 0;
+};
+
+// Refills pending; false once the closing bracket has gone out
+bool NextMinersPiece(MinersStream& stream) {
+    stream.pending_pos = 0;
+    if (stream.closed) {
+        stream.pending = "";
+        return false;
+    }
+    AsyncLockGuard guard(MinerSessionLock());
+    if (stream.next < stream.end && stream.next < connected_miners.size()) {
+        stream.pending = stream.first_row ? "" : ",";
+        stream.pending += MinerStatsJson(connected_miners[stream.next], millis());
+        stream.first_row = false;
+        stream.next++;
+        return true;
+    }
+    stream.pending = "]}";
+    stream.closed = true;
+    return true;
+}
+
+// Answers the request itself and returns false when it may not touch OTA
+bool AuthorizeOta(AsyncWebServerRequest* request) {
+    if (!OtaEnabled()) {
+        request->send(403, "text/plain", "OTA is disabled; build with YUMA_OTA_PASSWORD to enable it");
+        return false;
+    }
+    if (!OtaRequestAllowed(request)) {
+        request->requestAuthentication();
+        return false;
+    }
+    return true;
+}
+}
+
 void SetupWebServer() {
     if (server != nullptr) {
         delete server;
@@ -43,6 +116,8 @@ void SetupWebServer() {
         h1, h2 { color: #00aaff; }
         .static-grid { display: grid; grid-template-columns: repeat(auto-fit, minmax(220px, 1fr)); gap: 10px; }
         .static-grid div { display: flex; flex-direction: column; }
+        table { width: 100%; border-collapse: collapse; font-size: 13px; }
+        th, td { text-align: left; padding: 3px 6px; border-bottom: 1px solid #3a3a3a; }
     </style>
     <script>
         function updateStats() {
@@ -52,6 +127,7 @@ void SetupWebServer() {
                     '<div class="metric"><span>Uptime:</span><span>' + data.uptime + '</span></div>' +
                     '<div class="metric"><span>Shares OK:</span><span class="green">' + data.shares_ok + '</span></div>' +
                     '<div class="metric"><span>Shares Bad:</span><span class="red">' + data.shares_bad + '</span></div>' +
+                    '<div class="metric"><span>Shares Stale:</span><span class="orange">' + data.shares_stale + '</span></div>' +
                     '<div class="metric"><span>Jobs Received:</span><span>' + data.jobs_received + '</span></div>' +
                     '<div class="metric"><span>Difficulty:</span><span>' + data.current_difficulty + '</span></div>' +
                     '<div class="metric"><span>Last Job:</span><span>' + data.last_job_id + '</span></div>' +
@@ -60,11 +136,40 @@ void SetupWebServer() {
                     '<div class="metric"><span>mDNS Address:</span><span><a href="http://yuma.local" target="_blank">yuma.local</a></span></div>' +
                     '<div class="metric"><span>Gateway:</span><span>' + data.gateway + '</span></div>' +
                     '<div class="metric"><span>Static IP Mode:</span><span class="' + (data.static_ip_mode ? 'green">Enabled' : 'orange">DHCP') + '</span></div>' +
-                    '<div class="metric"><span>WiFi RSSI:</span><span>' + data.wifi_rssi + ' dBm</span></div>';
+                    '<div class="metric"><span>WiFi RSSI:</span><span>' + data.wifi_rssi + ' dBm</span></div>' +
+                    '<div class="metric"><span>Boot to First Job:</span><span>' + (data.boot.first_notify_ms ? data.boot.first_notify_ms + ' ms' : 'waiting') + (data.boot.fast_wifi ? ' (fast boot)' : '') + '</span></div>';
+            });
+        }
+        function formatHashrate(h) {
+            const units = ['H/s', 'kH/s', 'MH/s', 'GH/s', 'TH/s'];
+            let i = 0;
+            while (h >= 1000 && i < units.length - 1) { h /= 1000; i++; }
+            return h.toFixed(1) + ' ' + units[i];
+        }
+        function updateMiners() {
+            fetch('/api/miners?limit=100').then(r => r.json()).then(data => {
+                const body = document.getElementById('miners');
+                body.innerHTML = '';
+                data.miners.forEach(m => {
+                    const row = body.insertRow();
+                    const submitted = m.accepted + m.rejected + m.stale;
+                    [m.ip, m.worker, m.user_agent, formatHashrate(m.hashrate), m.difficulty,
+                     m.accepted + ' / ' + m.rejected + ' / ' + m.stale,
+                     m.last_share_s === null ? '-' : m.last_share_s + ' s',
+                     Math.floor(m.connected_s / 60) + ' min'].forEach(value => {
+                        row.insertCell().textContent = value;
+                    });
+                    if (submitted > 0 && m.rejected * 10 > submitted) {
+                        row.className = 'red';
+                    }
+                });
+                document.getElementById('miners-total').textContent = data.total > data.miners.length ?
+                    'showing ' + data.miners.length + ' of ' + data.total : '';
             });
         }
         setInterval(updateStats, 5000);
-        window.onload = updateStats;
+        setInterval(updateMiners, 10000);
+        window.onload = () => { updateStats(); updateMiners(); };
     </script>
 </head>
 <body>
@@ -76,6 +181,14 @@ void SetupWebServer() {
             <div id="status">Loading...</div>
         </div>
 
+        <div class="status">
+            <h2>Miners <span id="miners-total" class="orange"></span></h2>
+            <table>
+                <thead><tr><th>IP</th><th>Worker</th><th>Agent</th><th>Hashrate</th><th>Diff</th><th>A / R / S</th><th>Last Share</th><th>Up</th></tr></thead>
+                <tbody id="miners"></tbody>
+            </table>
+        </div>
+
         <div class="config-form">
             <h2>Configuration</h2>
             <form action="/config" method="POST">
@@ -87,6 +200,14 @@ void SetupWebServer() {
                     <label>Pool Port:</label><br>
                     <input type="number" name="pool_port" value=")HTML" + String(config.pool_port) + R"HTML(">
                 </div>
+                <div>
+                    <input type="checkbox" name="pool_sv2" )HTML" + String(config.pool_sv2 ? "checked" : "") + R"HTML(>
+                    <label>SV2 (plaintext/local only): Stratum V2 upstream to a LAN or loopback pool, no Noise encryption</label>
+                </div>
+                <div>
+                    <label>Submit Coalescing Window (&micro;s, 0 = off):</label><br>
+                    <input type="number" name="submit_coalesce_us" min="0" value=")HTML" + String(config.submit_coalesce_us) + R"HTML(">
+                </div>
                 <div>
                     <label>Pool User (Wallet):</label><br>
                     <input type="text" name="pool_user" value=")HTML" + String(config.pool_user) + R"HTML(" style="width: 400px;">
@@ -96,12 +217,85 @@ void SetupWebServer() {
                     <input type="text" name="pool_pass" value=")HTML" + String(config.pool_pass) + R"HTML(">
                 </div>
                 <div>
-                    <label>Initial Difficulty:</label><br>
+                    <label>Pool TLS Fingerprint (hex; SHA-256, SHA-1 on ESP8266; empty = certificate not verified):</label><br>
+                    <input type="text" name="pool_tls_fingerprint" value=")HTML" + String(config.pool_tls_fingerprint) + R"HTML(" style="width: 400px;">
+                </div>
+                <div>
+                    <label>Worker Map (miner=upstream, comma separated, * suffix matches a prefix):</label><br>
+                    <input type="text" name="worker_map" value=")HTML" + String(config.worker_map) + R"HTML(" style="width: 400px;">
+                </div>
+                <div>
+                    <label>Allowed Workers (comma separated, empty allows all):</label><br>
+                    <input type="text" name="worker_allow" value=")HTML" + String(config.worker_allow) + R"HTML(" style="width: 400px;">
+                </div>
+                <div>
+                    <input type="checkbox" name="header_jobs" )HTML" + String(config.header_jobs ? "checked" : "") + R"HTML(>
+                    <label>Build Header Jobs for Miners That Ask</label>
+                </div>
+                <div>
+                    <label>Alternate Pool Host (empty = one pool only):</label><br>
+                    <input type="text" name="alt_pool_host" value=")HTML" + String(config.alt_pool_host) + R"HTML(" style="width: 300px;">
+                </div>
+                <div>
+                    <label>Alternate Pool Port:</label><br>
+                    <input type="number" name="alt_pool_port" value=")HTML" + String(config.alt_pool_port) + R"HTML(">
+                </div>
+                <div>
+                    <label>Alternate Pool User (Wallet):</label><br>
+                    <input type="text" name="alt_pool_user" value=")HTML" + String(config.alt_pool_user) + R"HTML(" style="width: 400px;">
+                </div>
+                <div>
+                    <label>Alternate Pool Password:</label><br>
+                    <input type="text" name="alt_pool_pass" value=")HTML" + String(config.alt_pool_pass) + R"HTML(">
+                </div>
+                <div>
+                    <label>Alternate Pool TLS Fingerprint:</label><br>
+                    <input type="text" name="alt_pool_tls_fingerprint" value=")HTML" + String(config.alt_pool_tls_fingerprint) + R"HTML(" style="width: 400px;">
+                </div>
+                <div>
+                    <label>Alternate Pool Share of Work (%):</label><br>
+                    <input type="number" name="alt_pool_weight" min="0" max="100" value=")HTML" + String(config.alt_pool_weight) + R"HTML(">
+                </div>
+                <div>
+                    <label>Minimum Time on One Pool (s):</label><br>
+                    <input type="number" name="pool_slice_s" min="60" value=")HTML" + String(config.pool_slice_s) + R"HTML(">
+                </div>
+                <div>
+                    <label>Suggested Difficulty (the pool's vardiff sets each miner's):</label><br>
                     <input type="number" name="difficulty" value=")HTML" + String(config.difficulty) + R"HTML(">
                 </div>
                 <div>
-                    <input type="checkbox" name="vardiff_enabled" )HTML" + String(config.vardiff_enabled ? "checked" : "") + R"HTML(">
-                    <label>VarDiff Enabled</label>
+                    <label>Miner Idle Timeout (s, 0 = off):</label><br>
+                    <input type="number" name="miner_idle_timeout_s" min="0" value=")HTML" + String(config.miner_idle_timeout_s) + R"HTML(">
+                </div>
+                <div>
+                    <label>Miner ACK Timeout (ms, 0 = off):</label><br>
+                    <input type="number" name="miner_ack_timeout_ms" min="0" value=")HTML" + String(config.miner_ack_timeout_ms) + R"HTML(">
+                </div>
+                <div>
+                    <label>Sibling Proxy for Overflow Miners (host, empty = refuse):</label><br>
+                    <input type="text" name="sibling_host" value=")HTML" + String(config.sibling_host) + R"HTML(" placeholder="192.168.1.51">
+                    <input type="number" name="sibling_port" value=")HTML" + String(config.sibling_port) + R"HTML(">
+                </div>
+                <div>
+                    <input type="checkbox" name="cluster_balance" )HTML" + String(config.cluster_balance ? "checked" : "") + R"HTML(">
+                    <label>Balance Miners Across YUMA Proxies on This Network</label>
+                </div>
+                <div>
+                    <label>Shed Load Below Free Heap (KB, 0 = off):</label><br>
+                    <input type="number" name="shed_heap_kb" min="0" value=")HTML" + String(config.shed_heap_kb) + R"HTML(">
+                </div>
+                <div>
+                    <label>Shed Load Above Loop Lag (ms, 0 = off):</label><br>
+                    <input type="number" name="shed_lag_ms" min="0" value=")HTML" + String(config.shed_lag_ms) + R"HTML(">
+                </div>
+                <div>
+                    <label>Wi-Fi Power Policy:</label><br>
+                    <select name="power_policy">
+                        <option value="auto")HTML" + String(config.power_policy == 0 ? " selected" : "") + R"HTML(>Auto (awake while mining)</option>
+                        <option value="performance")HTML" + String(config.power_policy == 1 ? " selected" : "") + R"HTML(>Always awake</option>
+                        <option value="powersave")HTML" + String(config.power_policy == 2 ? " selected" : "") + R"HTML(>Always power save</option>
+                    </select>
                 </div>
                 <div>
                     <input type="checkbox" name="use_static_ip" )HTML" + String(config.use_static_ip ? "checked" : "") + R"HTML(">
@@ -134,7 +328,7 @@ void SetupWebServer() {
         <div class="status">
             <h2>Actions</h2>
             <button onclick="location.href='/reset_wifi'">Reset WiFi</button>
-            <button onclick="location.href='/test_pool'">Test Pool</button>
+            <button onclick="fetch('/test_pool', {method: 'POST'}).then(() => location.href = '/test_pool')">Test Pool</button>
         </div>
     </div>
 </body>
@@ -144,27 +338,316 @@ void SetupWebServer() {
     });
 
     server->on("/api/status", HTTP_GET, [](AsyncWebServerRequest* request) {
-        DynamicJsonDocument doc(512);
+        // Runs off loop() on ESP32; the session list must not change under it
+        AsyncLockGuard guard(MinerSessionLock());
+        // Each miner or peer entry adds roughly 96 bytes of nodes and copied strings
+        DynamicJsonDocument doc(2816 + (connected_miners.size() + ClusterPeerCount()) * 96);
 
         unsigned long uptime_seconds = (millis() - metrics.uptime_start) / 1000;
         doc["pool_connected"] = metrics.pool_connected;
         doc["uptime"] = String(uptime_seconds / 3600) + "h " + String((uptime_seconds % 3600) / 60) + "m";
         doc["shares_ok"] = metrics.shares_ok;
         doc["shares_bad"] = metrics.shares_bad;
+        doc["shares_stale"] = metrics.shares_stale;
         doc["jobs_received"] = metrics.jobs_received;
         doc["current_difficulty"] = metrics.current_difficulty;
         doc["last_job_id"] = metrics.last_job_id;
         doc["connected_miners_count"] = connected_miners.size();
+        doc["miners_reaped_idle"] = metrics.miners_reaped_idle;
+        doc["miners_reaped_ack"] = metrics.miners_reaped_ack;
+
+        const MinerAdmissionStats& admission_stats = CurrentMinerAdmissionStats();
+        JsonObject admission = doc.createNestedObject("admission");
+        admission["capacity"] = admission_stats.capacity;
+        admission["refused"] = admission_stats.refused;
+        admission["redirected"] = admission_stats.redirected;
+        admission["session_budget_bytes"] = admission_stats.session_budget;
+        admission["session_samples"] = admission_stats.session_samples;
+        admission["measured_session_bytes"] = admission_stats.measured_session_bytes;
+        admission["startup_free_heap"] = admission_stats.startup_free_heap;
+        admission["free_heap"] = ESP.getFreeHeap();
+
+        const ClusterStats& cluster_stats = CurrentClusterStats();
+        JsonObject cluster = doc.createNestedObject("cluster");
+        cluster["balance"] = config.cluster_balance;
+        cluster["rebalanced"] = cluster_stats.rebalanced;
+        JsonArray cluster_peers = cluster.createNestedArray("peers");
+        for (size_t i = 0; i < ClusterPeerCount(); ++i) {
+            const ClusterPeer& peer = GetClusterPeer(i);
+            JsonObject entry = cluster_peers.createNestedObject();
+            entry["address"] = peer.address.toString() + ":" + String(peer.port);
+            entry["miners"] = peer.miners;
+            entry["capacity"] = peer.capacity;
+            entry["pool_ok"] = peer.pool_ok;
+            entry["age_s"] = (millis() - peer.seen_ms) / 1000;
+        }
         doc["wifi_rssi"] = WiFi.RSSI();
         doc["ip_address"] = WiFi.localIP().toString();
         doc["gateway"] = WiFi.gatewayIP().toString();
         doc["static_ip_mode"] = config.use_static_ip;
+        doc["restart_pending"] = ConfigRestartPending();
+
+        const HandoverStats& handover_stats = CurrentHandoverStats();
+        JsonObject handover = doc.createNestedObject("pool_handover");
+        handover["state"] = HandoverStateName(CurrentHandoverState());
+        handover["completed"] = handover_stats.completed;
+        handover["failed"] = handover_stats.failed;
+        handover["last_duration_ms"] = handover_stats.last_duration_ms;
+        handover["last_error"] = handover_stats.last_error;
+
+        const PoolSplitStats& split_stats = CurrentPoolSplitStats();
+        JsonObject split = doc.createNestedObject("pool_split");
+        split["enabled"] = PoolSplitEnabled();
+        split["active"] = ActivePoolIndex() == kPrimaryPool ? "primary" : "alternate";
+        split["switches"] = split_stats.switches;
+        split["held_by_miners"] = split_stats.held_by;
+        JsonArray split_pools = split.createNestedArray("pools");
+        for (size_t i = 0; i < kPoolCount; ++i) {
+            JsonObject entry = split_pools.createNestedObject();
+            entry["host"] = PoolTargetAt(i).host;
+            entry["weight_pct"] = PoolWeightPercent(i);
+            entry["work_pct"] = PoolWorkPercent(i);
+            entry["work"] = split_stats.work[i];
+            entry["shares"] = split_stats.shares[i];
+            entry["time_s"] = split_stats.ms_on_pool[i] / 1000;
+        }
+
+        const HeaderJobStats& header_stats = CurrentHeaderJobStats();
+        JsonObject headers = doc.createNestedObject("header_jobs");
+        headers["enabled"] = config.header_jobs;
+        headers["miners"] = HeaderJobMinerCount();
+        headers["templates"] = header_stats.templates;
+        headers["built"] = header_stats.headers;
+        headers["build_us_avg"] = header_stats.headers > 0 ? header_stats.build_us_total / header_stats.headers : 0;
+        headers["build_us_max"] = header_stats.build_us_max;
+
+        JsonObject boot = doc.createNestedObject("boot");
+        boot["wifi_ms"] = metrics.boot_wifi_ms;
+        boot["pool_ms"] = metrics.boot_pool_ms;
+        boot["first_notify_ms"] = metrics.boot_first_notify_ms;
+        boot["fast_wifi"] = metrics.boot_fast_wifi;
+        boot["cached_pool"] = metrics.boot_cached_pool;
+
+#ifdef USE_OLED_STATUS
+        const DisplayStats& display_stats = CurrentDisplayStats();
+        JsonObject display = doc.createNestedObject("display");
+        display["refreshes"] = display_stats.refreshes;
+        display["pages_sent"] = display_stats.pages_sent;
+        display["io_us_total"] = display_stats.io_us_total;
+        display["io_us_max"] = display_stats.io_us_max;
+#endif
+
+        JsonObject upstream = doc.createNestedObject("upstream");
+        upstream["protocol"] = config.pool_sv2 ? "sv2" : "sv1";
+        upstream["bytes_rx"] = metrics.pool_bytes_rx;
+        upstream["bytes_tx"] = metrics.pool_bytes_tx;
+        upstream["tls"] = PoolUriUsesTls(ActivePool().host);
+
+        const PoolTxStats& tx_stats = CurrentPoolTxStats();
+        upstream["writes"] = tx_stats.writes;
+        upstream["shares_sent"] = tx_stats.shares;
+        if (tx_stats.shares > 0) {
+            upstream["packets_per_share"] = static_cast<float>(tx_stats.share_writes) / tx_stats.shares;
+            upstream["bytes_per_share"] = static_cast<float>(tx_stats.share_bytes) / tx_stats.shares;
+        }
+
+        const PoolTlsStats& tls_stats = CurrentPoolTlsStats();
+        JsonObject tls = upstream.createNestedObject("tls_handshakes");
+        tls["full"] = tls_stats.handshakes_full;
+        tls["failed"] = tls_stats.handshake_failures;
+        tls["last_ms"] = tls_stats.last_handshake_ms;
+        tls["heap_bytes"] = tls_stats.heap_cost;
+        tls["verified"] = tls_stats.verified;
+        tls["pin_mismatches"] = tls_stats.pin_mismatches;
+        if (PoolTlsResumes()) {
+            tls["resumed"] = tls_stats.handshakes_resumed;
+            tls["session_cached"] = tls_stats.session_cached;
+        }
+
+        JsonArray endpoints = doc.createNestedArray("pool_endpoints");
+        const int active = ActivePoolEndpoint();
+        const unsigned long now = millis();
+        for (size_t i = 0; i < PoolEndpointCount(); ++i) {
+            const PoolEndpoint& endpoint = GetPoolEndpoint(i);
+            JsonObject entry = endpoints.createNestedObject();
+            entry["ip"] = endpoint.address.toString();
+            entry["rtt_ms"] = endpoint.rtt_ms;
+            entry["healthy"] = endpoint.healthy;
+            entry["active"] = static_cast<int>(i) == active;
+            entry["failures"] = endpoint.failures;
+            entry["age_s"] = (now - endpoint.resolved_ms) / 1000;
+            entry["ttl_s"] = endpoint.ttl_s;
+        }
+
+        JsonArray miners = doc.createNestedArray("miners");
+        for (const MinerSession* session : connected_miners) {
+            JsonObject entry = miners.createNestedObject();
+            entry["ip"] = session->client->remoteIP().toString();
+            entry["idle_s"] = (now - session->last_rx_ms) / 1000;
+            entry["accepted"] = session->shares_accepted;
+            entry["rejected"] = session->shares_rejected;
+            entry["stale"] = session->shares_stale;
+        }
 
         String response;
         serializeJson(doc, response);
         request->send(200, "application/json", response);
     });
 
+    // ?offset=N&limit=M pages through the sessions in connection order
+    server->on("/api/miners", HTTP_GET, [](AsyncWebServerRequest* request) {
+        const size_t total = MinerSessionCount();
+        long offset = request->hasParam("offset") ? request->getParam("offset")->value().toInt() : 0;
+        long limit = request->hasParam("limit") ? request->getParam("limit")->value().toInt() : kMinersPageSize;
+        offset = std::max(offset, 0L);
+        limit = constrain(limit, 1L, static_cast<long>(kMinersMaxPageSize));
+
+        auto stream = std::make_shared<MinersStream>();
+        stream->next = static_cast<size_t>(offset);
+        stream->end = stream->next + static_cast<size_t>(limit);
+        stream->pending = "{\"total\":" + String(static_cast<unsigned long>(total)) + ",\"offset\":" + String(offset) +
+                          ",\"limit\":" + String(limit) + ",\"miners\":[";
+
+        AsyncWebServerResponse* response = request->beginChunkedResponse(
+            "application/json", [stream](uint8_t* buffer, size_t max_len, size_t index) -> size_t {
+                size_t written = 0;
+                while (written < max_len) {
+                    if (stream->pending_pos >= stream->pending.length() && !NextMinersPiece(*stream)) {
+                        break;
+                    }
+                    size_t count = std::min(max_len - written, stream->pending.length() - stream->pending_pos);
+                    std::memcpy(buffer + written, stream->pending.c_str() + stream->pending_pos, count);
+                    stream->pending_pos += count;
+                    written += count;
+                }
+                return written;
+            });
+        request->send(response);
+    });
+
+    server->on("/api/health", HTTP_GET, [](AsyncWebServerRequest* request) {
+        const HealthStats& health = CurrentHealthStats();
+        // Each task entry is eleven nodes, about 192 bytes
+        DynamicJsonDocument doc(768 + TaskCount() * 192);
+        doc["level"] = ShedLevelName(health.level);
+        doc["shed_events"] = health.shed_events;
+        doc["jobs_dropped"] = health.jobs_dropped;
+        doc["free_heap"] = health.free_heap;
+        doc["min_free_heap"] = health.min_free_heap;
+        doc["largest_block"] = health.largest_block;
+        doc["fragmentation_pct"] = health.fragmentation;
+        doc["loop_lag_ms"] = health.loop_lag_ms;
+        doc["loop_lag_peak_ms"] = health.loop_lag_peak_ms;
+        doc["shed_heap_kb"] = config.shed_heap_kb;
+        doc["shed_lag_ms"] = config.shed_lag_ms;
+
+        JsonArray stacks = doc.createNestedArray("stacks");
+        for (size_t i = 0; i < health.stack_count; ++i) {
+            JsonObject entry = stacks.createNestedObject();
+            entry["task"] = health.stacks[i].name;
+            entry["free_bytes"] = health.stacks[i].free_bytes;
+        }
+
+        JsonArray tasks = doc.createNestedArray("tasks");
+        for (size_t i = 0; i < TaskCount(); ++i) {
+            const TaskStats& task = GetTaskStats(i);
+            JsonObject entry = tasks.createNestedObject();
+            entry["name"] = task.name;
+            entry["priority"] = TaskPriorityName(task.priority);
+            entry["period_ms"] = task.period_ms;
+            entry["budget_us"] = task.budget_us;
+            entry["runs"] = task.runs;
+            entry["signalled_runs"] = task.signalled_runs;
+            entry["overruns"] = task.overruns;
+            entry["last_us"] = task.last_us;
+            entry["max_us"] = task.max_us;
+            entry["max_late_ms"] = task.max_late_ms;
+        }
+
+        String response;
+        serializeJson(doc, response);
+        request->send(200, "application/json", response);
+    });
+
+    server->on("/api/power", HTTP_GET, [](AsyncWebServerRequest* request) {
+        const PowerStats& power = CurrentPowerStats();
+        DynamicJsonDocument doc(1536);
+        doc["policy"] = PowerPolicyName(static_cast<PowerPolicy>(config.power_policy));
+        doc["mode"] = PowerModeName(power.mode);
+        doc["switches"] = power.switches;
+
+        JsonArray bounds = doc.createNestedArray("bucket_ms");
+        for (unsigned long bound : kLatencyBucketMs) {
+            bounds.add(bound);
+        }
+
+        JsonObject modes = doc.createNestedObject("modes");
+        for (size_t i = 0; i < kPowerModeCount; ++i) {
+            const LatencyHistogram& histogram = power.reply_latency[i];
+            JsonObject entry = modes.createNestedObject(PowerModeName(static_cast<PowerMode>(i)));
+            entry["seconds"] = power.ms_in_mode[i] / 1000;
+            entry["replies"] = histogram.count;
+            entry["avg_ms"] = histogram.count > 0 ? histogram.total_ms / histogram.count : 0;
+            entry["max_ms"] = histogram.max_ms;
+            JsonArray buckets = entry.createNestedArray("buckets");
+            for (unsigned long bucket : histogram.buckets) {
+                buckets.add(bucket);
+            }
+        }
+
+        String response;
+        serializeJson(doc, response);
+        request->send(200, "application/json", response);
+    });
+
+    // Registered before /api/capture, which would otherwise also match this path
+    server->on("/api/capture/status", HTTP_GET, [](AsyncWebServerRequest* request) {
+        DynamicJsonDocument doc(256);
+        doc["mode"] = CaptureModeName(capture_mode);
+        doc["records"] = CaptureRecordCount();
+        doc["buffered_bytes"] = CaptureBufferedBytes();
+        doc["dropped"] = CaptureDroppedCount();
+
+        String response;
+        serializeJson(doc, response);
+        request->send(200, "application/json", response);
+    });
+
+    server->on("/api/capture", HTTP_GET, [](AsyncWebServerRequest* request) {
+        if (request->hasParam("file")) {
+            const char* path = request->getParam("file")->value() == "old" ? kCaptureOldFilePath : kCaptureFilePath;
+            if (!STORAGE_FS.exists(path)) {
+                request->send(404, "text/plain", "No capture file");
+                return;
+            }
+            request->send(STORAGE_FS, path, "application/octet-stream", true);
+            return;
+        }
+
+        auto snapshot = std::make_shared<std::vector<uint8_t>>();
+        SnapshotCapture(*snapshot);
+        AsyncWebServerResponse* response = request->beginResponse(
+            "application/octet-stream", snapshot->size(),
+            [snapshot](uint8_t* buffer, size_t max_len, size_t index) -> size_t {
+                size_t count = std::min(max_len, snapshot->size() - index);
+                std::memcpy(buffer, snapshot->data() + index, count);
+                return count;
+            });
+        response->addHeader("Content-Disposition", "attachment; filename=capture.bin");
+        request->send(response);
+    });
+
+    server->on("/api/capture", HTTP_POST, [](AsyncWebServerRequest* request) {
+        CaptureMode mode;
+        if (!request->hasParam("mode", true) || !ParseCaptureMode(request->getParam("mode", true)->value(), mode)) {
+            request->send(400, "text/plain", "mode must be off, ram or flash");
+            return;
+        }
+
+        SetCaptureMode(mode);
+        request->send(200, "text/plain", CaptureModeName(mode));
+    });
+
     server->on("/config", HTTP_POST, [](AsyncWebServerRequest* request) {
         if (request->hasParam("pool_host", true)) {
             CopyStringField(config.pool_host, sizeof(config.pool_host), request->getParam("pool_host", true)->value());
@@ -172,16 +655,87 @@ void SetupWebServer() {
         if (request->hasParam("pool_port", true)) {
             config.pool_port = request->getParam("pool_port", true)->value().toInt();
         }
+        config.pool_sv2 = request->hasParam("pool_sv2", true);
+        if (request->hasParam("submit_coalesce_us", true)) {
+            int window_us = request->getParam("submit_coalesce_us", true)->value().toInt();
+            config.submit_coalesce_us = window_us > 0 ? window_us : 0;
+        }
         if (request->hasParam("pool_user", true)) {
             CopyStringField(config.pool_user, sizeof(config.pool_user), request->getParam("pool_user", true)->value());
         }
         if (request->hasParam("pool_pass", true)) {
             CopyStringField(config.pool_pass, sizeof(config.pool_pass), request->getParam("pool_pass", true)->value());
         }
+        if (request->hasParam("pool_tls_fingerprint", true)) {
+            CopyStringField(config.pool_tls_fingerprint, sizeof(config.pool_tls_fingerprint),
+                            request->getParam("pool_tls_fingerprint", true)->value());
+        }
+        if (request->hasParam("worker_map", true)) {
+            CopyStringField(config.worker_map, sizeof(config.worker_map), request->getParam("worker_map", true)->value());
+        }
+        if (request->hasParam("worker_allow", true)) {
+            CopyStringField(config.worker_allow, sizeof(config.worker_allow),
+                            request->getParam("worker_allow", true)->value());
+        }
+        config.header_jobs = request->hasParam("header_jobs", true);
+        if (request->hasParam("alt_pool_host", true)) {
+            CopyStringField(config.alt_pool_host, sizeof(config.alt_pool_host),
+                            request->getParam("alt_pool_host", true)->value());
+        }
+        if (request->hasParam("alt_pool_port", true)) {
+            config.alt_pool_port = request->getParam("alt_pool_port", true)->value().toInt();
+        }
+        if (request->hasParam("alt_pool_user", true)) {
+            CopyStringField(config.alt_pool_user, sizeof(config.alt_pool_user),
+                            request->getParam("alt_pool_user", true)->value());
+        }
+        if (request->hasParam("alt_pool_pass", true)) {
+            CopyStringField(config.alt_pool_pass, sizeof(config.alt_pool_pass),
+                            request->getParam("alt_pool_pass", true)->value());
+        }
+        if (request->hasParam("alt_pool_tls_fingerprint", true)) {
+            CopyStringField(config.alt_pool_tls_fingerprint, sizeof(config.alt_pool_tls_fingerprint),
+                            request->getParam("alt_pool_tls_fingerprint", true)->value());
+        }
+        if (request->hasParam("alt_pool_weight", true)) {
+            int weight = request->getParam("alt_pool_weight", true)->value().toInt();
+            config.alt_pool_weight = constrain(weight, 0, 100);
+        }
+        if (request->hasParam("pool_slice_s", true)) {
+            int slice_s = request->getParam("pool_slice_s", true)->value().toInt();
+            config.pool_slice_s = slice_s > kMinPoolSliceS ? slice_s : kMinPoolSliceS;
+        }
         if (request->hasParam("difficulty", true)) {
             config.difficulty = request->getParam("difficulty", true)->value().toInt();
         }
-        config.vardiff_enabled = request->hasParam("vardiff_enabled", true);
+        if (request->hasParam("miner_idle_timeout_s", true)) {
+            int timeout_s = request->getParam("miner_idle_timeout_s", true)->value().toInt();
+            config.miner_idle_timeout_s = timeout_s > 0 ? timeout_s : 0;
+        }
+        if (request->hasParam("miner_ack_timeout_ms", true)) {
+            int timeout_ms = request->getParam("miner_ack_timeout_ms", true)->value().toInt();
+            config.miner_ack_timeout_ms = timeout_ms > 0 ? timeout_ms : 0;
+        }
+        if (request->hasParam("sibling_host", true)) {
+            CopyStringField(config.sibling_host, sizeof(config.sibling_host), request->getParam("sibling_host", true)->value());
+        }
+        if (request->hasParam("sibling_port", true)) {
+            config.sibling_port = request->getParam("sibling_port", true)->value().toInt();
+        }
+        config.cluster_balance = request->hasParam("cluster_balance", true);
+        if (request->hasParam("shed_heap_kb", true)) {
+            int heap_kb = request->getParam("shed_heap_kb", true)->value().toInt();
+            config.shed_heap_kb = heap_kb > 0 ? heap_kb : 0;
+        }
+        if (request->hasParam("shed_lag_ms", true)) {
+            int lag_ms = request->getParam("shed_lag_ms", true)->value().toInt();
+            config.shed_lag_ms = lag_ms > 0 ? lag_ms : 0;
+        }
+        PowerPolicy policy;
+        if (request->hasParam("power_policy", true) &&
+            ParsePowerPolicy(request->getParam("power_policy", true)->value(), policy)) {
+            config.power_policy = static_cast<int>(policy);
+        }
         bool static_requested = request->hasParam("use_static_ip", true);
 
         if (request->hasParam("static_ip", true)) {
@@ -220,12 +774,57 @@ void SetupWebServer() {
             request->send(500, "text/plain", "Failed to save configuration");
             return;
         }
+        NoteConfigChange();
 
         request->redirect("/");
     });
 
+    // Registered before /api/ota, which would otherwise also match this path
+    server->on("/api/ota/reboot", HTTP_POST, [](AsyncWebServerRequest* request) {
+        if (!AuthorizeOta(request)) {
+            return;
+        }
+        unsigned long delay_s = request->hasParam("in_s", true) ? request->getParam("in_s", true)->value().toInt() : 0;
+        if (!ScheduleOtaReboot(delay_s * 1000UL)) {
+            request->send(409, "text/plain", "No verified image waiting");
+            return;
+        }
+        request->send(200, "text/plain", "Reboot scheduled");
+    });
+
+    server->on("/api/ota", HTTP_GET, [](AsyncWebServerRequest* request) {
+        const OtaStatus ota = CurrentOtaStatus();
+        DynamicJsonDocument doc(384);
+        doc["state"] = OtaStateName(ota.state);
+        doc["received"] = ota.received;
+        doc["written"] = ota.written;
+        doc["elapsed_ms"] = ota.started_ms ? millis() - ota.started_ms : 0;
+        doc["last_slice_us"] = ota.last_slice_us;
+        doc["max_slice_us"] = ota.max_slice_us;
+        if (ota.reboot_at_ms) {
+            doc["reboot_in_ms"] = static_cast<long>(ota.reboot_at_ms - millis());
+        }
+        if (ota.error.length() > 0) {
+            doc["error"] = ota.error;
+        }
+
+        String response;
+        serializeJson(doc, response);
+        request->send(200, "application/json", response);
+    });
+
+    // The image is still being written when the upload ends; poll GET /api/ota
+    server->on("/api/ota", HTTP_POST, [](AsyncWebServerRequest* request) {
+        if (!AuthorizeOta(request)) {
+            return;
+        }
+        const OtaStatus ota = CurrentOtaStatus();
+        request->send(ota.state == OtaState::kFailed ? 500 : 202, "text/plain", OtaStateName(ota.state));
+    }, HandleOtaUpload);
+
     server->on("/restart", HTTP_GET, [](AsyncWebServerRequest* request) {
         request->send(200, "text/plain", "Restarting...");
+        SaveJobCache();
         delay(1000);
         ESP.restart();
     });
@@ -238,7 +837,36 @@ void SetupWebServer() {
     });
 
     server->on("/test_pool", HTTP_GET, [](AsyncWebServerRequest* request) {
-        request->send(200, "text/plain", "Pool test not implemented yet");
+        request->send(200, "application/json", PoolProbeJson());
+    });
+
+    // Runs on the scheduler; poll GET /test_pool for the samples
+    server->on("/test_pool", HTTP_POST, [](AsyncWebServerRequest* request) {
+        PoolProbeRequest probe;
+        if (request->hasParam("host", true)) {
+            probe.host = request->getParam("host", true)->value();
+        }
+        if (request->hasParam("port", true)) {
+            probe.port = request->getParam("port", true)->value().toInt();
+        }
+        if (request->hasParam("user", true)) {
+            probe.user = request->getParam("user", true)->value();
+        }
+        if (request->hasParam("pass", true)) {
+            probe.pass = request->getParam("pass", true)->value();
+        }
+        if (request->hasParam("samples", true)) {
+            probe.samples = request->getParam("samples", true)->value().toInt();
+        }
+        if (request->hasParam("watch_s", true)) {
+            probe.watch_s = request->getParam("watch_s", true)->value().toInt();
+        }
+
+        if (const char* error = StartPoolProbe(probe)) {
+            request->send(PoolProbeActive() ? 409 : 400, "text/plain", error);
+            return;
+        }
+        request->send(202, "text/plain", "probe started");
     });
 
     server->begin();
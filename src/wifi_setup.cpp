@@ -4,15 +4,25 @@
 
 #if defined(ESP32)
 #include <WiFi.h>
+#include <esp_wifi.h>
+#ifndef YUMA_HEADLESS
 #include <WiFiManager.h>
+#endif
 #elif defined(ESP8266)
 #include <ESP8266WiFi.h>
+#ifndef YUMA_HEADLESS
 #include <ESPAsync_WiFiManager.h>
 #endif
+#endif
 
 #include "app_context.h"
+#include "boot_cache.h"
+#include "log.h"
 
 namespace {
+#ifdef YUMA_HEADLESS
+constexpr unsigned long kHeadlessConnectTimeoutMs = 30000;
+#else
 #if defined(ESP32)
 WiFiManager wifiManager;
 #elif defined(ESP8266)
@@ -24,6 +34,8 @@ ESPAsync_WiFiManager wifiManager(&server, &dns);
 constexpr char kPortalSsid[] = "YUMA-PROXY";
 constexpr char kPortalPassword[] = "12345678";
 constexpr uint8_t kPortalMaxRetries = 3;
+#endif
+constexpr unsigned long kFastConnectTimeoutMs = 5000;
 
 bool WaitForConnection(unsigned long timeout_ms) {
     const unsigned long start = millis();
@@ -33,9 +45,73 @@ bool WaitForConnection(unsigned long timeout_ms) {
     return WiFi.status() == WL_CONNECTED;
 }
 
+// The station credentials the SDK keeps in flash. The ESP32 core's
+// WiFi.SSID() and WiFi.psk() read the live connection and stay empty until
+// the station associates, so ask the driver for its stored config there.
+void StoredStationCredentials(String& ssid, String& psk) {
+#if defined(ESP32)
+    wifi_config_t conf = {};
+    if (esp_wifi_get_config(WIFI_IF_STA, &conf) != ESP_OK) {
+        ssid = "";
+        psk = "";
+        return;
+    }
+    char buffer[sizeof(conf.sta.password) + 1] = {};
+    memcpy(buffer, conf.sta.ssid, sizeof(conf.sta.ssid));
+    ssid = buffer;
+    memset(buffer, 0, sizeof(buffer));
+    memcpy(buffer, conf.sta.password, sizeof(conf.sta.password));
+    psk = buffer;
+#elif defined(ESP8266)
+    ssid = WiFi.SSID();
+    psk = WiFi.psk();
+#endif
+}
+
+// Associate straight to the cached BSSID/channel, skipping the scan. The
+// credentials are the ones the SDK stored; the cache only says where the
+// access point was, and only while the SDK still holds the same network.
+bool TryFastWifiConnect() {
+    if (!HasBootCache()) {
+        return false;
+    }
+
+    const BootCache& cache = CurrentBootCache();
+    String ssid;
+    String psk;
+    StoredStationCredentials(ssid, psk);
+    if (ssid.length() == 0 || ssid != cache.ssid) {
+        return false;
+    }
+
+    LOG_INFO("Fast WiFi connect to %s (channel %d)\n", cache.ssid, static_cast<int>(cache.channel));
+
+    WiFi.begin(ssid.c_str(), psk.c_str(), cache.channel, cache.bssid);
+    if (WaitForConnection(kFastConnectTimeoutMs)) {
+        return true;
+    }
+
+    LOG_ERROR("Fast WiFi connect failed, falling back to full association\n");
+    WiFi.disconnect(false);
+    return false;
+}
+
+#ifdef YUMA_HEADLESS
+// No portal to fall back on: join the network baked in with YUMA_WIFI_SSID,
+// or whatever the radio kept from an earlier provisioned firmware
+bool ConnectWithBuiltInCredentials() {
+    if (config.ssid[0] != '\0') {
+        WiFi.begin(config.ssid, config.password);
+    } else {
+        WiFi.begin();
+    }
+    return WaitForConnection(kHeadlessConnectTimeoutMs);
+}
+#endif
+
 #if defined(ESP32)
 void on_wifi_disconnect(WiFiEvent_t event, WiFiEventInfo_t info) {
-    Serial.printf("WiFi disconnected. Reason: %d\n", info.wifi_sta_disconnected.reason);
+    LOG_INFO("WiFi disconnected. Reason: %d\n", info.wifi_sta_disconnected.reason);
     // Full list of reasons:
     // https://github.com/espressif/esp-idf/blob/master/components/esp_wifi/include/esp_wifi_types.h
 }
@@ -58,7 +134,7 @@ bool ConfigureStaticIp(IPAddress& ip_out, IPAddress& gateway_out,
 
     if (!parse_ip(cfg.static_ip, ip_out) || !parse_ip(cfg.static_gateway, gateway_out) ||
         !parse_ip(cfg.static_subnet, subnet_out)) {
-        Serial.println("Invalid static IP configuration detected, falling back to DHCP");
+        LOG_ERROR("Invalid static IP configuration detected, falling back to DHCP\n");
         return false;
     }
 
@@ -66,11 +142,13 @@ bool ConfigureStaticIp(IPAddress& ip_out, IPAddress& gateway_out,
         dns_out = gateway_out;
     }
 
+#ifndef YUMA_HEADLESS
 #if defined(ESP32)
     wifiManager.setSTAStaticIPConfig(ip_out, gateway_out, subnet_out, dns_out);
 #elif defined(ESP8266)
     wifiManager.setSTAStaticIPConfig(ip_out, gateway_out, subnet_out);
 #endif
+#endif
 #if defined(ESP8266) || defined(ESP32)
     WiFi.config(ip_out, gateway_out, subnet_out, dns_out);
 #endif
@@ -91,6 +169,7 @@ void SetupWifi() {
     WiFi.mode(WIFI_STA);
     WiFi.setAutoReconnect(true);
 
+#ifndef YUMA_HEADLESS
     // Configure access point settings
     wifiManager.setAPStaticIPConfig(IPAddress(192, 168, 4, 1), IPAddress(192, 168, 4, 1),
                                     IPAddress(255, 255, 255, 0));
@@ -108,12 +187,13 @@ void SetupWifi() {
     // Save parameters to flash automatically
 #if defined(ESP32)
     wifiManager.setSaveParamsCallback([]() {
-        Serial.println("WiFi parameters saved!");
+        LOG_INFO("WiFi parameters saved!\n");
     });
 #elif defined(ESP8266)
     wifiManager.setSaveConfigCallback([]() {
-        Serial.println("WiFi parameters saved!");
+        LOG_INFO("WiFi parameters saved!\n");
     });
+#endif
 #endif
 
     // IMPORTANT: Allow WiFi credentials to be saved
@@ -127,14 +207,22 @@ void SetupWifi() {
     // Configure static IP if requested
     bool static_configured = ConfigureStaticIp(static_ip, static_gateway, static_subnet, static_dns);
     if (static_configured) {
-        Serial.printf("Static IP requested: %s\n", static_ip.toString().c_str());
+        LOG_INFO("Static IP requested: %s\n", static_ip.toString().c_str());
     }
 
-    Serial.println("Starting WiFi connection...");
+    LOG_INFO("Starting WiFi connection...\n");
 
     bool connected = WiFi.status() == WL_CONNECTED;
     if (!connected) {
+        connected = TryFastWifiConnect();
+        metrics.boot_fast_wifi = connected;
+    }
+    if (!connected) {
+#ifdef YUMA_HEADLESS
+        connected = ConnectWithBuiltInCredentials();
+#else
         connected = wifiManager.autoConnect(kPortalSsid, kPortalPassword);
+#endif
     }
 
     if (WiFi.status() != WL_CONNECTED) {
@@ -142,34 +230,44 @@ void SetupWifi() {
     }
 
     if (!connected || WiFi.status() != WL_CONNECTED) {
-        Serial.println("Connection failed after autoConnect, reopening config portal...");
+#ifdef YUMA_HEADLESS
+        LOG_ERROR("Unable to join WiFi with the built-in credentials. Restarting...\n");
+        delay(1000);
+        ESP.restart();
+#else
+        LOG_ERROR("Connection failed after autoConnect, reopening config portal...\n");
         uint8_t attempt = 0;
         while (WiFi.status() != WL_CONNECTED && attempt < kPortalMaxRetries) {
             attempt++;
-            Serial.printf("Config portal attempt %u/%u\n",
-                          static_cast<unsigned int>(attempt),
-                          static_cast<unsigned int>(kPortalMaxRetries));
+            LOG_INFO("Config portal attempt %u/%u\n",
+                     static_cast<unsigned int>(attempt),
+                     static_cast<unsigned int>(kPortalMaxRetries));
             bool portal_connected = wifiManager.startConfigPortal(kPortalSsid, kPortalPassword);
             if (portal_connected && WaitForConnection(10000)) {
                 break;
             }
-            Serial.println("Config portal closed without a successful connection");
+            LOG_INFO("Config portal closed without a successful connection\n");
         }
 
         if (WiFi.status() != WL_CONNECTED) {
-            Serial.println("Unable to establish WiFi link after multiple attempts. Restarting...");
+            LOG_ERROR("Unable to establish WiFi link after multiple attempts. Restarting...\n");
             delay(1000);
             ESP.restart();
         }
+#endif
     }
 
-    Serial.println("WiFi connected!");
+    LOG_INFO("WiFi connected!\n");
     DebugWifiStatus();
+    RememberWifiLink();
 }
 
 void ResetWifiSettings() {
-    Serial.println("Resetting WiFi settings...");
+    LOG_INFO("Resetting WiFi settings...\n");
+#ifndef YUMA_HEADLESS
     wifiManager.resetSettings();
+#endif
+    ForgetWifiLink();
 
     // Also clear ESP32/ESP8266 saved credentials
     WiFi.disconnect(true);  // true = erase saved credentials
@@ -177,10 +275,10 @@ void ResetWifiSettings() {
 }
 
 void DebugWifiStatus() {
-    Serial.printf("WiFi Status: %d\n", WiFi.status());
-    Serial.printf("SSID: %s\n", WiFi.SSID().c_str());
-    Serial.printf("IP: %s\n", WiFi.localIP().toString().c_str());
-    Serial.printf("Gateway: %s\n", WiFi.gatewayIP().toString().c_str());
-    Serial.printf("DNS: %s\n", WiFi.dnsIP().toString().c_str());
-    Serial.printf("RSSI: %d dBm\n", WiFi.RSSI());
+    LOG_INFO("WiFi Status: %d\n", WiFi.status());
+    LOG_INFO("SSID: %s\n", WiFi.SSID().c_str());
+    LOG_INFO("IP: %s\n", WiFi.localIP().toString().c_str());
+    LOG_INFO("Gateway: %s\n", WiFi.gatewayIP().toString().c_str());
+    LOG_INFO("DNS: %s\n", WiFi.dnsIP().toString().c_str());
+    LOG_INFO("RSSI: %d dBm\n", WiFi.RSSI());
 }